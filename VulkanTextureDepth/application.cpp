@@ -13,14 +13,18 @@
 // Include modules here
 #include "include/application.hpp"
 #include "include/constants.hpp"
+#include "include/queues.hpp"
 
 #include <vector>
 #include <iostream>
 #include <glm/glm.hpp>            // Core GLM functionality
-#define GLM_FORCE_RADIANS
-#define GLM_FORCE_DEPTH_ZERO_TO_ONE
-#include <glm/gtc/matrix_transform.hpp>  // For glm::rotate, glm::lookAt, glm::perspective
+#include <glm/gtc/matrix_transform.hpp>  // For glm::rotate, glm::lookAt
 #include <chrono>
+#include <algorithm>
+#include <thread>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 // ================================================================================
 // ================================================================================
 
@@ -28,7 +32,9 @@ VulkanInstance::VulkanInstance(GLFWwindow* window, ValidationLayers& validationL
     : windowInstance(window), validationLayers(validationLayers) {
 
     createInstance();
-    createSurface();
+    if (windowInstance != nullptr) {
+        createSurface();
+    }
 }
 // --------------------------------------------------------------------------------
 
@@ -80,9 +86,13 @@ void VulkanInstance::createInstance() {
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.apiVersion = VK_API_VERSION_1_3;
 
-    uint32_t extensionCount = 0;
-    const char** extensions = glfwGetRequiredInstanceExtensions(&extensionCount);
-    std::vector<const char*> extensionVector(extensions, extensions + extensionCount);
+    // A headless instance needs no surface extensions, so GLFW need not be initialized
+    std::vector<const char*> extensionVector;
+    if (windowInstance != nullptr) {
+        uint32_t extensionCount = 0;
+        const char** extensions = glfwGetRequiredInstanceExtensions(&extensionCount);
+        extensionVector.assign(extensions, extensions + extensionCount);
+    }
 
     if (validationLayers.isEnabled()) {
         std::vector<const char*> validationLayerExtensions = validationLayers.getRequiredExtensions();
@@ -127,80 +137,28 @@ void VulkanInstance::createSurface() {
 
 
 VulkanApplication::VulkanApplication(GLFWwindow* window, 
-                                     const std::vector<Vertex>& vertices,
-                                     const std::vector<uint16_t>& indices)
+                                     const MeshSource& mesh,
+                                     const std::string& texturePath,
+                                     LatencyMode latencyMode,
+                                     const DepthConfig& depthConfig)
     : windowInstance(std::move(window)),
-      vertices(vertices),
-      indices(indices){
-    // Instantiate related classes
+      latencyProfile(LatencyProfile::get(latencyMode)),
+      depthConfig(depthConfig){
     glfwSetWindowUserPointer(windowInstance, this);
+    createResources(texturePath, mesh);
+}
+// --------------------------------------------------------------------------------
 
-    validationLayers = std::make_unique<ValidationLayers>();
-    vulkanInstanceCreator = std::make_unique<VulkanInstance>(this->windowInstance, 
-                                                             *validationLayers.get());
-    vulkanPhysicalDevice = std::make_unique<VulkanPhysicalDevice>(*this->vulkanInstanceCreator->getInstance(),
-                                                                  this->vulkanInstanceCreator->getSurface());
-    vulkanLogicalDevice = std::make_unique<VulkanLogicalDevice>(vulkanPhysicalDevice->getDevice(),
-                                                                validationLayers->getValidationLayers(),
-                                                                vulkanInstanceCreator->getSurface(),
-                                                                deviceExtensions);
-    allocatorManager = std::make_unique<AllocatorManager>(
-        vulkanPhysicalDevice->getDevice(),
-        vulkanLogicalDevice->getDevice(),
-        *vulkanInstanceCreator->getInstance());
-
-    swapChain = std::make_unique<SwapChain>(vulkanLogicalDevice->getDevice(),
-                                            vulkanInstanceCreator->getSurface(),
-                                            vulkanPhysicalDevice->getDevice(),
-                                            this->windowInstance);
-    depthManager = std::make_unique<DepthManager>(
-        *allocatorManager,                              // Dereference unique_ptr
-        vulkanLogicalDevice->getDevice(),
-        vulkanPhysicalDevice->getDevice(),
-        swapChain->getSwapChainExtent()
-    );
-    depthManager->createDepthResources();
-    commandBufferManager = std::make_unique<CommandBufferManager>(vulkanLogicalDevice->getDevice(),
-                                                                  indices,
-                                                                  vulkanPhysicalDevice->getDevice(),
-                                                                  vulkanInstanceCreator->getSurface());
-    samplerManager = std::make_unique<SamplerManager>(
-            vulkanLogicalDevice->getDevice(),
-            vulkanPhysicalDevice->getDevice()
-    );
-    samplerManager->createSampler("default");
-    textureManager = std::make_unique<TextureManager>(
-        *allocatorManager,                              // Dereference unique_ptr
-        vulkanLogicalDevice->getDevice(),
-        vulkanPhysicalDevice->getDevice(),
-        *commandBufferManager,                          // Dereference unique_ptr
-        vulkanLogicalDevice->getGraphicsQueue(),
-        "../../../data/texture.jpg",
-        *samplerManager
-    );
-    bufferManager = std::make_unique<BufferManager>(vertices,
-                                                    indices,
-                                                    *allocatorManager,
-                                                    *commandBufferManager.get(),
-                                                    vulkanLogicalDevice->getGraphicsQueue());
-    descriptorManager = std::make_unique<DescriptorManager>(vulkanLogicalDevice->getDevice());
-    descriptorManager->createDescriptorSets(bufferManager->getUniformBuffers(),
-                                            textureManager->getTextureImageView(),
-                                            samplerManager->getSampler("default"));
-    graphicsPipeline = std::make_unique<GraphicsPipeline>(vulkanLogicalDevice->getDevice(),
-                                                          *swapChain.get(),
-                                                          *commandBufferManager.get(),
-                                                          *bufferManager.get(),
-                                                          *descriptorManager.get(),
-                                                          indices,
-                                                          vulkanPhysicalDevice->getDevice(),
-                                                          std::string("../../shaders/shader.vert.spv"),
-                                                          std::string("../../shaders/shader.frag.spv"),
-                                                          *depthManager);
-    graphicsPipeline->createFrameBuffers(swapChain->getSwapChainImageViews(), 
-                                         swapChain->getSwapChainExtent());
-    graphicsQueue = this->vulkanLogicalDevice->getGraphicsQueue();
-    presentQueue = this->vulkanLogicalDevice->getPresentQueue();
+VulkanApplication::VulkanApplication(const HeadlessConfig& headlessConfig,
+                                     const MeshSource& mesh,
+                                     const std::string& texturePath,
+                                     LatencyMode latencyMode,
+                                     const DepthConfig& depthConfig)
+    : windowInstance(nullptr),
+      latencyProfile(LatencyProfile::get(latencyMode)),
+      depthConfig(depthConfig),
+      headlessConfig(headlessConfig){
+    createResources(texturePath, mesh);
 }
 // -------------------------------------------------------------------------------- 
 
@@ -218,31 +176,235 @@ void VulkanApplication::scrollCallback(GLFWwindow* window, double xoffset, doubl
 }
 // --------------------------------------------------------------------------------
 
+void VulkanApplication::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    VulkanApplication* app = reinterpret_cast<VulkanApplication*>(glfwGetWindowUserPointer(window));
+    if (!app || action != GLFW_PRESS) {
+        return;
+    }
+    switch (key) {
+        case GLFW_KEY_R: app->reloadTexture(app->texturePath); break;
+        case GLFW_KEY_1: app->setLatencyMode(LatencyMode::LowLatency); break;
+        case GLFW_KEY_2: app->setLatencyMode(LatencyMode::Balanced); break;
+        case GLFW_KEY_3: app->setLatencyMode(LatencyMode::Throughput); break;
+        case GLFW_KEY_4: app->setLatencyMode(LatencyMode::PowerSaver); break;
+        case GLFW_KEY_P: app->writeFrameTimings(); break;
+        case GLFW_KEY_M: app->writeMemoryStats(); break;
+        default: break;
+    }
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::reloadTexture(const std::string& path) {
+    texturePath = path;
+    // Runs from trim() on this thread once the new image is live
+    textureRegistry->reloadAsync(texture, path, [this](TextureHandle) {
+        textureDescriptorStale.assign(textureDescriptorStale.size(), true);
+    });
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::setLatencyMode(LatencyMode mode) {
+    if (mode == latencyProfile.mode) {
+        return;
+    }
+    latencyProfile = LatencyProfile::get(mode);
+
+    // Every per-frame object is replaced, so nothing may still be executing
+    vkDeviceWaitIdle(vulkanLogicalDevice->getDevice());
+    // Frame numbering restarts at slot 0, so publish what the old slots still hold
+    resolveFramesInFlight();
+
+    commandBufferManager->setFramesInFlight(latencyProfile.framesInFlight);
+    const uint32_t framesInFlight = commandBufferManager->getFramesInFlight();
+    bufferManager->recreateUniformBuffers(framesInFlight);
+    const TextureManager& current = textureRegistry->get(texture);
+    descriptorManager->createDescriptorSets(bufferManager->getUniformBuffer(),
+                                            bufferManager->getUniformSlotSize(),
+                                            framesInFlight,
+                                            cullingPass->getInstanceBuffers(),
+                                            current.getTextureImageView(),
+                                            current.getTextureSampler());
+    // The new sets already bind the current texture
+    textureDescriptorStale.assign(framesInFlight, false);
+    currentFrame = 0;
+
+    // Offscreen images cover every slot already and do not depend on the profile
+    if (isHeadless()) {
+        logLatencyProfile();
+        return;
+    }
+
+    // The present mode and image count only change with a new swap chain
+    DeletionQueue& deletionQueue = commandBufferManager->getDeletionQueue();
+    swapChain->setLatencyProfile(latencyProfile);
+    graphicsPipeline->retireFramebuffers(deletionQueue);
+    swapChain->recreateSwapChain(deletionQueue);
+    depthManager->recreateDepthResources(swapChain->getSwapChainExtent(), deletionQueue);
+    graphicsPipeline->createFrameBuffers(swapChain->getSwapChainImageViews(), swapChain->getSwapChainExtent());
+    // The old fences are gone along with the old frame slots
+    imagesInFlight.assign(swapChain->getSwapChainImages().size(), VK_NULL_HANDLE);
+    // The device is still idle, so the old swap chain can go right away
+    deletionQueue.flush();
+
+    presentPacer->resetSwapChain();
+    presentPacer->setEnabled(latencyProfile.presentWait);
+    logLatencyProfile();
+}
+// --------------------------------------------------------------------------------
+
 void VulkanApplication::run() {
+    if (isHeadless()) {
+        throw std::runtime_error("A headless application has no window to run; use runFrames instead!");
+    }
     glfwSetScrollCallback(windowInstance, scrollCallback);
+    glfwSetKeyCallback(windowInstance, keyCallback);
     while (!glfwWindowShouldClose(windowInstance)) {
+        // A minimized window has no surface to draw to; sleep until it is restored
+        if (isMinimized()) {
+            glfwWaitEvents();
+            continue;
+        }
+        // With pacing on, input is sampled only once the previous frame is on screen
+        presentPacer->waitForLastPresent(swapChain->getSwapChain());
         glfwPollEvents();
         drawFrame();
 
         if (framebufferResized) {
+            framebufferResized = false;
             recreateSwapChain();
+        }
+    }
+    vkDeviceWaitIdle(vulkanLogicalDevice->getDevice());
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::runFrames(uint32_t frameCount) {
+    for (uint32_t i = 0; i < frameCount; ++i) {
+        if (!isHeadless()) {
+            if (glfwWindowShouldClose(windowInstance)) {
+                break;
+            }
+            // Time spent minimized does not use up the frame count
+            if (isMinimized()) {
+                glfwWaitEvents();
+                --i;
+                continue;
+            }
+            presentPacer->waitForLastPresent(swapChain->getSwapChain());
+            glfwPollEvents();
+        }
+        drawFrame();
+
+        if (framebufferResized) {
             framebufferResized = false;
+            recreateSwapChain();
         }
     }
     vkDeviceWaitIdle(vulkanLogicalDevice->getDevice());
+    // The last frames are otherwise only published when their slots are reused
+    resolveFramesInFlight();
+}
+// --------------------------------------------------------------------------------
+
+bool VulkanApplication::isHeadless() const {
+    return windowInstance == nullptr;
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::setReadbackCallback(std::function<void(const ReadbackFrame&)> callback) {
+    if (!offscreenTarget || !offscreenTarget->hasReadback()) {
+        throw std::runtime_error("Readback needs a headless application created with readback enabled!");
+    }
+    offscreenTarget->setReadbackCallback(std::move(callback));
+}
+// --------------------------------------------------------------------------------
+
+const Profiler& VulkanApplication::getProfiler() const {
+    return *profiler;
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::setFrameCallback(std::function<void(uint64_t)> callback) {
+    frameCallback = std::move(callback);
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::setFixedTimeStep(float seconds) {
+    fixedTimeStep = seconds;
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::bindTexture(TextureHandle handle) {
+    if (handle == texture) {
+        return;
+    }
+    textureRegistry->addRef(handle);
+    TextureHandle previous = texture;
+    texture = handle;
+    // Frames in flight still sample the old texture until their sets are rewritten, and
+    // trim() only destroys it once no frame can use it
+    textureRegistry->release(previous);
+    textureDescriptorStale.assign(textureDescriptorStale.size(), true);
+}
+// --------------------------------------------------------------------------------
+
+Scene& VulkanApplication::getScene() {
+    return *scene;
+}
+// --------------------------------------------------------------------------------
+
+TextureRegistry& VulkanApplication::getTextureRegistry() {
+    return *textureRegistry;
+}
+// --------------------------------------------------------------------------------
+
+UploadQueue& VulkanApplication::getUploadQueue() {
+    return *uploadQueue;
+}
+// --------------------------------------------------------------------------------
+
+MeshArena& VulkanApplication::getMeshArena() {
+    return *meshArena;
+}
+// --------------------------------------------------------------------------------
+
+AllocatorManager& VulkanApplication::getAllocatorManager() {
+    return *allocatorManager;
 }
 // ================================================================================
 
 void VulkanApplication::destroyResources() {
+    // Join the decode workers before anything they record into is destroyed
+    threadPool.reset();
+    recordingPool.reset();
+
+    presentPacer.reset();
     graphicsPipeline.reset();
+    profiler.reset();
+    cullingPass.reset();
+    // Writes the cache back to disk for the next launch
+    pipelineCache.reset();
     descriptorManager.reset();
+    scene.reset();
+
+    // Textures hold sampler handles and retire images into the command buffer manager's
+    // deletion queue, so they go first
+    if (textureRegistry && texture.isValid()) {
+        textureRegistry->release(texture);
+    }
+    textureRegistry.reset();
     commandBufferManager.reset();
-    
+    // The deletion queue frees retired slots of the table while it is flushed
+    bindlessTable.reset();
     samplerManager.reset();
-    textureManager.reset();
     bufferManager.reset(); 
+    meshArena.reset();
     depthManager.reset();
     swapChain.reset();
+    offscreenTarget.reset();
+
+    // Releases any staging memory still owned by in-flight upload batches
+    uploadQueue.reset();
     
     // Reset allocator before logical device
     allocatorManager.reset();
@@ -259,37 +421,114 @@ void VulkanApplication::destroyResources() {
 void VulkanApplication::drawFrame() {
     VkDevice device = vulkanLogicalDevice->getDevice();
     uint32_t frameIndex = currentFrame;
+    profiler->beginFrame(frameIndex);
 
     // Wait for the frame to be finished
+    profiler->beginScope(CpuScope::FenceWait);
     commandBufferManager->waitForFences(frameIndex);
+    profiler->endScope(CpuScope::FenceWait);
+
+    // Acquire before the slot is touched, so a frame abandoned for an out-of-date swap chain
+    // leaves its fence signaled and the next attempt does not wait forever on it. Each frame
+    // slot owns one offscreen image, so headless frames have nothing to acquire
+    uint32_t imageIndex = frameIndex;
+    VkFence inFlightFence = commandBufferManager->getInFlightFence(frameIndex);
+    if (!isHeadless()) {
+        profiler->beginScope(CpuScope::Acquire);
+        VkResult result = vkAcquireNextImageKHR(device, swapChain->getSwapChain(), UINT64_MAX, 
+                                                commandBufferManager->getImageAvailableSemaphore(frameIndex), 
+                                                VK_NULL_HANDLE, &imageIndex);
+        profiler->endScope(CpuScope::Acquire);
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            recreateSwapChain(); // Recreate swap chain if it's out of date
+            return;
+        } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            throw std::runtime_error("failed to acquire swap chain image!");
+        }
+
+        // With fewer images than frames in flight, another slot may still render to this image
+        if (imagesInFlight[imageIndex] != VK_NULL_HANDLE && imagesInFlight[imageIndex] != inFlightFence) {
+            vkWaitForFences(device, 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+        }
+        imagesInFlight[imageIndex] = inFlightFence;
+    }
+
+    // The slot's timestamp queries and readback copy are complete now and are reused by
+    // this frame's recording
+    profiler->resolveFrame(frameIndex);
+    if (offscreenTarget) {
+        offscreenTarget->resolveReadback(frameIndex);
+    }
+    // This frame is now certain to be submitted
     commandBufferManager->resetFences(frameIndex);
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(device, swapChain->getSwapChain(), UINT64_MAX, 
-                                            commandBufferManager->getImageAvailableSemaphore(frameIndex), 
-                                            VK_NULL_HANDLE, &imageIndex);
+    // Recycles the frame's primary and secondary command buffers in one call per pool
+    commandBufferManager->resetCommandPools(frameIndex);
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        recreateSwapChain(); // Recreate swap chain if it's out of date
-        return;
-    } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        throw std::runtime_error("failed to acquire swap chain image!");
+    // Scripted workloads change the scene, bound texture and uploads while the slot is idle
+    if (frameCallback) {
+        frameCallback(framesRendered);
     }
 
-    // Update the uniform buffer with the current image/frame
-    updateUniformBuffer(frameIndex);
+    // The frame that last used this slot has finished, so unreferenced textures may go
+    textureRegistry->trim();
 
-    VkCommandBuffer cmdBuffer = commandBufferManager->getCommandBuffer(frameIndex);
+    // Background compiles and shader edits take effect at this frame boundary
+    graphicsPipeline->updatePipelines(commandBufferManager->getDeletionQueue());
 
-    vkResetCommandBuffer(cmdBuffer, 0);
+    // VMA refreshes its budget once per frame, and churned memory is compacted periodically
+    allocatorManager->setCurrentFrame(framesRendered);
+    if (framesRendered > 0 && framesRendered % DEFRAGMENTATION_INTERVAL == 0) {
+        allocatorManager->beginDefragmentation();
+    }
 
-    graphicsPipeline->recordCommandBuffer(frameIndex, imageIndex);
+    if (bindlessTable) {
+        // Swaps and reloads only change which slot this frame pushes
+        graphicsPipeline->setBindlessIndices(textureRegistry->getBindlessIndices(texture));
+    } else if (textureDescriptorStale[frameIndex]) {
+        // This frame's descriptor set is idle now, so a swapped texture can be bound to it
+        const TextureManager& current = textureRegistry->get(texture);
+        descriptorManager->updateTextureDescriptor(frameIndex,
+                                                   current.getTextureImageView(),
+                                                   current.getTextureSampler());
+        textureDescriptorStale[frameIndex] = false;
+    }
+
+    // Release staging memory from finished uploads and submit any uploads queued since the
+    // last frame ahead of this frame's draw
+    uploadQueue->collect();
+    uploadQueue->flush();
+
+    // Update the uniform buffer with the current image/frame
+    profiler->beginScope(CpuScope::UniformUpdate);
+    updateUniformBuffer(frameIndex);
+    // Repack this frame's instance and draw buffers if the scene changed
+    scene->update(frameIndex);
+    profiler->endScope(CpuScope::UniformUpdate);
+
+    profiler->beginScope(CpuScope::Record);
+    const uint64_t frameNumber = framesRendered++;
+    // Defragmentation copies run first so the frame already draws from the moved buffers
+    auto defragment = [this](VkCommandBuffer commandBuffer) {
+        allocatorManager->defragmentStep(commandBuffer, commandBufferManager->getDeletionQueue());
+    };
+    if (offscreenTarget && offscreenTarget->hasReadback()) {
+        graphicsPipeline->recordCommandBuffer(frameIndex, imageIndex, [this, imageIndex, frameNumber](VkCommandBuffer commandBuffer) {
+            offscreenTarget->recordReadback(commandBuffer, imageIndex, frameNumber);
+        }, defragment);
+    } else {
+        graphicsPipeline->recordCommandBuffer(frameIndex, imageIndex, nullptr, defragment);
+    }
+    profiler->endScope(CpuScope::Record);
+    VkCommandBuffer cmdBuffer = commandBufferManager->getCommandBuffer(frameIndex);
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
     VkSemaphore waitSemaphores[] = {commandBufferManager->getImageAvailableSemaphore(frameIndex)};
     VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
+    // Headless frames neither wait for an acquire nor signal a present
+    submitInfo.waitSemaphoreCount = isHeadless() ? 0 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
 
@@ -297,12 +536,20 @@ void VulkanApplication::drawFrame() {
     submitInfo.pCommandBuffers = &cmdBuffer;
 
     VkSemaphore signalSemaphores[] = {commandBufferManager->getRenderFinishedSemaphore(frameIndex)};
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = isHeadless() ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, commandBufferManager->getInFlightFence(frameIndex)) != VK_SUCCESS) {
+    profiler->beginScope(CpuScope::Submit);
+    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFence) != VK_SUCCESS) {
         throw std::runtime_error("failed to submit draw command buffer!");
     }
+    profiler->endScope(CpuScope::Submit);
+
+    if (isHeadless()) {
+        profiler->endFrame();
+        currentFrame = (currentFrame + 1) % commandBufferManager->getFramesInFlight();
+        return;
+    }
 
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -313,8 +560,12 @@ void VulkanApplication::drawFrame() {
     presentInfo.swapchainCount = 1;
     presentInfo.pSwapchains = swapChains;
     presentInfo.pImageIndices = &imageIndex;
+    VkPresentIdKHR presentId{};
+    presentPacer->tagPresent(presentInfo, presentId);
 
-    result = vkQueuePresentKHR(presentQueue, &presentInfo);
+    profiler->beginScope(CpuScope::Present);
+    VkResult result = vkQueuePresentKHR(presentQueue, &presentInfo);
+    profiler->endScope(CpuScope::Present);
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized) {
         framebufferResized = false;
         recreateSwapChain();  // Recreate swap chain if it's out of date or suboptimal
@@ -322,7 +573,9 @@ void VulkanApplication::drawFrame() {
         throw std::runtime_error("failed to present swap chain image!");
     }
 
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    profiler->endFrame();
+    updateTitleReadout();
+    currentFrame = (currentFrame + 1) % commandBufferManager->getFramesInFlight();
 }
 // --------------------------------------------------------------------------------
 
@@ -335,38 +588,33 @@ void VulkanApplication::framebufferResizeCallback(GLFWwindow* window, int width,
 // --------------------------------------------------------------------------------
 
 void VulkanApplication::recreateSwapChain() {
-    // If the window is minimized, pause execution until the window is resized again
-    int width = 0, height = 0;
-    GLFWwindow* glfwWindow = static_cast<GLFWwindow*>(windowInstance);
-    glfwGetFramebufferSize(glfwWindow, &width, &height);
-
-    while (width == 0 || height == 0) {
-        glfwGetFramebufferSize(glfwWindow, &width, &height);
-        glfwWaitEvents();
+    // A zero extent cannot back a swap chain; the run loop waits for the window to come
+    // back and recreates it then
+    if (isMinimized()) {
+        framebufferResized = true;
+        return;
     }
 
-    // Wait for the device to be idle before starting swap chain recreation
-    vkDeviceWaitIdle(vulkanLogicalDevice->getDevice());
-
-    // Clean up the old swap chain-related resources
-    graphicsPipeline->destroyFramebuffers();  // Destroy the old framebuffers
-    swapChain->cleanupSwapChain();            // Clean up the old swap chain (destroy image views, etc.)
-
-    // Recreate the swap chain and dependent resources
-    swapChain->recreateSwapChain();           // Create a new swap chain and its image views
+    // Frames in flight may still render to the old framebuffers, swap chain images and
+    // depth image, so they are retired to the deletion queue instead of idling the device
+    DeletionQueue& deletionQueue = commandBufferManager->getDeletionQueue();
+    graphicsPipeline->retireFramebuffers(deletionQueue);
+    swapChain->recreateSwapChain(deletionQueue);
+    depthManager->recreateDepthResources(swapChain->getSwapChainExtent(), deletionQueue);
 
     // Recreate the framebuffers using the new swap chain image views
     graphicsPipeline->createFrameBuffers(swapChain->getSwapChainImageViews(), swapChain->getSwapChainExtent());
+    imagesInFlight.assign(swapChain->getSwapChainImages().size(), VK_NULL_HANDLE);
+    presentPacer->resetSwapChain();
 
-    // Free and recreate command buffers frame by frame
-    VkCommandPool commandPool = commandBufferManager->getCommandPool();
-    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        VkCommandBuffer cmdBuffer = commandBufferManager->getCommandBuffer(i);
-        vkFreeCommandBuffers(vulkanLogicalDevice->getDevice(), commandPool, 1, &cmdBuffer); // Free single command buffer
-    }
+    // Command buffers are reset and re-recorded every frame, so they survive the swap chain
+}
+// --------------------------------------------------------------------------------
 
-    // Recreate the command buffers
-    commandBufferManager->createCommandBuffers();
+bool VulkanApplication::isMinimized() const {
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(windowInstance, &width, &height);
+    return width == 0 || height == 0;
 }
 // --------------------------------------------------------------------------------
 
@@ -374,15 +622,307 @@ void VulkanApplication::updateUniformBuffer(uint32_t currentImage) {
     static auto startTime = std::chrono::high_resolution_clock::now();
     auto currentTime = std::chrono::high_resolution_clock::now();
     float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+    // A fixed step makes every run draw the same sequence of frames
+    if (fixedTimeStep > 0.0f) {
+        time = static_cast<float>(framesRendered) * fixedTimeStep;
+    }
 
-    UniformBufferObject ubo{};
-    ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    float fov = glm::radians(45.0f) / zoomLevel; // Adjust FOV with zoom level
-    ubo.proj = glm::perspective(fov, swapChain->getSwapChainExtent().width / (float)swapChain->getSwapChainExtent().height, 0.1f, 10.0f);
-    ubo.proj[1][1] *= -1; // Invert Y-axis for Vulkan
+    // The camera only moves with the zoom level and the render extent, so the shared
+    // uniforms are rebuilt when either changes and each frame's slot is rewritten once
+    const VkExtent2D extent = getRenderExtent();
+    if (zoomLevel != cameraZoom || extent.width != cameraExtent.width || extent.height != cameraExtent.height) {
+        camera.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        float fov = glm::radians(45.0f) / zoomLevel; // Adjust FOV with zoom level
+        // Reverse-Z maps the far plane to 0, which spreads float precision evenly over distance
+        const float aspect = extent.width / (float)extent.height;
+        camera.proj = depthConfig.projection(fov, aspect, 0.1f, 10.0f);
+        camera.viewProj = camera.proj * camera.view;
+        cameraZoom = zoomLevel;
+        cameraExtent = extent;
+        ++cameraVersion;
+    }
+    bufferManager->updateUniformBuffer(currentImage, camera, cameraVersion);
+
+    // Only the spin changes every frame, and it travels as a push constant
+    DrawPushConstants draw{};
+    draw.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    graphicsPipeline->setDrawConstants(draw);
+    // Instance bounds are in the space draw.model is applied to
+    cullingPass->setFrustum(currentImage, camera.viewProj * draw.model);
+}
+// --------------------------------------------------------------------------------
 
-    memcpy(bufferManager->getUniformBuffersMapped()[currentImage], &ubo, sizeof(ubo));
+void VulkanApplication::createResources(const std::string& texturePath, const MeshSource& mesh) {
+    // Instantiate related classes
+    validationLayers = std::make_unique<ValidationLayers>();
+    vulkanInstanceCreator = std::make_unique<VulkanInstance>(this->windowInstance, 
+                                                             *validationLayers.get());
+    vulkanPhysicalDevice = std::make_unique<VulkanPhysicalDevice>(*this->vulkanInstanceCreator->getInstance(),
+                                                                  this->vulkanInstanceCreator->getSurface());
+    vulkanLogicalDevice = std::make_unique<VulkanLogicalDevice>(vulkanPhysicalDevice->getDevice(),
+                                                                validationLayers->getValidationLayers(),
+                                                                vulkanInstanceCreator->getSurface(),
+                                                                isHeadless() ? std::vector<const char*>{} : deviceExtensions);
+    allocatorManager = std::make_unique<AllocatorManager>(
+        vulkanPhysicalDevice->getDevice(),
+        vulkanLogicalDevice->getDevice(),
+        *vulkanInstanceCreator->getInstance(),
+        AllocatorManager::DEFAULT_STAGING_RING_SIZE,
+        vulkanLogicalDevice->getEnabledFeatures().memoryBudget);
+    const QueueFamilyIndices& queueFamilyIndices = vulkanLogicalDevice->getQueueFamilyIndices();
+    uploadQueue = std::make_unique<UploadQueue>(vulkanLogicalDevice->getDevice(),
+                                                *allocatorManager,
+                                                vulkanLogicalDevice->getTransferQueue(),
+                                                queueFamilyIndices.uploadFamily(),
+                                                vulkanLogicalDevice->getGraphicsQueue(),
+                                                queueFamilyIndices.graphicsFamily.value());
+
+    if (isHeadless()) {
+        // One image per frame slot a profile can select stands in for the swap chain
+        offscreenTarget = std::make_unique<OffscreenTarget>(*allocatorManager,
+                                                            vulkanLogicalDevice->getDevice(),
+                                                            headlessConfig.extent,
+                                                            headlessConfig.colorFormat,
+                                                            MAX_FRAMES_IN_FLIGHT,
+                                                            headlessConfig.readback);
+    } else {
+        swapChain = std::make_unique<SwapChain>(vulkanLogicalDevice->getDevice(),
+                                                vulkanInstanceCreator->getSurface(),
+                                                vulkanPhysicalDevice->getDevice(),
+                                                this->windowInstance,
+                                                latencyProfile);
+        imagesInFlight.assign(swapChain->getSwapChainImages().size(), VK_NULL_HANDLE);
+    }
+    presentPacer = std::make_unique<PresentPacer>(vulkanLogicalDevice->getDevice(),
+                                                  vulkanLogicalDevice->getEnabledFeatures().presentWait);
+    presentPacer->setEnabled(latencyProfile.presentWait);
+    depthManager = std::make_unique<DepthManager>(
+        *allocatorManager,                              // Dereference unique_ptr
+        vulkanLogicalDevice->getDevice(),
+        vulkanPhysicalDevice->getDevice(),
+        getRenderExtent(),
+        isHeadless() ? offscreenTarget->getFormat() : swapChain->getSwapChainImageFormat(),
+        depthConfig
+    );
+    depthManager->createDepthResources();
+    // The render thread records one partition of the draw list itself
+    const uint32_t recordingThreads = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+    recordingPool = std::make_unique<ThreadPool>(std::max(recordingThreads - 1, 1u));
+    commandBufferManager = std::make_unique<CommandBufferManager>(vulkanLogicalDevice->getDevice(),
+                                                                  vulkanPhysicalDevice->getDevice(),
+                                                                  vulkanInstanceCreator->getSurface(),
+                                                                  latencyProfile.framesInFlight,
+                                                                  recordingThreads);
+    const uint32_t framesInFlight = commandBufferManager->getFramesInFlight();
+    textureDescriptorStale.assign(framesInFlight, false);
+    samplerManager = std::make_unique<SamplerManager>(
+            vulkanLogicalDevice->getDevice(),
+            vulkanPhysicalDevice->getDevice()
+    );
+    // Devices with descriptor indexing sample every texture through one table by slot
+    if (vulkanLogicalDevice->getEnabledFeatures().descriptorIndexing) {
+        bindlessTable = std::make_unique<BindlessTextureTable>(vulkanLogicalDevice->getDevice(),
+                                                               vulkanPhysicalDevice->getDevice());
+    }
+    threadPool = std::make_unique<ThreadPool>();
+    textureRegistry = std::make_unique<TextureRegistry>(
+        *allocatorManager,                              // Dereference unique_ptr
+        vulkanLogicalDevice->getDevice(),
+        vulkanPhysicalDevice->getDevice(),
+        *uploadQueue,                                   // Dereference unique_ptr
+        *samplerManager,
+        *threadPool,
+        commandBufferManager->getDeletionQueue(),
+        0,
+        bindlessTable.get()
+    );
+    texture = textureRegistry->acquire(texturePath);
+    this->texturePath = texturePath;
+    bufferManager = std::make_unique<BufferManager>(*allocatorManager,
+                                                    vulkanPhysicalDevice->getDevice(),
+                                                    framesInFlight);
+    // Every mesh is sub-allocated from the arena; 16-bit indices reach any vertex through
+    // vertexOffset, so the index width only has to fit the largest single mesh
+    meshArena = std::make_unique<MeshArena>(*allocatorManager,
+                                            *uploadQueue,
+                                            MeshSource::selectIndexType(mesh.getVertexCount()));
+    meshRange = meshArena->allocate(mesh);
+    // Submit every startup upload as a single batch; the first frame is ordered after it
+    uploadQueue->flush();
+    // Scene and culling buffers cover every frame count a profile can select, so they
+    // survive latency profile switches
+    scene = std::make_unique<Scene>(*allocatorManager,
+                                    vulkanLogicalDevice->getEnabledFeatures(),
+                                    MAX_FRAMES_IN_FLIGHT);
+    // The whole index buffer is drawn as one mesh with a single identity instance
+    uint32_t meshId = scene->addMesh(meshRange.indexCount, meshRange.firstIndex, meshRange.vertexOffset,
+                                     mesh.getBoundingSphere());
+    scene->addInstance(meshId, glm::mat4(1.0f));
+    pipelineCache = std::make_unique<PipelineCache>(vulkanLogicalDevice->getDevice(),
+                                                    vulkanPhysicalDevice->getDevice());
+    // One query range per slot a profile can select, so switches keep the pool
+    profiler = std::make_unique<Profiler>(vulkanLogicalDevice->getDevice(),
+                                          vulkanPhysicalDevice->getDevice(),
+                                          queueFamilyIndices.graphicsFamily.value(),
+                                          MAX_FRAMES_IN_FLIGHT);
+    lastTitleUpdate = std::chrono::steady_clock::now();
+    cullingPass = std::make_unique<CullingPass>(vulkanLogicalDevice->getDevice(),
+                                                *allocatorManager,
+                                                *scene,
+                                                *pipelineCache,
+                                                vulkanLogicalDevice->getEnabledFeatures(),
+                                                MAX_FRAMES_IN_FLIGHT,
+                                                std::string("../../shaders/cull.comp.spv"));
+    // The vertex shader reads the culled instances when culling is available
+    descriptorManager = std::make_unique<DescriptorManager>(vulkanLogicalDevice->getDevice(),
+                                                            bindlessTable == nullptr);
+    const TextureManager& current = textureRegistry->get(texture);
+    descriptorManager->createDescriptorSets(bufferManager->getUniformBuffer(),
+                                            bufferManager->getUniformSlotSize(),
+                                            bufferManager->getFramesInFlight(),
+                                            cullingPass->getInstanceBuffers(),
+                                            current.getTextureImageView(),
+                                            current.getTextureSampler());
+    // Offscreen images are left ready to be copied out instead of presented
+    graphicsPipeline = std::make_unique<GraphicsPipeline>(vulkanLogicalDevice->getDevice(),
+                                                          isHeadless() ? offscreenTarget->getFormat()
+                                                                       : swapChain->getSwapChainImageFormat(),
+                                                          isHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                                                                       : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                                                          *commandBufferManager.get(),
+                                                          *meshArena,
+                                                          *descriptorManager.get(),
+                                                          vulkanPhysicalDevice->getDevice(),
+                                                          std::string("../../shaders/shader.vert.spv"),
+                                                          std::string(bindlessTable ? "../../shaders/bindless.frag.spv"
+                                                                                    : "../../shaders/shader.frag.spv"),
+                                                          *depthManager,
+                                                          *pipelineCache,
+                                                          *scene,
+                                                          *cullingPass,
+                                                          *recordingPool,
+                                                          *profiler,
+                                                          bindlessTable.get(),
+                                                          std::string("../../shaders/depth.vert.spv"));
+    graphicsPipeline->setSynchronization2(vulkanLogicalDevice->getEnabledFeatures().synchronization2);
+    std::cout << "Depth: " << (depthConfig.reverseZ ? "reverse-Z" : "standard")
+              << (depthConfig.prepass ? " with pre-pass" : "")
+              << (depthManager->isLazilyAllocated() ? ", lazily allocated" : "")
+              << ", " << depthManager->getSampleCount() << "x MSAA" << std::endl;
+    if (bindlessTable) {
+        graphicsPipeline->setBindlessIndices(textureRegistry->getBindlessIndices(texture));
+        std::cout << "Bindless textures enabled with " << bindlessTable->getTextureCapacity()
+                  << " slots." << std::endl;
+    }
+    std::cout << "Pipeline creation took " << pipelineCache->getCreationMilliseconds() << " ms ("
+              << (pipelineCache->wasLoadedFromDisk() ? "warm cache" : "cold cache") << ")." << std::endl;
+    graphicsPipeline->createFrameBuffers(isHeadless() ? offscreenTarget->getImageViews()
+                                                      : swapChain->getSwapChainImageViews(),
+                                         getRenderExtent());
+    graphicsQueue = this->vulkanLogicalDevice->getGraphicsQueue();
+    presentQueue = this->vulkanLogicalDevice->getPresentQueue();
+    logLatencyProfile();
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::resolveFramesInFlight() {
+    // Oldest slot first, so the history stays in frame order
+    const uint32_t framesInFlight = commandBufferManager->getFramesInFlight();
+    for (uint32_t i = 0; i < framesInFlight; ++i) {
+        const uint32_t slot = (currentFrame + i) % framesInFlight;
+        profiler->resolveFrame(slot);
+        if (offscreenTarget) {
+            offscreenTarget->resolveReadback(slot);
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+VkExtent2D VulkanApplication::getRenderExtent() const {
+    return isHeadless() ? offscreenTarget->getExtent() : swapChain->getSwapChainExtent();
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::logLatencyProfile() const {
+    std::cout << "Latency profile " << latencyProfile.name << ": "
+              << commandBufferManager->getFramesInFlight() << " frame(s) in flight, ";
+    if (isHeadless()) {
+        const VkExtent2D extent = offscreenTarget->getExtent();
+        std::cout << "headless " << extent.width << "x" << extent.height
+                  << (offscreenTarget->hasReadback() ? " with readback." : ".") << std::endl;
+        return;
+    }
+    std::cout << LatencyProfile::presentModeName(swapChain->getPresentMode()) << " presents, "
+              << swapChain->getSwapChainImages().size() << " swap chain images"
+              << (presentPacer->isEnabled() ? ", paced by present wait." : ".") << std::endl;
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::updateTitleReadout() {
+    if (isHeadless()) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now - lastTitleUpdate < std::chrono::milliseconds(500)) {
+        return;
+    }
+    lastTitleUpdate = now;
+
+    // About one second of frames at typical refresh rates
+    const FrameSummary summary = profiler->summarize(120);
+    std::ostringstream title;
+    title << std::fixed << std::setprecision(1)
+          << "Vulkan Application | " << summary.framesPerSecond << " fps | CPU "
+          << std::setprecision(2) << summary.cpuMs << " ms | GPU ";
+    if (profiler->hasGpuTimestamps()) {
+        title << summary.gpuMs << " ms";
+    } else {
+        title << "n/a";
+    }
+    title << " | worst " << summary.worstMs << " ms";
+    glfwSetWindowTitle(windowInstance, title.str().c_str());
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::writeFrameTimings(const std::string& csvPath, const std::string& tracePath) const {
+    const std::vector<FrameTiming> timings = profiler->getHistory().snapshot();
+
+    std::ofstream csv(csvPath);
+    if (!csv) {
+        throw std::runtime_error("Failed to open " + csvPath + " for writing!");
+    }
+    Profiler::writeCsv(csv, timings);
+
+    std::ofstream trace(tracePath);
+    if (!trace) {
+        throw std::runtime_error("Failed to open " + tracePath + " for writing!");
+    }
+    Profiler::writeChromeTrace(trace, timings);
+
+    std::cout << "Wrote " << timings.size() << " frame timings to " << csvPath
+              << " and " << tracePath << "." << std::endl;
+}
+// --------------------------------------------------------------------------------
+
+void VulkanApplication::writeMemoryStats(const std::string& jsonPath) const {
+    std::ofstream json(jsonPath);
+    if (!json) {
+        throw std::runtime_error("Failed to open " + jsonPath + " for writing!");
+    }
+    json << allocatorManager->buildStatsString(true);
+
+    const MemoryStats stats = allocatorManager->getStats();
+    std::cout << "Memory: " << stats.usage / (1024 * 1024) << " of " << stats.budget / (1024 * 1024)
+              << " MiB" << (stats.budgetFromDriver ? "" : " (heap sizes)") << ", "
+              << stats.overBudgetAllocations << " allocations over budget." << std::endl;
+    for (size_t i = 0; i < stats.categories.size(); ++i) {
+        const MemoryCategoryStats& category = stats.categories[i];
+        std::cout << "  " << memoryCategoryName(static_cast<MemoryCategory>(i)) << ": "
+                  << category.allocations << " allocations, " << category.bytes / 1024 << " KiB, peak "
+                  << category.peakBytes / 1024 << " KiB" << std::endl;
+    }
+    std::cout << "  defragmentation: " << stats.allocationsMoved << " moved, "
+              << stats.bytesFreed / 1024 << " KiB freed. Wrote " << jsonPath << "." << std::endl;
 }
 // ================================================================================
 // ================================================================================
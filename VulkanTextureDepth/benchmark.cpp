@@ -0,0 +1,304 @@
+// ================================================================================
+// ================================================================================
+// - File:    benchmark.cpp
+// - Purpose: This file contains the implementation of the Benchmark class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/benchmark.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+// ================================================================================
+// ================================================================================
+
+std::vector<BenchmarkScene> Benchmark::defaultScenes() {
+    std::vector<BenchmarkScene> scenes(5);
+    scenes[0].name = "baseline";
+
+    scenes[1].name = "many_quads";
+    scenes[1].quads = 10000;
+
+    scenes[2].name = "many_textures";
+    scenes[2].quads = 64;
+    scenes[2].textures = 16;
+
+    scenes[3].name = "upload_heavy";
+    scenes[3].uploadsPerFrame = 16;
+    scenes[3].uploadBytes = 256 * 1024;
+
+    scenes[4].name = "combined";
+    scenes[4].quads = 10000;
+    scenes[4].textures = 16;
+    scenes[4].uploadsPerFrame = 16;
+    scenes[4].uploadBytes = 256 * 1024;
+    return scenes;
+}
+// --------------------------------------------------------------------------------
+
+BenchmarkResult Benchmark::runScene(VulkanApplication& app, const BenchmarkScene& scene,
+                                    const std::string& textureDirectory) {
+    const size_t totalFrames = static_cast<size_t>(scene.warmupFrames) + scene.frames;
+    if (totalFrames > app.getProfiler().getHistory().getCapacity()) {
+        throw std::runtime_error("Benchmark scene " + scene.name + " runs more frames than the profiler keeps!");
+    }
+
+    // Lay the quads out in a square grid filling clip space
+    const std::vector<Vertex> vertices = quadVertices();
+    const std::vector<uint16_t> indices = quadIndices();
+    MeshRange quad = app.getMeshArena().allocate(VectorMeshSource(vertices, indices));
+    Scene& sceneInstances = app.getScene();
+    sceneInstances.clearInstances();
+    const uint32_t mesh = sceneInstances.addMesh(quad.indexCount, quad.firstIndex, quad.vertexOffset,
+                                                 glm::vec4(0.0f, 0.0f, 0.0f, 0.71f));
+    const uint32_t side = std::max(1u, static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(scene.quads)))));
+    const float spacing = 2.0f / static_cast<float>(side);
+    for (uint32_t i = 0; i < scene.quads; ++i) {
+        const float x = -1.0f + spacing * (static_cast<float>(i % side) + 0.5f);
+        const float y = -1.0f + spacing * (static_cast<float>(i / side) + 0.5f);
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x, y, 0.0f));
+        model = glm::scale(model, glm::vec3(spacing * 0.9f));
+        sceneInstances.addInstance(mesh, model);
+    }
+
+    TextureRegistry& registry = app.getTextureRegistry();
+    std::vector<TextureHandle> textures;
+    for (const std::string& path : writeTextures(textureDirectory, std::max(1u, scene.textures))) {
+        textures.push_back(registry.acquire(path));
+    }
+    app.bindTexture(textures.front());
+
+    // One destination region per upload, so no two uploads of a frame overlap
+    VkBuffer uploadTarget = VK_NULL_HANDLE;
+    VmaAllocation uploadAllocation = VK_NULL_HANDLE;
+    std::vector<uint8_t> payload;
+    if (scene.uploadsPerFrame > 0) {
+        app.getAllocatorManager().createBuffer(scene.uploadBytes * scene.uploadsPerFrame,
+                                               VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY,
+                                               uploadTarget, uploadAllocation);
+        payload.resize(static_cast<size_t>(scene.uploadBytes));
+        for (size_t i = 0; i < payload.size(); ++i) {
+            payload[i] = static_cast<uint8_t>(i * 31u + 7u);
+        }
+    }
+
+    uint64_t uploadedBytes = 0;
+    app.setFixedTimeStep(1.0f / 60.0f);
+    app.setFrameCallback([&](uint64_t frame) {
+        if (textures.size() > 1) {
+            app.bindTexture(textures[frame % textures.size()]);
+        }
+        for (uint32_t i = 0; i < scene.uploadsPerFrame; ++i) {
+            app.getUploadQueue().uploadBuffer(uploadTarget, payload.data(), scene.uploadBytes,
+                                              scene.uploadBytes * i);
+        }
+        if (frame >= scene.warmupFrames) {
+            uploadedBytes += scene.uploadBytes * scene.uploadsPerFrame;
+        }
+    });
+
+    app.runFrames(static_cast<uint32_t>(totalFrames));
+    app.setFrameCallback(nullptr);
+
+    BenchmarkResult result = summarize(scene, app.getProfiler().getHistory().snapshot(), uploadedBytes);
+    result.headless = app.isHeadless();
+    sampleMemory(app.getAllocatorManager(), result);
+
+    if (uploadTarget != VK_NULL_HANDLE) {
+        app.getUploadQueue().waitIdle();
+        app.getAllocatorManager().destroyBuffer(uploadTarget, uploadAllocation);
+    }
+    for (TextureHandle handle : textures) {
+        registry.release(handle);
+    }
+    sceneInstances.clearInstances();
+    app.getMeshArena().free(quad);
+    return result;
+}
+// --------------------------------------------------------------------------------
+
+std::vector<std::string> Benchmark::writeTextures(const std::string& directory, uint32_t count, uint32_t size) {
+    std::filesystem::create_directories(directory);
+
+    std::vector<std::string> paths;
+    std::vector<char> pixels(static_cast<size_t>(size) * size * 3);
+    for (uint32_t t = 0; t < count; ++t) {
+        // A checkerboard whose colors and cell size depend on the index, so every file
+        // has distinct content and the registry keeps a separate texture for each
+        const uint8_t r = static_cast<uint8_t>(64 + (t * 53u) % 192);
+        const uint8_t g = static_cast<uint8_t>(64 + (t * 97u) % 192);
+        const uint8_t b = static_cast<uint8_t>(64 + (t * 151u) % 192);
+        const uint32_t cell = 8u << (t % 4);
+        for (uint32_t y = 0; y < size; ++y) {
+            for (uint32_t x = 0; x < size; ++x) {
+                const bool dark = ((x / cell) + (y / cell)) % 2 == 0;
+                char* pixel = &pixels[(static_cast<size_t>(y) * size + x) * 3];
+                pixel[0] = static_cast<char>(dark ? r / 4 : r);
+                pixel[1] = static_cast<char>(dark ? g / 4 : g);
+                pixel[2] = static_cast<char>(dark ? b / 4 : b);
+            }
+        }
+
+        const std::string path = (std::filesystem::path(directory) /
+                                  ("bench_texture_" + std::to_string(t) + ".ppm")).string();
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            throw std::runtime_error("Failed to open " + path + " for writing!");
+        }
+        out << "P6\n" << size << ' ' << size << "\n255\n";
+        out.write(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+        if (!out) {
+            throw std::runtime_error("Failed to write " + path + "!");
+        }
+        paths.push_back(path);
+    }
+    return paths;
+}
+// --------------------------------------------------------------------------------
+
+BenchmarkResult Benchmark::summarize(const BenchmarkScene& scene, const std::vector<FrameTiming>& timings,
+                                     uint64_t uploadedBytes) {
+    std::vector<const FrameTiming*> measured;
+    for (const FrameTiming& timing : timings) {
+        if (timing.frame >= scene.warmupFrames) {
+            measured.push_back(&timing);
+        }
+    }
+
+    std::vector<double> intervals;
+    std::vector<double> cpu;
+    std::vector<double> gpu;
+    for (size_t i = 0; i < measured.size(); ++i) {
+        if (i > 0) {
+            intervals.push_back(measured[i]->startMs - measured[i - 1]->startMs);
+        }
+        cpu.push_back(measured[i]->cpuFrameMs);
+        if (measured[i]->gpuValid) {
+            gpu.push_back(measured[i]->gpuFrameMs);
+        }
+    }
+
+    BenchmarkResult result;
+    result.scene = scene;
+    result.frameMs = computeStats(intervals);
+    result.cpuMs = computeStats(cpu);
+    result.gpuMs = computeStats(gpu);
+    result.uploadedBytes = uploadedBytes;
+    if (!measured.empty()) {
+        const double elapsedMs = measured.back()->startMs + measured.back()->cpuFrameMs - measured.front()->startMs;
+        if (elapsedMs > 0.0) {
+            result.uploadMiBPerSecond = static_cast<double>(uploadedBytes) / (1024.0 * 1024.0) / (elapsedMs / 1000.0);
+        }
+    }
+    return result;
+}
+// --------------------------------------------------------------------------------
+
+double Benchmark::percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    const double rank = std::clamp(fraction, 0.0, 1.0) * static_cast<double>(values.size() - 1);
+    const size_t lower = static_cast<size_t>(rank);
+    const size_t upper = std::min(lower + 1, values.size() - 1);
+    const double weight = rank - static_cast<double>(lower);
+    return values[lower] + (values[upper] - values[lower]) * weight;
+}
+// --------------------------------------------------------------------------------
+
+TimingStats Benchmark::computeStats(const std::vector<double>& values) {
+    TimingStats stats;
+    stats.samples = values.size();
+    if (values.empty()) {
+        return stats;
+    }
+    stats.mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+    stats.p50 = percentile(values, 0.5);
+    stats.p99 = percentile(values, 0.99);
+    stats.max = *std::max_element(values.begin(), values.end());
+    return stats;
+}
+// --------------------------------------------------------------------------------
+
+void Benchmark::writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+    auto writeStats = [&out](const char* name, const TimingStats& stats) {
+        out << "      \"" << name << "\": {\"samples\": " << stats.samples << ", \"mean\": " << stats.mean
+            << ", \"p50\": " << stats.p50 << ", \"p99\": " << stats.p99 << ", \"max\": " << stats.max << "},\n";
+    };
+
+    out << "{\n  \"scenes\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& result = results[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\n";
+        out << "      \"name\": \"" << result.scene.name << "\",\n";
+        out << "      \"mode\": \"" << (result.headless ? "headless" : "windowed") << "\",\n";
+        out << "      \"quads\": " << result.scene.quads << ",\n";
+        out << "      \"textures\": " << result.scene.textures << ",\n";
+        out << "      \"uploads_per_frame\": " << result.scene.uploadsPerFrame << ",\n";
+        out << "      \"upload_bytes\": " << result.scene.uploadBytes << ",\n";
+        out << "      \"warmup_frames\": " << result.scene.warmupFrames << ",\n";
+        out << "      \"frames\": " << result.scene.frames << ",\n";
+        writeStats("frame_ms", result.frameMs);
+        writeStats("cpu_ms", result.cpuMs);
+        writeStats("gpu_ms", result.gpuMs);
+        out << "      \"uploaded_bytes\": " << result.uploadedBytes << ",\n";
+        out << "      \"upload_mib_per_s\": " << result.uploadMiBPerSecond << ",\n";
+        out << "      \"vma_usage_bytes\": " << result.vmaUsageBytes << ",\n";
+        out << "      \"vma_budget_bytes\": " << result.vmaBudgetBytes << ",\n";
+        out << "      \"vma_allocation_bytes\": " << result.vmaAllocationBytes << ",\n";
+        out << "      \"vma_allocation_count\": " << result.vmaAllocationCount << "\n";
+        out << "    }";
+    }
+    out << (results.empty() ? "]\n}\n" : "\n  ]\n}\n");
+}
+// --------------------------------------------------------------------------------
+
+std::vector<Vertex> Benchmark::quadVertices() {
+    return {
+        {{-0.5f, -0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f}},
+        {{0.5f, -0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}, {1.0f, 0.0f}},
+        {{0.5f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}, {1.0f, 1.0f}},
+        {{-0.5f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}, {0.0f, 1.0f}}
+    };
+}
+// --------------------------------------------------------------------------------
+
+std::vector<uint16_t> Benchmark::quadIndices() {
+    return {0, 1, 2, 2, 3, 0};
+}
+// ================================================================================
+
+void Benchmark::sampleMemory(AllocatorManager& allocatorManager, BenchmarkResult& result) {
+    VmaAllocator allocator = allocatorManager.getAllocator();
+
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(allocator, &memoryProperties);
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+    vmaGetHeapBudgets(allocator, budgets);
+    for (uint32_t heap = 0; heap < memoryProperties->memoryHeapCount; ++heap) {
+        result.vmaUsageBytes += budgets[heap].usage;
+        result.vmaBudgetBytes += budgets[heap].budget;
+    }
+
+    VmaTotalStatistics statistics{};
+    vmaCalculateStatistics(allocator, &statistics);
+    result.vmaAllocationBytes = statistics.total.statistics.allocationBytes;
+    result.vmaAllocationCount = statistics.total.statistics.allocationCount;
+}
+// ================================================================================
+// ================================================================================
+// eof
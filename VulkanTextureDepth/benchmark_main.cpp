@@ -0,0 +1,138 @@
+// ================================================================================
+// ================================================================================
+// - File:    benchmark_main.cpp
+// - Purpose: Entry point of the VulkanBenchmark target, which runs the fixed-workload
+//            scenes and writes their measurements as JSON.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/benchmark.hpp"
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+// Begin code
+int main(int argc, const char * argv[]) {
+    try {
+        // --scene=<name> runs one scene and may be repeated; all scenes run by default.
+        // --frames=<count> overrides the measured frames of every scene, --headless renders
+        // offscreen, --latency=<profile> selects the latency profile and --output=<file>
+        // names the JSON report, with - for standard output
+        bool headless = false;
+        std::optional<uint32_t> frameCount;
+        LatencyMode latencyMode = LatencyMode::Throughput;
+        std::string outputPath = "benchmark_results.json";
+        std::string textureDirectory = "benchmark_textures";
+        std::vector<std::string> sceneNames;
+        const std::string sceneFlag = "--scene=";
+        const std::string framesFlag = "--frames=";
+        const std::string latencyFlag = "--latency=";
+        const std::string outputFlag = "--output=";
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--headless") {
+                headless = true;
+            } else if (arg.rfind(sceneFlag, 0) == 0) {
+                sceneNames.push_back(arg.substr(sceneFlag.size()));
+            } else if (arg.rfind(framesFlag, 0) == 0) {
+                frameCount = static_cast<uint32_t>(std::stoul(arg.substr(framesFlag.size())));
+            } else if (arg.rfind(latencyFlag, 0) == 0) {
+                std::optional<LatencyMode> mode = LatencyProfile::parseMode(arg.substr(latencyFlag.size()));
+                if (!mode) {
+                    throw std::runtime_error("Unknown latency profile: " + arg.substr(latencyFlag.size()));
+                }
+                latencyMode = *mode;
+            } else if (arg.rfind(outputFlag, 0) == 0) {
+                outputPath = arg.substr(outputFlag.size());
+            } else {
+                throw std::runtime_error("Unknown argument: " + arg);
+            }
+        }
+
+        std::vector<BenchmarkScene> scenes;
+        for (const BenchmarkScene& scene : Benchmark::defaultScenes()) {
+            bool selected = sceneNames.empty();
+            for (const std::string& name : sceneNames) {
+                selected = selected || name == scene.name;
+            }
+            if (selected) {
+                scenes.push_back(scene);
+                if (frameCount) {
+                    scenes.back().frames = *frameCount;
+                }
+            }
+        }
+        for (const std::string& name : sceneNames) {
+            bool known = false;
+            for (const BenchmarkScene& scene : scenes) {
+                known = known || scene.name == name;
+            }
+            if (!known) {
+                throw std::runtime_error("Unknown benchmark scene: " + name);
+            }
+        }
+
+        // Each scene gets a fresh application, so memory usage and caches start clean
+        const std::vector<Vertex> vertices = Benchmark::quadVertices();
+        const std::vector<uint16_t> indices = Benchmark::quadIndices();
+        const VectorMeshSource mesh(vertices, indices);
+        const std::string defaultTexture = Benchmark::writeTextures(textureDirectory, 1).front();
+        std::vector<BenchmarkResult> results;
+        for (const BenchmarkScene& scene : scenes) {
+            std::cerr << "Running benchmark scene " << scene.name << "..." << std::endl;
+            if (headless) {
+                VulkanApplication app(HeadlessConfig{}, mesh, defaultTexture, latencyMode);
+                results.push_back(Benchmark::runScene(app, scene, textureDirectory));
+                continue;
+            }
+
+            if (!glfwInit()) {
+                throw std::runtime_error("GLFW Initialization Failed!\n");
+            }
+            glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+            glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+            GLFWwindow* window = glfwCreateWindow(1200, 1050, ("Vulkan Benchmark | " + scene.name).c_str(),
+                                                  nullptr, nullptr);
+            if (!window) {
+                glfwTerminate();
+                throw std::runtime_error("GLFW Instantiation failed!\n");
+            }
+            {
+                VulkanApplication app(window, mesh, defaultTexture, latencyMode);
+                results.push_back(Benchmark::runScene(app, scene, textureDirectory));
+            }
+            glfwDestroyWindow(window);
+            glfwTerminate();
+        }
+
+        if (outputPath == "-") {
+            Benchmark::writeJson(std::cout, results);
+        } else {
+            std::ofstream out(outputPath);
+            if (!out) {
+                throw std::runtime_error("Failed to open " + outputPath + " for writing!");
+            }
+            Benchmark::writeJson(out, results);
+            std::cerr << "Wrote " << results.size() << " benchmark results to " << outputPath << "." << std::endl;
+        }
+    } catch(const std::exception& e) {
+        std::cerr << e.what() <<  "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,217 @@
+// ================================================================================
+// ================================================================================
+// - File:    bindless.cpp
+// - Purpose: This file contains the implementation of the BindlessTextureTable class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/bindless.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+// ================================================================================
+// ================================================================================
+
+BindlessTextureTable::BindlessTextureTable(VkDevice device,
+                                           VkPhysicalDevice physicalDevice,
+                                           uint32_t maxTextures,
+                                           uint32_t maxSamplers)
+    : device(device) {
+    VkPhysicalDeviceDescriptorIndexingProperties indexingProperties{};
+    indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &indexingProperties;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    // Both arrays live in the fragment stage, so the per-stage limits are the tighter ones
+    textureCapacity = std::min({maxTextures,
+                                indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+                                indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages});
+    samplerCapacity = std::min({maxSamplers,
+                                indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+                                indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers});
+    if (textureCapacity == 0 || samplerCapacity == 0) {
+        throw std::runtime_error("The device reports no update-after-bind image or sampler descriptors!");
+    }
+
+    try {
+        createDescriptorSet();
+    } catch (...) {
+        destroy();
+        throw;
+    }
+}
+// --------------------------------------------------------------------------------
+
+BindlessTextureTable::~BindlessTextureTable() {
+    destroy();
+}
+// --------------------------------------------------------------------------------
+
+uint32_t BindlessTextureTable::addTexture(VkImageView imageView) {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    uint32_t slot;
+    if (!freeTextureSlots.empty()) {
+        slot = freeTextureSlots.back();
+        freeTextureSlots.pop_back();
+    } else if (nextTextureSlot < textureCapacity) {
+        slot = nextTextureSlot++;
+    } else {
+        throw std::runtime_error("The bindless texture table is full!");
+    }
+
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfo.imageView = imageView;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = descriptorSet;
+    descriptorWrite.dstBinding = 0;
+    descriptorWrite.dstArrayElement = slot;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &imageInfo;
+    // Legal while the set is bound by pending frames, since none of them uses this slot
+    vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+    return slot;
+}
+// --------------------------------------------------------------------------------
+
+void BindlessTextureTable::removeTexture(uint32_t slot) {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    // The stale descriptor stays in place; partially bound slots need not be valid
+    freeTextureSlots.push_back(slot);
+}
+// --------------------------------------------------------------------------------
+
+uint32_t BindlessTextureTable::addSampler(VkSampler sampler) {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    auto it = std::find(samplers.begin(), samplers.end(), sampler);
+    if (it != samplers.end()) {
+        return static_cast<uint32_t>(it - samplers.begin());
+    }
+    if (samplers.size() >= samplerCapacity) {
+        throw std::runtime_error("The bindless sampler table is full!");
+    }
+    const uint32_t slot = static_cast<uint32_t>(samplers.size());
+
+    VkDescriptorImageInfo samplerInfo{};
+    samplerInfo.sampler = sampler;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = descriptorSet;
+    descriptorWrite.dstBinding = 1;
+    descriptorWrite.dstArrayElement = slot;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &samplerInfo;
+    vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+
+    samplers.push_back(sampler);
+    return slot;
+}
+// --------------------------------------------------------------------------------
+
+VkDescriptorSetLayout BindlessTextureTable::getDescriptorSetLayout() const {
+    return descriptorSetLayout;
+}
+// --------------------------------------------------------------------------------
+
+VkDescriptorSet BindlessTextureTable::getDescriptorSet() const {
+    return descriptorSet;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t BindlessTextureTable::getTextureCapacity() const {
+    return textureCapacity;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t BindlessTextureTable::getTextureCount() const {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    return nextTextureSlot - static_cast<uint32_t>(freeTextureSlots.size());
+}
+// ================================================================================
+
+void BindlessTextureTable::createDescriptorSet() {
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    bindings[0].descriptorCount = textureCapacity;
+    bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    bindings[1].descriptorCount = samplerCapacity;
+    bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // Unwritten slots are allowed, and slots may be written while the set is in use
+    const VkDescriptorBindingFlags bindingFlag = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                                 VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                                 VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+    std::array<VkDescriptorBindingFlags, 2> bindingFlags = {bindingFlag, bindingFlag};
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+    flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    flagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    flagsInfo.pBindingFlags = bindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &flagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create the bindless descriptor set layout!");
+    }
+
+    std::array<VkDescriptorPoolSize, 2> poolSizes = {{
+        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, textureCapacity},
+        {VK_DESCRIPTOR_TYPE_SAMPLER, samplerCapacity}
+    }};
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create the bindless descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &descriptorSetLayout;
+    if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate the bindless descriptor set!");
+    }
+}
+// --------------------------------------------------------------------------------
+
+void BindlessTextureTable::destroy() {
+    // Destroying the pool frees the set
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+        descriptorSet = VK_NULL_HANDLE;
+    }
+    if (descriptorSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+        descriptorSetLayout = VK_NULL_HANDLE;
+    }
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,395 @@
+// ================================================================================
+// ================================================================================
+// - File:    culling.cpp
+// - Purpose: This file contains the implementation of the CullingPass class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/culling.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+// ================================================================================
+// ================================================================================
+
+CullingPass::CullingPass(VkDevice device,
+                         AllocatorManager& allocatorManager,
+                         Scene& scene,
+                         PipelineCache& pipelineCache,
+                         const DeviceFeatureSupport& features,
+                         uint32_t framesInFlight,
+                         const std::string& compFile)
+    : device(device),
+      allocatorManager(allocatorManager),
+      scene(scene),
+      enabled(features.drawIndirectFirstInstance),
+      frames(framesInFlight) {
+    if (!enabled) {
+        instanceBuffers = scene.getInstanceBuffers();
+        return;
+    }
+
+    try {
+        createBuffers();
+        createDescriptors();
+        createPipelines(compFile, pipelineCache);
+    } catch (...) {
+        destroy();
+        throw;
+    }
+}
+// --------------------------------------------------------------------------------
+
+CullingPass::~CullingPass() {
+    destroy();
+}
+// --------------------------------------------------------------------------------
+
+bool CullingPass::isEnabled() const {
+    return enabled;
+}
+// --------------------------------------------------------------------------------
+
+void CullingPass::setFrustum(uint32_t frameIndex, const glm::mat4& viewProj) {
+    frames.at(frameIndex).planes = extractFrustumPlanes(viewProj);
+}
+// --------------------------------------------------------------------------------
+
+void CullingPass::record(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    FrameResources& frame = frames.at(frameIndex);
+    if (!enabled) {
+        return;
+    }
+
+    // The frame's fence has been waited on, so its last results are complete
+    if (frame.recorded) {
+        vmaInvalidateAllocation(allocatorManager.getAllocator(), frame.statsAllocation, 0, sizeof(CullingStats));
+        lastStats = *frame.stats;
+        frame.recorded = false;
+    }
+
+    const uint32_t drawCount = scene.getDrawCount(frameIndex);
+    if (drawCount == 0) {
+        return;
+    }
+
+    vkCmdFillBuffer(commandBuffer, frame.countsBuffer, 0, sizeof(uint32_t) * drawCount, 0);
+    vkCmdFillBuffer(commandBuffer, frame.statsBuffer, 0, sizeof(CullingStats), 0);
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    PushConstants constants{};
+    for (size_t i = 0; i < frame.planes.size(); ++i) {
+        constants.planes[i] = frame.planes[i];
+    }
+    constants.drawCount = drawCount;
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+                            0, 1, &frame.descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+                       0, sizeof(PushConstants), &constants);
+
+    // One row of workgroups per draw, wide enough for the draw with the most instances
+    const uint32_t groupsPerDraw = (scene.getLargestDraw(frameIndex) + 63) / 64;
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+    vkCmdDispatch(commandBuffer, groupsPerDraw, drawCount, 1);
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, commandPipeline);
+    vkCmdDispatch(commandBuffer, (drawCount + 63) / 64, 1, 1);
+
+    frame.recorded = true;
+}
+// --------------------------------------------------------------------------------
+
+const std::vector<VkBuffer>& CullingPass::getInstanceBuffers() const {
+    return instanceBuffers;
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer CullingPass::getIndirectBuffer(uint32_t frameIndex) const {
+    if (!enabled) {
+        return scene.getIndirectBuffer(frameIndex);
+    }
+    return frames.at(frameIndex).commandBuffer;
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer CullingPass::getStatsBuffer(uint32_t frameIndex) const {
+    return frames.at(frameIndex).statsBuffer;
+}
+// --------------------------------------------------------------------------------
+
+CullingStats CullingPass::getStats() const {
+    return lastStats;
+}
+// --------------------------------------------------------------------------------
+
+std::array<glm::vec4, 6> CullingPass::extractFrustumPlanes(const glm::mat4& viewProj) {
+    // glm is column-major, so row i of the matrix is element i of every column
+    auto row = [&viewProj](int i) {
+        return glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+    };
+    const glm::vec4 r0 = row(0);
+    const glm::vec4 r1 = row(1);
+    const glm::vec4 r2 = row(2);
+    const glm::vec4 r3 = row(3);
+
+    std::array<glm::vec4, 6> planes = {
+        glm::vec4(r3.x + r0.x, r3.y + r0.y, r3.z + r0.z, r3.w + r0.w),  // Left
+        glm::vec4(r3.x - r0.x, r3.y - r0.y, r3.z - r0.z, r3.w - r0.w),  // Right
+        glm::vec4(r3.x + r1.x, r3.y + r1.y, r3.z + r1.z, r3.w + r1.w),  // Bottom
+        glm::vec4(r3.x - r1.x, r3.y - r1.y, r3.z - r1.z, r3.w - r1.w),  // Top
+        r2,                                                             // Near, z >= 0
+        glm::vec4(r3.x - r2.x, r3.y - r2.y, r3.z - r2.z, r3.w - r2.w)   // Far
+    };
+
+    for (glm::vec4& plane : planes) {
+        const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        if (length > 0.0f) {
+            plane = glm::vec4(plane.x / length, plane.y / length, plane.z / length, plane.w / length);
+        }
+    }
+    return planes;
+}
+// --------------------------------------------------------------------------------
+
+bool CullingPass::isSphereVisible(const std::array<glm::vec4, 6>& planes, const glm::vec4& sphere) {
+    for (const glm::vec4& plane : planes) {
+        if (plane.x * sphere.x + plane.y * sphere.y + plane.z * sphere.z + plane.w < -sphere.w) {
+            return false;
+        }
+    }
+    return true;
+}
+// ================================================================================
+
+void CullingPass::createBuffers() {
+    const VkDeviceSize instanceBytes = sizeof(InstanceData) * scene.getMaxInstances();
+    const VkDeviceSize commandBytes = sizeof(VkDrawIndexedIndirectCommand) * scene.getMaxDraws();
+    const VkDeviceSize countBytes = sizeof(uint32_t) * scene.getMaxDraws();
+
+    for (FrameResources& frame : frames) {
+        allocatorManager.createBuffer(instanceBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                      VMA_MEMORY_USAGE_GPU_ONLY, frame.instanceBuffer, frame.instanceAllocation);
+        allocatorManager.createBuffer(countBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      VMA_MEMORY_USAGE_GPU_ONLY, frame.countsBuffer, frame.countsAllocation);
+        allocatorManager.createBuffer(commandBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                      VMA_MEMORY_USAGE_GPU_ONLY, frame.commandBuffer, frame.commandAllocation);
+        allocatorManager.createBuffer(sizeof(CullingStats),
+                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      VMA_MEMORY_USAGE_GPU_TO_CPU, frame.statsBuffer, frame.statsAllocation);
+        allocatorManager.mapMemory(frame.statsAllocation, reinterpret_cast<void**>(&frame.stats));
+        instanceBuffers.push_back(frame.instanceBuffer);
+    }
+}
+// --------------------------------------------------------------------------------
+
+void CullingPass::createDescriptors() {
+    constexpr uint32_t bindingCount = 6;
+
+    std::array<VkDescriptorSetLayoutBinding, bindingCount> bindings{};
+    for (uint32_t i = 0; i < bindingCount; ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorCount = 1;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].pImmutableSamplers = nullptr;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = bindingCount;
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling descriptor set layout!");
+    }
+
+    const uint32_t frameCount = static_cast<uint32_t>(frames.size());
+    VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, bindingCount * frameCount};
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = frameCount;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(frameCount, descriptorSetLayout);
+    std::vector<VkDescriptorSet> sets(frameCount);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = frameCount;
+    allocInfo.pSetLayouts = layouts.data();
+    if (vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate culling descriptor sets!");
+    }
+
+    for (uint32_t i = 0; i < frameCount; ++i) {
+        FrameResources& frame = frames[i];
+        frame.descriptorSet = sets[i];
+
+        // Binding order matches cull.comp
+        const std::array<VkBuffer, bindingCount> buffers = {
+            scene.getInstanceBuffers()[i], scene.getIndirectBuffer(i), frame.instanceBuffer,
+            frame.countsBuffer, frame.commandBuffer, frame.statsBuffer
+        };
+
+        std::array<VkDescriptorBufferInfo, bindingCount> bufferInfos{};
+        std::array<VkWriteDescriptorSet, bindingCount> writes{};
+        for (uint32_t b = 0; b < bindingCount; ++b) {
+            bufferInfos[b].buffer = buffers[b];
+            bufferInfos[b].offset = 0;
+            bufferInfos[b].range = VK_WHOLE_SIZE;
+
+            writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[b].dstSet = frame.descriptorSet;
+            writes[b].dstBinding = b;
+            writes[b].dstArrayElement = 0;
+            writes[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[b].descriptorCount = 1;
+            writes[b].pBufferInfo = &bufferInfos[b];
+        }
+        vkUpdateDescriptorSets(device, bindingCount, writes.data(), 0, nullptr);
+    }
+}
+// --------------------------------------------------------------------------------
+
+void CullingPass::createPipelines(const std::string& compFile, PipelineCache& pipelineCache) {
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = 1;
+    layoutInfo.pSetLayouts = &descriptorSetLayout;
+    layoutInfo.pushConstantRangeCount = 1;
+    layoutInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling pipeline layout!");
+    }
+
+    std::vector<char> code = readFile(compFile);
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = code.size();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(device, &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling shader module!");
+    }
+
+    // Both phases share one module and differ only in the PHASE specialization constant
+    const std::array<uint32_t, 2> phases = {0, 1};
+    std::array<VkSpecializationInfo, 2> specializations{};
+    VkSpecializationMapEntry entry{0, 0, sizeof(uint32_t)};
+    std::array<VkComputePipelineCreateInfo, 2> pipelineInfos{};
+    for (size_t i = 0; i < phases.size(); ++i) {
+        specializations[i].mapEntryCount = 1;
+        specializations[i].pMapEntries = &entry;
+        specializations[i].dataSize = sizeof(uint32_t);
+        specializations[i].pData = &phases[i];
+
+        pipelineInfos[i].sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfos[i].stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfos[i].stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfos[i].stage.module = shaderModule;
+        pipelineInfos[i].stage.pName = "main";
+        pipelineInfos[i].stage.pSpecializationInfo = &specializations[i];
+        pipelineInfos[i].layout = pipelineLayout;
+    }
+
+    std::array<VkPipeline, 2> pipelines = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VkResult result = vkCreateComputePipelines(device, pipelineCache.getCache(),
+                                               static_cast<uint32_t>(pipelineInfos.size()),
+                                               pipelineInfos.data(), nullptr, pipelines.data());
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+    cullPipeline = pipelines[0];
+    commandPipeline = pipelines[1];
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling pipelines!");
+    }
+}
+// --------------------------------------------------------------------------------
+
+void CullingPass::destroy() {
+    if (cullPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, cullPipeline, nullptr);
+        cullPipeline = VK_NULL_HANDLE;
+    }
+    if (commandPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, commandPipeline, nullptr);
+        commandPipeline = VK_NULL_HANDLE;
+    }
+    if (pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        pipelineLayout = VK_NULL_HANDLE;
+    }
+    // Destroying the pool frees the sets allocated from it
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+    }
+    if (descriptorSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+        descriptorSetLayout = VK_NULL_HANDLE;
+    }
+
+    for (FrameResources& frame : frames) {
+        if (frame.instanceBuffer != VK_NULL_HANDLE) {
+            allocatorManager.destroyBuffer(frame.instanceBuffer, frame.instanceAllocation);
+        }
+        if (frame.countsBuffer != VK_NULL_HANDLE) {
+            allocatorManager.destroyBuffer(frame.countsBuffer, frame.countsAllocation);
+        }
+        if (frame.commandBuffer != VK_NULL_HANDLE) {
+            allocatorManager.destroyBuffer(frame.commandBuffer, frame.commandAllocation);
+        }
+        if (frame.statsBuffer != VK_NULL_HANDLE) {
+            if (frame.stats != nullptr) {
+                allocatorManager.unmapMemory(frame.statsAllocation);
+            }
+            allocatorManager.destroyBuffer(frame.statsBuffer, frame.statsAllocation);
+        }
+        frame = FrameResources{};
+    }
+    instanceBuffers.clear();
+}
+// --------------------------------------------------------------------------------
+
+std::vector<char> CullingPass::readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file: " + filename);
+    }
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    return buffer;
+}
+// ================================================================================
+// ================================================================================
+// eof
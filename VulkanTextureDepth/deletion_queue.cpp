@@ -0,0 +1,78 @@
+// ================================================================================
+// ================================================================================
+// - File:    deletion_queue.cpp
+// - Purpose: This file contains the implementation of the DeletionQueue class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/deletion_queue.hpp"
+
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+DeletionQueue::DeletionQueue(uint32_t framesInFlight)
+    : framesInFlight(framesInFlight) {}
+// --------------------------------------------------------------------------------
+
+DeletionQueue::~DeletionQueue() {
+    flush();
+}
+// --------------------------------------------------------------------------------
+
+void DeletionQueue::push(std::function<void()> deleter) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    entries.push_back({fenceWaits + framesInFlight, std::move(deleter)});
+}
+// --------------------------------------------------------------------------------
+
+void DeletionQueue::onFenceWaited() {
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        ++fenceWaits;
+        while (!entries.empty() && entries.front().releaseAt <= fenceWaits) {
+            ready.push_back(std::move(entries.front().deleter));
+            entries.pop_front();
+        }
+    }
+
+    // Deleters may push further work, so they run without the lock
+    for (std::function<void()>& deleter : ready) {
+        deleter();
+    }
+}
+// --------------------------------------------------------------------------------
+
+void DeletionQueue::flush() {
+    std::deque<Entry> pending;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending.swap(entries);
+    }
+    for (Entry& entry : pending) {
+        entry.deleter();
+    }
+}
+// --------------------------------------------------------------------------------
+
+void DeletionQueue::setFramesInFlight(uint32_t framesInFlight) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    this->framesInFlight = framesInFlight;
+}
+// --------------------------------------------------------------------------------
+
+size_t DeletionQueue::size() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return entries.size();
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,68 @@
+// ================================================================================
+// ================================================================================
+// - File:    depth_config.cpp
+// - Purpose: This file contains the implementation of the DepthConfig struct
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/depth_config.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+// ================================================================================
+// ================================================================================
+
+VkCompareOp DepthConfig::depthCompareOp() const {
+    return reverseZ ? VK_COMPARE_OP_GREATER : VK_COMPARE_OP_LESS;
+}
+// --------------------------------------------------------------------------------
+
+VkCompareOp DepthConfig::shadingCompareOp() const {
+    return prepass ? VK_COMPARE_OP_EQUAL : depthCompareOp();
+}
+// --------------------------------------------------------------------------------
+
+bool DepthConfig::shadingWritesDepth() const {
+    return !prepass;
+}
+// --------------------------------------------------------------------------------
+
+float DepthConfig::clearDepth() const {
+    return reverseZ ? 0.0f : 1.0f;
+}
+// --------------------------------------------------------------------------------
+
+glm::mat4 DepthConfig::projection(float fovY, float aspect, float nearPlane, float farPlane) const {
+    // Swapping the planes maps the near plane to 1 and the far plane to 0
+    glm::mat4 proj = reverseZ ? glm::perspectiveRH_ZO(fovY, aspect, farPlane, nearPlane)
+                              : glm::perspectiveRH_ZO(fovY, aspect, nearPlane, farPlane);
+    proj[1][1] *= -1; // Invert Y-axis for Vulkan
+    return proj;
+}
+// --------------------------------------------------------------------------------
+
+std::vector<VkFormat> DepthConfig::formatCandidates() const {
+    if (reverseZ) {
+        return {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT};
+    }
+    return {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT};
+}
+// --------------------------------------------------------------------------------
+
+VkSampleCountFlagBits DepthConfig::sampleCount(VkSampleCountFlags supported) const {
+    for (uint32_t count = VK_SAMPLE_COUNT_64_BIT; count > VK_SAMPLE_COUNT_1_BIT; count >>= 1) {
+        if (count <= msaaSamples && (supported & count)) {
+            return static_cast<VkSampleCountFlagBits>(count);
+        }
+    }
+    return VK_SAMPLE_COUNT_1_BIT;
+}
+// ================================================================================
+// ================================================================================
+// eof
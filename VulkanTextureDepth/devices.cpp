@@ -18,6 +18,7 @@
 #include <stdexcept>
 #include <vector>
 #include <set>
+#include <string>
 #include <limits>
 #include <algorithm>
 #include <iostream>
@@ -29,6 +30,11 @@ VulkanPhysicalDevice::VulkanPhysicalDevice(VkInstance& instance, VkSurfaceKHR su
 
     std::lock_guard<std::mutex> lock(deviceMutex);  // Lock when setting physicalDevice
 
+    // A headless device never creates a swap chain
+    if (surface == VK_NULL_HANDLE) {
+        deviceExtensions.clear();
+    }
+
     uint32_t deviceCount = 0;
     vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
 
@@ -91,8 +97,9 @@ bool VulkanPhysicalDevice::isDeviceSuitable(const VkPhysicalDevice device) const
 
     bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported) {
+    const bool headless = surface == VK_NULL_HANDLE;
+    bool swapChainAdequate = headless;
+    if (extensionsSupported && !headless) {
         SwapChainSupportDetails swapChainSupport = SwapChain::querySwapChainSupport(device, surface);
         swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
     }
@@ -100,7 +107,7 @@ bool VulkanPhysicalDevice::isDeviceSuitable(const VkPhysicalDevice device) const
     VkPhysicalDeviceFeatures supportedFeatures;
     vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
-    return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
+    return indices.isComplete(!headless) && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
 }
 // --------------------------------------------------------------------------------
 
@@ -190,15 +197,51 @@ VkQueue VulkanLogicalDevice::getPresentQueue() const {
 
 // --------------------------------------------------------------------------------
 
+VkQueue VulkanLogicalDevice::getTransferQueue() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return transferQueue;
+}
+
+// --------------------------------------------------------------------------------
+
+VkQueue VulkanLogicalDevice::getComputeQueue() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return computeQueue;
+}
+
+// --------------------------------------------------------------------------------
+
+const QueueFamilyIndices& VulkanLogicalDevice::getQueueFamilyIndices() const {
+    return queueFamilyIndices;
+}
+
+// --------------------------------------------------------------------------------
+
+const DeviceFeatureSupport& VulkanLogicalDevice::getEnabledFeatures() const {
+    return enabledFeatures;
+}
+
+// --------------------------------------------------------------------------------
+
 void VulkanLogicalDevice::createLogicalDevice() {
     QueueFamilyIndices indices = QueueFamily::findQueueFamilies(physicalDevice, surface);
 
-    if (!indices.graphicsFamily.has_value() || !indices.presentFamily.has_value()) {
+    const bool headless = surface == VK_NULL_HANDLE;
+    if (!indices.isComplete(!headless)) {
         throw std::runtime_error("Failed to find required queue families.");
     }
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-    std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
+    std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value()};
+    if (indices.presentFamily.has_value()) {
+        uniqueQueueFamilies.insert(indices.presentFamily.value());
+    }
+    if (indices.transferFamily.has_value()) {
+        uniqueQueueFamilies.insert(indices.transferFamily.value());
+    }
+    if (indices.computeFamily.has_value()) {
+        uniqueQueueFamilies.insert(indices.computeFamily.value());
+    }
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -210,17 +253,125 @@ void VulkanLogicalDevice::createLogicalDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    VkPhysicalDeviceFeatures deviceFeatures{};
-    deviceFeatures.samplerAnisotropy = VK_TRUE;
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+    // Vulkan 1.2 feature structs may only be chained on devices that expose 1.2
+    const bool vulkan12 = deviceProperties.apiVersion >= VK_API_VERSION_1_2;
+    const bool vulkan13 = deviceProperties.apiVersion >= VK_API_VERSION_1_3;
+
+    // Present pacing is optional and needs both the present id and present wait extensions,
+    // and a headless device never presents
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+    std::set<std::string> availableExtensionSet;
+    for (const VkExtensionProperties& extension : availableExtensions) {
+        availableExtensionSet.insert(extension.extensionName);
+    }
+    // The budget extension only adds queries, so it is enabled whenever it exists
+    const bool memoryBudget = availableExtensionSet.count(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) > 0;
+    const bool presentWaitExtensions = !headless &&
+                                       availableExtensionSet.count(VK_KHR_PRESENT_ID_EXTENSION_NAME) > 0 &&
+                                       availableExtensionSet.count(VK_KHR_PRESENT_WAIT_EXTENSION_NAME) > 0;
+
+    VkPhysicalDeviceVulkan12Features supported12{};
+    supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceVulkan13Features supported13{};
+    supported13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    VkPhysicalDevicePresentIdFeaturesKHR supportedPresentId{};
+    supportedPresentId.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    VkPhysicalDevicePresentWaitFeaturesKHR supportedPresentWait{};
+    supportedPresentWait.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    VkPhysicalDeviceFeatures2 supportedFeatures{};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    void** supportedTail = &supportedFeatures.pNext;
+    if (vulkan12) {
+        *supportedTail = &supported12;
+        supportedTail = &supported12.pNext;
+    }
+    if (vulkan13) {
+        *supportedTail = &supported13;
+        supportedTail = &supported13.pNext;
+    }
+    if (presentWaitExtensions) {
+        *supportedTail = &supportedPresentId;
+        supportedPresentId.pNext = &supportedPresentWait;
+    }
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures);
+
+    VkPhysicalDeviceVulkan12Features enabled12{};
+    enabled12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    enabled12.drawIndirectCount = vulkan12 ? supported12.drawIndirectCount : VK_FALSE;
+    // The bindless texture table needs every one of these, so they are enabled together
+    const bool descriptorIndexing = vulkan12 &&
+                                    supported12.runtimeDescriptorArray == VK_TRUE &&
+                                    supported12.descriptorBindingPartiallyBound == VK_TRUE &&
+                                    supported12.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE &&
+                                    supported12.descriptorBindingUpdateUnusedWhilePending == VK_TRUE;
+    if (descriptorIndexing) {
+        enabled12.runtimeDescriptorArray = VK_TRUE;
+        enabled12.descriptorBindingPartiallyBound = VK_TRUE;
+        enabled12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        enabled12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    }
+
+    // The render graph records its barriers with vkCmdPipelineBarrier2 when this is present
+    VkPhysicalDeviceVulkan13Features enabled13{};
+    enabled13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    enabled13.synchronization2 = vulkan13 ? supported13.synchronization2 : VK_FALSE;
+
+    const bool presentWait = presentWaitExtensions &&
+                             supportedPresentId.presentId == VK_TRUE &&
+                             supportedPresentWait.presentWait == VK_TRUE;
+    VkPhysicalDevicePresentIdFeaturesKHR enabledPresentId{};
+    enabledPresentId.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    enabledPresentId.presentId = VK_TRUE;
+    VkPhysicalDevicePresentWaitFeaturesKHR enabledPresentWait{};
+    enabledPresentWait.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    enabledPresentWait.presentWait = VK_TRUE;
+
+    std::vector<const char*> enabledExtensions = deviceExtensions;
+    if (presentWait) {
+        enabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+        enabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+    }
+    if (memoryBudget) {
+        enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
+    VkPhysicalDeviceFeatures2 deviceFeatures{};
+    deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    void** enabledTail = &deviceFeatures.pNext;
+    if (vulkan12) {
+        *enabledTail = &enabled12;
+        enabledTail = &enabled12.pNext;
+    }
+    if (vulkan13) {
+        *enabledTail = &enabled13;
+        enabledTail = &enabled13.pNext;
+    }
+    if (presentWait) {
+        *enabledTail = &enabledPresentId;
+        enabledPresentId.pNext = &enabledPresentWait;
+    }
+    deviceFeatures.features.samplerAnisotropy = VK_TRUE;
+    // Precompressed textures are loaded in whichever block format the device supports
+    deviceFeatures.features.textureCompressionBC = supportedFeatures.features.textureCompressionBC;
+    deviceFeatures.features.textureCompressionASTC_LDR = supportedFeatures.features.textureCompressionASTC_LDR;
+    // Indirect drawing falls back to simpler submission paths when these are missing
+    deviceFeatures.features.multiDrawIndirect = supportedFeatures.features.multiDrawIndirect;
+    deviceFeatures.features.drawIndirectFirstInstance = supportedFeatures.features.drawIndirectFirstInstance;
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &deviceFeatures;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
-    createInfo.pEnabledFeatures = &deviceFeatures;
+    createInfo.pEnabledFeatures = nullptr; // Features are supplied through the pNext chain
 
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     if (!validationLayers.empty()) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -239,9 +390,22 @@ void VulkanLogicalDevice::createLogicalDevice() {
     {
         std::lock_guard<std::mutex> lock(queueMutex); // Lock while accessing the queues
         vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
-        vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
+        if (indices.presentFamily.has_value()) {
+            vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
+        }
+        vkGetDeviceQueue(device, indices.uploadFamily(), 0, &transferQueue);
+        vkGetDeviceQueue(device, indices.asyncComputeFamily(), 0, &computeQueue);
+        queueFamilyIndices = indices;
     }
 
+    enabledFeatures.multiDrawIndirect = deviceFeatures.features.multiDrawIndirect == VK_TRUE;
+    enabledFeatures.drawIndirectFirstInstance = deviceFeatures.features.drawIndirectFirstInstance == VK_TRUE;
+    enabledFeatures.drawIndirectCount = enabled12.drawIndirectCount == VK_TRUE;
+    enabledFeatures.presentWait = presentWait;
+    enabledFeatures.descriptorIndexing = descriptorIndexing;
+    enabledFeatures.memoryBudget = memoryBudget;
+    enabledFeatures.synchronization2 = enabled13.synchronization2 == VK_TRUE;
+
     std::cout << "Logical device and queues created successfully." << std::endl; // For logging
 }
 
@@ -257,6 +421,10 @@ VulkanLogicalDevice::VulkanLogicalDevice(VulkanLogicalDevice&& other) noexcept
     device = other.device;
     graphicsQueue = other.graphicsQueue;
     presentQueue = other.presentQueue;
+    transferQueue = other.transferQueue;
+    computeQueue = other.computeQueue;
+    queueFamilyIndices = other.queueFamilyIndices;
+    enabledFeatures = other.enabledFeatures;
 
     // Reset the source object
     other.device = VK_NULL_HANDLE;
@@ -277,6 +445,10 @@ VulkanLogicalDevice& VulkanLogicalDevice::operator=(VulkanLogicalDevice&& other)
         device = other.device;
         graphicsQueue = other.graphicsQueue;
         presentQueue = other.presentQueue;
+        transferQueue = other.transferQueue;
+        computeQueue = other.computeQueue;
+        queueFamilyIndices = other.queueFamilyIndices;
+        enabledFeatures = other.enabledFeatures;
         physicalDevice = other.physicalDevice;
         validationLayers = std::move(other.validationLayers); // Move the vectors
         deviceExtensions = std::move(other.deviceExtensions);
@@ -294,11 +466,13 @@ VulkanLogicalDevice& VulkanLogicalDevice::operator=(VulkanLogicalDevice&& other)
 SwapChain::SwapChain(VkDevice device, 
                      VkSurfaceKHR surface, 
                      VkPhysicalDevice physicalDevice, 
-                     GLFWwindow* window)
+                     GLFWwindow* window,
+                     const LatencyProfile& latencyProfile)
     : device(device), 
       surface(surface), 
       physicalDevice(physicalDevice),
-      window(window) {
+      window(window),
+      latencyProfile(latencyProfile) {
     createSwapChain();
     createImageViews();
 }
@@ -335,6 +509,16 @@ const std::vector<VkImageView>& SwapChain::getSwapChainImageViews() const {
 }
 // --------------------------------------------------------------------------------
 
+VkPresentModeKHR SwapChain::getPresentMode() const {
+    return presentMode;
+}
+// --------------------------------------------------------------------------------
+
+void SwapChain::setLatencyProfile(const LatencyProfile& latencyProfile) {
+    this->latencyProfile = latencyProfile;
+}
+// --------------------------------------------------------------------------------
+
 SwapChainSupportDetails SwapChain::querySwapChainSupport(VkPhysicalDevice device, VkSurfaceKHR surface) {
     SwapChainSupportDetails details;
 
@@ -365,8 +549,10 @@ void SwapChain::cleanupSwapChain() {
     for (auto imageView : swapChainImageViews) {
         vkDestroyImageView(device, imageView, nullptr);
     }
+    swapChainImageViews.clear();
 
     vkDestroySwapchainKHR(device, swapChain, nullptr);
+    swapChain = VK_NULL_HANDLE;
 }
 // --------------------------------------------------------------------------------
 
@@ -375,6 +561,25 @@ void SwapChain::recreateSwapChain() {
     createSwapChain();  // Recreate the swap chain with updated parameters (like new window size)
     createImageViews();  // Recreate the image views for the swap chain images
 }
+// --------------------------------------------------------------------------------
+
+void SwapChain::recreateSwapChain(DeletionQueue& deletionQueue) {
+    VkSwapchainKHR oldSwapChain = swapChain;
+    std::vector<VkImageView> oldImageViews = std::move(swapChainImageViews);
+    swapChainImageViews.clear();
+
+    // createSwapChain() passes the current handle as oldSwapchain before replacing it
+    createSwapChain();
+    createImageViews();
+
+    VkDevice device = this->device;
+    deletionQueue.push([device, oldSwapChain, oldImageViews]() {
+        for (VkImageView imageView : oldImageViews) {
+            vkDestroyImageView(device, imageView, nullptr);
+        }
+        vkDestroySwapchainKHR(device, oldSwapChain, nullptr);
+    });
+}
 
 // ================================================================================
 
@@ -385,10 +590,7 @@ void SwapChain::createSwapChain() {
     VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
     VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
 
-    uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
-    if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount) {
-        imageCount = swapChainSupport.capabilities.maxImageCount;
-    }
+    uint32_t imageCount = latencyProfile.chooseImageCount(swapChainSupport.capabilities);
 
     VkSwapchainCreateInfoKHR createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -416,7 +618,7 @@ void SwapChain::createSwapChain() {
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    createInfo.oldSwapchain = swapChain;  // VK_NULL_HANDLE on first creation
 
     if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapChain) != VK_SUCCESS) {
         throw std::runtime_error("failed to create swap chain!");
@@ -428,6 +630,7 @@ void SwapChain::createSwapChain() {
 
     swapChainImageFormat = surfaceFormat.format;
     swapChainExtent = extent;
+    this->presentMode = presentMode;
 }
 // --------------------------------------------------------------------------------
 
@@ -503,13 +706,7 @@ VkSurfaceFormatKHR SwapChain::chooseSwapSurfaceFormat(const std::vector<VkSurfac
 // --------------------------------------------------------------------------------
 
 VkPresentModeKHR SwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
-    for (const auto& availablePresentMode : availablePresentModes) {
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-            return availablePresentMode;
-        }
-    }
-
-    return VK_PRESENT_MODE_FIFO_KHR;
+    return latencyProfile.choosePresentMode(availablePresentModes);
 }
 // --------------------------------------------------------------------------------
 
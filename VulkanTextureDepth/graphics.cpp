@@ -14,36 +14,71 @@
 
 #include "include/graphics.hpp"
 #include "include/queues.hpp"
+#include "include/texture_loader.hpp"
 #include <iostream>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "include/stb_image.h"
 
 #include <cstring>  // memcpy
+#include <cmath>
+#include <algorithm>
 #include <string>
 #include <fstream>
 #include <filesystem>
+#include <exception>
+#include <future>
 // ================================================================================
 // ================================================================================
 
 DepthManager::DepthManager(AllocatorManager& allocatorManager, 
                            VkDevice device, 
                            VkPhysicalDevice physicalDevice, 
-                           VkExtent2D swapChainExtent)
+                           VkExtent2D swapChainExtent,
+                           VkFormat colorFormat,
+                           const DepthConfig& config)
     : allocatorManager(allocatorManager),
       device(device),
       physicalDevice(physicalDevice),
-      swapChainExtent(swapChainExtent) {}
+      swapChainExtent(swapChainExtent),
+      colorFormat(colorFormat),
+      config(config) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    samples = config.sampleCount(properties.limits.framebufferColorSampleCounts &
+                                 properties.limits.framebufferDepthSampleCounts);
+
+    // Tilers expose a lazily allocated type whose pages are only committed if a render
+    // pass actually spills the attachment out of tile memory
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+        if (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) {
+            lazyMemorySupported = true;
+            break;
+        }
+    }
+}
 // --------------------------------------------------------------------------------
 
 DepthManager::~DepthManager() {
+    if (colorImageView != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, colorImageView, nullptr);
+        colorImageView = VK_NULL_HANDLE;
+    }
+    if (colorImage != VK_NULL_HANDLE) {
+        allocatorManager.destroyImage(colorImage, colorImageMemory);
+        colorImage = VK_NULL_HANDLE;
+        colorImageMemory = VK_NULL_HANDLE;
+    }
+
     if (depthImageView != VK_NULL_HANDLE) {
         vkDestroyImageView(device, depthImageView, nullptr);
         depthImageView = VK_NULL_HANDLE;
     }
 
     if (depthImage != VK_NULL_HANDLE && depthImageMemory != VK_NULL_HANDLE) {
-        vmaDestroyImage(allocatorManager.getAllocator(), depthImage, depthImageMemory);
+        allocatorManager.destroyImage(depthImage, depthImageMemory);
         depthImage = VK_NULL_HANDLE;
         depthImageMemory = VK_NULL_HANDLE;
     }
@@ -53,16 +88,60 @@ DepthManager::~DepthManager() {
 void DepthManager::createDepthResources() {
     VkFormat depthFormat = findDepthFormat();
 
-    createImage(swapChainExtent.width, swapChainExtent.height, depthFormat, 
-                VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, 
-                VMA_MEMORY_USAGE_GPU_ONLY, depthImage, depthImageMemory);
+    depthLazilyAllocated = createAttachmentImage(swapChainExtent.width, swapChainExtent.height, depthFormat,
+                                                 VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                                                 depthImage, depthImageMemory);
     depthImageView = createImageView(depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+
+    // The samples are resolved on tile at the end of the subpass and never stored
+    if (samples != VK_SAMPLE_COUNT_1_BIT) {
+        createAttachmentImage(swapChainExtent.width, swapChainExtent.height, colorFormat,
+                              VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, colorImage, colorImageMemory);
+        colorImageView = createImageView(colorImage, colorFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+    }
+}
+// --------------------------------------------------------------------------------
+
+bool DepthManager::recreateDepthResources(VkExtent2D extent, DeletionQueue& deletionQueue) {
+    if (extent.width == swapChainExtent.width && extent.height == swapChainExtent.height &&
+        depthImage != VK_NULL_HANDLE) {
+        return false;
+    }
+
+    VkDevice device = this->device;
+    AllocatorManager* allocator = &allocatorManager;
+    VkImage oldImages[] = {depthImage, colorImage};
+    VmaAllocation oldMemory[] = {depthImageMemory, colorImageMemory};
+    VkImageView oldViews[] = {depthImageView, colorImageView};
+    for (size_t i = 0; i < 2; ++i) {
+        VkImage oldImage = oldImages[i];
+        VmaAllocation oldAllocation = oldMemory[i];
+        VkImageView oldView = oldViews[i];
+        deletionQueue.push([device, allocator, oldImage, oldAllocation, oldView]() {
+            if (oldView != VK_NULL_HANDLE) {
+                vkDestroyImageView(device, oldView, nullptr);
+            }
+            if (oldImage != VK_NULL_HANDLE) {
+                allocator->destroyImage(oldImage, oldAllocation);
+            }
+        });
+    }
+    depthImage = VK_NULL_HANDLE;
+    depthImageMemory = VK_NULL_HANDLE;
+    depthImageView = VK_NULL_HANDLE;
+    colorImage = VK_NULL_HANDLE;
+    colorImageMemory = VK_NULL_HANDLE;
+    colorImageView = VK_NULL_HANDLE;
+
+    swapChainExtent = extent;
+    createDepthResources();
+    return true;
 }
 // --------------------------------------------------------------------------------
 
 VkFormat DepthManager::findDepthFormat() {
     return findSupportedFormat(
-        {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
+        config.formatCandidates(),
             VK_IMAGE_TILING_OPTIMAL,
             VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
         );
@@ -72,6 +151,11 @@ VkFormat DepthManager::findDepthFormat() {
 VkImageView DepthManager::getDepthImageView() {
     return depthImageView;
 }
+// --------------------------------------------------------------------------------
+
+bool DepthManager::isLazilyAllocated() const {
+    return depthLazilyAllocated;
+}
 // ================================================================================
 
 bool DepthManager::hasStencilComponent(VkFormat format) {
@@ -99,7 +183,8 @@ VkFormat DepthManager::findSupportedFormat(const std::vector<VkFormat>& candidat
 void DepthManager::createImage(uint32_t width, uint32_t height, VkFormat format, 
                                VkImageTiling tiling, VkImageUsageFlags usage, 
                                VmaMemoryUsage memoryUsage, VkImage& image, 
-                               VmaAllocation& imageMemory) {
+                               VmaAllocation& imageMemory,
+                               VkSampleCountFlagBits numSamples) {
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
@@ -112,15 +197,29 @@ void DepthManager::createImage(uint32_t width, uint32_t height, VkFormat format,
     imageInfo.tiling = tiling;
     imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     imageInfo.usage = usage;
-    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.samples = numSamples;
     imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-    VmaAllocationCreateInfo allocInfo{};
-    allocInfo.usage = memoryUsage;
+    allocatorManager.createImage(imageInfo, memoryUsage, image, imageMemory, MemoryCategory::Attachments);
+}
+// --------------------------------------------------------------------------------
 
-    if (vmaCreateImage(allocatorManager.getAllocator(), &imageInfo, &allocInfo, &image, &imageMemory, nullptr) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create image!");
+bool DepthManager::createAttachmentImage(uint32_t width, uint32_t height, VkFormat format,
+                                         VkImageUsageFlags usage, VkImage& image,
+                                         VmaAllocation& imageMemory) {
+    if (lazyMemorySupported) {
+        try {
+            createImage(width, height, format, VK_IMAGE_TILING_OPTIMAL,
+                        usage | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+                        VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED, image, imageMemory, samples);
+            return true;
+        } catch (const std::runtime_error&) {
+            // The lazy type may not be compatible with this format; use ordinary memory
+        }
     }
+    createImage(width, height, format, VK_IMAGE_TILING_OPTIMAL, usage,
+                VMA_MEMORY_USAGE_GPU_ONLY, image, imageMemory, samples);
+    return false;
 }
 // --------------------------------------------------------------------------------
 
@@ -149,50 +248,35 @@ VkImageView DepthManager::createImageView(VkImage image, VkFormat format,
 
 
 CommandBufferManager::CommandBufferManager(VkDevice device,
-                                           const std::vector<uint16_t>& indices,
                                            VkPhysicalDevice physicalDevice,
-                                           VkSurfaceKHR surface)
+                                           VkSurfaceKHR surface,
+                                           uint32_t framesInFlight,
+                                           uint32_t recordingThreads)
     : device(device),
-      indices(indices) {
-    // Create initial size for vectors
-    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT),
-    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT),
-    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+      framesInFlight(std::clamp(framesInFlight, 1u, MAX_FRAMES_IN_FLIGHT)),
+      recordingThreads(std::max(recordingThreads, 1u)),
+      deletionQueue(this->framesInFlight) {
+    QueueFamilyIndices queueFamilyIndices = QueueFamily::findQueueFamilies(physicalDevice, surface);
+    graphicsFamily = queueFamilyIndices.graphicsFamily.value();
 
     // Instantiate attributes
-    createCommandPool(physicalDevice, surface);
+    createCommandPool();
     createSyncObjects();
     createCommandBuffers();
 }
 // --------------------------------------------------------------------------------
 
 CommandBufferManager::~CommandBufferManager() {
-    if (device != VK_NULL_HANDLE) {
-        // Free command buffers before destroying the command pool
-        if (!commandBuffers.empty() && commandPool != VK_NULL_HANDLE) {
-            vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
-        }
+    // The device is idle by now, so anything still retired can go immediately
+    deletionQueue.flush();
 
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            if (imageAvailableSemaphores[i] != VK_NULL_HANDLE) {
-                vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
-            }
-            if (renderFinishedSemaphores[i] != VK_NULL_HANDLE) {
-                vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
-            }
-            if (inFlightFences[i] != VK_NULL_HANDLE) {
-                vkDestroyFence(device, inFlightFences[i], nullptr);
-            }
-        }
-
-        if (commandPool != VK_NULL_HANDLE) {
-            vkDestroyCommandPool(device, commandPool, nullptr);
-        }
+    if (device != VK_NULL_HANDLE) {
+        destroyFrameObjects();
     }
 }
 // --------------------------------------------------------------------------------
 
-void CommandBufferManager::waitForFences(uint32_t frameIndex) const {
+void CommandBufferManager::waitForFences(uint32_t frameIndex) {
     VkResult result = vkWaitForFences(device, 1, &inFlightFences[frameIndex], VK_TRUE, UINT64_MAX);
     std::string msg = std::string("Failed to wait for fence at frame index ") + 
                       std::to_string(frameIndex) + 
@@ -202,10 +286,16 @@ void CommandBufferManager::waitForFences(uint32_t frameIndex) const {
     if (result != VK_SUCCESS) {
         throw std::runtime_error(msg);
     }
+    // A fence that was not reset and resubmitted marks no newly completed frame
+    if (!fenceWaited[frameIndex]) {
+        fenceWaited[frameIndex] = true;
+        deletionQueue.onFenceWaited();
+    }
 }
 // --------------------------------------------------------------------------------
 
-void CommandBufferManager::resetFences(uint32_t frameIndex) const {
+void CommandBufferManager::resetFences(uint32_t frameIndex) {
+    fenceWaited[frameIndex] = false;
     VkResult result = vkResetFences(device, 1, &inFlightFences[frameIndex]);
     std::string msg = std::string("Failed to reset fence at frame index ") + 
                       std::to_string(frameIndex) + 
@@ -217,11 +307,26 @@ void CommandBufferManager::resetFences(uint32_t frameIndex) const {
 }
 // --------------------------------------------------------------------------------
 
-const VkCommandPool& CommandBufferManager::getCommandPool() const {
-    if (commandPool == VK_NULL_HANDLE) {
+void CommandBufferManager::resetCommandPools(uint32_t frameIndex) const {
+    // One reset per pool recycles the primary and every secondary buffer of the frame
+    VkResult result = vkResetCommandPool(device, commandPools[frameIndex], 0);
+    for (size_t i = 0; result == VK_SUCCESS && i < secondaryPools[frameIndex].size(); ++i) {
+        result = vkResetCommandPool(device, secondaryPools[frameIndex][i], 0);
+    }
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error(std::string("Failed to reset command pools at frame index ") +
+                                 std::to_string(frameIndex) +
+                                 ". Error code: " +
+                                 std::to_string(static_cast<int>(result)));
+    }
+}
+// --------------------------------------------------------------------------------
+
+const VkCommandPool& CommandBufferManager::getCommandPool(uint32_t frameIndex) const {
+    if (frameIndex >= commandPools.size() || commandPools[frameIndex] == VK_NULL_HANDLE) {
         throw std::runtime_error("Command pool is not initialized.");
     }
-    return commandPool;
+    return commandPools[frameIndex];
 }
 // --------------------------------------------------------------------------------
 
@@ -243,6 +348,40 @@ const VkCommandBuffer& CommandBufferManager::getCommandBuffer(uint32_t frameInde
 }
 // --------------------------------------------------------------------------------
 
+const VkCommandBuffer& CommandBufferManager::getSecondaryCommandBuffer(uint32_t frameIndex,
+                                                                       uint32_t thread,
+                                                                       uint32_t pass) const {
+    if (frameIndex >= secondaryBuffers.size() || thread >= recordingThreads || pass >= SECONDARY_PASSES) {
+        throw std::out_of_range("Secondary command buffer index is out of bounds!");
+    }
+    return secondaryBuffers[frameIndex][thread * SECONDARY_PASSES + pass];
+}
+// --------------------------------------------------------------------------------
+
+uint32_t CommandBufferManager::getRecordingThreadCount() const {
+    return recordingThreads;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t CommandBufferManager::getFramesInFlight() const {
+    return framesInFlight;
+}
+// --------------------------------------------------------------------------------
+
+void CommandBufferManager::setFramesInFlight(uint32_t framesInFlight) {
+    // Nothing is executing, so retired resources no longer need their frames to come around
+    deletionQueue.flush();
+    destroyFrameObjects();
+
+    this->framesInFlight = std::clamp(framesInFlight, 1u, MAX_FRAMES_IN_FLIGHT);
+    deletionQueue.setFramesInFlight(this->framesInFlight);
+
+    createCommandPool();
+    createSyncObjects();
+    createCommandBuffers();
+}
+// --------------------------------------------------------------------------------
+
 const VkSemaphore& CommandBufferManager::getImageAvailableSemaphore(uint32_t frameIndex) const {
     if (imageAvailableSemaphores[frameIndex] == VK_NULL_HANDLE)
         throw std::runtime_error(std::string("Image available semaphore ") +
@@ -271,9 +410,11 @@ const VkFence& CommandBufferManager::getInFlightFence(uint32_t frameIndex) const
 // ================================================================================
 
 void CommandBufferManager::createSyncObjects() {
-    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+    imageAvailableSemaphores.assign(framesInFlight, VK_NULL_HANDLE);
+    renderFinishedSemaphores.assign(framesInFlight, VK_NULL_HANDLE);
+    inFlightFences.assign(framesInFlight, VK_NULL_HANDLE);
+    // Fences start signaled, so the first wait on each one completes an empty frame
+    fenceWaited.assign(framesInFlight, false);
 
     auto createSemaphore = [this]() -> VkSemaphore {
         VkSemaphore semaphore;
@@ -298,7 +439,7 @@ void CommandBufferManager::createSyncObjects() {
         return fence;
     };
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (size_t i = 0; i < framesInFlight; i++) {
         imageAvailableSemaphores[i] = createSemaphore();
         renderFinishedSemaphores[i] = createSemaphore();
         inFlightFences[i] = createFence();
@@ -307,222 +448,438 @@ void CommandBufferManager::createSyncObjects() {
 // --------------------------------------------------------------------------------
 
 void CommandBufferManager::createCommandBuffers() {
-    commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = commandPool;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
-
-    VkResult result = vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data());
-    std::string msg = std::string("Failed to create command pool!: Error code: ") + 
-                      std::to_string((result));
-    if (result != VK_SUCCESS) {
-        throw std::runtime_error(msg);
-    }  
+    commandBuffers.assign(framesInFlight, VK_NULL_HANDLE);
+    secondaryBuffers.assign(framesInFlight,
+                            std::vector<VkCommandBuffer>(recordingThreads * SECONDARY_PASSES, VK_NULL_HANDLE));
+
+    for (size_t i = 0; i < framesInFlight; i++) {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = commandPools[i];
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        VkResult result = vkAllocateCommandBuffers(device, &allocInfo, &commandBuffers[i]);
+        for (uint32_t thread = 0; result == VK_SUCCESS && thread < recordingThreads; ++thread) {
+            // A thread's buffers come from its own pool, so its passes never share with another thread
+            allocInfo.commandPool = secondaryPools[i][thread];
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandBufferCount = SECONDARY_PASSES;
+            result = vkAllocateCommandBuffers(device, &allocInfo, &secondaryBuffers[i][thread * SECONDARY_PASSES]);
+        }
+        std::string msg = std::string("Failed to allocate command buffers!: Error code: ") + 
+                          std::to_string((result));
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error(msg);
+        }
+    }
 }
 // --------------------------------------------------------------------------------
 
-void CommandBufferManager::createCommandPool(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface) {
-    QueueFamilyIndices queueFamilyIndices = QueueFamily::findQueueFamilies(physicalDevice, surface);
+void CommandBufferManager::createCommandPool() {
+    commandPools.assign(framesInFlight, VK_NULL_HANDLE);
+    secondaryPools.assign(framesInFlight, std::vector<VkCommandPool>(recordingThreads, VK_NULL_HANDLE));
+    for (size_t i = 0; i < framesInFlight; i++) {
+        commandPools[i] = createPool();
+        for (uint32_t thread = 0; thread < recordingThreads; ++thread) {
+            secondaryPools[i][thread] = createPool();
+        }
+    }
+}
+// --------------------------------------------------------------------------------
 
+VkCommandPool CommandBufferManager::createPool() const {
+    // Pools are reset as a whole each frame, so individual buffers are never reset
     VkCommandPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = graphicsFamily;
 
-    VkResult result = vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool);
+    VkCommandPool pool = VK_NULL_HANDLE;
+    VkResult result = vkCreateCommandPool(device, &poolInfo, nullptr, &pool);
     std::string msg = std::string("Failed to create command pool!: Error code: ") + 
                       std::to_string((result));
     if (result != VK_SUCCESS) {
         throw std::runtime_error(msg);
     }
+    return pool;
+}
+// --------------------------------------------------------------------------------
+
+void CommandBufferManager::destroyFrameObjects() {
+    for (VkSemaphore semaphore : imageAvailableSemaphores) {
+        if (semaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(device, semaphore, nullptr);
+        }
+    }
+    for (VkSemaphore semaphore : renderFinishedSemaphores) {
+        if (semaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(device, semaphore, nullptr);
+        }
+    }
+    for (VkFence fence : inFlightFences) {
+        if (fence != VK_NULL_HANDLE) {
+            vkDestroyFence(device, fence, nullptr);
+        }
+    }
+
+    // Destroying a pool frees every command buffer allocated from it
+    for (VkCommandPool pool : commandPools) {
+        if (pool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(device, pool, nullptr);
+        }
+    }
+    for (const std::vector<VkCommandPool>& pools : secondaryPools) {
+        for (VkCommandPool pool : pools) {
+            if (pool != VK_NULL_HANDLE) {
+                vkDestroyCommandPool(device, pool, nullptr);
+            }
+        }
+    }
+
+    imageAvailableSemaphores.clear();
+    renderFinishedSemaphores.clear();
+    inFlightFences.clear();
+    fenceWaited.clear();
+    commandPools.clear();
+    commandBuffers.clear();
+    secondaryPools.clear();
+    secondaryBuffers.clear();
 }
 // ================================================================================
 // ================================================================================
 
-SamplerManager::SamplerManager(VkDevice device, VkPhysicalDevice physicalDevice)
-    : device(device), physicalDevice(physicalDevice) {}
-// --------------------------------------------------------------------------------
+SamplerManager::SamplerManager(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t maxSamplers)
+    : device(device) {
+    // The limits never change, so they are read once instead of on every creation
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+    this->maxSamplers = std::max(1u, std::min(maxSamplers, properties.limits.maxSamplerAllocationCount));
 
-SamplerManager::~SamplerManager() {
-    std::lock_guard<std::mutex> lock(samplerMutex);
-    for (auto& sampler : samplers) {
-        vkDestroySampler(device, sampler.second, nullptr);
+    // At most half full, so every probe sequence ends at an empty slot
+    size_t slotCount = 1;
+    while (slotCount < 2 * static_cast<size_t>(this->maxSamplers)) {
+        slotCount *= 2;
     }
+    slotMask = slotCount - 1;
+    slots = std::make_unique<std::atomic<const CachedSampler*>[]>(slotCount);
+    for (size_t i = 0; i < slotCount; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+    samplers.reserve(this->maxSamplers);
 }
 // --------------------------------------------------------------------------------
 
-VkSampler SamplerManager::getSampler(const std::string& samplerKey) const {
+SamplerManager::~SamplerManager() {
     std::lock_guard<std::mutex> lock(samplerMutex);
-    auto it = samplers.find(samplerKey);
-    if (it != samplers.end()) {
-        return it->second;
-    } else {
-        throw std::runtime_error("Sampler not found: " + samplerKey);
+    for (const std::unique_ptr<CachedSampler>& cached : samplers) {
+        vkDestroySampler(device, cached->sampler, nullptr);
     }
 }
 // --------------------------------------------------------------------------------
 
-VkSampler SamplerManager::createSampler(const std::string& samplerKey) {
+VkSampler SamplerManager::getSampler(const SamplerDesc& desc) {
+    const size_t hash = SamplerDescHash{}(desc);
+    VkSampler sampler = find(desc, hash);
+    if (sampler != VK_NULL_HANDLE) {
+        return sampler;
+    }
+
     std::lock_guard<std::mutex> lock(samplerMutex);
-    VkSamplerCreateInfo samplerInfo{};
-    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerInfo.magFilter = VK_FILTER_LINEAR;
-    samplerInfo.minFilter = VK_FILTER_LINEAR;
-    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.anisotropyEnable = VK_TRUE;
+    // Another thread may have created it while this one waited
+    sampler = find(desc, hash);
+    if (sampler != VK_NULL_HANDLE) {
+        return sampler;
+    }
+    if (samplers.size() >= maxSamplers) {
+        throw std::runtime_error("The sampler budget of " + std::to_string(maxSamplers) + " samplers is spent!");
+    }
 
-    VkPhysicalDeviceProperties properties{};
-    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
-    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
-    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-    samplerInfo.unnormalizedCoordinates = VK_FALSE;
-    samplerInfo.compareEnable = VK_FALSE;
-    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-
-    VkSampler sampler;
+    VkSamplerCreateInfo samplerInfo = desc.toCreateInfo(maxAnisotropy);
     if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
         throw std::runtime_error("failed to create texture sampler!");
     }
+    samplers.push_back(std::make_unique<CachedSampler>(CachedSampler{desc, hash, sampler}));
 
-    samplers[samplerKey] = sampler;
+    size_t slot = hash & slotMask;
+    while (slots[slot].load(std::memory_order_relaxed) != nullptr) {
+        slot = (slot + 1) & slotMask;
+    }
+    // Readers that see the pointer also see the entry it points to
+    slots[slot].store(samplers.back().get(), std::memory_order_release);
+    samplerCount.store(static_cast<uint32_t>(samplers.size()), std::memory_order_relaxed);
     return sampler;
 }
+// --------------------------------------------------------------------------------
+
+uint32_t SamplerManager::getSamplerCount() const {
+    return samplerCount.load(std::memory_order_relaxed);
+}
+// --------------------------------------------------------------------------------
+
+uint32_t SamplerManager::getMaxSamplers() const {
+    return maxSamplers;
+}
+// ================================================================================
+
+VkSampler SamplerManager::find(const SamplerDesc& desc, size_t hash) const {
+    for (size_t slot = hash & slotMask;; slot = (slot + 1) & slotMask) {
+        const CachedSampler* cached = slots[slot].load(std::memory_order_acquire);
+        if (cached == nullptr) {
+            return VK_NULL_HANDLE;
+        }
+        if (cached->hash == hash && cached->desc == desc) {
+            return cached->sampler;
+        }
+    }
+}
 // ================================================================================
 // ================================================================================ 
 
 TextureManager::TextureManager(AllocatorManager& allocatorManager,
                                VkDevice device,
                                VkPhysicalDevice physicalDevice,
-                               CommandBufferManager& commandBufferManager,
-                               VkQueue graphicsQueue,
+                               UploadQueue& uploadQueue,
                                const std::string image,
                                SamplerManager& samplerManager,
-                               const std::string& samplerKey)
+                               const SamplerDesc& samplerDesc)
     : allocatorManager(allocatorManager),
       device(device),
       physicalDevice(physicalDevice),
-      commandBufferManager(commandBufferManager),
-      graphicsQueue(graphicsQueue),
+      uploadQueue(uploadQueue),
       imagePath(image){
     createTextureImage();
     createTextureImageView();
-    textureSampler = samplerManager.getSampler(samplerKey);
+    textureSampler = samplerManager.getSampler(samplerDesc);
+}
+// --------------------------------------------------------------------------------
+
+TextureManager::TextureManager(AllocatorManager& allocatorManager,
+                               VkDevice device,
+                               VkPhysicalDevice physicalDevice,
+                               UploadQueue& uploadQueue,
+                               const DecodedTexture& decoded,
+                               SamplerManager& samplerManager,
+                               const SamplerDesc& samplerDesc)
+    : allocatorManager(allocatorManager),
+      device(device),
+      physicalDevice(physicalDevice),
+      uploadQueue(uploadQueue),
+      imagePath(decoded.path){
+    {
+        std::lock_guard<std::mutex> lock(textureMutex);
+        uploadDecodedTexture(decoded);
+    }
+    createTextureImageView();
+    textureSampler = samplerManager.getSampler(samplerDesc);
 }
 // --------------------------------------------------------------------------------
 
 
 TextureManager::~TextureManager() {
-    
+    // The owner guarantees the device no longer uses any version of the texture
+    destroyImageVersion(pendingImage);
+    for (ImageVersion& version : retiredImages) {
+        destroyImageVersion(version);
+    }
+    retiredImages.clear();
+
     if (textureImageView != VK_NULL_HANDLE) {
         vkDestroyImageView(device, textureImageView, nullptr);
         textureImageView = VK_NULL_HANDLE;
     }
 
     if (textureImage != VK_NULL_HANDLE && textureImageMemory != VK_NULL_HANDLE) {
-        vmaDestroyImage(allocatorManager.getAllocator(), textureImage, textureImageMemory);
+        allocatorManager.destroyImage(textureImage, textureImageMemory);
         textureImage = VK_NULL_HANDLE;
         textureImageMemory = VK_NULL_HANDLE;
     }
 }
 // --------------------------------------------------------------------------------
 
-void TextureManager::reloadTexture(const std::string& newImagePath) {
-    std::lock_guard<std::mutex> lock(textureMutex);  // Ensures no other thread can modify the texture during reload
+uint64_t TextureManager::reloadTexture(const std::string& newImagePath) {
+    return reloadTexture(decodeTexture(newImagePath, physicalDevice));
+}
+// --------------------------------------------------------------------------------
+
+uint64_t TextureManager::reloadTexture(const DecodedTexture& decoded) {
+    // The replacement is built without the lock; the live image is never touched here
+    ImageVersion replacement = buildImageVersion(decoded);
 
-    // Safely release existing resources
-    if (textureImage != VK_NULL_HANDLE && textureImageMemory != VK_NULL_HANDLE) {
-        vmaDestroyImage(allocatorManager.getAllocator(), textureImage, textureImageMemory);
-        textureImage = VK_NULL_HANDLE;
-        textureImageMemory = VK_NULL_HANDLE;
+    std::lock_guard<std::mutex> lock(textureMutex);
+    replacement.serial = nextReloadSerial++;
+    if (pendingImage.image != VK_NULL_HANDLE) {
+        // Superseded before going live, so only its own upload can still reference it
+        retiredImages.push_back(pendingImage);
     }
+    pendingImage = replacement;
+    return replacement.serial;
+}
+// --------------------------------------------------------------------------------
 
-    if (textureImageView != VK_NULL_HANDLE) {
-        vkDestroyImageView(device, textureImageView, nullptr);
-        textureImageView = VK_NULL_HANDLE;
+bool TextureManager::commitReload(DeletionQueue& deletionQueue) {
+    std::lock_guard<std::mutex> lock(textureMutex);
+    if (pendingImage.image == VK_NULL_HANDLE || !uploadQueue.isComplete(pendingImage.uploadTicket)) {
+        return false;
     }
 
-    // Update image path and recreate texture
-    imagePath = newImagePath;
-    createTextureImage();
-    createTextureImageView();
+    // Frames already recorded keep sampling the old image, so it outlives them
+    VkDevice device = this->device;
+    AllocatorManager* allocator = &allocatorManager;
+    VkImage oldImage = textureImage;
+    VmaAllocation oldMemory = textureImageMemory;
+    VkImageView oldView = textureImageView;
+    deletionQueue.push([device, allocator, oldImage, oldMemory, oldView]() {
+        vkDestroyImageView(device, oldView, nullptr);
+        allocator->destroyImage(oldImage, oldMemory);
+    });
+
+    textureImage = pendingImage.image;
+    textureImageMemory = pendingImage.memory;
+    textureImageView = pendingImage.view;
+    textureFormat = pendingImage.format;
+    mipLevels = pendingImage.mipLevels;
+    uploadTicket = pendingImage.uploadTicket;
+    imagePath = pendingImage.path;
+    committedReload = pendingImage.serial;
+    pendingImage = ImageVersion{};
+    return true;
+}
+// --------------------------------------------------------------------------------
+
+size_t TextureManager::releaseRetired() {
+    std::lock_guard<std::mutex> lock(textureMutex);
+    for (auto it = retiredImages.begin(); it != retiredImages.end();) {
+        if (uploadQueue.isComplete(it->uploadTicket)) {
+            destroyImageVersion(*it);
+            it = retiredImages.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return retiredImages.size();
 }
 // ================================================================================
 
 void TextureManager::createTextureImage() {
-    std::lock_guard<std::mutex> lock(textureMutex);
     if (textureImage != VK_NULL_HANDLE && textureImageMemory != VK_NULL_HANDLE) {
         return; // Resources already initialized, skip re-creation
     }
 
+    // Decoding is the slow part and touches no member state, so it runs before taking the lock
+    DecodedTexture decoded = decodeTexture(imagePath, physicalDevice);
+
+    std::lock_guard<std::mutex> lock(textureMutex);
+    if (textureImage != VK_NULL_HANDLE && textureImageMemory != VK_NULL_HANDLE) {
+        return;
+    }
+    uploadDecodedTexture(decoded);
+}
+// --------------------------------------------------------------------------------
+
+DecodedTexture TextureManager::decodeTexture(const std::string& imagePath,
+                                             VkPhysicalDevice physicalDevice,
+                                             const std::vector<uint8_t>& fileBytes) {
     if (imagePath.empty()) {
         throw std::invalid_argument("TextureManager: imagePath is empty, please provide a valid texture file path.");
     }
-    int texWidth, texHeight, texChannels;
-    stbi_uc* pixels = stbi_load(imagePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
 
+    DecodedTexture decoded;
+    decoded.path = imagePath;
+
+    // Precompressed containers are uploaded as-is, mips included, with no CPU decode
+    const std::string compressedPath = findCompressedVariant(imagePath, physicalDevice);
+    if (!compressedPath.empty()) {
+        CompressedTexture compressed = TextureLoader::loadFile(compressedPath);
+        decoded.format = compressed.format;
+        decoded.width = compressed.width;
+        decoded.height = compressed.height;
+        decoded.mipLevels = compressed.mipLevels;
+        decoded.data = std::move(compressed.data);
+        decoded.levelOffsets = std::move(compressed.levelOffsets);
+        return decoded;
+    }
+
+    int texWidth, texHeight, texChannels;
+    stbi_uc* pixels = fileBytes.empty()
+        ? stbi_load(imagePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha)
+        : stbi_load_from_memory(fileBytes.data(), static_cast<int>(fileBytes.size()),
+                                &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
     if (!pixels) {
         throw std::runtime_error("Failed to load texture image!");
     }
 
-    // Create a staging buffer with VMA
-    VkBuffer stagingBuffer;
-    VmaAllocation stagingBufferMemory;
-    allocatorManager.createBuffer(
-        imageSize, 
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-        VMA_MEMORY_USAGE_CPU_TO_GPU, // Use VMA-specific memory usage for CPU to GPU transfer
-        stagingBuffer, 
-        stagingBufferMemory
-    );
+    decoded.format = VK_FORMAT_R8G8B8A8_SRGB;
+    decoded.width = static_cast<uint32_t>(texWidth);
+    decoded.height = static_cast<uint32_t>(texHeight);
+    decoded.mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(decoded.width, decoded.height)))) + 1;
 
-    // Map memory, copy pixel data to the staging buffer, then unmap memory
-    void* data;
-    if (vmaMapMemory(allocatorManager.getAllocator(), stagingBufferMemory, &data) != VK_SUCCESS) {
-        throw std::runtime_error("TextureManager::createTextureImage: Failed to map memory for staging buffer.");
+    // The mip chain is blitted on the GPU when the format allows it and box-filtered here otherwise
+    if (supportsLinearBlit(physicalDevice, decoded.format)) {
+        decoded.data.assign(pixels, pixels + static_cast<size_t>(decoded.width) * decoded.height * 4);
+    } else {
+        decoded.data = buildMipChainRGBA8(pixels, decoded.width, decoded.height, decoded.mipLevels,
+                                          decoded.levelOffsets);
     }
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    vmaUnmapMemory(allocatorManager.getAllocator(), stagingBufferMemory);
+    stbi_image_free(pixels);
+    return decoded;
+}
+// --------------------------------------------------------------------------------
 
-    stbi_image_free(pixels); // Free the loaded image pixels now that they're in the staging buffer
+void TextureManager::uploadDecodedTexture(const DecodedTexture& decoded) {
+    ImageVersion version = buildImageVersion(decoded);
+    textureImage = version.image;
+    textureImageMemory = version.memory;
+    textureImageView = version.view;
+    textureFormat = version.format;
+    mipLevels = version.mipLevels;
+    uploadTicket = version.uploadTicket;
+}
+// --------------------------------------------------------------------------------
 
-    // Create the texture image on the GPU
-    createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, 
-                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 
-                VMA_MEMORY_USAGE_GPU_ONLY, textureImage, textureImageMemory);
-    
-    // Transition the texture image layout and copy data from the staging buffer
-    transitionImageLayout(
-        textureImage, 
-        VK_FORMAT_R8G8B8A8_SRGB, 
-        VK_IMAGE_LAYOUT_UNDEFINED, 
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-    );
-    copyBufferToImage(
-        stagingBuffer, 
-        textureImage, 
-        static_cast<uint32_t>(texWidth), 
-        static_cast<uint32_t>(texHeight)
-    );
-    transitionImageLayout(
-        textureImage, 
-        VK_FORMAT_R8G8B8A8_SRGB, 
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-    );
+TextureManager::ImageVersion TextureManager::buildImageVersion(const DecodedTexture& decoded) {
+    ImageVersion version;
+    version.format = decoded.format;
+    version.mipLevels = decoded.mipLevels;
+    version.path = decoded.path;
+
+    // Blitting the chain reads from the image, so it also needs TRANSFER_SRC
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (decoded.levelOffsets.empty() && version.mipLevels > 1) {
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    createImage(decoded.width, decoded.height, version.mipLevels, version.format, VK_IMAGE_TILING_OPTIMAL,
+                usage, VMA_MEMORY_USAGE_GPU_ONLY, version.image, version.memory);
+
+    // Record the layout transitions and the copies into the current upload batch. The data is
+    // copied into staging memory here, so the caller may release it as soon as this returns.
+    if (decoded.levelOffsets.empty()) {
+        version.uploadTicket = uploadQueue.uploadImage(version.image, decoded.data.data(), decoded.data.size(),
+                                                       decoded.width, decoded.height, version.mipLevels);
+    } else {
+        version.uploadTicket = uploadQueue.uploadImageLevels(version.image, decoded.data.data(), decoded.data.size(),
+                                                             decoded.width, decoded.height, decoded.levelOffsets);
+    }
+    version.view = createImageView(version.image, version.format, version.mipLevels);
+    return version;
+}
+// --------------------------------------------------------------------------------
 
-    // Clean up the staging buffer using VMA
-    vmaDestroyBuffer(allocatorManager.getAllocator(), stagingBuffer, stagingBufferMemory);
+void TextureManager::destroyImageVersion(ImageVersion& version) {
+    if (version.view != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, version.view, nullptr);
+        version.view = VK_NULL_HANDLE;
+    }
+    if (version.image != VK_NULL_HANDLE && version.memory != VK_NULL_HANDLE) {
+        allocatorManager.destroyImage(version.image, version.memory);
+        version.image = VK_NULL_HANDLE;
+        version.memory = VK_NULL_HANDLE;
+    }
 }
 // --------------------------------------------------------------------------------
 
-void TextureManager::createImage(uint32_t width, uint32_t height, VkFormat format, 
+void TextureManager::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, 
                                  VkImageTiling tiling, VkImageUsageFlags usage, 
                                  VmaMemoryUsage memoryUsage, VkImage& image, 
                                  VmaAllocation& imageMemory) {
@@ -532,7 +889,7 @@ void TextureManager::createImage(uint32_t width, uint32_t height, VkFormat forma
     imageInfo.extent.width = width;
     imageInfo.extent.height = height;
     imageInfo.extent.depth = 1;
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = mipLevels;
     imageInfo.arrayLayers = 1;
     imageInfo.format = format;
     imageInfo.tiling = tiling;
@@ -541,9 +898,9 @@ void TextureManager::createImage(uint32_t width, uint32_t height, VkFormat forma
     imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-    VmaAllocationCreateInfo allocInfo{};
-    allocInfo.usage = memoryUsage;
-    if (vmaCreateImage(allocatorManager.getAllocator(), &imageInfo, &allocInfo, &image, &imageMemory, nullptr) != VK_SUCCESS) {
+    try {
+        allocatorManager.createImage(imageInfo, memoryUsage, image, imageMemory, MemoryCategory::Textures);
+    } catch (const std::runtime_error&) {
         throw std::runtime_error(
             std::string("TextureManager::createImage: Failed to create image with properties:\n") +
             " Width: " + std::to_string(width) + 
@@ -555,113 +912,122 @@ void TextureManager::createImage(uint32_t width, uint32_t height, VkFormat forma
 }
 // --------------------------------------------------------------------------------
 
-uint32_t TextureManager::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+VkDeviceSize TextureManager::getSizeInBytes() const {
+    if (textureImageMemory == VK_NULL_HANDLE) {
+        return 0;
+    }
+    VmaAllocationInfo allocationInfo{};
+    vmaGetAllocationInfo(allocatorManager.getAllocator(), textureImageMemory, &allocationInfo);
+    return allocationInfo.size;
+}
+// --------------------------------------------------------------------------------
 
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
+std::string TextureManager::findCompressedVariant(const std::string& imagePath, VkPhysicalDevice physicalDevice) {
+    if (TextureLoader::isCompressedContainer(imagePath)) {
+        const VkFormat format = TextureLoader::peekFormat(imagePath);
+        if (format == VK_FORMAT_UNDEFINED || !supportsSampledFormat(physicalDevice, format)) {
+            throw std::runtime_error("TextureManager: " + imagePath +
+                                     " is not in a block-compressed format this device can sample.");
         }
+        return imagePath;
     }
 
-    throw std::runtime_error("failed to find suitable memory type!");
-} 
+    const std::filesystem::path path(imagePath);
+    const std::string stem = (path.parent_path() / path.stem()).string();
+    const std::vector<std::string> candidates = {
+        stem + ".bc7.ktx2",
+        stem + ".astc.ktx2",
+        stem + ".ktx2",
+        stem + ".dds"
+    };
+    for (const std::string& candidate : candidates) {
+        const VkFormat format = TextureLoader::peekFormat(candidate);
+        if (format != VK_FORMAT_UNDEFINED && supportsSampledFormat(physicalDevice, format)) {
+            return candidate;
+        }
+    }
+    return std::string();
+}
 // --------------------------------------------------------------------------------
 
-VkCommandBuffer TextureManager::beginSingleTimeCommands() {
-    VkCommandBuffer commandBuffer = allocateCommandBuffer();
-
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
-    return commandBuffer;
+bool TextureManager::supportsSampledFormat(VkPhysicalDevice physicalDevice, VkFormat format) {
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
+    return (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
 }
 // --------------------------------------------------------------------------------
 
-void TextureManager::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
-    vkEndCommandBuffer(commandBuffer);
-    submitSingleTimeCommandBuffer(commandBuffer);
+bool TextureManager::supportsLinearBlit(VkPhysicalDevice physicalDevice, VkFormat format) {
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
+
+    const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                          VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (formatProperties.optimalTilingFeatures & required) == required;
 }
 // --------------------------------------------------------------------------------
 
-void TextureManager::transitionImageLayout(
-    VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
-    
-    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-    VkImageMemoryBarrier barrier = createImageMemoryBarrier(image, format, oldLayout, newLayout);
-
-    VkPipelineStageFlags sourceStage;
-    VkPipelineStageFlags destinationStage;
-
-    if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    } else {
-        throw std::invalid_argument("unsupported layout transition!");
+std::vector<uint8_t> TextureManager::buildMipChainRGBA8(const uint8_t* pixels, uint32_t width, uint32_t height,
+                                                        uint32_t mipLevels, std::vector<VkDeviceSize>& levelOffsets) {
+    levelOffsets.clear();
+    VkDeviceSize total = 0;
+    for (uint32_t level = 0; level < mipLevels; ++level) {
+        levelOffsets.push_back(total);
+        total += static_cast<VkDeviceSize>(std::max(width >> level, 1u)) * std::max(height >> level, 1u) * 4;
+    }
+
+    std::vector<uint8_t> chain(static_cast<size_t>(total));
+    memcpy(chain.data(), pixels, static_cast<size_t>(width) * height * 4);
+
+    for (uint32_t level = 1; level < mipLevels; ++level) {
+        const uint32_t srcWidth = std::max(width >> (level - 1), 1u);
+        const uint32_t srcHeight = std::max(height >> (level - 1), 1u);
+        const uint32_t dstWidth = std::max(width >> level, 1u);
+        const uint32_t dstHeight = std::max(height >> level, 1u);
+        const uint8_t* src = chain.data() + levelOffsets[level - 1];
+        uint8_t* dst = chain.data() + levelOffsets[level];
+
+        for (uint32_t y = 0; y < dstHeight; ++y) {
+            const uint32_t y0 = std::min(y * 2, srcHeight - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, srcHeight - 1);
+            for (uint32_t x = 0; x < dstWidth; ++x) {
+                const uint32_t x0 = std::min(x * 2, srcWidth - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1);
+                for (uint32_t c = 0; c < 4; ++c) {
+                    const uint32_t sum = src[(y0 * srcWidth + x0) * 4 + c] + src[(y0 * srcWidth + x1) * 4 + c] +
+                                         src[(y1 * srcWidth + x0) * 4 + c] + src[(y1 * srcWidth + x1) * 4 + c];
+                    dst[(y * dstWidth + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
     }
-
-    vkCmdPipelineBarrier(
-        commandBuffer,
-        sourceStage, destinationStage,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &barrier
-    );
-
-    endSingleTimeCommands(commandBuffer);
+    return chain;
 }
 // --------------------------------------------------------------------------------
 
-void TextureManager::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkBufferImageCopy region{};
-        region.bufferOffset = 0;
-        region.bufferRowLength = 0;
-        region.bufferImageHeight = 0;
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
-        region.imageOffset = {0, 0, 0};
-        region.imageExtent = {
-            width,
-            height,
-            1
-        };
-
-        vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+uint32_t TextureManager::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
 
-        endSingleTimeCommands(commandBuffer);
-}
-// --------------------------------------------------------------------------------
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
 
-bool TextureManager::hasStencilComponent(VkFormat format) {
-    return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
-}
+    throw std::runtime_error("failed to find suitable memory type!");
+} 
 // --------------------------------------------------------------------------------
 
 void TextureManager::createTextureImageView() {
     if (textureImageView != VK_NULL_HANDLE) {
         return; // Image view already exists, skip re-creation
     }
-    textureImageView = createImageView(textureImage, VK_FORMAT_R8G8B8A8_SRGB);
+    textureImageView = createImageView(textureImage, textureFormat, mipLevels);
 }
 // --------------------------------------------------------------------------------
 
-VkImageView TextureManager::createImageView(VkImage image, VkFormat format) {
+VkImageView TextureManager::createImageView(VkImage image, VkFormat format, uint32_t mipLevels) {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = image;
@@ -669,7 +1035,7 @@ VkImageView TextureManager::createImageView(VkImage image, VkFormat format) {
     viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = mipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
 
@@ -680,296 +1046,113 @@ VkImageView TextureManager::createImageView(VkImage image, VkFormat format) {
 
     return imageView;
 }
-// --------------------------------------------------------------------------------
-
-VkImageMemoryBarrier TextureManager::createImageMemoryBarrier(
-    VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = oldLayout;
-    barrier.newLayout = newLayout;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = image;
-
-    if (format == VK_FORMAT_D32_SFLOAT || format == VK_FORMAT_D32_SFLOAT_S8_UINT) {
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-        if (hasStencilComponent(format)) {
-            barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-        }
-    } else {
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    }
-
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-
-    return barrier;
-}
-// -------------------------------------------------------------------------------- 
-
-VkCommandBuffer TextureManager::allocateCommandBuffer() {
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = commandBufferManager.getCommandPool();
-    allocInfo.commandBufferCount = 1;
-
-    VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-    return commandBuffer;
-}
-// --------------------------------------------------------------------------------
-
-void TextureManager::submitSingleTimeCommandBuffer(VkCommandBuffer commandBuffer) {
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
-
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue);
-    vkFreeCommandBuffers(device, commandBufferManager.getCommandPool(), 1, &commandBuffer);
-}
 // ================================================================================
 // ================================================================================
 
-BufferManager::BufferManager(const std::vector<Vertex>& vertices,
-                             const std::vector<uint16_t>& indices,
-                             AllocatorManager& allocatorManager,
-                             CommandBufferManager& commandBufferManager,
-                             VkQueue graphicsQueue)
-    : vertices(vertices),
-      indices(indices),
-      allocatorManager(allocatorManager),
-      commandBufferManager(commandBufferManager),
-     // commandPool(commandPool),
-      graphicsQueue(graphicsQueue){
-    // Set initial vector sizes
-    uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-    uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-
-    createVertexBuffer();
-    createIndexBuffer();
-    createUniformBuffers();
+BufferManager::BufferManager(AllocatorManager& allocatorManager,
+                             VkPhysicalDevice physicalDevice,
+                             uint32_t framesInFlight)
+    : allocatorManager(allocatorManager),
+      framesInFlight(framesInFlight){
+    // Dynamic offsets must be multiples of the alignment, which is a power of two
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    const VkDeviceSize alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+    slotSize = (sizeof(CameraUniforms) + alignment - 1) & ~(alignment - 1);
+    if (!createUniformBuffers()) {
+        throw std::runtime_error("Failed to create the uniform buffer for " +
+                                 std::to_string(framesInFlight) + " frames in flight.");
+    }
 }
 // --------------------------------------------------------------------------------
 
 BufferManager::~BufferManager() {
     // Clean up uniform buffers
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        if (uniformBuffers[i] != VK_NULL_HANDLE) {
-            // Unmap the memory if it was mapped
-            if (uniformBuffersMapped[i] != nullptr) {
-                vmaUnmapMemory(allocatorManager.getAllocator(), uniformBuffersMemory[i]);
-            }
-            // Destroy the buffer and free the associated memory
-            allocatorManager.destroyBuffer(uniformBuffers[i], uniformBuffersMemory[i]);
-        }
-    }
-
-    // Clean up vertex buffer
-    if (vertexBuffer != VK_NULL_HANDLE) {
-        allocatorManager.destroyBuffer(vertexBuffer, vertexBufferAllocation);
-    }
-
-    // Clean up index buffer
-    if (indexBuffer != VK_NULL_HANDLE) {
-        allocatorManager.destroyBuffer(indexBuffer, indexBufferAllocation);
-    }
+    destroyUniformBuffers();
 }
 // --------------------------------------------------------------------------------
 
-void BufferManager::updateUniformBuffer(uint32_t currentFrame, const UniformBufferObject& ubo) {
+void BufferManager::updateUniformBuffer(uint32_t currentFrame, const CameraUniforms& camera, uint64_t version) {
     // Ensure that the current frame index is within bounds
-    if (currentFrame >= MAX_FRAMES_IN_FLIGHT) {
+    if (currentFrame >= slotVersions.size()) {
         throw std::out_of_range("Frame index out of bounds.");
     }
-
-    // Map the memory for the current frame's uniform buffer
-    void* data = uniformBuffersMapped[currentFrame];
-    if (data == nullptr) {
-        throw std::runtime_error(std::string("Failed to map uniform buffer for frame ") + std::to_string(currentFrame));
+    if (slotVersions[currentFrame] == version) {
+        return;
     }
 
-    // Copy the UniformBufferObject data into the mapped memory
-    memcpy(data, &ubo, sizeof(ubo));
+    // Copy the camera into the frame's slot; CPU_TO_GPU memory is not guaranteed to be coherent
+    const VkDeviceSize offset = slotSize * currentFrame;
+    memcpy(static_cast<char*>(uniformBufferMapped) + offset, &camera, sizeof(camera));
+    vmaFlushAllocation(allocatorManager.getAllocator(), uniformBufferMemory, offset, sizeof(camera));
+    slotVersions[currentFrame] = version;
 }
-
 // --------------------------------------------------------------------------------
 
-const VkBuffer BufferManager::getVertexBuffer() const{
-    return vertexBuffer;
+VkBuffer BufferManager::getUniformBuffer() const {
+    return uniformBuffer;
 }
 // --------------------------------------------------------------------------------
 
-const VkBuffer BufferManager::getIndexBuffer() const {
-    return indexBuffer;
+VkDeviceSize BufferManager::getUniformSlotSize() const {
+    return slotSize;
 }
 // --------------------------------------------------------------------------------
 
-const std::vector<VkBuffer>& BufferManager::getUniformBuffers() const {
-    return uniformBuffers;
+uint32_t BufferManager::getFramesInFlight() const {
+    return framesInFlight;
 }
 // --------------------------------------------------------------------------------
 
-const std::vector<void*>& BufferManager::getUniformBuffersMapped() const {
-    return uniformBuffersMapped;
-}
-// ================================================================================
-
-bool BufferManager::createVertexBuffer() {
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-    // Step 1: Create a staging buffer
-    VkBuffer stagingBuffer;
-    VmaAllocation stagingBufferAllocation;
-    try {
-        allocatorManager.createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-                                      VMA_MEMORY_USAGE_CPU_ONLY, stagingBuffer, stagingBufferAllocation);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return false;
-    }
-
-    // Step 2: Map memory and copy vertex data to the staging buffer
-    void* data;
-    try {
-        allocatorManager.mapMemory(stagingBufferAllocation, &data);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation); // Cleanup
-        return false;
-    }
-    memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
-    allocatorManager.unmapMemory(stagingBufferAllocation);
-
-    // Step 3: Create the vertex buffer on the GPU
-    try {
-        allocatorManager.createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 
-                                      VMA_MEMORY_USAGE_GPU_ONLY, vertexBuffer, vertexBufferAllocation);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation); // Cleanup
-        return false;
+void BufferManager::recreateUniformBuffers(uint32_t framesInFlight) {
+    destroyUniformBuffers();
+    this->framesInFlight = framesInFlight;
+    if (!createUniformBuffers()) {
+        throw std::runtime_error("Failed to recreate uniform buffers for " +
+                                 std::to_string(framesInFlight) + " frames in flight.");
     }
-
-    // Step 4: Copy data from the staging buffer to the vertex buffer
-    try {
-        allocatorManager.copyBuffer(stagingBuffer, vertexBuffer, bufferSize, graphicsQueue, commandBufferManager.getCommandPool());
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation); // Cleanup
-        allocatorManager.destroyBuffer(vertexBuffer, vertexBufferAllocation);   // Cleanup
-        return false;
-    }
-
-    // Step 5: Clean up the staging buffer
-    allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation);
-
-    return true; // Indicate success
 }
-// --------------------------------------------------------------------------------
-
-bool BufferManager::createIndexBuffer() {
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
-    // Step 1: Create a staging buffer
-    VkBuffer stagingBuffer;
-    VmaAllocation stagingBufferAllocation;
-    try {
-        allocatorManager.createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-                                      VMA_MEMORY_USAGE_CPU_ONLY, stagingBuffer, stagingBufferAllocation);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return false;
-    }
-
-    // Step 2: Map memory and copy index data to the staging buffer
-    void* data;
-    try {
-        allocatorManager.mapMemory(stagingBufferAllocation, &data);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation); // Cleanup
-        return false;
-    }
-    memcpy(data, indices.data(), static_cast<size_t>(bufferSize));
-    allocatorManager.unmapMemory(stagingBufferAllocation);
-
-    // Step 3: Create the index buffer on the GPU
-    try {
-        allocatorManager.createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 
-                                      VMA_MEMORY_USAGE_GPU_ONLY, indexBuffer, indexBufferAllocation);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation); // Cleanup
-        return false;
-    }
+// ================================================================================
 
-    // Step 4: Copy data from the staging buffer to the index buffer
+bool BufferManager::createUniformBuffers() {
     try {
-        allocatorManager.copyBuffer(stagingBuffer, indexBuffer, bufferSize, graphicsQueue, commandBufferManager.getCommandPool());
+        // One buffer holds every frame's slot, so a single descriptor reaches them all
+        allocatorManager.createBuffer(slotSize * framesInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                      VMA_MEMORY_USAGE_CPU_TO_GPU,
+                                      uniformBuffer, uniformBufferMemory);
+        allocatorManager.mapMemory(uniformBufferMemory, &uniformBufferMapped);
     } catch (const std::runtime_error& e) {
         std::cerr << "Error: " << e.what() << std::endl;
-        allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation); // Cleanup
-        allocatorManager.destroyBuffer(indexBuffer, indexBufferAllocation);     // Cleanup
+        destroyUniformBuffers();
         return false;
     }
 
-    // Step 5: Clean up the staging buffer
-    allocatorManager.destroyBuffer(stagingBuffer, stagingBufferAllocation);
-
+    // Every slot starts out stale so the first update of each frame writes it
+    slotVersions.assign(framesInFlight, 0);
     return true; // Indicate success
 }
 // --------------------------------------------------------------------------------
 
-bool BufferManager::createUniformBuffers() {
-    VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-
-    // Resize the buffers to the correct size for the number of frames in flight
-    uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-    uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
-
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        try {
-            // Step 1: Create a uniform buffer for each frame
-            allocatorManager.createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
-                                          VMA_MEMORY_USAGE_CPU_TO_GPU, 
-                                          uniformBuffers[i], uniformBuffersMemory[i]);
-        } catch (const std::runtime_error& e) {
-            std::cerr << "Error: " << e.what() << std::endl;
-            // Cleanup for previously created buffers
-            for (size_t j = 0; j < i; j++) {
-                allocatorManager.destroyBuffer(uniformBuffers[j], uniformBuffersMemory[j]);
-            }
-            return false;
-        }
-
-        try {
-            // Step 2: Map the uniform buffer memory
-            allocatorManager.mapMemory(uniformBuffersMemory[i], &uniformBuffersMapped[i]);
-        } catch (const std::runtime_error& e) {
-            std::cerr << "Error: " << e.what() << std::endl;
-            // Cleanup for previously created buffers
-            for (size_t j = 0; j <= i; j++) {
-                allocatorManager.destroyBuffer(uniformBuffers[j], uniformBuffersMemory[j]);
-            }
-            return false;
+void BufferManager::destroyUniformBuffers() {
+    if (uniformBuffer != VK_NULL_HANDLE) {
+        // Unmap the memory if it was mapped
+        if (uniformBufferMapped != nullptr) {
+            vmaUnmapMemory(allocatorManager.getAllocator(), uniformBufferMemory);
         }
+        // Destroy the buffer and free the associated memory
+        allocatorManager.destroyBuffer(uniformBuffer, uniformBufferMemory);
     }
-
-    return true; // Indicate success
+    uniformBuffer = VK_NULL_HANDLE;
+    uniformBufferMemory = VK_NULL_HANDLE;
+    uniformBufferMapped = nullptr;
+    slotVersions.clear();
 }
 // ================================================================================
 // ================================================================================
 
 
-DescriptorManager::DescriptorManager(VkDevice device)
-    : device(device){
+DescriptorManager::DescriptorManager(VkDevice device, bool textureBinding)
+    : device(device), textureBinding(textureBinding) {
     createDescriptorSetLayout();
     createDescriptorPool();
 }
@@ -995,9 +1178,12 @@ DescriptorManager::DescriptorManager(VkDevice device)
 
 void DescriptorManager::createDescriptorPool() {
     std::vector<VkDescriptorPoolSize> poolSizes = {
-        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT)},
-        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT)}
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT)},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT)}
     };
+    if (textureBinding) {
+        poolSizes.push_back({VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT)});
+    }
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -1011,39 +1197,60 @@ void DescriptorManager::createDescriptorPool() {
 }
 // --------------------------------------------------------------------------------
 
-void DescriptorManager::createDescriptorSets(const std::vector<VkBuffer> uniformBuffers, 
+void DescriptorManager::createDescriptorSets(VkBuffer uniformBuffer,
+                                             VkDeviceSize uniformSlotSize,
+                                             uint32_t frameCount,
+                                             const std::vector<VkBuffer>& instanceBuffers,
                                              VkImageView textureImageView, 
                                              VkSampler textureSampler) {
-    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
+    if (frameCount == 0 || frameCount > MAX_FRAMES_IN_FLIGHT || instanceBuffers.size() < frameCount) {
+        throw std::out_of_range("Descriptor sets requested for an unsupported number of frames!");
+    }
+
+    // Rebuilding for a new frame count returns the previous sets to the pool first
+    if (!descriptorSets.empty()) {
+        vkResetDescriptorPool(device, descriptorPool, 0);
+        descriptorSets.clear();
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(frameCount, descriptorSetLayout);
     VkDescriptorSetAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = descriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(frameCount);
     allocInfo.pSetLayouts = layouts.data();
 
-    descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    descriptorSets.resize(frameCount);
     if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets!");
     }
+    uniformOffsets.resize(frameCount);
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (size_t i = 0; i < frameCount; i++) {
+        // The range covers one slot; the dynamic offset picks which one when the set is bound
         VkDescriptorBufferInfo bufferInfo{};
-        bufferInfo.buffer = uniformBuffers[i];
+        bufferInfo.buffer = uniformBuffer;
         bufferInfo.offset = 0;
-        bufferInfo.range = sizeof(UniformBufferObject);
+        bufferInfo.range = sizeof(CameraUniforms);
+        uniformOffsets[i] = static_cast<uint32_t>(uniformSlotSize * i);
 
         VkDescriptorImageInfo imageInfo{};
         imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         imageInfo.imageView = textureImageView;
         imageInfo.sampler = textureSampler;
 
-        std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+        VkDescriptorBufferInfo instanceInfo{};
+        instanceInfo.buffer = instanceBuffers[i];
+        instanceInfo.offset = 0;
+        instanceInfo.range = VK_WHOLE_SIZE;
+
+        std::vector<VkWriteDescriptorSet> descriptorWrites(3, VkWriteDescriptorSet{});
 
         descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         descriptorWrites[0].dstSet = descriptorSets[i];
         descriptorWrites[0].dstBinding = 0;
         descriptorWrites[0].dstArrayElement = 0;
-        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         descriptorWrites[0].descriptorCount = 1;
         descriptorWrites[0].pBufferInfo = &bufferInfo;
 
@@ -1055,11 +1262,50 @@ void DescriptorManager::createDescriptorSets(const std::vector<VkBuffer> uniform
         descriptorWrites[1].descriptorCount = 1;
         descriptorWrites[1].pImageInfo = &imageInfo;
 
+        descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[2].dstSet = descriptorSets[i];
+        descriptorWrites[2].dstBinding = 2;
+        descriptorWrites[2].dstArrayElement = 0;
+        descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[2].descriptorCount = 1;
+        descriptorWrites[2].pBufferInfo = &instanceInfo;
+
+        // Without a texture binding the textures come from the bindless table
+        if (!textureBinding) {
+            descriptorWrites.erase(descriptorWrites.begin() + 1);
+        }
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
     }
 }
 // --------------------------------------------------------------------------------
 
+void DescriptorManager::updateTextureDescriptor(uint32_t frameIndex, VkImageView textureImageView,
+                                                VkSampler textureSampler) {
+    if (!textureBinding) {
+        throw std::runtime_error("The descriptor sets have no texture binding to update!");
+    }
+    if (frameIndex >= descriptorSets.size()) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfo.imageView = textureImageView;
+    imageInfo.sampler = textureSampler;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = descriptorSets[frameIndex];
+    descriptorWrite.dstBinding = 1;
+    descriptorWrite.dstArrayElement = 0;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &imageInfo;
+
+    vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+}
+// --------------------------------------------------------------------------------
+
 const VkDescriptorSetLayout& DescriptorManager::getDescriptorSetLayout() const{
     if (descriptorSetLayout == VK_NULL_HANDLE)
         throw std::runtime_error("Descriptor set layout is not initialized!");
@@ -1093,13 +1339,21 @@ const VkDescriptorSet& DescriptorManager::getDescriptorSet(uint32_t frameIndex)
 
     return descriptorSets[frameIndex];
 }
+// --------------------------------------------------------------------------------
+
+uint32_t DescriptorManager::getUniformOffset(uint32_t frameIndex) const {
+    if (frameIndex >= uniformOffsets.size()) {
+        throw std::out_of_range("Frame index is out of bounds!");
+    }
+    return uniformOffsets[frameIndex];
+}
 // ================================================================================
 
 void DescriptorManager::createDescriptorSetLayout() {
     VkDescriptorSetLayoutBinding uboLayoutBinding{};
     uboLayoutBinding.binding = 0;
     uboLayoutBinding.descriptorCount = 1;
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     uboLayoutBinding.pImmutableSamplers = nullptr;
     uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
@@ -1110,7 +1364,17 @@ void DescriptorManager::createDescriptorSetLayout() {
     samplerLayoutBinding.pImmutableSamplers = nullptr;
     samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, samplerLayoutBinding};
+    VkDescriptorSetLayoutBinding instanceLayoutBinding{};
+    instanceLayoutBinding.binding = 2;
+    instanceLayoutBinding.descriptorCount = 1;
+    instanceLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    instanceLayoutBinding.pImmutableSamplers = nullptr;
+    instanceLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    std::vector<VkDescriptorSetLayoutBinding> bindings = {uboLayoutBinding, instanceLayoutBinding};
+    if (textureBinding) {
+        bindings.push_back(samplerLayoutBinding);
+    }
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -1124,27 +1388,53 @@ void DescriptorManager::createDescriptorSetLayout() {
 // ================================================================================
 
 GraphicsPipeline::GraphicsPipeline(VkDevice device,
-                                   SwapChain& swapChain,
+                                   VkFormat colorFormat,
+                                   VkImageLayout colorFinalLayout,
                                    CommandBufferManager& commandBufferManager,
-                                   BufferManager& bufferManager,
+                                   MeshArena& meshArena,
                                    DescriptorManager& descriptorManager,  // Fixed typo here
-                                   const std::vector<uint16_t>& indices,
                                    VkPhysicalDevice physicalDevice,
                                    std::string vertFile,
                                    std::string fragFile,
-                                   DepthManager& depthManager)
+                                   DepthManager& depthManager,
+                                   PipelineCache& pipelineCache,
+                                   Scene& scene,
+                                   CullingPass& cullingPass,
+                                   ThreadPool& recordingPool,
+                                   Profiler& profiler,
+                                   BindlessTextureTable* bindlessTable,
+                                   std::string depthVertFile)
     : device(device),
-      swapChain(swapChain),
+      colorFinalLayout(colorFinalLayout),
       commandBufferManager(commandBufferManager),
-      bufferManager(bufferManager),
+      meshArena(meshArena),
       descriptorManager(descriptorManager),  // Correct initialization
-      indices(indices),
       physicalDevice(physicalDevice),
       vertFile(vertFile),
       fragFile(fragFile),
-      depthManager(depthManager){
-    createRenderPass(swapChain.getSwapChainImageFormat());
-    createGraphicsPipeline();
+      depthManager(depthManager),
+      pipelineCache(pipelineCache),
+      scene(scene),
+      cullingPass(cullingPass),
+      recordingPool(recordingPool),
+      profiler(profiler),
+      bindlessTable(bindlessTable),
+      depthVertFile(depthVertFile) {
+    if (depthManager.getConfig().prepass && depthVertFile.empty()) {
+        throw std::runtime_error("The depth pre-pass needs a position-only vertex shader!");
+    }
+    createRenderPass(colorFormat);
+    createPipelineLayout();
+    // The defaults are compiled up front so there is always a pipeline to draw with
+    pipelineLibrary = std::make_unique<PipelineLibrary>(device,
+        [this](const PipelineDesc& desc, const std::vector<char>& vertCode, const std::vector<char>& fragCode) {
+            return buildPipeline(desc, vertCode, fragCode);
+        });
+    defaultShading = pipelineLibrary->createNow({vertFile, fragFile});
+    shadingPipeline = defaultShading;
+    if (depthManager.getConfig().prepass) {
+        depthPipeline = pipelineLibrary->createNow({depthVertFile, ""});
+    }
 }
 // --------------------------------------------------------------------------------
 
@@ -1156,10 +1446,8 @@ GraphicsPipeline::~GraphicsPipeline() {
         }
     }
 
-    // Clean up pipeline-related resources
-    if (graphicsPipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(device, graphicsPipeline, nullptr);
-    }
+    // Clean up pipeline-related resources; the library joins its compile threads first
+    pipelineLibrary.reset();
     if (pipelineLayout != VK_NULL_HANDLE) {
         vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
     }
@@ -1171,13 +1459,18 @@ GraphicsPipeline::~GraphicsPipeline() {
 
 void GraphicsPipeline::createFrameBuffers(const std::vector<VkImageView>& swapChainImageViews, 
                                           VkExtent2D swapChainExtent) {
+    extent = swapChainExtent;
     framebuffers.resize(swapChainImageViews.size());
 
     for (size_t i = 0; i < swapChainImageViews.size(); i++) {
-            std::array<VkImageView, 2> attachments = {
-                swapChainImageViews[i],
-                depthManager.getDepthImageView()
-            };
+        // With MSAA the presented image is the resolve target, attached last
+        std::vector<VkImageView> attachments;
+        if (depthManager.getSampleCount() == VK_SAMPLE_COUNT_1_BIT) {
+            attachments = {swapChainImageViews[i], depthManager.getDepthImageView()};
+        } else {
+            attachments = {depthManager.getColorImageView(), depthManager.getDepthImageView(),
+                           swapChainImageViews[i]};
+        }
 
         VkFramebufferCreateInfo framebufferInfo{};
         framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
@@ -1203,76 +1496,265 @@ void GraphicsPipeline::destroyFramebuffers() {
 }
 // --------------------------------------------------------------------------------
 
-void GraphicsPipeline::recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex) {
+void GraphicsPipeline::retireFramebuffers(DeletionQueue& deletionQueue) {
+    VkDevice device = this->device;
+    std::vector<VkFramebuffer> retired = std::move(framebuffers);
+    framebuffers.clear();
+    deletionQueue.push([device, retired]() {
+        for (VkFramebuffer framebuffer : retired) {
+            vkDestroyFramebuffer(device, framebuffer, nullptr);
+        }
+    });
+}
+// --------------------------------------------------------------------------------
+
+void GraphicsPipeline::recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex,
+                                           const std::function<void(VkCommandBuffer)>& afterRenderPass,
+                                           const std::function<void(VkCommandBuffer)>& beforeFrame) {
     VkCommandBuffer commandBuffer = commandBufferManager.getCommandBuffer(frameIndex);
 
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
     if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error(std::string("failed to begin recording command buffer!") +
                                  std::to_string(frameIndex));
     }
 
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = renderPass;
-    renderPassInfo.framebuffer = framebuffers[imageIndex];
+    if (beforeFrame) {
+        beforeFrame(commandBuffer);
+    }
 
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = swapChain.getSwapChainExtent();
+    // Query resets cannot be recorded inside a render pass either
+    profiler.resetQueries(commandBuffer, frameIndex);
+    profiler.writeTimestamp(commandBuffer, frameIndex, GpuTimestamp::FrameBegin, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
 
-    std::array<VkClearValue, 2> clearValues{};
-    clearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
-    clearValues[1].depthStencil = {1.0f, 0};
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
+    // Split the draw list into one contiguous partition per recording thread
+    const uint32_t drawCount = scene.getDrawCount(frameIndex);
+    const uint32_t partitions = std::max(1u, std::min(commandBufferManager.getRecordingThreadCount(), drawCount));
+    const uint32_t drawsPerPartition = (drawCount + partitions - 1) / partitions;
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    // With a pre-pass every partition's depth is laid down before any partition shades, so
+    // the pre-pass buffers of all partitions come first in execution order
+    const uint32_t passes = depthManager.getConfig().prepass ? 2 : 1;
+    std::vector<VkCommandBuffer> secondaries(partitions * passes);
+    std::vector<std::future<void>> recordings;
+    recordings.reserve(partitions - 1);
+    for (uint32_t pass = 0; pass < passes; ++pass) {
+        for (uint32_t p = 0; p < partitions; ++p) {
+            secondaries[pass * partitions + p] = commandBufferManager.getSecondaryCommandBuffer(frameIndex, p, pass);
+        }
+    }
+    // A thread records every pass of its partition, since its buffers share one pool
+    auto recordPasses = [this, &secondaries, frameIndex, imageIndex, partitions, passes, drawsPerPartition](uint32_t p) {
+        for (uint32_t pass = 0; pass < passes; ++pass) {
+            recordPartition(secondaries[pass * partitions + p], frameIndex, imageIndex,
+                            p * drawsPerPartition, drawsPerPartition, passes == 2 && pass == 0);
+        }
+    };
+    for (uint32_t p = 1; p < partitions; ++p) {
+        recordings.push_back(recordingPool.submit([&recordPasses, p]() {
+            recordPasses(p);
+        }));
+    }
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    // The render thread records the first partition instead of waiting idle
+    std::exception_ptr failure;
+    try {
+        recordPasses(0);
+    } catch (...) {
+        failure = std::current_exception();
+    }
+    // Every worker must be finished with its buffer before the primary is ended
+    for (std::future<void>& recording : recordings) {
+        try {
+            recording.get();
+        } catch (...) {
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    // The graph orders the culling outputs against the draws that read them and hands the
+    // statistics to the host
+    frameGraph.reset();
+    const ResourceId commands = frameGraph.importBuffer("indirect commands", cullingPass.getIndirectBuffer(frameIndex));
+    const ResourceId instances = frameGraph.importBuffer("instances", cullingPass.getInstanceBuffers()[frameIndex]);
+
+    // Compute work cannot be recorded inside a render pass
+    const PassId cull = frameGraph.addPass("cull", QueueClass::Graphics, [this, frameIndex](VkCommandBuffer cmd) {
+        cullingPass.record(cmd, frameIndex);
+        profiler.writeTimestamp(cmd, frameIndex, GpuTimestamp::CullingEnd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    });
+    if (cullingPass.isEnabled()) {
+        const ResourceId stats = frameGraph.importBuffer("culling stats", cullingPass.getStatsBuffer(frameIndex));
+        const ResourceAccess computeWrite{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT};
+        frameGraph.write(cull, commands, computeWrite);
+        frameGraph.write(cull, instances, computeWrite);
+        frameGraph.write(cull, stats, computeWrite);
+        frameGraph.exportResource(stats, {VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT});
+    } else {
+        // Nothing reads its outputs, but the profiler still expects its timestamp
+        frameGraph.keepPass(cull);
+    }
+
+    const PassId draw = frameGraph.addPass("scene", QueueClass::Graphics,
+                                           [this, frameIndex, imageIndex, &secondaries](VkCommandBuffer cmd) {
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = renderPass;
+        renderPassInfo.framebuffer = framebuffers[imageIndex];
+
+        renderPassInfo.renderArea.offset = {0, 0};
+        renderPassInfo.renderArea.extent = extent;
+
+        std::array<VkClearValue, 2> clearValues{};
+        clearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+        clearValues[1].depthStencil = {depthManager.getConfig().clearDepth(), 0};
+        renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+        renderPassInfo.pClearValues = clearValues.data();
+
+        vkCmdBeginRenderPass(cmd, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        vkCmdExecuteCommands(cmd, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+        vkCmdEndRenderPass(cmd);
+        profiler.writeTimestamp(cmd, frameIndex, GpuTimestamp::FrameEnd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    });
+    frameGraph.read(draw, commands, {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT});
+    frameGraph.read(draw, instances, {VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT});
+    frameGraph.keepPass(draw);
+
+    // Recorded after the last timestamp so GPU frame times match between modes
+    if (afterRenderPass) {
+        frameGraph.keepPass(frameGraph.addPass("after render pass", QueueClass::Graphics, afterRenderPass));
+    }
+
+    // Every pass runs on the graphics queue, so the graph records into one command buffer
+    const uint32_t family = commandBufferManager.getGraphicsFamily();
+    frameGraph.compile(family, family);
+    frameGraph.execute({commandBuffer}, synchronization2);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+}
+// --------------------------------------------------------------------------------
+
+void GraphicsPipeline::recordPartition(VkCommandBuffer secondary, uint32_t frameIndex, uint32_t imageIndex,
+                                       uint32_t firstDraw, uint32_t drawCount, bool depthOnly) const {
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = renderPass;
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = framebuffers[imageIndex];
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+                      VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    if (vkBeginCommandBuffer(secondary, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording secondary command buffer!");
+    }
+
+    // Secondary buffers inherit no state, so each binds everything it draws with
+    vkCmdBindPipeline(secondary, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      pipelineLibrary->get(depthOnly ? depthPipeline : shadingPipeline));
 
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
-    viewport.width = (float) swapChain.getSwapChainExtent().width;
-    viewport.height = (float) swapChain.getSwapChainExtent().height;
+    viewport.width = (float) extent.width;
+    viewport.height = (float) extent.height;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetViewport(secondary, 0, 1, &viewport);
 
     VkRect2D scissor{};
     scissor.offset = {0, 0};
-    scissor.extent = swapChain.getSwapChainExtent();
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    scissor.extent = extent;
+    vkCmdSetScissor(secondary, 0, 1, &scissor);
 
-    VkBuffer vertexBuffers[] = { bufferManager.getVertexBuffer() };
+    // Every mesh lives in the arena, so one binding serves the whole draw list
+    VkBuffer vertexBuffers[] = { meshArena.getVertexBuffer() };
     VkDeviceSize offsets[] = { 0 };
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(commandBuffer, bufferManager.getIndexBuffer(), 0, VK_INDEX_TYPE_UINT16);
+    vkCmdBindVertexBuffers(secondary, 0, 1, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(secondary, meshArena.getIndexBuffer(), 0, meshArena.getIndexType());
 
+    // The dynamic offset selects this frame's slot of the camera uniform ring
+    const uint32_t uniformOffset = descriptorManager.getUniformOffset(frameIndex);
     vkCmdBindDescriptorSets(
-        commandBuffer, 
+        secondary, 
         VK_PIPELINE_BIND_POINT_GRAPHICS, 
         pipelineLayout, 
         0, 
         1, 
         &descriptorManager.getDescriptorSet(frameIndex), 
-        0, 
-        nullptr
+        1, 
+        &uniformOffset
     );
+    vkCmdPushConstants(secondary, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                       sizeof(DrawPushConstants), &drawConstants);
 
-    //vkCmdDraw(commandBuffer, static_cast<uint32_t>(vertices.size()), 1, 0, 0);
-    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+    // The table's single set serves every frame; the fragment shader indexes it by slot.
+    // The pre-pass has no fragment stage, so it needs neither
+    if (bindlessTable && !depthOnly) {
+        VkDescriptorSet bindlessSet = bindlessTable->getDescriptorSet();
+        vkCmdBindDescriptorSets(secondary, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1,
+                                &bindlessSet, 0, nullptr);
+        vkCmdPushConstants(secondary, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(DrawPushConstants),
+                           sizeof(BindlessIndices), &bindlessIndices);
+    }
 
-    vkCmdEndRenderPass(commandBuffer);
+    scene.recordDraws(secondary, frameIndex, cullingPass.getIndirectBuffer(frameIndex), firstDraw, drawCount);
 
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to record command buffer!");
+    if (vkEndCommandBuffer(secondary) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record secondary command buffer!");
     }
 }
 // --------------------------------------------------------------------------------
 
+void GraphicsPipeline::setBindlessIndices(const BindlessIndices& indices) {
+    bindlessIndices = indices;
+}
+// --------------------------------------------------------------------------------
+
+void GraphicsPipeline::setDrawConstants(const DrawPushConstants& constants) {
+    drawConstants = constants;
+}
+// --------------------------------------------------------------------------------
+
+PipelineId GraphicsPipeline::selectShading(const PipelineDesc& desc) {
+    shadingPipeline = pipelineLibrary->request(desc, defaultShading);
+    return shadingPipeline;
+}
+// --------------------------------------------------------------------------------
+
+void GraphicsPipeline::selectDefaultShading() {
+    shadingPipeline = defaultShading;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t GraphicsPipeline::updatePipelines(DeletionQueue& deletionQueue) {
+    return pipelineLibrary->beginFrame(deletionQueue);
+}
+// --------------------------------------------------------------------------------
+
+PipelineLibrary& GraphicsPipeline::getPipelineLibrary() {
+    return *pipelineLibrary;
+}
+// --------------------------------------------------------------------------------
+
+void GraphicsPipeline::setSynchronization2(bool enabled) {
+    synchronization2 = enabled;
+}
+// --------------------------------------------------------------------------------
+
 const VkPipelineLayout& GraphicsPipeline::getPipelineLayout() const {
     if (pipelineLayout == VK_NULL_HANDLE)
         throw std::runtime_error("Graphics pipeline layout is not initialized!");
@@ -1280,10 +1762,10 @@ const VkPipelineLayout& GraphicsPipeline::getPipelineLayout() const {
 }
 // --------------------------------------------------------------------------------
 
-const VkPipeline& GraphicsPipeline::getPipeline() const {
-    if (graphicsPipeline == VK_NULL_HANDLE)
+VkPipeline GraphicsPipeline::getPipeline() const {
+    if (!pipelineLibrary)
         throw std::runtime_error("Graphics pipeline is not initialized!");
-    return graphicsPipeline;
+    return pipelineLibrary->get(shadingPipeline);
 }
 // --------------------------------------------------------------------------------
 
@@ -1310,7 +1792,7 @@ const VkFramebuffer& GraphicsPipeline::getFrameBuffer(uint32_t frameIndex) const
 }
 // ================================================================================
 
-VkShaderModule GraphicsPipeline::createShaderModule(const std::vector<char>& code) {
+VkShaderModule GraphicsPipeline::createShaderModule(const std::vector<char>& code) const {
     VkShaderModuleCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
     createInfo.codeSize = code.size();
@@ -1325,26 +1807,6 @@ VkShaderModule GraphicsPipeline::createShaderModule(const std::vector<char>& cod
 }
 // --------------------------------------------------------------------------------
 
-std::vector<char> GraphicsPipeline::readFile(const std::string& filename) {
-    std::ifstream file(filename, std::ios::ate | std::ios::binary);
-
-    if (!file.is_open()) {
-        std::cerr << "Current working directory: " << std::filesystem::current_path() << std::endl;
-        throw std::runtime_error("failed to open file!");
-    }
-
-    size_t fileSize = (size_t) file.tellg();
-    std::vector<char> buffer(fileSize);
-
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-
-    file.close();
-
-    return buffer;
-}
-// --------------------------------------------------------------------------------
-
 uint32_t GraphicsPipeline::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
     VkPhysicalDeviceMemoryProperties memProperties;
     vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
@@ -1359,13 +1821,45 @@ uint32_t GraphicsPipeline::findMemoryType(uint32_t typeFilter, VkMemoryPropertyF
 }
 // --------------------------------------------------------------------------------
 
-void GraphicsPipeline::createGraphicsPipeline() {
+void GraphicsPipeline::createPipelineLayout() {
+    // Set 0 holds the per-frame buffers; bindless rendering adds the texture table as set 1
+    std::vector<VkDescriptorSetLayout> setLayouts = {descriptorManager.getDescriptorSetLayout()};
+    // The vertex stage reads the draw constants and the fragment stage the slots after them
+    std::vector<VkPushConstantRange> pushConstantRanges = {
+        {VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawPushConstants)}
+    };
+    if (bindlessTable) {
+        setLayouts.push_back(bindlessTable->getDescriptorSetLayout());
+        pushConstantRanges.push_back({VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(DrawPushConstants), sizeof(BindlessIndices)});
+    }
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
 
-    auto vertShaderCode = readFile(vertFile);
-    auto fragShaderCode = readFile(fragFile);
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+}
+// --------------------------------------------------------------------------------
 
-    VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+VkPipeline GraphicsPipeline::buildPipeline(const PipelineDesc& desc, const std::vector<char>& vertCode,
+                                           const std::vector<char>& fragCode) const {
+    // The pre-pass reads only positions from the interleaved vertices and writes no color
+    const bool depthOnly = fragCode.empty();
+    VkShaderModule vertShaderModule = createShaderModule(vertCode);
+    VkShaderModule fragShaderModule = VK_NULL_HANDLE;
+    if (!depthOnly) {
+        try {
+            fragShaderModule = createShaderModule(fragCode);
+        } catch (...) {
+            vkDestroyShaderModule(device, vertShaderModule, nullptr);
+            throw;
+        }
+    }
 
     VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
     vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -1381,8 +1875,9 @@ void GraphicsPipeline::createGraphicsPipeline() {
 
     VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
+    // Generated from the layout selected at compile time
+    constexpr auto bindingDescription = GpuVertex::getBindingDescription();
+    constexpr auto attributeDescriptions = GpuVertex::getAttributeDescriptions();
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -1414,13 +1909,15 @@ void GraphicsPipeline::createGraphicsPipeline() {
     VkPipelineMultisampleStateCreateInfo multisampling{};
     multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
     multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.rasterizationSamples = depthManager.getSampleCount();
 
+    // After a pre-pass the depth is final, so shading only tests it for equality
+    const DepthConfig& depthConfig = depthManager.getConfig();
     VkPipelineDepthStencilStateCreateInfo depthStencil{};
     depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
     depthStencil.depthTestEnable = VK_TRUE;
-    depthStencil.depthWriteEnable = VK_TRUE;
-    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthWriteEnable = depthConfig.shadingWritesDepth() ? VK_TRUE : VK_FALSE;
+    depthStencil.depthCompareOp = depthConfig.shadingCompareOp();
     depthStencil.depthBoundsTestEnable = VK_FALSE;
     depthStencil.stencilTestEnable = VK_FALSE;
 
@@ -1448,19 +1945,16 @@ void GraphicsPipeline::createGraphicsPipeline() {
     dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
     dynamicState.pDynamicStates = dynamicStates.data();
 
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;  // Set to 1 since you have one descriptor set layout
-    pipelineLayoutInfo.pSetLayouts = &descriptorManager.getDescriptorSetLayout();  // Pass the descriptor set layout here
-    pipelineLayoutInfo.pushConstantRangeCount = 0;  // No push constants for now
-
-    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create pipeline layout!");
+    if (depthOnly) {
+        vertexInputInfo.vertexAttributeDescriptionCount = 1;
+        colorBlendAttachment.colorWriteMask = 0;
+        depthStencil.depthWriteEnable = VK_TRUE;
+        depthStencil.depthCompareOp = depthConfig.depthCompareOp();
     }
 
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
+    pipelineInfo.stageCount = depthOnly ? 1 : 2;
     pipelineInfo.pStages = shaderStages;
     pipelineInfo.pVertexInputState = &vertexInputInfo;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
@@ -1475,29 +1969,54 @@ void GraphicsPipeline::createGraphicsPipeline() {
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create graphics pipeline!");
-    }
+    // The cache is internally synchronized, so compile threads share it
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    auto creationStart = std::chrono::steady_clock::now();
+    VkResult result = vkCreateGraphicsPipelines(device, pipelineCache.getCache(), 1, &pipelineInfo, nullptr,
+                                                &pipeline);
+    pipelineCache.recordCreationTime(std::chrono::steady_clock::now() - creationStart);
 
-    vkDestroyShaderModule(device, fragShaderModule, nullptr);
+    if (fragShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(device, fragShaderModule, nullptr);
+    }
     vkDestroyShaderModule(device, vertShaderModule, nullptr);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create graphics pipeline from " + desc.vertFile + "!");
+    }
+    return pipeline;
 }
 // --------------------------------------------------------------------------------
 
-void GraphicsPipeline::createRenderPass(VkFormat swapChainImageFormat) {
+void GraphicsPipeline::createRenderPass(VkFormat colorFormat) {
+    const VkSampleCountFlagBits samples = depthManager.getSampleCount();
+    const bool multisampled = samples != VK_SAMPLE_COUNT_1_BIT;
+
+    // With MSAA the multisampled color is discarded once it is resolved into the image
     VkAttachmentDescription colorAttachment{};
-    colorAttachment.format = swapChainImageFormat;
-    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    colorAttachment.format = colorFormat;
+    colorAttachment.samples = samples;
     colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : colorFinalLayout;
+
+    VkAttachmentDescription resolveAttachment{};
+    resolveAttachment.format = colorFormat;
+    resolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    resolveAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    resolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    resolveAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    resolveAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    resolveAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    resolveAttachment.finalLayout = colorFinalLayout;
 
     VkAttachmentDescription depthAttachment{};
     depthAttachment.format = depthManager.findDepthFormat();
-    depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    depthAttachment.samples = samples;
+    // Depth starts cleared and is discarded at the end, so a transient depth image never
+    // has to leave tile memory
     depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
@@ -1513,10 +2032,15 @@ void GraphicsPipeline::createRenderPass(VkFormat swapChainImageFormat) {
     depthAttachmentRef.attachment = 1;
     depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
+    VkAttachmentReference resolveAttachmentRef{};
+    resolveAttachmentRef.attachment = 2;
+    resolveAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
     VkSubpassDescription subpass{};
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorAttachmentRef;
+    subpass.pResolveAttachments = multisampled ? &resolveAttachmentRef : nullptr;
     subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
     VkSubpassDependency dependency{};
@@ -1527,13 +2051,13 @@ void GraphicsPipeline::createRenderPass(VkFormat swapChainImageFormat) {
     dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
     dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
-    // Correct the attachments array and count
-    std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
+    // The resolve target is only part of the pass with MSAA
+    std::array<VkAttachmentDescription, 3> attachments = {colorAttachment, depthAttachment, resolveAttachment};
 
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());  // Set to 2
-    renderPassInfo.pAttachments = attachments.data();  // Point to both color and depth attachments
+    renderPassInfo.attachmentCount = multisampled ? 3 : 2;
+    renderPassInfo.pAttachments = attachments.data();
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
     renderPassInfo.dependencyCount = 1;
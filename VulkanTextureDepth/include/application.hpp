@@ -20,12 +20,23 @@
 #define GLFW_INCLUDE_VULKAN  // <vulkan/vulkan.h>
 #include "validation_layers.hpp"
 #include "memory.hpp"
+#include "upload.hpp"
 //#include "graphics_pipeline.hpp"
 #include "graphics.hpp"
+#include "texture_registry.hpp"
+#include "thread_pool.hpp"
+#include "pipeline_cache.hpp"
+#include "scene.hpp"
+#include "culling.hpp"
 #include "devices.hpp"
+#include "latency.hpp"
+#include "profiler.hpp"
+#include "offscreen.hpp"
 
 #include <memory>
 #include <mutex>
+#include <chrono>
+#include <functional>
 // ================================================================================
 // ================================================================================
 
@@ -39,7 +50,8 @@ public:
     /**
      * @brief Constructor for the VulkanInstance class 
      *
-     * @param window A reference to a Window object
+     * @param window A reference to a Window object, or nullptr for a headless instance
+     *        that enables no surface extensions and creates no surface
      */
     VulkanInstance(GLFWwindow* window, ValidationLayers& validationLayers);
 // --------------------------------------------------------------------------------
@@ -57,7 +69,7 @@ public:
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Returns a raw pointer to an instance of surface
+     * @brief Returns a raw pointer to an instance of surface, VK_NULL_HANDLE when headless
      */
     VkSurfaceKHR getSurface();
 // ================================================================================
@@ -93,15 +105,49 @@ public:
 
     static void scrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 // --------------------------------------------------------------------------------
+
+    /**
+     * @brief GLFW key callback; pressing R hot-reloads the current texture from disk,
+     * keys 1 to 4 select the low latency, balanced, throughput and power saver profiles,
+     * P writes the recorded frame timings to disk and M writes the memory statistics.
+     */
+    static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+// --------------------------------------------------------------------------------
     /**
      * @brief Constructs a new VulkanApplication instance.
      * 
      * @param window A reference to a Window object that the application will use.
-     * @param vertices A vector of Vertex objects
+     * @param mesh The vertices and indices drawn; only read during construction
+     * @param texturePath Path to the texture sampled by the mesh
+     * @param latencyMode The latency profile the renderer starts with
+     * @param depthConfig Selects reverse-Z depth and the depth pre-pass
      */
     VulkanApplication(GLFWwindow* window, 
-                      const std::vector<Vertex>& vertices,
-                      const std::vector<uint16_t>& indices);
+                      const MeshSource& mesh,
+                      const std::string& texturePath = "../../../data/texture.jpg",
+                      LatencyMode latencyMode = LatencyMode::Balanced,
+                      const DepthConfig& depthConfig = DepthConfig{});
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Constructs a headless VulkanApplication that renders without a window.
+     *
+     * No surface or swap chain is created and the device is not required to present.
+     * Frames are rendered into an OffscreenTarget and, if the config asks for it, read back
+     * to host memory. Drive it with runFrames.
+     *
+     * @param headlessConfig The size and format of the offscreen images and whether they
+     *        are read back.
+     * @param mesh The vertices and indices drawn; only read during construction
+     * @param texturePath Path to the texture sampled by the mesh
+     * @param latencyMode The latency profile, which sets the number of frames in flight
+     * @param depthConfig Selects reverse-Z depth and the depth pre-pass
+     */
+    VulkanApplication(const HeadlessConfig& headlessConfig,
+                      const MeshSource& mesh,
+                      const std::string& texturePath = "../../../data/texture.jpg",
+                      LatencyMode latencyMode = LatencyMode::Balanced,
+                      const DepthConfig& depthConfig = DepthConfig{});
 // --------------------------------------------------------------------------------
 
     /**
@@ -110,6 +156,56 @@ public:
     ~VulkanApplication();
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Replaces the mesh texture without stalling rendering.
+     *
+     * The new texture is decoded and uploaded in the background. Frames keep sampling the old
+     * texture until the upload completes, after which each frame's descriptor set is rewritten
+     * as that frame comes around and the old image is destroyed once no frame can use it.
+     *
+     * @param path Path to the new texture file.
+     */
+    void reloadTexture(const std::string& path);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Switches to another latency profile without restarting.
+     *
+     * Waits for the device to go idle, then rebuilds the per-frame sync objects, command
+     * buffers, uniform buffers and descriptor sets for the profile's frame count and
+     * recreates the swap chain with its present mode and image count.
+     *
+     * @param mode The profile to switch to.
+     */
+    void setLatencyMode(LatencyMode mode);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes the profiler's frame history to disk.
+     *
+     * Produces a CSV with one row per frame and a Chrome trace that can be opened in
+     * chrome://tracing or Perfetto.
+     *
+     * @param csvPath Path of the CSV file.
+     * @param tracePath Path of the trace file.
+     * @throws std::runtime_error if either file cannot be written.
+     */
+    void writeFrameTimings(const std::string& csvPath = "frame_timings.csv",
+                           const std::string& tracePath = "frame_trace.json") const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes VMA's detailed statistics to disk and prints usage per category.
+     *
+     * The JSON lists every allocation and free range, which shows leaks and fragmentation
+     * in long sessions and can be viewed with VMA's VmaDumpVis tool.
+     *
+     * @param jsonPath Path of the JSON file.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void writeMemoryStats(const std::string& jsonPath = "memory_stats.json") const;
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Runs the main application loop
      *
@@ -119,6 +215,99 @@ public:
     void run();
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Renders a fixed number of frames, then waits for the device to go idle.
+     *
+     * Works windowed and headless; a windowed run also stops early if the window is
+     * closed. Every rendered frame has reached the profiler history, and the readback
+     * callback, by the time this returns.
+     *
+     * @param frameCount The number of frames to render.
+     */
+    void runFrames(uint32_t frameCount);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true if the application renders without a window.
+     */
+    bool isHeadless() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Sets the function that receives each frame read back from the GPU.
+     *
+     * @param callback Called on the render thread with each completed frame.
+     * @throws std::runtime_error if the application is not headless with readback enabled.
+     */
+    void setReadbackCallback(std::function<void(const ReadbackFrame&)> callback);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the profiler that records the timings of every frame.
+     */
+    const Profiler& getProfiler() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Sets a function called at the start of every frame, once the frame's slot is idle.
+     *
+     * Scripted workloads use it to change the scene, bind another texture or queue uploads;
+     * uploads queued from it are submitted ahead of that frame's draw.
+     *
+     * @param callback Receives the number of the frame about to be rendered.
+     */
+    void setFrameCallback(std::function<void(uint64_t)> callback);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Advances the animation by a fixed time per frame instead of the wall clock.
+     *
+     * @param seconds Animation time per frame; zero returns to the wall clock.
+     */
+    void setFixedTimeStep(float seconds);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Samples another texture in the mesh's descriptor sets.
+     *
+     * The application takes its own reference to the texture and releases the previous one.
+     * Each frame's descriptor set is rewritten when that frame next starts.
+     *
+     * @param handle A valid handle from the application's texture registry.
+     */
+    void bindTexture(TextureHandle handle);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the scene whose instances are drawn each frame.
+     */
+    Scene& getScene();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the registry that owns every texture.
+     */
+    TextureRegistry& getTextureRegistry();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the queue that carries uploads ahead of each frame.
+     */
+    UploadQueue& getUploadQueue();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the arena that holds the vertices and indices of every scene mesh.
+     */
+    MeshArena& getMeshArena();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the allocator that owns every buffer and image.
+     */
+    AllocatorManager& getAllocatorManager();
+// --------------------------------------------------------------------------------
+
     void setFramebufferResized(bool resized) { framebufferResized = resized; }
 // ================================================================================
 private:
@@ -132,19 +321,45 @@ private:
     std::unique_ptr<DepthManager> depthManager;
     std::unique_ptr<CommandBufferManager> commandBufferManager;
     std::unique_ptr<SamplerManager> samplerManager;
-    std::unique_ptr<TextureManager> textureManager;
+    std::unique_ptr<ThreadPool> threadPool;
+    std::unique_ptr<ThreadPool> recordingPool; /**< Workers that record secondary command buffers. */
+    std::unique_ptr<BindlessTextureTable> bindlessTable; /**< Set 1 of every texture, null without descriptor indexing. */
+    std::unique_ptr<TextureRegistry> textureRegistry;
+    TextureHandle texture;
+    std::string texturePath;
+    std::vector<bool> textureDescriptorStale; /**< Frames whose set still binds a replaced texture; unused when bindless. */
     std::unique_ptr<BufferManager> bufferManager;
+    CameraUniforms camera{};                        /**< Shared uniforms of the current camera. */
+    float cameraZoom = 0.0f;                        /**< Zoom level camera was built for. */
+    VkExtent2D cameraExtent{0, 0};                  /**< Render extent camera was built for. */
+    uint64_t cameraVersion = 0;                     /**< Bumped whenever camera is rebuilt. */
+    std::unique_ptr<MeshArena> meshArena;           /**< Vertex and index data of every mesh. */
+    MeshRange meshRange;                            /**< The mesh passed to the constructor. */
+    std::unique_ptr<Scene> scene;
+    std::unique_ptr<CullingPass> cullingPass;
     std::unique_ptr<DescriptorManager> descriptorManager;
+    std::unique_ptr<PipelineCache> pipelineCache;
     std::unique_ptr<GraphicsPipeline> graphicsPipeline;
+    std::unique_ptr<PresentPacer> presentPacer;
+    LatencyProfile latencyProfile;
+    DepthConfig depthConfig;                  /**< Depth convention and pre-pass selection. */
+    std::unique_ptr<Profiler> profiler;
+    HeadlessConfig headlessConfig;                   /**< Offscreen settings, used when windowInstance is null. */
+    std::unique_ptr<OffscreenTarget> offscreenTarget; /**< Replaces the swap chain when headless. */
+    uint64_t framesRendered = 0;                     /**< Frames recorded since startup. */
+    std::function<void(uint64_t)> frameCallback;     /**< Scripted per-frame work, if any. */
+    float fixedTimeStep = 0.0f;                      /**< Animation seconds per frame, 0 for the wall clock. */
+    static constexpr uint64_t DEFRAGMENTATION_INTERVAL = 600; /**< Frames between defragmentation runs. */
+    std::chrono::steady_clock::time_point lastTitleUpdate; /**< When the title readout was last refreshed. */
 
-    std::vector<Vertex> vertices;
-    std::vector<uint16_t> indices;
     VkQueue graphicsQueue; // = VK_NULL_HANDLE;
     VkQueue presentQueue; // = VK_NULL_HANDLE;
 
     std::unique_ptr<AllocatorManager> allocatorManager;
+    std::unique_ptr<UploadQueue> uploadQueue;
     uint32_t currentFrame = 0;
     bool framebufferResized = false; 
+    std::vector<VkFence> imagesInFlight;  /**< Fence of the frame last rendering to each swap chain image. */
 // --------------------------------------------------------------------------------
 
     /**
@@ -159,8 +374,9 @@ private:
      *
     * This method handles the process of drawing a frame in the Vulkan application. It performs the following steps:
     * 1. Waits for the previous frame to finish using synchronization objects.
-    * 2. Acquires an image from the swap chain to render to.
-    * 3. Resets the command buffer and records commands to it.
+    * 2. Acquires an image from the swap chain to render to, returning early with the frame's
+    *    fence still signaled if the swap chain is out of date.
+    * 3. Resets the fence and command buffer and records commands to it.
     * 4. Submits the recorded command buffer to the graphics queue for execution.
     * 5. Presents the rendered image to the swap chain.
     *
@@ -173,10 +389,19 @@ private:
      * @brief Recreates the swap chain and all dependent resources
      * 
      * This method will be called if the window is resized and the swap chain needs to be recreated.
+     * The old swap chain is handed to the new one as oldSwapchain, and it, its framebuffers
+     * and the depth image are retired through the deletion queue, so the device never idles.
+     * While the window is minimized nothing is recreated and framebufferResized stays set.
      */
     void recreateSwapChain();
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Returns true if the window's framebuffer has a zero extent.
+     */
+    bool isMinimized() const;
+// --------------------------------------------------------------------------------
+
     /**
      * @brief GLFW framebuffer resize callback
      * 
@@ -189,7 +414,51 @@ private:
     static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Writes a frame's camera slot if the camera changed and sets the draw constants.
+     *
+     * The view and projection are rebuilt only when the zoom level or render extent have
+     * changed; the per-frame model rotation is pushed as a DrawPushConstants.
+     *
+     * @param currentImage The frame whose uniform slot and frustum are updated.
+     */
     void updateUniformBuffer(uint32_t currentImage);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Prints the active latency profile and the present mode it resolved to.
+     */
+    void logLatencyProfile() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Shows the recent frame rate and CPU and GPU frame times in the window title.
+     *
+     * Refreshes at most twice a second so the readout stays legible.
+     */
+    void updateTitleReadout();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates every Vulkan object; shared by the windowed and headless constructors.
+     *
+     * @param texturePath Path to the texture sampled by the mesh.
+     * @param mesh The vertices and indices uploaded into the mesh buffers.
+     */
+    void createResources(const std::string& texturePath, const MeshSource& mesh);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Publishes the profiler results and readbacks of every slot after the device
+     * has gone idle.
+     */
+    void resolveFramesInFlight();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the extent of the swap chain, or of the offscreen images when headless.
+     */
+    VkExtent2D getRenderExtent() const;
 };
 // ================================================================================
 // ================================================================================
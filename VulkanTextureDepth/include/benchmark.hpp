@@ -0,0 +1,180 @@
+// ================================================================================
+// ================================================================================
+// - File:    benchmark.hpp
+// - Purpose: This file contains the fixed-workload benchmark scenes run by the
+//            VulkanBenchmark target and the statistics and JSON report they produce.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef benchmark_HPP
+#define benchmark_HPP
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "application.hpp"
+#include "profiler.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct BenchmarkScene
+ * @brief A deterministic workload: what is drawn and uploaded every frame.
+ */
+struct BenchmarkScene {
+    std::string name;                   /**< Identifier used on the command line and in the report. */
+    uint32_t quads = 1;                 /**< Textured quads drawn every frame, laid out in a grid. */
+    uint32_t textures = 1;              /**< Distinct textures, bound round robin, one per frame. */
+    uint32_t uploadsPerFrame = 0;       /**< Buffer uploads queued ahead of every frame. */
+    VkDeviceSize uploadBytes = 64 * 1024; /**< Size of each upload. */
+    uint32_t frames = 600;              /**< Frames measured. */
+    uint32_t warmupFrames = 30;         /**< Frames rendered before measuring starts. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct TimingStats
+ * @brief Distribution of one per-frame duration, in milliseconds.
+ */
+struct TimingStats {
+    size_t samples = 0;  /**< Number of frames the statistics cover. */
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct BenchmarkResult
+ * @brief Measurements of one scene run.
+ */
+struct BenchmarkResult {
+    BenchmarkScene scene;                /**< The scene that was run. */
+    bool headless = false;               /**< The scene rendered offscreen. */
+    TimingStats frameMs;                 /**< Interval between consecutive frame starts. */
+    TimingStats cpuMs;                   /**< CPU time from frame start to submit or present. */
+    TimingStats gpuMs;                   /**< GPU time of each frame's command buffer. */
+    uint64_t uploadedBytes = 0;          /**< Bytes uploaded during the measured frames. */
+    double uploadMiBPerSecond = 0.0;     /**< uploadedBytes over the measured wall time. */
+    VkDeviceSize vmaUsageBytes = 0;      /**< Device memory in use across all heaps, per VMA's budget query. */
+    VkDeviceSize vmaBudgetBytes = 0;     /**< Memory budget across all heaps. */
+    VkDeviceSize vmaAllocationBytes = 0; /**< Bytes of all live VMA allocations. */
+    uint32_t vmaAllocationCount = 0;     /**< Number of live VMA allocations. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class Benchmark
+ * @brief Runs BenchmarkScenes on a VulkanApplication and reports their timings.
+ *
+ * Scenes are fully scripted, so two runs on the same machine do the same work: the
+ * animation advances by a fixed step per frame, textures are generated rather than read
+ * from user data, and uploads write a fixed pattern.
+ */
+class Benchmark {
+public:
+    /**
+     * @brief Returns the scenes run when none are named on the command line.
+     */
+    static std::vector<BenchmarkScene> defaultScenes();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Runs a scene to completion and measures it.
+     *
+     * The application should be freshly created, so memory usage reflects only this scene.
+     *
+     * @param app The application to drive; its scene instances are replaced.
+     * @param scene The workload to run.
+     * @param textureDirectory Directory the scene's generated textures are written to.
+     * @return The measurements of the run.
+     * @throws std::runtime_error if the frame count exceeds the profiler history.
+     */
+    static BenchmarkResult runScene(VulkanApplication& app, const BenchmarkScene& scene,
+                                    const std::string& textureDirectory);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes deterministic, mutually distinct PPM textures.
+     *
+     * @param directory Directory the files are written to; created if missing.
+     * @param count Number of textures.
+     * @param size Width and height of each texture in pixels.
+     * @return The paths of the files, in order.
+     * @throws std::runtime_error if a file cannot be written.
+     */
+    static std::vector<std::string> writeTextures(const std::string& directory, uint32_t count,
+                                                  uint32_t size = 256);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Computes the timing statistics of a scene's measured frames.
+     *
+     * Frames numbered below the scene's warmup count are ignored.
+     *
+     * @param scene The scene the frames belong to.
+     * @param timings The profiler history of the run, oldest first.
+     * @param uploadedBytes Bytes uploaded during the measured frames.
+     * @return A result with the timing and upload fields filled in.
+     */
+    static BenchmarkResult summarize(const BenchmarkScene& scene, const std::vector<FrameTiming>& timings,
+                                     uint64_t uploadedBytes);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the value at a fraction of a sorted distribution.
+     *
+     * Interpolates linearly between the two nearest ranks.
+     *
+     * @param values The samples, in any order.
+     * @param fraction Position in [0, 1]; 0.5 is the median.
+     * @return The percentile, or 0 for an empty sample.
+     */
+    static double percentile(std::vector<double> values, double fraction);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Computes the mean, median, 99th percentile and maximum of a sample.
+     */
+    static TimingStats computeStats(const std::vector<double>& values);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes results as one JSON document.
+     */
+    static void writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the vertices of a single unit quad, textured across its full extent.
+     */
+    static std::vector<Vertex> quadVertices();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the indices of the quad from quadVertices.
+     */
+    static std::vector<uint16_t> quadIndices();
+// ================================================================================
+private:
+    /**
+     * @brief Fills in the VMA memory fields of a result.
+     */
+    static void sampleMemory(AllocatorManager& allocatorManager, BenchmarkResult& result);
+};
+// ================================================================================
+// ================================================================================
+#endif /* benchmark_HPP */
+// eof
@@ -0,0 +1,166 @@
+// ================================================================================
+// ================================================================================
+// - File:    bindless.hpp
+// - Purpose: This file contains the BindlessTextureTable class, which keeps every
+//            resident texture and sampler in one update-after-bind descriptor set
+//            that shaders index directly.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef bindless_HPP
+#define bindless_HPP
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct BindlessIndices
+ * @brief The fragment stage push constants that select a texture and sampler.
+ *
+ * The layout matches the BindlessIndices block in bindless.frag, which is pushed at offset
+ * sizeof(DrawPushConstants), after the vertex stage's constants.
+ */
+struct BindlessIndices {
+    uint32_t texture = 0;   /**< Slot of the sampled image in the texture array. */
+    uint32_t sampler = 0;   /**< Slot of the sampler in the sampler array. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class BindlessTextureTable
+ * @brief One descriptor set holding an array of sampled images and an array of samplers.
+ *
+ * Both bindings are partially bound and update-after-bind, so a new texture only costs one
+ * descriptor write into a free slot, even while frames that bound the set are still
+ * executing, and the set is bound once per command buffer no matter how many textures the
+ * frame samples. Shaders select a slot with BindlessIndices.
+ *
+ * A slot that a frame in flight may still sample must not be rewritten. Slots are therefore
+ * only reused after removeTexture(), which the caller defers until no such frame remains.
+ * Requires the descriptor indexing features reported by DeviceFeatureSupport::descriptorIndexing.
+ * Every method is thread-safe.
+ */
+class BindlessTextureTable {
+public:
+    /**
+     * @brief Creates the set layout, pool and set.
+     *
+     * @param device The Vulkan logical device.
+     * @param physicalDevice The physical device whose update-after-bind limits cap the arrays.
+     * @param maxTextures Requested size of the sampled image array.
+     * @param maxSamplers Requested size of the sampler array.
+     * @throws std::runtime_error if the layout, pool or set cannot be created.
+     */
+    BindlessTextureTable(VkDevice device,
+                         VkPhysicalDevice physicalDevice,
+                         uint32_t maxTextures = 4096,
+                         uint32_t maxSamplers = 64);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys the pool and layout. The GPU must be done with the set.
+     */
+    ~BindlessTextureTable();
+// --------------------------------------------------------------------------------
+
+    BindlessTextureTable(const BindlessTextureTable&) = delete;
+    BindlessTextureTable& operator=(const BindlessTextureTable&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes an image view into a free slot of the texture array.
+     *
+     * @param imageView A view in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL when sampled.
+     * @return The slot, passed to shaders as BindlessIndices::texture.
+     * @throws std::runtime_error if every slot is taken.
+     */
+    uint32_t addTexture(VkImageView imageView);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns a texture slot for reuse.
+     *
+     * No frame in flight may sample the slot any more; push the call on the DeletionQueue
+     * when the texture may still be in use.
+     *
+     * @param slot A slot returned by addTexture.
+     */
+    void removeTexture(uint32_t slot);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the slot holding a sampler, writing it into a new slot on first use.
+     *
+     * Samplers are long-lived and few, so their slots are never freed.
+     *
+     * @throws std::runtime_error if every sampler slot is taken.
+     */
+    uint32_t addSampler(VkSampler sampler);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the layout of the set, bound as set 1 by the graphics pipeline.
+     */
+    VkDescriptorSetLayout getDescriptorSetLayout() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the set shared by every frame.
+     */
+    VkDescriptorSet getDescriptorSet() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the size of the texture array after clamping to the device limits.
+     */
+    uint32_t getTextureCapacity() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of texture slots in use.
+     */
+    uint32_t getTextureCount() const;
+// ================================================================================
+private:
+    VkDevice device;
+    uint32_t textureCapacity;
+    uint32_t samplerCapacity;
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+
+    std::vector<uint32_t> freeTextureSlots;   /**< Released texture slots, reused first. */
+    uint32_t nextTextureSlot = 0;             /**< First texture slot never handed out. */
+    std::vector<VkSampler> samplers;          /**< Sampler of each sampler slot. */
+
+    mutable std::mutex tableMutex;            /**< Guards the slots and host access to the set. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates the layout, pool and set; the constructor cleans up on failure.
+     */
+    void createDescriptorSet();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys whatever createDescriptorSet made.
+     */
+    void destroy();
+};
+// ================================================================================
+// ================================================================================
+#endif /* bindless_HPP */
+// eof
@@ -0,0 +1,254 @@
+// ================================================================================
+// ================================================================================
+// - File:    culling.hpp
+// - Purpose: This file contains the CullingPass class, a compute pass that frustum
+//            culls scene instances and compacts the survivors into the draw list.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef culling_HPP
+#define culling_HPP
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "memory.hpp"
+#include "devices.hpp"
+#include "scene.hpp"
+#include "pipeline_cache.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct CullingStats
+ * @brief Instance counts reported by one execution of the culling pass.
+ */
+struct CullingStats {
+    uint32_t tested = 0;   /**< Instances tested against the frustum. */
+    uint32_t visible = 0;  /**< Instances that survived and were drawn. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class CullingPass
+ * @brief Tests scene instances against the view frustum on the GPU before they are drawn.
+ *
+ * The pass reads the instance records and draw commands written by the Scene and produces
+ * a second, GPU-only copy of both in which each draw's instances are only those whose
+ * bounding sphere intersects the frustum. The vertex shader and the indirect draws then
+ * read the culled copy. Culling statistics are written to a host-visible buffer per frame
+ * in flight and read back once that frame's fence has been waited on, so reading them
+ * never stalls the CPU on the GPU.
+ *
+ * Culling requires drawIndirectFirstInstance, since each draw's survivors are addressed
+ * through firstInstance. On devices without it the pass is disabled and every instance
+ * is drawn.
+ */
+class CullingPass {
+public:
+    /**
+     * @brief Creates the culling pipelines and the per-frame output buffers.
+     *
+     * @param device The Vulkan logical device.
+     * @param allocatorManager The allocator used for the output buffers.
+     * @param scene The scene whose draw list is culled.
+     * @param pipelineCache The pipeline cache used to create the compute pipelines.
+     * @param features The optional draw features enabled on the logical device.
+     * @param framesInFlight Number of frames that may be recorded before the oldest completes.
+     * @param compFile The location of the culling compute shader relative to the executable.
+     * @throws std::runtime_error if a Vulkan object or buffer cannot be created.
+     */
+    CullingPass(VkDevice device,
+                AllocatorManager& allocatorManager,
+                Scene& scene,
+                PipelineCache& pipelineCache,
+                const DeviceFeatureSupport& features,
+                uint32_t framesInFlight,
+                const std::string& compFile);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys the pipelines, descriptor objects and output buffers.
+     */
+    ~CullingPass();
+// --------------------------------------------------------------------------------
+
+    CullingPass(const CullingPass&) = delete;
+    CullingPass& operator=(const CullingPass&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true if the device supports culling and the pass records work.
+     */
+    bool isEnabled() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Sets the frustum a frame is culled against.
+     *
+     * @param frameIndex The frame in flight being prepared.
+     * @param viewProj The matrix taking instance world space to clip space; for this
+     *        renderer that is proj * view * ubo.model.
+     */
+    void setFrustum(uint32_t frameIndex, const glm::mat4& viewProj);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records the culling dispatches for a frame outside of any render pass.
+     *
+     * Reads back the statistics this frame slot produced last time it ran, so it must
+     * be called after the frame's fence has been waited on and after Scene::update.
+     *
+     * The caller orders the outputs against their readers: the draws read the commands and
+     * instances, and the host reads the statistics buffer once the frame's fence signals.
+     *
+     * @param commandBuffer The command buffer being recorded.
+     * @param frameIndex The frame in flight being recorded.
+     */
+    void record(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the instance buffers the vertex shader should read, indexed by frame.
+     *
+     * These are the culled buffers when the pass is enabled and the scene's own
+     * buffers otherwise.
+     */
+    const std::vector<VkBuffer>& getInstanceBuffers() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the indirect command buffer the draws should read for a frame.
+     */
+    VkBuffer getIndirectBuffer(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the buffer the pass writes a frame's CullingStats to.
+     */
+    VkBuffer getStatsBuffer(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the statistics of the most recent culling pass that has completed.
+     *
+     * The values lag the frame being recorded by the number of frames in flight.
+     */
+    CullingStats getStats() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Extracts normalized frustum planes from a clip-space matrix.
+     *
+     * Assumes the Vulkan clip volume, with depth in [0, 1]. Each plane stores its
+     * inward-facing normal in xyz and its offset in w, so a point p is inside when
+     * dot(plane.xyz, p) + plane.w >= 0 for every plane.
+     *
+     * @param viewProj The matrix taking world space to clip space.
+     * @return The left, right, bottom, top, near and far planes.
+     */
+    static std::array<glm::vec4, 6> extractFrustumPlanes(const glm::mat4& viewProj);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief CPU reference of the test cull.comp applies to each instance.
+     *
+     * @param planes Planes returned by extractFrustumPlanes.
+     * @param sphere World-space center in xyz, radius in w.
+     * @return True unless the sphere lies entirely outside one of the planes.
+     */
+    static bool isSphereVisible(const std::array<glm::vec4, 6>& planes, const glm::vec4& sphere);
+// ================================================================================
+private:
+    /**
+     * @struct PushConstants
+     * @brief Layout of the Frustum push constant block in cull.comp.
+     */
+    struct PushConstants {
+        glm::vec4 planes[6];
+        uint32_t drawCount;
+    };
+// --------------------------------------------------------------------------------
+
+    /**
+     * @struct FrameResources
+     * @brief The culling outputs and state of one frame in flight.
+     */
+    struct FrameResources {
+        VkBuffer instanceBuffer = VK_NULL_HANDLE;       /**< Surviving instance records. */
+        VmaAllocation instanceAllocation = VK_NULL_HANDLE;
+        VkBuffer countsBuffer = VK_NULL_HANDLE;         /**< Survivors per draw, cleared each frame. */
+        VmaAllocation countsAllocation = VK_NULL_HANDLE;
+        VkBuffer commandBuffer = VK_NULL_HANDLE;        /**< Draw commands over the survivors. */
+        VmaAllocation commandAllocation = VK_NULL_HANDLE;
+        VkBuffer statsBuffer = VK_NULL_HANDLE;          /**< Host-visible CullingStats. */
+        VmaAllocation statsAllocation = VK_NULL_HANDLE;
+        CullingStats* stats = nullptr;                  /**< Mapped statsBuffer. */
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        std::array<glm::vec4, 6> planes{};              /**< Frustum set by setFrustum. */
+        bool recorded = false;                          /**< statsBuffer holds results to read. */
+    };
+// --------------------------------------------------------------------------------
+
+    VkDevice device;                        /**< The Vulkan logical device. */
+    AllocatorManager& allocatorManager;     /**< Allocator for the output buffers. */
+    Scene& scene;                           /**< Source of the draw list. */
+    bool enabled;                           /**< False if the device cannot cull. */
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline cullPipeline = VK_NULL_HANDLE;      /**< PHASE 0: test and compact instances. */
+    VkPipeline commandPipeline = VK_NULL_HANDLE;   /**< PHASE 1: write the draw commands. */
+
+    std::vector<FrameResources> frames;     /**< Outputs, one set per frame in flight. */
+    std::vector<VkBuffer> instanceBuffers;  /**< Buffers returned by getInstanceBuffers. */
+    CullingStats lastStats;                 /**< Most recent completed statistics. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates the output buffers of every frame.
+     */
+    void createBuffers();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates the descriptor set layout, pool and one set per frame.
+     */
+    void createDescriptors();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates the pipeline layout and both specializations of cull.comp.
+     */
+    void createPipelines(const std::string& compFile, PipelineCache& pipelineCache);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys every Vulkan object owned by the pass.
+     */
+    void destroy();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Reads a file into a vector of characters.
+     */
+    static std::vector<char> readFile(const std::string& filename);
+};
+// ================================================================================
+// ================================================================================
+#endif /* culling_HPP */
+// eof
@@ -0,0 +1,117 @@
+// ================================================================================
+// ================================================================================
+// - File:    deletion_queue.hpp
+// - Purpose: This file contains a deferred-deletion queue that destroys Vulkan
+//            handles once every frame that could still reference them has finished.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef deletion_queue_HPP
+#define deletion_queue_HPP
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <cstdint>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class DeletionQueue
+ * @brief Defers destruction of retired resources until the frames that used them complete.
+ *
+ * Frame fences are waited on in submission order, one slot after another. Once a deleter has
+ * seen framesInFlight fence waits after being pushed, every frame submitted before the push
+ * has completed, so the resource can be destroyed without a device-wide idle. This holds
+ * whether the resource was retired while recording a frame or between frames.
+ *
+ * Deleters should capture handles by value rather than references to their former owners,
+ * since the owner may be gone by the time the deleter runs.
+ */
+class DeletionQueue {
+public:
+    /**
+     * @brief Constructs an empty queue.
+     *
+     * @param framesInFlight Number of frames that may be in flight at once.
+     */
+    explicit DeletionQueue(uint32_t framesInFlight);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Runs every remaining deleter. The device must be idle.
+     */
+    ~DeletionQueue();
+// --------------------------------------------------------------------------------
+
+    DeletionQueue(const DeletionQueue&) = delete;
+    DeletionQueue& operator=(const DeletionQueue&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Schedules a deleter to run once every frame submitted so far has completed.
+     *
+     * This method is thread-safe.
+     *
+     * @param deleter A callable that destroys the retired resources.
+     */
+    void push(std::function<void()> deleter);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records that a frame fence has been waited on and runs the deleters it released.
+     *
+     * Called by CommandBufferManager::waitForFences().
+     */
+    void onFenceWaited();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Runs every deleter immediately. The device must be idle.
+     */
+    void flush();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Changes the number of fence waits deleters pushed from now on must wait for.
+     *
+     * Deleters already queued keep the release point they were pushed with, and deleters
+     * still run in push order, so ones pushed after lowering the count wait behind those
+     * queued before it. Raising the count is only safe once the device has gone idle.
+     *
+     * @param framesInFlight Number of frames that may be in flight at once.
+     */
+    void setFramesInFlight(uint32_t framesInFlight);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of deleters still waiting.
+     */
+    size_t size() const;
+// ================================================================================
+private:
+    /**
+     * @brief A deleter and the fence-wait count at which it becomes safe to run.
+     */
+    struct Entry {
+        uint64_t releaseAt = 0;
+        std::function<void()> deleter;
+    };
+// --------------------------------------------------------------------------------
+
+    uint32_t framesInFlight;    /**< Fence waits that must pass before a deleter runs. */
+    uint64_t fenceWaits = 0;    /**< Fence waits recorded so far. */
+    std::deque<Entry> entries;  /**< Pending deleters, in push order. */
+    mutable std::mutex queueMutex;
+};
+// ================================================================================
+// ================================================================================
+#endif /* deletion_queue_HPP */
+// eof
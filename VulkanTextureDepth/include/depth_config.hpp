@@ -0,0 +1,110 @@
+// ================================================================================
+// ================================================================================
+// - File:    depth_config.hpp
+// - Purpose: This file contains the DepthConfig struct, which selects reverse-Z depth,
+//            the depth pre-pass and the MSAA level and derives the depth state they need.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef depth_config_HPP
+#define depth_config_HPP
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct DepthConfig
+ * @brief How the depth buffer is laid out and filled.
+ *
+ * With reverseZ the projection maps the near plane to depth 1 and the far plane to 0, the
+ * buffer is cleared to 0 and nearer fragments win with GREATER. Float depth keeps most of
+ * its precision near 0, so reversing the range spreads it evenly over distance; the format
+ * is therefore restricted to floating point.
+ *
+ * With prepass every draw is first rendered by a position-only pipeline that writes depth
+ * and no color. The shading pipeline then tests with EQUAL and does not write depth, so
+ * early depth testing rejects every fragment but the visible one before it is shaded.
+ *
+ * msaaSamples above 1 renders into multisampled color and depth targets that are resolved
+ * into the presented image at the end of the subpass.
+ */
+struct DepthConfig {
+    bool reverseZ = false;  /**< Clear to 0 and keep the greatest depth. */
+    bool prepass = false;   /**< Lay down depth in a position-only pass before shading. */
+    uint32_t msaaSamples = 1;  /**< Requested samples per pixel, capped by the device. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the compare op of the pass that writes depth: the pre-pass if there
+     * is one, the shading pass otherwise.
+     */
+    VkCompareOp depthCompareOp() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the compare op of the shading pass, EQUAL after a pre-pass.
+     */
+    VkCompareOp shadingCompareOp() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true if the shading pass writes depth, which it only does without
+     * a pre-pass.
+     */
+    bool shadingWritesDepth() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the value the depth buffer is cleared to, the farthest depth.
+     */
+    float clearDepth() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the Vulkan projection matrix for this depth mode.
+     *
+     * The matrix maps view space to Vulkan clip space: depth in [0, 1], reversed with
+     * reverseZ, and Y pointing down. It is built with glm::perspectiveRH_ZO, so it does not
+     * depend on GLM_FORCE_DEPTH_ZERO_TO_ONE being defined before glm is included.
+     *
+     * @param fovY Vertical field of view in radians.
+     * @param aspect Width over height of the render extent.
+     * @param nearPlane Distance to the near plane.
+     * @param farPlane Distance to the far plane.
+     */
+    glm::mat4 projection(float fovY, float aspect, float nearPlane, float farPlane) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the depth formats to choose from, in order of preference.
+     *
+     * Reverse-Z only lists floating point formats, since a fixed point format gains
+     * nothing from the reversed range.
+     */
+    std::vector<VkFormat> formatCandidates() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the sample count the targets are created with.
+     *
+     * @param supported The counts both color and depth framebuffers support, i.e.
+     *        framebufferColorSampleCounts & framebufferDepthSampleCounts.
+     * @return The largest supported count that does not exceed msaaSamples, which is
+     *         VK_SAMPLE_COUNT_1_BIT if msaaSamples is 0 or 1.
+     */
+    VkSampleCountFlagBits sampleCount(VkSampleCountFlags supported) const;
+};
+// ================================================================================
+// ================================================================================
+#endif /* depth_config_HPP */
+// eof
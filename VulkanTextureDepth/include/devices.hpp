@@ -17,12 +17,33 @@
 #include <GLFW/glfw3.h>
 #include <vulkan/vulkan.h>
 #include "queues.hpp"
+#include "deletion_queue.hpp"
+#include "latency.hpp"
 #include <memory>
 #include <vector>
 #include <mutex>
 // ================================================================================
 // ================================================================================ 
 
+/**
+ * @struct DeviceFeatureSupport
+ * @brief Optional draw features that were enabled on the logical device.
+ *
+ * Renderers check these flags to pick the cheapest submission path the device
+ * supports instead of assuming every indirect drawing feature is present.
+ */
+struct DeviceFeatureSupport {
+    bool multiDrawIndirect = false;         /**< More than one draw per vkCmdDrawIndexedIndirect call. */
+    bool drawIndirectFirstInstance = false; /**< Indirect commands may use a non-zero firstInstance. */
+    bool drawIndirectCount = false;         /**< vkCmdDrawIndexedIndirectCount reads the draw count from a buffer. */
+    bool presentWait = false;               /**< VK_KHR_present_id and VK_KHR_present_wait are enabled. */
+    bool descriptorIndexing = false;        /**< Partially bound, update-after-bind runtime arrays of sampled images. */
+    bool memoryBudget = false;              /**< VK_EXT_memory_budget reports the memory the process may use. */
+    bool synchronization2 = false;          /**< vkCmdPipelineBarrier2 and the 64-bit stage and access flags. */
+};
+// ================================================================================
+// ================================================================================ 
+
 /**
  * @class VulkanPhysicalDevice
  * @brief Represents a physical device in a Vulkan application.
@@ -39,6 +60,8 @@ public:
      * from the available devices that support Vulkan.
      * 
      * @param instance A reference to the Vulkan instance.
+     * @param surface The surface the device must present to, or VK_NULL_HANDLE for
+     *        headless rendering, which drops the present and swap chain requirements.
      */
     VulkanPhysicalDevice(VkInstance& instance, VkSurfaceKHR surface);
 // --------------------------------------------------------------------------------
@@ -187,10 +210,12 @@ public:
      * @param surface The Vulkan surface.
      * @param physicalDevice The Vulkan physical device.
      * @param window A pointer to the Window object.
+     * @param latencyProfile The profile that selects the present mode and image count.
      *
      * @throws std::runtime_error if the swap chain or image views cannot be created.
      */
-    SwapChain(VkDevice device, VkSurfaceKHR surface, VkPhysicalDevice physicalDevice, GLFWwindow* window);
+    SwapChain(VkDevice device, VkSurfaceKHR surface, VkPhysicalDevice physicalDevice, GLFWwindow* window,
+              const LatencyProfile& latencyProfile = LatencyProfile::get(LatencyMode::Balanced));
 // --------------------------------------------------------------------------------
 
     /**
@@ -241,6 +266,24 @@ public:
     const std::vector<VkImageView>& getSwapChainImageViews() const;
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Retrieves the present mode the current swap chain was created with.
+     *
+     * @return The present mode chosen from the latency profile's preferences.
+     */
+    VkPresentModeKHR getPresentMode() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Replaces the latency profile used the next time the swap chain is created.
+     *
+     * Call recreateSwapChain afterwards to apply the new present mode and image count.
+     *
+     * @param latencyProfile The profile that selects the present mode and image count.
+     */
+    void setLatencyProfile(const LatencyProfile& latencyProfile);
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Queries the swap chain support details for a physical device and surface.
      *
@@ -277,14 +320,29 @@ public:
      * @throws std::runtime_error if the swap chain or image views cannot be recreated successfully.
      */
     void recreateSwapChain();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Recreates the swap chain without waiting for the device to go idle.
+     *
+     * The current swap chain is passed as oldSwapchain so presentation can continue during the
+     * switch, and it is handed to deletionQueue together with its image views. Framebuffers
+     * that reference the old image views must be retired the same way.
+     *
+     * @param deletionQueue The queue that destroys the old swap chain once its frames have completed.
+     * @throws std::runtime_error if the swap chain or image views cannot be created.
+     */
+    void recreateSwapChain(DeletionQueue& deletionQueue);
 // ================================================================================
 private:
     VkDevice device;
     VkSurfaceKHR surface;
     VkPhysicalDevice physicalDevice;
     GLFWwindow* window;
+    LatencyProfile latencyProfile;
 
     VkSwapchainKHR swapChain = VK_NULL_HANDLE;
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
     VkFormat swapChainImageFormat;
     VkExtent2D swapChainExtent;
     std::vector<VkImage> swapChainImages;
@@ -323,7 +381,7 @@ private:
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Chooses the best present mode for the swap chain from the available present modes.
+     * @brief Chooses the present mode the latency profile prefers from the available present modes.
      *
      * @param availablePresentModes The list of available present modes.
      * @return The chosen present mode (VkPresentModeKHR).
@@ -363,7 +421,8 @@ public:
      * 
      * @param physicalDevice The Vulkan physical device to use for logical device creation.
      * @param validationLayers A vector containing the names of the validation layers to be enabled.
-     * @param surface The surface used to present images to the screen.
+     * @param surface The surface used to present images to the screen, or VK_NULL_HANDLE
+     *        for headless rendering, in which case no present queue is created.
      * @param deviceExtensions A vector of required device extensions.
      */
     VulkanLogicalDevice(VkPhysicalDevice physicalDevice, 
@@ -458,14 +517,52 @@ public:
     /**
      * @brief Retrieves the Vulkan present queue.
      * 
-     * @return The Vulkan present queue handle.
+     * @return The Vulkan present queue handle, or VK_NULL_HANDLE for a headless device.
      */
     VkQueue getPresentQueue() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the Vulkan transfer queue.
+     * 
+     * @return The dedicated transfer queue handle, or the graphics queue if the device
+     *         has no transfer-only queue family.
+     */
+    VkQueue getTransferQueue() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the Vulkan compute queue.
+     * 
+     * @return The async-compute queue handle, or the graphics queue if the device
+     *         has no compute queue family without graphics support.
+     */
+    VkQueue getComputeQueue() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the queue family indices the logical device was created with.
+     * 
+     * @return The QueueFamilyIndices used to create the device queues.
+     */
+    const QueueFamilyIndices& getQueueFamilyIndices() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the optional draw features enabled on the logical device.
+     * 
+     * @return The DeviceFeatureSupport flags the device was created with.
+     */
+    const DeviceFeatureSupport& getEnabledFeatures() const;
 // ================================================================================
 private:
     VkDevice device = VK_NULL_HANDLE; ///< Vulkan logical device handle.
     VkQueue graphicsQueue; ///< Handle to the Vulkan graphics queue.
-    VkQueue presentQueue; ///< Handle to the Vulkan present queue.
+    VkQueue presentQueue = VK_NULL_HANDLE; ///< Handle to the Vulkan present queue, null when headless.
+    VkQueue transferQueue = VK_NULL_HANDLE; ///< Handle to the transfer queue, the graphics queue if none is dedicated.
+    VkQueue computeQueue = VK_NULL_HANDLE; ///< Handle to the compute queue, the graphics queue if none is dedicated.
+    QueueFamilyIndices queueFamilyIndices; ///< Queue families the device queues were created from.
+    DeviceFeatureSupport enabledFeatures; ///< Optional draw features enabled at device creation.
     VkPhysicalDevice physicalDevice; ///< Handle to the Vulkan physical device.
     std::vector<const char*> validationLayers; ///< Names of the validation layers to be enabled.
     VkSurfaceKHR surface; ///< Surface used to present images to the screen.
@@ -22,101 +22,84 @@
 #include <string>
 #include <cstddef>
 #include <unordered_map>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 #include "memory.hpp"
 #include "devices.hpp"
+#include "upload.hpp"
+#include "deletion_queue.hpp"
+#include "pipeline_cache.hpp"
+#include "scene.hpp"
+#include "culling.hpp"
+#include "thread_pool.hpp"
+#include "profiler.hpp"
+#include "mesh.hpp"
+#include "mesh_arena.hpp"
+#include "bindless.hpp"
+#include "sampler_desc.hpp"
+#include "depth_config.hpp"
+#include "pipeline_library.hpp"
+#include "render_graph.hpp"
 #include <vk_mem_alloc.h>
 // ================================================================================
 // ================================================================================ 
 
-static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+// Upper bound on the frames in flight any latency profile may select; resources that are
+// not rebuilt when the profile changes are sized for this many frames
+static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 3;
 // ================================================================================
 // ================================================================================ 
 
 
 /**
- * @brief Represents a vertex with position and color attributes.
+ * @struct CameraUniforms
+ * @brief Per-frame data shared by every draw, read from the dynamic uniform buffer ring.
  *
- * This struct defines a vertex with a 2D position and a 3D color. It also provides
- * static methods to describe how these vertex attributes are laid out in memory
- * for Vulkan's vertex input system. 
+ * The layout matches the CameraUniforms block in shader.vert. It only changes with the
+ * camera, so it is rewritten when the zoom level or render extent changes rather than
+ * every frame.
  */
-struct Vertex {
-    glm::vec3 pos;
-    glm::vec3 color;
-    glm::vec2 texCoord;
-// --------------------------------------------------------------------------------
-
-    /**
-     * @brief Returns the binding description for the vertex input.
-     *
-     * This function specifies how the vertex data is organized in the vertex buffer.
-     * It provides the binding index, the byte stride between consecutive vertex data,
-     * and the rate at which the input should advance.
-     * 
-     * @return A VkVertexInputBindingDescription struct that describes the input binding.
-     */
-    static VkVertexInputBindingDescription getBindingDescription() {
-        VkVertexInputBindingDescription bindingDescription{};
-        bindingDescription.binding = 0;
-        bindingDescription.stride = sizeof(Vertex);
-        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-        return bindingDescription;
-    }
-// --------------------------------------------------------------------------------
-
-    /**
-     * @brief Returns the attribute descriptions for the vertex input.
-     *
-     * This function describes the vertex attributes (position and color) and their
-     * layout in memory. It specifies the format of each attribute and the byte offset
-     * from the start of the vertex structure.
-     * 
-     * @return A std::array of VkVertexInputAttributeDescription structs that describe the vertex attributes.
-     */
-    static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions() {
-        std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
-
-        attributeDescriptions[0].binding = 0;
-        attributeDescriptions[0].location = 0;
-        attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-        attributeDescriptions[0].offset = offsetof(Vertex, pos);
-
-        attributeDescriptions[1].binding = 0;
-        attributeDescriptions[1].location = 1;
-        attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-        attributeDescriptions[1].offset = offsetof(Vertex, color);
-
-        attributeDescriptions[2].binding = 0;
-        attributeDescriptions[2].location = 2;
-        attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-        attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
-
-        return attributeDescriptions;
-    }
-};
-// ================================================================================
-// ================================================================================
-
-struct UniformBufferObject {
-    alignas(16) glm::mat4 model;
+struct CameraUniforms {
     alignas(16) glm::mat4 view;
     alignas(16) glm::mat4 proj;
+    alignas(16) glm::mat4 viewProj;   /**< proj * view, so the shader does not rebuild it. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct DrawPushConstants
+ * @brief The vertex stage push constants recorded with every draw.
+ *
+ * The layout matches the DrawConstants block in shader.vert. Fragment stage push
+ * constants, such as the BindlessIndices, follow at offset sizeof(DrawPushConstants).
+ */
+struct DrawPushConstants {
+    alignas(16) glm::mat4 model{1.0f};  /**< Transform applied ahead of each instance's model. */
 };
-// struct UniformBufferObject {
-//     glm::mat4 model;
-//     glm::mat4 view;
-//     glm::mat4 proj;
-// };
 
 // ================================================================================
 // ================================================================================
 
+/**
+ * @class DepthManager
+ * @brief Owns the render targets that live only inside the render pass.
+ *
+ * That is the depth buffer and, with MSAA, the multisampled color image that is resolved
+ * into the swap chain or offscreen image at the end of the subpass.
+ */
 class DepthManager {
 public:
+    /**
+     * @param colorFormat Format of the presented image, used for the multisampled color target.
+     * @param config Depth convention, pre-pass and requested MSAA level; the sample count
+     *        is capped by what the device supports for both color and depth.
+     */
     DepthManager(AllocatorManager& allocatorManager, VkDevice device, 
-                 VkPhysicalDevice physicalDevice, VkExtent2D swapChainExtent);
+                 VkPhysicalDevice physicalDevice, VkExtent2D swapChainExtent,
+                 VkFormat colorFormat, const DepthConfig& config = DepthConfig{});
 // --------------------------------------------------------------------------------
 
     ~DepthManager();
@@ -128,20 +111,72 @@ public:
     void createDepthResources();
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Replaces the depth and multisampled color images with ones of a new extent.
+     *
+     * Frames in flight may still render into the old images, so they are retired through the
+     * deletion queue rather than destroyed. Nothing happens if the extent is unchanged.
+     *
+     * @param extent The new swap chain extent.
+     * @param deletionQueue Destroys the old image once no submitted frame uses it.
+     * @return True if the image was replaced, in which case framebuffers must be rebuilt.
+     */
+    bool recreateDepthResources(VkExtent2D extent, DeletionQueue& deletionQueue);
+// --------------------------------------------------------------------------------
+
+    VkExtent2D getExtent() const { return swapChainExtent; }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the depth range, compare ops and pre-pass choice the buffer is used with.
+     */
+    const DepthConfig& getConfig() const { return config; }
+// --------------------------------------------------------------------------------
+
     VkFormat findDepthFormat();
 // --------------------------------------------------------------------------------
 
     VkImageView getDepthImageView();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true if the depth image lives in lazily allocated memory.
+     *
+     * The depth buffer is never read after the render pass, so on devices with a lazily
+     * allocated memory type it is created as a transient attachment that may never be
+     * backed by physical memory at all.
+     */
+    bool isLazilyAllocated() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the sample count of the depth and color targets.
+     */
+    VkSampleCountFlagBits getSampleCount() const { return samples; }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the multisampled color target, or VK_NULL_HANDLE without MSAA.
+     */
+    VkImageView getColorImageView() const { return colorImageView; }
 // ================================================================================
 private:
     AllocatorManager& allocatorManager;
     VkDevice device;
     VkPhysicalDevice physicalDevice;
     VkExtent2D swapChainExtent;
+    VkFormat colorFormat;
+    DepthConfig config;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
     
     VkImage depthImage = VK_NULL_HANDLE;
     VmaAllocation depthImageMemory = VK_NULL_HANDLE;
     VkImageView depthImageView = VK_NULL_HANDLE;
+    VkImage colorImage = VK_NULL_HANDLE;         /**< Multisampled color target, only with MSAA. */
+    VmaAllocation colorImageMemory = VK_NULL_HANDLE;
+    VkImageView colorImageView = VK_NULL_HANDLE;
+    bool lazyMemorySupported = false;   /**< The device has a lazily allocated memory type. */
+    bool depthLazilyAllocated = false;  /**< The current depth image uses that type. */
 // --------------------------------------------------------------------------------
 
     bool hasStencilComponent(VkFormat format);
@@ -154,7 +189,23 @@ private:
     void createImage(uint32_t width, uint32_t height, VkFormat format, 
                      VkImageTiling tiling, VkImageUsageFlags usage, 
                      VmaMemoryUsage memoryUsage, VkImage& image, 
-                     VmaAllocation& imageMemory);
+                     VmaAllocation& imageMemory,
+                     VkSampleCountFlagBits numSamples = VK_SAMPLE_COUNT_1_BIT);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates an optimal-tiling image with the manager's sample count that is only
+     * used inside render passes.
+     *
+     * The image is made transient and lazily allocated when the device supports it, and
+     * falls back to ordinary device-local memory otherwise.
+     *
+     * @return True if the image is lazily allocated.
+     * @throws std::runtime_error if neither allocation succeeds.
+     */
+    bool createAttachmentImage(uint32_t width, uint32_t height, VkFormat format,
+                               VkImageUsageFlags usage, VkImage& image,
+                               VmaAllocation& imageMemory);
 // --------------------------------------------------------------------------------
 
     VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
@@ -169,22 +220,32 @@ private:
  *
  * This class encapsulates the command buffer management in Vulkan, providing methods for creating command pools,
  * allocating command buffers, and managing synchronization primitives like fences and semaphores.
+ *
+ * Every frame in flight owns one command pool for its primary command buffer and one pool per recording
+ * thread for that thread's secondary command buffer, so threads never share a pool. The pools of a frame
+ * are reset together with resetCommandPools once its fence has been waited on.
+ *
+ * The number of frames in flight is chosen at runtime, up to MAX_FRAMES_IN_FLIGHT, and can be changed
+ * with setFramesInFlight while the device is idle.
  */
 class CommandBufferManager {
 public:
+    static constexpr uint32_t SECONDARY_PASSES = 2;  /**< Secondary buffers per thread and frame. */
     
     /**
      * @brief Constructor for CommandBufferManager.
      *
      * @param device The Vulkan device handle used for command buffer and resource creation.
-     * @param indices The vector of indices used for managing the command buffers.
      * @param physicalDevice The Vulkan physical device used to create the command pool.
      * @param surface The Vulkan surface handle used for surface-related operations.
+     * @param framesInFlight The number of frames that may be in flight, clamped to [1, MAX_FRAMES_IN_FLIGHT].
+     * @param recordingThreads The number of threads that record secondary command buffers each frame.
      */
     CommandBufferManager(VkDevice device,
-                         const std::vector<uint16_t>& indices,
                          VkPhysicalDevice physicalDevice,
-                         VkSurfaceKHR surface);
+                         VkSurfaceKHR surface,
+                         uint32_t framesInFlight = 2,
+                         uint32_t recordingThreads = 1);
 // --------------------------------------------------------------------------------
     
     /**
@@ -196,25 +257,45 @@ public:
     /**
      * @brief Waits for a specific frame's fences to be signaled before proceeding.
      *
+     * Resources pushed to the deletion queue that no frame in flight can reference any more
+     * are destroyed once the wait returns. Waiting again before the fence is reset, as when
+     * a frame gives up after an out-of-date acquire, returns at once and does not count as
+     * another completed frame.
+     *
      * @param frameIndex The index of the frame whose fence should be waited for.
      */
-    void waitForFences(uint32_t frameIndex) const;
+    void waitForFences(uint32_t frameIndex);
 // --------------------------------------------------------------------------------
 
     /**
      * @brief Resets the fences for a specific frame, allowing it to be reused.
      *
+     * Only reset a fence once the frame is certain to be submitted, or the next wait on
+     * it never returns.
+     *
      * @param frameIndex The index of the frame whose fence should be reset.
      */
-    void resetFences(uint32_t) const;
+    void resetFences(uint32_t frameIndex);
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Retrieves the Vulkan command pool associated with this manager.
+     * @brief Resets every command pool of a frame, recycling all of its command buffers at once.
+     *
+     * Must only be called once the frame's fence has been waited on.
      *
+     * @param frameIndex The index of the frame whose pools are reset.
+     * @throws std::runtime_error if a pool cannot be reset.
+     */
+    void resetCommandPools(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieves the command pool that owns a frame's primary command buffer.
+     *
+     * @param frameIndex The index of the frame whose pool is retrieved.
      * @return The Vulkan command pool.
      */
-    const VkCommandPool& getCommandPool() const;
+    const VkCommandPool& getCommandPool(uint32_t frameIndex) const;
 // --------------------------------------------------------------------------------
 
     /**
@@ -234,6 +315,45 @@ public:
     const VkCommandBuffer& getCommandBuffer(uint32_t frameIndex) const;
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Retrieves a secondary command buffer a recording thread uses for a frame.
+     *
+     * Each thread has one buffer per pass of the frame, so the depth pre-pass and the
+     * shading pass of a partition are recorded separately and can be executed in order.
+     *
+     * @param frameIndex The index of the frame being recorded.
+     * @param thread The recording thread, less than getRecordingThreadCount().
+     * @param pass The pass, less than SECONDARY_PASSES.
+     * @return A secondary command buffer allocated from that thread's pool for the frame.
+     */
+    const VkCommandBuffer& getSecondaryCommandBuffer(uint32_t frameIndex, uint32_t thread,
+                                                     uint32_t pass = 0) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of recording threads secondary buffers were allocated for.
+     */
+    uint32_t getRecordingThreadCount() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of frames that may be in flight.
+     */
+    uint32_t getFramesInFlight() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Rebuilds the per-frame command pools, command buffers and sync objects for a new frame count.
+     *
+     * The device must be idle. Anything still in the deletion queue is destroyed first, and deleters
+     * pushed afterwards wait for the new number of frames.
+     *
+     * @param framesInFlight The number of frames that may be in flight, clamped to [1, MAX_FRAMES_IN_FLIGHT].
+     * @throws std::runtime_error if a Vulkan object cannot be created.
+     */
+    void setFramesInFlight(uint32_t framesInFlight);
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Retrieves the image available semaphore for a given frame index.
      *
@@ -261,6 +381,18 @@ public:
     const VkFence& getInFlightFence(uint32_t frameIndex) const;
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Returns the queue that destroys retired resources once their frames have completed.
+     */
+    DeletionQueue& getDeletionQueue() { return deletionQueue; }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the queue family the command buffers are recorded for.
+     */
+    uint32_t getGraphicsFamily() const { return graphicsFamily; }
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Allocates and creates the command buffers for rendering.
      */
@@ -270,28 +402,44 @@ private:
     // Attributes passed to constructor
     VkDevice device;                      /**< The Vulkan device handle. */
     VkExtent2D swapChainExtent;           /**< The extent of the swap chain for rendering. */
-    std::vector<uint16_t> indices;        /**< Vector holding index data for command buffers. */
 
-    VkCommandPool commandPool = VK_NULL_HANDLE; /**< The Vulkan command pool used to allocate command buffers. */
+    uint32_t framesInFlight;              /**< Number of frames whose objects are allocated. */
+    uint32_t recordingThreads;            /**< Number of secondary command buffers per frame. */
+    uint32_t graphicsFamily = 0;          /**< Queue family every command pool is created for. */
+
+    std::vector<VkCommandPool> commandPools; /**< Pool of each frame's primary command buffer. */
     std::vector<VkCommandBuffer> commandBuffers; /**< The list of Vulkan command buffers. */
+    std::vector<std::vector<VkCommandPool>> secondaryPools; /**< Per frame, one pool per recording thread. */
+    std::vector<std::vector<VkCommandBuffer>> secondaryBuffers; /**< Per frame, SECONDARY_PASSES buffers per recording thread. */
     std::vector<VkSemaphore> imageAvailableSemaphores; /**< Semaphores used to signal when images are available. */
     std::vector<VkSemaphore> renderFinishedSemaphores; /**< Semaphores used to signal when rendering is finished. */
     std::vector<VkFence> inFlightFences; /**< Fences used for synchronizing frame rendering. */ 
+    std::vector<bool> fenceWaited;      /**< Whether a fence was waited on since its last reset. */
+    DeletionQueue deletionQueue; /**< Retired resources, drained as frame fences are waited on. */
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Creates a command pool for allocating command buffers.
-     *
-     * @param physicalDevice The Vulkan physical device used to create the command pool.
-     * @param surface The Vulkan surface handle used for surface-related operations.
+     * @brief Creates the primary and per-thread command pools of every frame.
      */
-    void createCommandPool(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface);
+    void createCommandPool();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates one transient command pool on the graphics queue family.
+     */
+    VkCommandPool createPool() const;
 // --------------------------------------------------------------------------------
 
     /**
      * @brief Creates synchronization objects like semaphores and fences for rendering.
      */
     void createSyncObjects();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys the command pools and sync objects of every frame.
+     */
+    void destroyFrameObjects();
 };
 // ================================================================================
 // ================================================================================
@@ -300,9 +448,13 @@ private:
  * @class SamplerManager
  * @brief Manages the creation, retrieval, and destruction of Vulkan texture samplers.
  *
- * The SamplerManager class is responsible for managing Vulkan samplers. 
- * It allows for the creation of reusable samplers based on unique keys, 
- * making it efficient to share samplers across multiple textures that have similar sampling properties.
+ * The SamplerManager class is responsible for managing Vulkan samplers. Samplers are
+ * keyed by their SamplerDesc, so every texture sampled with the same state shares one
+ * VkSampler and the device's sampler allocation limit is only spent on distinct states.
+ *
+ * Samplers live as long as the manager. Lookups of existing samplers are lock-free: they
+ * probe a fixed open-addressing table whose slots are published with release stores, and
+ * only the creation of a new sampler takes a lock.
  */
 class SamplerManager {
 public:
@@ -310,14 +462,16 @@ public:
     /**
      * @brief Constructs a SamplerManager for managing Vulkan texture samplers.
      *
-     * Initializes the SamplerManager with the Vulkan device and physical device handles needed
-     * for creating samplers.
+     * Initializes the SamplerManager with the Vulkan device handle and caches the physical
+     * device's anisotropy and sampler allocation limits.
      * 
      * @param device The Vulkan logical device handle used to create and manage samplers.
      * @param physicalDevice The Vulkan physical device handle used for querying properties 
      *        such as supported anisotropy levels.
+     * @param maxSamplers Most distinct samplers the manager creates, further capped by
+     *        maxSamplerAllocationCount.
      */
-    SamplerManager(VkDevice device, VkPhysicalDevice physicalDevice);
+    SamplerManager(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t maxSamplers = 1024);
 // --------------------------------------------------------------------------------
 
     /**
@@ -328,38 +482,83 @@ public:
      */
     ~SamplerManager();
 // --------------------------------------------------------------------------------
+
+    SamplerManager(const SamplerManager&) = delete;
+    SamplerManager& operator=(const SamplerManager&) = delete;
+// --------------------------------------------------------------------------------
+
     /**
-     * @brief Retrieves an existing sampler by key.
+     * @brief Returns the sampler for a state, creating it on first use.
      *
-     * Looks up the sampler associated with the specified key. If the sampler does not exist,
-     * it will throw an exception.
+     * Thread-safe. Returning an existing sampler takes no lock.
      * 
-     * @param samplerKey A unique key identifying the desired sampler.
-     * @return The Vulkan sampler associated with the given key.
-     * @throws std::out_of_range if the sampler associated with the key does not exist.
+     * @param desc The sampler state.
+     * @return The Vulkan sampler shared by every caller passing an equal state.
+     * @throws std::runtime_error if Vulkan fails to create the sampler or the sampler
+     *         budget is spent.
      */
-    VkSampler getSampler(const std::string& samplerKey) const;
+    VkSampler getSampler(const SamplerDesc& desc = SamplerDesc{});
 // --------------------------------------------------------------------------------
+
     /**
-     * @brief Creates and stores a sampler with the specified key.
-     *
-     * Creates a new Vulkan sampler with commonly used sampling parameters and associates it
-     * with the specified key for future retrieval. The created sampler is stored in the 
-     * `samplers` map and can be reused across multiple textures.
-     * 
-     * @param samplerKey A unique key identifying the sampler for future retrieval.
-     * @return The Vulkan sampler created and stored with the specified key.
-     * @throws std::runtime_error if Vulkan fails to create the sampler.
+     * @brief Returns the number of distinct samplers created so far.
+     */
+    uint32_t getSamplerCount() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the most samplers the manager will create.
      */
-    VkSampler createSampler(const std::string& samplerKey);
+    uint32_t getMaxSamplers() const;
 // ================================================================================
 private:
+    /**
+     * @brief A created sampler and the state it was created from.
+     */
+    struct CachedSampler {
+        SamplerDesc desc;
+        size_t hash;
+        VkSampler sampler;
+    };
+// --------------------------------------------------------------------------------
 
     VkDevice device; /**< The Vulkan logical device handle used for sampler creation. */ 
-    VkPhysicalDevice physicalDevice; /**< The Vulkan physical device handle for querying properties. */ 
-    std::unordered_map<std::string, VkSampler> samplers;  /**< Map of samplers keyed by unique strings for reuse. */
+    float maxAnisotropy; /**< maxSamplerAnisotropy of the physical device. */
+    uint32_t maxSamplers; /**< Budget of distinct samplers. */
 
-    mutable std::mutex samplerMutex; /**< Mutex to synchronize access to the `samplers` map. */ 
+    std::unique_ptr<std::atomic<const CachedSampler*>[]> slots; /**< Open-addressing table, read without a lock. */
+    size_t slotMask; /**< Table size minus one; the table is at least twice maxSamplers. */
+    std::vector<std::unique_ptr<CachedSampler>> samplers; /**< Owns every table entry, in creation order. */
+    std::atomic<uint32_t> samplerCount{0}; /**< Number of entries in samplers. */
+
+    std::mutex samplerMutex; /**< Serializes sampler creation. */ 
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Probes the table for a state without locking.
+     *
+     * @return The sampler, or VK_NULL_HANDLE if the state has no sampler yet.
+     */
+    VkSampler find(const SamplerDesc& desc, size_t hash) const;
+};
+// ================================================================================
+// ================================================================================ 
+
+/**
+ * @struct DecodedTexture
+ * @brief CPU-side texture data produced by TextureManager::decodeTexture and ready for upload.
+ *
+ * Decoding touches no Vulkan object other than format queries on the physical device, so it
+ * may run on any thread.
+ */
+struct DecodedTexture {
+    std::string path;                        /**< The texture path the data was decoded for. */
+    VkFormat format = VK_FORMAT_UNDEFINED;   /**< Format of the image to create. */
+    uint32_t width = 0;                      /**< Width of level 0 in texels. */
+    uint32_t height = 0;                     /**< Height of level 0 in texels. */
+    uint32_t mipLevels = 1;                  /**< Number of mip levels of the image. */
+    std::vector<uint8_t> data;               /**< Level 0 only, or the whole chain if levelOffsets is set. */
+    std::vector<VkDeviceSize> levelOffsets;  /**< Offsets of pre-built levels; empty if the GPU blits the chain. */
 };
 // ================================================================================
 // ================================================================================ 
@@ -370,8 +569,8 @@ private:
  *
  * The TextureManager class handles the creation of texture images, image layout transitions,
  * and buffer-to-image copies for Vulkan. It leverages the AllocatorManager to manage Vulkan memory 
- * allocations and CommandBufferManager for handling command buffers during the transition and copy 
- * operations. 
+ * allocations and the UploadQueue to record the transition and copy operations into a batched,
+ * non-blocking transfer. 
  */
 class TextureManager {
 public:
@@ -380,17 +579,16 @@ public:
      *
      * Initializes the TextureManager with necessary Vulkan objects and parameters to manage texture images.
      * The texture image is loaded from the specified file path, and the image view is created for shader access.
-     * The TextureManager also obtains a sampler from the SamplerManager using the specified sampler key.
+     * The TextureManager also obtains a sampler for the specified state from the SamplerManager.
      * 
      * @param allocatorManager Reference to an AllocatorManager responsible for managing Vulkan memory.
      * @param device The Vulkan logical device handle used for memory allocations and operations.
      * @param physicalDevice The Vulkan physical device handle used to query memory properties.
-     * @param commandBufferManager Reference to the CommandBufferManager responsible for command buffer allocation.
-     * @param graphicsQueue The Vulkan queue for submitting graphics commands.
+     * @param uploadQueue Reference to the UploadQueue that records the texture upload.
      * @param imagePath Path to the texture image file to be loaded and used as a texture.
      * @param samplerManager Reference to a SamplerManager that manages reusable Vulkan samplers.
-     * @param samplerKey The key used to identify the desired sampler from the SamplerManager. 
-     *        If no key is specified, the "default" sampler is used.
+     * @param samplerDesc The state of the sampler taken from the SamplerManager; trilinear,
+     *        repeating and anisotropic when not specified.
      * 
      * @throws std::invalid_argument if the imagePath is empty.
      * @throws std::runtime_error if any Vulkan resource creation fails, such as loading the texture image,
@@ -399,11 +597,52 @@ public:
     TextureManager(AllocatorManager& allocatorManager,
                    VkDevice device,
                    VkPhysicalDevice physicalDevice,
-                   CommandBufferManager& commandBufferManager,
-                   VkQueue graphicsQueue,
+                   UploadQueue& uploadQueue,
                    const std::string imagePath,
                    SamplerManager& samplerManager,
-                   const std::string& samplerKey = "default");
+                   const SamplerDesc& samplerDesc = SamplerDesc{});
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Constructs a TextureManager from data decoded ahead of time, typically on a worker thread.
+     *
+     * @param allocatorManager Reference to an AllocatorManager responsible for managing Vulkan memory.
+     * @param device The Vulkan logical device handle used for memory allocations and operations.
+     * @param physicalDevice The Vulkan physical device handle used to query memory properties.
+     * @param uploadQueue Reference to the UploadQueue that records the texture upload.
+     * @param decoded The output of decodeTexture(). Its data is copied into staging memory.
+     * @param samplerManager Reference to a SamplerManager that manages reusable Vulkan samplers.
+     * @param samplerDesc The state of the sampler taken from the SamplerManager.
+     *
+     * @throws std::runtime_error if the Vulkan image, image view or sampler cannot be created.
+     */
+    TextureManager(AllocatorManager& allocatorManager,
+                   VkDevice device,
+                   VkPhysicalDevice physicalDevice,
+                   UploadQueue& uploadQueue,
+                   const DecodedTexture& decoded,
+                   SamplerManager& samplerManager,
+                   const SamplerDesc& samplerDesc = SamplerDesc{});
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Loads and decodes a texture file into CPU memory without touching the GPU.
+     *
+     * A precompressed KTX2 or DDS variant with pre-baked mips is used when one exists for a
+     * format the device supports; otherwise stb_image decodes the file to RGBA8. When the device
+     * cannot blit the format with linear filtering, the mip chain is box-filtered here as well.
+     * This function is thread-safe.
+     *
+     * @param imagePath Path to the texture file.
+     * @param physicalDevice The Vulkan physical device used for format support queries.
+     * @param fileBytes The contents of imagePath if the caller already read them, or empty.
+     * @return The decoded texture.
+     * @throws std::invalid_argument if imagePath is empty.
+     * @throws std::runtime_error if the file cannot be loaded or decoded.
+     */
+    static DecodedTexture decodeTexture(const std::string& imagePath,
+                                        VkPhysicalDevice physicalDevice,
+                                        const std::vector<uint8_t>& fileBytes = {});
 // --------------------------------------------------------------------------------
     
     /**
@@ -426,35 +665,118 @@ public:
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Reloads the texture image from a new file path.
+     * @brief Retrieves the sampler the texture was created with.
+     */
+    VkSampler getTextureSampler() const { return textureSampler; }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the UploadQueue ticket of the batch that carries the current texture data.
+     *
+     * The texture may be bound as soon as the batch is flushed, since the upload is submitted
+     * ahead of any draw that samples it, but the ticket lets callers wait on the upload explicitly.
+     */
+    uint64_t getUploadTicket() const { return uploadTicket; }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of mip levels in the texture image.
+     */
+    uint32_t getMipLevels() const { return mipLevels; }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the size of the GPU memory allocation backing the texture image.
+     */
+    VkDeviceSize getSizeInBytes() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Builds a replacement texture image from a new file path without disturbing the live one.
+     *
+     * The file is decoded and a new image and image view are created with the upload recorded into
+     * the current UploadQueue batch. The live image, image view and sampler stay untouched, so frames
+     * in flight, and frames recorded before commitReload() swaps the new image in, keep sampling the
+     * old texture. A reload that has not been committed yet is superseded by a later one.
+     * This method may be called from any thread.
+     *
+     * @param newImagePath The file path to the new texture image.
+     * @return A serial identifying this reload, compared against getCommittedReload().
+     * @throws std::runtime_error if the image cannot be decoded or its Vulkan resources cannot be created.
+     */
+    uint64_t reloadTexture(const std::string& newImagePath);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Builds a replacement texture image from data decoded ahead of time.
+     * @see reloadTexture(const std::string&)
+     */
+    uint64_t reloadTexture(const DecodedTexture& decoded);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Makes the pending reload the live texture once its upload has completed.
      *
-     * This method safely releases the resources associated with the current texture, including the
-     * image, image view, and sampler. It then updates the texture path to the specified new image
-     * path and recreates the texture resources using the new image. The reloading process involves
-     * creating a new Vulkan image, transitioning its layout, and copying buffer data for the new texture.
+     * Call at a frame boundary on the render thread, after the fence of the frame about to be
+     * recorded has signaled. The replaced image is pushed to deletionQueue rather than destroyed;
+     * descriptor sets that still reference it must be rewritten before the frames that use them
+     * are recorded.
      *
-     * @param newImagePath The file path to the new texture image to be loaded and used as the texture.
+     * @param deletionQueue The queue that destroys the replaced image once its frames have completed.
+     * @return True if the live image view changed.
+     */
+    bool commitReload(DeletionQueue& deletionQueue);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys superseded reloads whose uploads have completed.
      *
-     * @throws std::runtime_error if any step in the texture creation process fails, such as image loading,
-     *         Vulkan resource allocation, or image transition.
+     * A reload replaced by a later one before it was committed was never bound, so only its own
+     * upload batch can still be writing to it.
      *
-     * @note This function can be used for dynamic texture reloading at runtime. Make sure to call this
-     *       method only when the texture resources are not actively in use in the graphics pipeline.
+     * @return The number of superseded images still waiting for their uploads.
      */
-    void reloadTexture(const std::string& newImagePath);
+    size_t releaseRetired();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the serial of the reload currently live, or 0 for the original image.
+     */
+    uint64_t getCommittedReload() const { return committedReload; }
 // ================================================================================
 private:
     AllocatorManager& allocatorManager;  /**< The memory allocator manager for handling buffer memory. */
     VkDevice device;                     /**< The Vulkan device handle. */
     VkPhysicalDevice physicalDevice; /**< The Vulkan physical device used for querying memory properties. */ 
-    CommandBufferManager& commandBufferManager;  /**< Reference to the command buffer manager. */
-    VkQueue graphicsQueue;/**< The Vulkan graphics queue used for submitting commands. */ 
+    UploadQueue& uploadQueue;  /**< Batched upload queue used to transfer texture data. */
     std::string imagePath; /**< Path to the texture image to be loaded. */ 
 
     VkImage textureImage = VK_NULL_HANDLE ; /**< The Vulkan image object representing the texture. */ 
     VmaAllocation textureImageMemory = VK_NULL_HANDLE ; /**< The memory backing the Vulkan texture image. */ 
     VkImageView textureImageView = VK_NULL_HANDLE;
     VkSampler textureSampler = VK_NULL_HANDLE;
+    uint64_t uploadTicket = 0; /**< UploadQueue ticket of the batch holding the texture data. */
+    uint32_t mipLevels = 1; /**< Number of mip levels in textureImage. */
+    VkFormat textureFormat = VK_FORMAT_R8G8B8A8_SRGB; /**< Format of textureImage, block-compressed when loaded from a container. */
+
+    /**
+     * @brief An image not currently live: either a reload waiting to be committed or a superseded one.
+     */
+    struct ImageVersion {
+        VkImage image = VK_NULL_HANDLE;
+        VmaAllocation memory = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t mipLevels = 1;
+        uint64_t uploadTicket = 0;  /**< Upload batch that writes the image. */
+        uint64_t serial = 0;        /**< reloadTexture() call that produced the image. */
+        std::string path;
+    };
+
+    ImageVersion pendingImage;                /**< Reload waiting for commitReload(); image is null when none. */
+    std::vector<ImageVersion> retiredImages;  /**< Superseded reloads waiting for their uploads to finish. */
+    uint64_t nextReloadSerial = 1;
+    uint64_t committedReload = 0;
 
     std::mutex textureMutex;
 // --------------------------------------------------------------------------------
@@ -462,13 +784,31 @@ private:
     /**
      * @brief Loads the texture image from a file and uploads it to a Vulkan image.
      *
-     * Loads the texture from the specified file, creates a staging buffer for the pixel data, 
-     * and uploads it to a Vulkan image. The texture image is then transitioned to the 
-     * appropriate layout for shader sampling.
+     * Decodes the texture with decodeTexture() before taking textureMutex, then creates the
+     * Vulkan image and queues the pixel data on the UploadQueue. The layout transitions and the copy are recorded into the current
+     * upload batch, so this call does not wait for the GPU.
      */
     void createTextureImage();
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Creates the Vulkan image for decoded data, records its upload and makes it live. The caller must hold textureMutex.
+     */
+    void uploadDecodedTexture(const DecodedTexture& decoded);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates an image and image view for decoded data and records the upload. Touches no member state.
+     */
+    ImageVersion buildImageVersion(const DecodedTexture& decoded);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys the image view and image of a version that is no longer referenced.
+     */
+    void destroyImageVersion(ImageVersion& version);
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Creates a Vulkan image and allocates memory for it.
      *
@@ -477,6 +817,7 @@ private:
      *
      * @param width The width of the image.
      * @param height The height of the image.
+     * @param mipLevels The number of mip levels to allocate.
      * @param format The format of the image (e.g., VK_FORMAT_R8G8B8A8_SRGB).
      * @param tiling The tiling mode of the image (e.g., VK_IMAGE_TILING_OPTIMAL).
      * @param usage The usage flags for the image (e.g., transfer source, sampled image).
@@ -488,87 +829,70 @@ private:
     //                  VkImageTiling tiling, VkImageUsageFlags usage, 
     //                  VkMemoryPropertyFlags properties, VkImage& image, 
     //                  VkDeviceMemory& imageMemory);
-    void createImage(uint32_t width, uint32_t height, VkFormat format, 
+    void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, 
                      VkImageTiling tiling, VkImageUsageFlags usage, 
                      VmaMemoryUsage memoryUsage, VkImage& image, 
                      VmaAllocation& imageMemory);
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Finds the appropriate memory type for a Vulkan resource.
+     * @brief Finds a precompressed container for imagePath whose format the device can sample.
      *
-     * Finds a suitable memory type from the physical device memory properties that 
-     * satisfies the required properties for a Vulkan resource.
+     * If imagePath is itself a KTX2 or DDS file it is returned unchanged. Otherwise the files
+     * <stem>.bc7.ktx2, <stem>.astc.ktx2, <stem>.ktx2 and <stem>.dds are tried in that order and
+     * the first one whose format supports VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT is returned.
      *
-     * @param typeFilter A bitmask of memory types supported by the resource.
-     * @param properties The desired memory properties (e.g., device-local, host-visible).
-     * @return The index of the memory type that matches the required properties.
+     * @return The container path, or an empty string if stb_image should decode imagePath.
+     * @throws std::runtime_error if imagePath is a container whose format the device cannot sample.
      */
-    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+    static std::string findCompressedVariant(const std::string& imagePath, VkPhysicalDevice physicalDevice);
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Begins recording a single-use command buffer for submitting Vulkan commands.
-     *
-     * Allocates and begins recording a command buffer that is intended for single-use operations.
-     * This is typically used for short-lived operations like image transitions and buffer-to-image copies.
-     *
-     * @return The Vulkan command buffer handle.
+     * @brief Returns true if optimal-tiling images of format can be sampled on this device.
      */
-    VkCommandBuffer beginSingleTimeCommands();
-
+    static bool supportsSampledFormat(VkPhysicalDevice physicalDevice, VkFormat format);
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Ends recording and submits the single-use command buffer for execution.
-     *
-     * Ends the recording of a single-use command buffer and submits it to the graphics queue 
-     * for execution. The command buffer is freed after it completes execution.
+     * @brief Checks whether mip levels of the given format can be generated with linear blits.
      *
-     * @param commandBuffer The command buffer to end and submit for execution.
+     * @param physicalDevice The Vulkan physical device to query.
+     * @param format The texture format.
+     * @return True if optimal-tiling images of format support blit source, blit destination and
+     *         linear filtering.
      */
-    void endSingleTimeCommands(VkCommandBuffer commandBuffer);
+    static bool supportsLinearBlit(VkPhysicalDevice physicalDevice, VkFormat format);
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Transitions the image layout to the specified new layout.
+     * @brief Builds a full RGBA8 mip chain on the CPU with a 2x2 box filter.
      *
-     * Transitions a Vulkan image from one layout to another (e.g., from undefined to transfer destination).
-     * This function is used during texture uploads and prepares the image for shader access.
+     * Used when the texture format cannot be blitted with linear filtering. Odd dimensions
+     * clamp the footprint at the right and bottom edges.
      *
-     * @param image The Vulkan image to transition.
-     * @param format The format of the image.
-     * @param oldLayout The current layout of the image.
-     * @param newLayout The desired layout of the image after the transition.
-     */
-    void transitionImageLayout(VkImage image, VkFormat format, 
-                               VkImageLayout oldLayout, VkImageLayout newLayout);
-// --------------------------------------------------------------------------------
-
-    /**
-     * @brief Copies data from a buffer to a Vulkan image.
-     *
-     * Copies pixel data from a staging buffer to the specified Vulkan image.
-     * This function is used during texture uploads to transfer the image data to the GPU.
-     *
-     * @param buffer The Vulkan buffer containing the pixel data.
-     * @param image The Vulkan image to which the data is copied.
-     * @param width The width of the image.
-     * @param height The height of the image.
+     * @param pixels Tightly packed RGBA8 texels of level 0.
+     * @param width The width of level 0.
+     * @param height The height of level 0.
+     * @param mipLevels The number of levels to build, including level 0.
+     * @param levelOffsets Receives the byte offset of each level in the returned chain.
+     * @return The packed mip chain, level 0 first.
      */
-    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
+    static std::vector<uint8_t> buildMipChainRGBA8(const uint8_t* pixels, uint32_t width, uint32_t height,
+                                                   uint32_t mipLevels, std::vector<VkDeviceSize>& levelOffsets);
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Checks if the image format has a stencil component.
+     * @brief Finds the appropriate memory type for a Vulkan resource.
      *
-     * Determines whether a given image format includes a stencil component.
-     * This is useful when transitioning image layouts that involve depth-stencil images.
+     * Finds a suitable memory type from the physical device memory properties that 
+     * satisfies the required properties for a Vulkan resource.
      *
-     * @param format The Vulkan format to check.
-     * @return True if the format includes a stencil component, false otherwise.
+     * @param typeFilter A bitmask of memory types supported by the resource.
+     * @param properties The desired memory properties (e.g., device-local, host-visible).
+     * @return The index of the memory type that matches the required properties.
      */
-    bool hasStencilComponent(VkFormat format);
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 // --------------------------------------------------------------------------------
 
     /**
@@ -588,171 +912,114 @@ private:
      *
      * @param image The Vulkan image for which the image view is created.
      * @param format The format of the image.
+     * @param mipLevels The number of mip levels the view exposes, starting at level 0.
      * @return The created Vulkan image view.
      */
-    VkImageView createImageView(VkImage image, VkFormat format);
-// --------------------------------------------------------------------------------
-
-    /**
-     * @brief Creates a Vulkan image memory barrier for layout transitions.
-     *
-     * Sets up a `VkImageMemoryBarrier` structure for transitioning a Vulkan image from one layout to another.
-     * This helper function encapsulates common settings, allowing you to specify the source and destination
-     * image layouts, format, and image to transition. It simplifies the setup of image layout transitions by
-     * returning a pre-configured `VkImageMemoryBarrier` object that can be used in `vkCmdPipelineBarrier`.
-     *
-     * @param image The Vulkan image to transition.
-     * @param format The format of the image (e.g., VK_FORMAT_R8G8B8A8_SRGB).
-     * @param oldLayout The current layout of the image.
-     * @param newLayout The desired layout of the image after the transition.
-     * @return A configured `VkImageMemoryBarrier` for the specified transition.
-    */
-    VkImageMemoryBarrier createImageMemoryBarrier(VkImage image, VkFormat format, 
-                                                  VkImageLayout oldLayout, VkImageLayout newLayout);
-// --------------------------------------------------------------------------------
-
-    /**
-     * @brief Allocates a single-use Vulkan command buffer.
-     *
-     * This function allocates a primary command buffer from the command pool managed by the
-     * `CommandBufferManager`. The command buffer is intended for short-lived operations and is
-     * typically used for one-time commands such as buffer-to-image copies or layout transitions.
-     * 
-     * The caller is responsible for starting and ending the command buffer recording and freeing
-     * the command buffer after use.
-     *
-     * @return A Vulkan command buffer handle ready for recording.
-     */
-    VkCommandBuffer allocateCommandBuffer();
-// --------------------------------------------------------------------------------
-
-    /**
-     * @brief Submits a single-use command buffer and waits for execution to complete.
-     *
-     * This function is designed to submit a command buffer that performs a single, short-lived operation.
-     * After submission, it waits for the command to complete, making it suitable for one-time commands such as
-     * buffer-to-image copies or image layout transitions. The function frees the command buffer after execution.
-     *
-     * @param commandBuffer The command buffer to submit for execution.
-     */
-    void submitSingleTimeCommandBuffer(VkCommandBuffer commandBuffer);
+    VkImageView createImageView(VkImage image, VkFormat format, uint32_t mipLevels);
 };
 // ================================================================================
 // ================================================================================ 
 
 /**
  * @class BufferManager
- * @brief Manages vertex, index, and uniform buffers for Vulkan rendering.
+ * @brief Manages the ring of per-frame camera uniforms for Vulkan rendering.
  *
- * This class encapsulates the management and allocation of various Vulkan buffers, such as vertex buffers,
- * index buffers, and uniform buffers. It also handles the mapping and updating of uniform buffers for different
- * frames.
+ * Every frame in flight owns one slot of a single persistently mapped uniform buffer. The
+ * slots are spaced by the device's minUniformBufferOffsetAlignment, so one
+ * VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC descriptor reaches any of them through its
+ * dynamic offset. Vertex and index data live in the MeshArena.
  */
 class BufferManager {
 public:
      /**
      * @brief Constructor for BufferManager.
      *
-     * @param vertices A vector of Vertex objects representing the vertex data.
-     * @param indices A vector of 16-bit unsigned integers representing the index data.
      * @param allocatorManager A reference to the AllocatorManager responsible for memory allocation.
-     * @param commandBufferManager A reference to the CommandBufferManager used for command buffer management.
-     * @param graphicsQueue The Vulkan queue used for submitting graphics commands.
+     * @param physicalDevice The physical device whose uniform buffer offset alignment spaces the slots.
+     * @param framesInFlight The number of slots to create, one per frame in flight.
+     * @throws std::runtime_error if the buffer cannot be created.
      */
-    BufferManager(const std::vector<Vertex>& vertices,
-                  const std::vector<uint16_t>& indices,
-                  AllocatorManager& allocatorManager,
-                  CommandBufferManager& commandBufferManager,
-                  VkQueue graphicsQueue);
+    BufferManager(AllocatorManager& allocatorManager,
+                  VkPhysicalDevice physicalDevice,
+                  uint32_t framesInFlight = 2);
 // --------------------------------------------------------------------------------
     
     /**
      * @brief Destructor for BufferManager.
      *
-     * Cleans up all allocated Vulkan buffers and frees any associated memory.
+     * Cleans up the uniform buffer and frees its memory.
      */
     ~BufferManager();
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Updates the uniform buffer with new data for the current frame.
+     * @brief Copies the camera into a frame's slot unless the slot already holds it.
+     *
+     * The slot must not be in use by the GPU, so call this only after the frame's fence
+     * has been waited on.
      *
      * @param currentFrame The index of the current frame.
-     * @param ubo The UniformBufferObject containing the new data to be copied to the uniform buffer.
+     * @param camera The camera uniforms to copy.
+     * @param version Identifies the camera state; equal versions must mean equal uniforms,
+     *        and the copy is skipped if the slot was last written with this version. New
+     *        slots hold version 0, so the first camera should be version 1.
+     * @throws std::out_of_range if currentFrame has no slot.
      */
-    void updateUniformBuffer(uint32_t currentFrame, const UniformBufferObject& ubo);
+    void updateUniformBuffer(uint32_t currentFrame, const CameraUniforms& camera, uint64_t version);
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Retrieves the Vulkan vertex buffer.
-     *
-     * @return The Vulkan buffer used for storing vertex data.
+     * @brief Retrieves the buffer holding every frame's slot.
      */
-    const VkBuffer getVertexBuffer() const;
+    VkBuffer getUniformBuffer() const;
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Retrieves the Vulkan index buffer.
-     *
-     * @return The Vulkan buffer used for storing index data.
+     * @brief Returns the distance in bytes between consecutive slots, which is the
+     * dynamic offset step of the uniform buffer descriptor.
      */
-    const VkBuffer getIndexBuffer() const;
+    VkDeviceSize getUniformSlotSize() const;
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Retrieves the vector of uniform buffers used for each frame.
-     *
-     * @return A reference to the vector of Vulkan uniform buffers.
+     * @brief Returns the number of slots in the ring.
      */
-    const std::vector<VkBuffer>& getUniformBuffers() const;
+    uint32_t getFramesInFlight() const;
 // --------------------------------------------------------------------------------
-    
+
     /**
-     * @brief Retrieves the vector of mapped uniform buffers used for memory access.
+     * @brief Replaces the uniform buffer with one holding a slot per frame of a new frame count.
      *
-     * @return A reference to the vector of void pointers that map the uniform buffers.
+     * The GPU must not be using the current buffer, so call this with the device idle.
+     *
+     * @param framesInFlight The number of slots to create.
+     * @throws std::runtime_error if the new buffer cannot be created.
      */
-    const std::vector<void*>& getUniformBuffersMapped() const;
+    void recreateUniformBuffers(uint32_t framesInFlight);
 // ================================================================================
 private:
-    std::vector<Vertex> vertices;                   /**< The vertex data used for rendering. */
-    std::vector<uint16_t> indices;                  /**< The index data for drawing elements. */
     AllocatorManager& allocatorManager;             /**< The memory allocator manager for handling buffer memory. */
-    CommandBufferManager& commandBufferManager;     /**< Command buffer manager for managing related command buffers. */
-    VkQueue graphicsQueue;                          /**< The Vulkan queue used for submitting graphics commands. */
-
-    VkBuffer vertexBuffer;                          /**< Vulkan buffer for storing vertex data. */
-    VkBuffer indexBuffer;                           /**< Vulkan buffer for storing index data. */
-    VmaAllocation vertexBufferAllocation;           /**< Memory allocation handle for the vertex buffer. */
-    VmaAllocation indexBufferAllocation;            /**< Memory allocation handle for the index buffer. */
+    uint32_t framesInFlight;                        /**< Number of slots in the ring. */
+    VkDeviceSize slotSize = 0;                      /**< sizeof(CameraUniforms) rounded up to the offset alignment. */
 
-    std::vector<VkBuffer> uniformBuffers;           /**< Vector of Vulkan buffers used for uniform data across frames. */
-    std::vector<void*> uniformBuffersMapped;        /**< Vector of pointers that map uniform buffers for direct memory access. */
-    std::vector<VmaAllocation> uniformBuffersMemory;/**< Memory allocation handles for the uniform buffers. */
+    VkBuffer uniformBuffer = VK_NULL_HANDLE;        /**< The buffer holding every slot. */
+    VmaAllocation uniformBufferMemory = VK_NULL_HANDLE; /**< Memory allocation of the uniform buffer. */
+    void* uniformBufferMapped = nullptr;            /**< Persistent mapping of the uniform buffer. */
+    std::vector<uint64_t> slotVersions;             /**< Camera version each slot was last written with. */
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Creates the vertex buffer and allocates memory for it.
+     * @brief Creates and maps the uniform buffer with one slot per frame.
      *
-     * @return True if the vertex buffer was successfully created, false otherwise.
+     * @return True if the uniform buffer was successfully created, false otherwise.
      */
-    bool createVertexBuffer();
-// --------------------------------------------------------------------------------
-
-    /**
-     * @brief Creates the index buffer and allocates memory for it.
-     *
-     * @return True if the index buffer was successfully created, false otherwise.
-     */
-    bool createIndexBuffer();
+    bool createUniformBuffers();
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Creates uniform buffers for each frame in the application.
-     *
-     * @return True if the uniform buffers were successfully created, false otherwise.
+     * @brief Unmaps and destroys the uniform buffer.
      */
-    bool createUniformBuffers();
+    void destroyUniformBuffers();
 };
 // // ================================================================================
 // // ================================================================================ 
@@ -770,8 +1037,11 @@ public:
      * @brief Constructor for DescriptorManager.
      *
      * @param device The Vulkan device handle used for creating descriptor sets and pools.
+     * @param textureBinding Whether the sets carry the combined image sampler at binding 1.
+     *        Bindless rendering samples through a BindlessTextureTable instead and leaves
+     *        the binding out.
      */
-    DescriptorManager(VkDevice device);
+    DescriptorManager(VkDevice device, bool textureBinding = true);
 // --------------------------------------------------------------------------------
 
     /**
@@ -787,19 +1057,47 @@ public:
      *
      * This method allocates and configures descriptor sets for each frame, allowing the shaders
      * to access uniform buffer data and texture sampling resources. The descriptor sets
-     * are configured to include both the uniform buffer and the texture sampler.
+     * are configured to include the camera uniform buffer, the texture sampler unless the
+     * manager was created without a texture binding, and the per-instance storage buffer.
+     * Every set binds the same uniform buffer as a dynamic uniform buffer; each frame selects
+     * its slot with getUniformOffset. Calling this again, with the
+     * device idle, replaces the previous sets, which is how a new frame count is applied.
      * 
-     * @param uniformBuffers A vector of Vulkan buffers that hold the uniform buffer data for each frame.
-     * @param textureImageView The Vulkan image view of the texture to be sampled in the shader.
-     * @param textureSampler The Vulkan sampler used to sample the texture image.
+     * @param uniformBuffer The buffer holding one CameraUniforms slot per frame.
+     * @param uniformSlotSize The distance in bytes between consecutive slots.
+     * @param frameCount The number of frames, and so of sets and slots.
+     * @param instanceBuffers A vector of storage buffers holding each frame's InstanceData records.
+     * @param textureImageView The Vulkan image view of the texture to be sampled in the shader;
+     *        ignored without a texture binding.
+     * @param textureSampler The Vulkan sampler used to sample the texture image; ignored
+     *        without a texture binding.
      * 
      * @throws std::runtime_error if the descriptor sets cannot be allocated or updated.
+     * @throws std::out_of_range if frameCount is zero or more than MAX_FRAMES_IN_FLIGHT, or
+     *         there are fewer instance buffers than frames.
      */ 
-    void createDescriptorSets(const std::vector<VkBuffer> uniformBuffers,
+    void createDescriptorSets(VkBuffer uniformBuffer,
+                              VkDeviceSize uniformSlotSize,
+                              uint32_t frameCount,
+                              const std::vector<VkBuffer>& instanceBuffers,
                               VkImageView textureImageView,
                               VkSampler textureSampler);
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Rewrites the texture binding of one frame's descriptor set.
+     *
+     * The set must not be in use by the GPU, so call this for a frame only after its fence has
+     * been waited on. A texture swap is applied to each frame's set as that frame comes around.
+     *
+     * @param frameIndex The frame whose descriptor set is rewritten.
+     * @param textureImageView The image view to bind.
+     * @param textureSampler The sampler to bind.
+     * @throws std::runtime_error if the manager was created without a texture binding.
+     */
+    void updateTextureDescriptor(uint32_t frameIndex, VkImageView textureImageView, VkSampler textureSampler);
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Retrieves the Vulkan descriptor set layout.
      *
@@ -831,9 +1129,21 @@ public:
      * @return A reference to the Vulkan descriptor set for the given frame.
      */
     const VkDescriptorSet& getDescriptorSet(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the dynamic offset of a frame's camera uniforms, which is passed to
+     * vkCmdBindDescriptorSets along with the frame's set.
+     *
+     * @param frameIndex The index of the frame.
+     * @throws std::out_of_range if frameIndex has no descriptor set.
+     */
+    uint32_t getUniformOffset(uint32_t frameIndex) const;
 // ================================================================================
 private:
     VkDevice device;                                /**< The Vulkan device handle. */
+    bool textureBinding;                            /**< Whether binding 1 holds the texture. */
+    std::vector<uint32_t> uniformOffsets;           /**< Dynamic offset of each frame's camera slot. */
 
     VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;  /**< The layout of the descriptor sets. */
     VkDescriptorPool descriptorPool = VK_NULL_HANDLE;            /**< The descriptor pool for allocating descriptor sets. */
@@ -876,26 +1186,45 @@ public:
      * and building the graphics pipeline.
      *
      * @param device The Vulkan logical device handle.
-     * @param swapChain Reference to the swap chain.
+     * @param colorFormat Format of the images rendered to, the swap chain or offscreen images.
+     * @param colorFinalLayout Layout the render pass leaves the color image in;
+     *        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for a swap chain.
      * @param commandBufferManager Reference to the CommandBufferManager, used for managing command buffers.
-     * @param bufferManager Reference to the BufferManager, which provides vertex and index buffers.
+     * @param meshArena Reference to the MeshArena, which holds the vertex and index data of every mesh.
      * @param descriptorManager Reference to the DescriptorManager, which provides descriptor sets and layouts.
-     * @param indices The index data for rendering.
      * @param physicalDevice The Vulkan physical device handle.
      * @param vertFile The location of the vertice shader file relative to the executable 
      * @param fragFile The location of the fragmentation shader file relative to the executable
      * @param depthManager A reference to a DepthManager instance
+     * @param pipelineCache The pipeline cache shared by every pipeline the application creates
+     * @param scene The scene whose instances are drawn each frame
+     * @param cullingPass The compute pass that culls the scene before it is drawn
+     * @param recordingPool Worker threads that record secondary command buffers; the calling
+     *        thread records one partition itself
+     * @param profiler Writes the GPU timestamps of each recorded frame
+     * @param bindlessTable The texture table bound as set 1, or nullptr to sample the
+     *        texture bound in the DescriptorManager's sets
+     * @param depthVertFile The position-only vertex shader of the depth pre-pass; only
+     *        read when the DepthManager's config enables the pre-pass
+     * @throws std::runtime_error if the pre-pass is enabled without a depthVertFile.
      */
     GraphicsPipeline(VkDevice device,
-                     SwapChain& swapChain,
+                     VkFormat colorFormat,
+                     VkImageLayout colorFinalLayout,
                      CommandBufferManager& commandBufferManager,
-                     BufferManager& bufferManager,
+                     MeshArena& meshArena,
                      DescriptorManager& descirptorManager,
-                     const std::vector<uint16_t>& indices,
                      VkPhysicalDevice physicalDevice,
                      std::string vertFile,
                      std::string fragFile,
-                     DepthManager& depthManager);
+                     DepthManager& depthManager,
+                     PipelineCache& pipelineCache,
+                     Scene& scene,
+                     CullingPass& cullingPass,
+                     ThreadPool& recordingPool,
+                     Profiler& profiler,
+                     BindlessTextureTable* bindlessTable = nullptr,
+                     std::string depthVertFile = "");
  // --------------------------------------------------------------------------------
 
     /**
@@ -910,7 +1239,9 @@ public:
     /**
      * @brief Creates framebuffers for each swap chain image view.
      *
-     * @param swapChainImageViews The image views from the swap chain.
+     * The extent becomes the viewport and render area of every frame recorded afterwards.
+     *
+     * @param swapChainImageViews The image views from the swap chain or offscreen target.
      * @param swapChainExtent The extent of the swap chain, i.e., its width and height.
      */
     void createFrameBuffers(const std::vector<VkImageView>& swapChainImageViews, 
@@ -925,16 +1256,106 @@ public:
     void destroyFramebuffers();
 // --------------------------------------------------------------------------------
 
+    /**
+     * @brief Hands all the framebuffers to a deletion queue instead of destroying them now.
+     *
+     * Used when the swap chain is recreated while frames that render to the old framebuffers
+     * may still be executing.
+     *
+     * @param deletionQueue The queue that destroys the framebuffers once their frames have completed.
+     */
+    void retireFramebuffers(DeletionQueue& deletionQueue);
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Records command buffer for a specific frame and image index.
      *
      * This method records the commands needed to render a frame, including setting up the
-     * render pass, binding the graphics pipeline, and drawing indexed vertex data.
+     * render pass, binding the graphics pipeline, and drawing every scene instance
+     * through the scene's indirect draw list. The culling dispatches are recorded
+     * ahead of the render pass, and timestamps bracket both for the profiler.
+     *
+     * The draw list is split into contiguous partitions, one per recording thread, and
+     * each partition is recorded into that thread's secondary command buffer in parallel.
+     * The primary buffer then runs them with vkCmdExecuteCommands. The frame's command
+     * pools must have been reset with CommandBufferManager::resetCommandPools.
+     *
+     * Culling, drawing and afterRenderPass are recorded as passes of a RenderGraph, which
+     * derives the barriers between the culling outputs, the draws and the host.
      *
      * @param frameIndex The index of the current frame in flight.
      * @param imageIndex The index of the swap chain image being rendered to.
+     * @param afterRenderPass Optional commands recorded into the primary buffer after the
+     *        render pass, such as an offscreen readback.
+     * @param beforeFrame Optional commands recorded first, ahead of culling and drawing,
+     *        such as defragmentation copies of the buffers the frame reads.
      */
-    void recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex);
+    void recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex,
+                             const std::function<void(VkCommandBuffer)>& afterRenderPass = nullptr,
+                             const std::function<void(VkCommandBuffer)>& beforeFrame = nullptr);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Selects the texture and sampler slots pushed to the fragment shader by
+     * every frame recorded afterwards. Only used with a bindless table.
+     *
+     * @param indices Slots of a BindlessTextureTable.
+     */
+    void setBindlessIndices(const BindlessIndices& indices);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Sets the push constants the vertex stage reads with every draw recorded
+     * afterwards.
+     *
+     * @param constants The draw constants, pushed once per secondary command buffer.
+     */
+    void setDrawConstants(const DrawPushConstants& constants);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Shades every frame recorded afterwards with another pair of shaders.
+     *
+     * The variant compiles in the background and frames keep using the default shading
+     * pipeline until it is ready. Call between frames, never while recording.
+     *
+     * @param desc The vertex and fragment shaders of the variant.
+     * @return The variant's id in the pipeline library.
+     */
+    PipelineId selectShading(const PipelineDesc& desc);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns to the shading pipeline built from the constructor's shaders.
+     */
+    void selectDefaultShading();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Swaps in the pipelines that finished compiling and rebuilds those whose
+     * shaders changed on disk.
+     *
+     * Call once per frame after the frame's fence wait and before recording it.
+     *
+     * @param deletionQueue Destroys the replaced pipelines once no frame uses them.
+     * @return The number of pipelines swapped in.
+     */
+    uint32_t updatePipelines(DeletionQueue& deletionQueue);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the library holding every pipeline variant.
+     */
+    PipelineLibrary& getPipelineLibrary();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records the frame graph's barriers with vkCmdPipelineBarrier2 instead of
+     * vkCmdPipelineBarrier.
+     *
+     * @param enabled Whether the device was created with the synchronization2 feature.
+     */
+    void setSynchronization2(bool enabled);
 // --------------------------------------------------------------------------------
 
     /**
@@ -946,11 +1367,11 @@ public:
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Retrieves the Vulkan graphics pipeline.
+     * @brief Retrieves the Vulkan graphics pipeline the next frame shades with.
      *
-     * @return A reference to the Vulkan graphics pipeline.
+     * @return The selected variant, or the default while the variant compiles.
      */
-    const VkPipeline& getPipeline() const;
+    VkPipeline getPipeline() const;
 // --------------------------------------------------------------------------------
 
     /**
@@ -979,20 +1400,35 @@ public:
 // ================================================================================
 private:
     VkDevice device;                          /**< Vulkan logical device handle. */
-    SwapChain& swapChain;                     /**< Reference to the swap chain. */
+    VkImageLayout colorFinalLayout;           /**< Layout of the color image after the render pass. */
+    VkExtent2D extent{0, 0};                  /**< Extent of the current framebuffers. */
     CommandBufferManager& commandBufferManager;/**< Reference to the command buffer manager. */
-    BufferManager& bufferManager;             /**< Reference to the buffer manager. */
+    MeshArena& meshArena;                     /**< Vertex and index buffers of every mesh. */
     DescriptorManager& descriptorManager;     /**< Reference to the descriptor manager. */
-    std::vector<uint16_t> indices;            /**< Index data for rendering. */
     VkPhysicalDevice physicalDevice;          /**< Vulkan physical device handle. */
     std::string vertFile;                     /**< Vertices Shader File. */ 
     std::string fragFile;                     /**< Fragmentation Shader File. */
     DepthManager& depthManager;               /**< Reference to DepthManager instance. */
+    PipelineCache& pipelineCache;             /**< Shared cache passed to pipeline creation. */
+    Scene& scene;                             /**< Instances drawn by recordCommandBuffer. */
+    CullingPass& cullingPass;                 /**< Culls the scene ahead of the render pass. */
+    ThreadPool& recordingPool;                /**< Records secondary command buffers in parallel. */
+    Profiler& profiler;                       /**< Times the culling pass and render pass on the GPU. */
+    BindlessTextureTable* bindlessTable;      /**< Texture table bound as set 1, null without bindless. */
+    BindlessIndices bindlessIndices;          /**< Slots pushed to the fragment shader. */
+    DrawPushConstants drawConstants;          /**< Constants pushed to the vertex shader. */
+
+    std::string depthVertFile;                /**< Vertex shader of the depth pre-pass. */
 
     VkPipelineLayout pipelineLayout;          /**< The Vulkan pipeline layout. */
-    VkPipeline graphicsPipeline;              /**< The Vulkan graphics pipeline. */
+    std::unique_ptr<PipelineLibrary> pipelineLibrary; /**< Compiles and owns every pipeline. */
+    PipelineId defaultShading = 0;            /**< Shading pipeline built from vertFile and fragFile. */
+    PipelineId shadingPipeline = 0;           /**< Shading variant drawn with. */
+    PipelineId depthPipeline = 0;             /**< Position-only pre-pass pipeline, unused without a pre-pass. */
     VkRenderPass renderPass;                  /**< The Vulkan render pass. */
     std::vector<VkFramebuffer> framebuffers;  /**< Framebuffers for each swap chain image. */
+    RenderGraph frameGraph;                   /**< Rebuilt by every recordCommandBuffer call. */
+    bool synchronization2 = false;            /**< Barriers use vkCmdPipelineBarrier2. */
 // --------------------------------------------------------------------------------
 
     /**
@@ -1001,16 +1437,24 @@ private:
      * @param code The SPIR-V bytecode of the shader.
      * @return The created shader module.
      */
-    VkShaderModule createShaderModule(const std::vector<char>& code);
+    VkShaderModule createShaderModule(const std::vector<char>& code) const;
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Reads a file into a vector of characters.
+     * @brief Records one partition of the draw list into a secondary command buffer.
+     *
+     * Safe to call from several threads at once as long as each uses its own buffer.
      *
-     * @param filename The path to the file.
-     * @return The file content as a vector of characters.
+     * @param secondary A secondary buffer from the recording thread's own pool.
+     * @param frameIndex The index of the current frame in flight.
+     * @param imageIndex The index of the swap chain image being rendered to.
+     * @param firstDraw The first draw of the partition.
+     * @param drawCount The number of draws in the partition.
+     * @param depthOnly Records the partition with the pre-pass pipeline instead of the
+     *        shading pipeline.
      */
-    std::vector<char> readFile(const std::string& filename);
+    void recordPartition(VkCommandBuffer secondary, uint32_t frameIndex, uint32_t imageIndex,
+                         uint32_t firstDraw, uint32_t drawCount, bool depthOnly) const;
 // --------------------------------------------------------------------------------
 
     /**
@@ -1026,17 +1470,33 @@ private:
     /**
      * @brief Creates the Vulkan render pass.
      *
-     * @param swapChainImageFormat The format of the swap chain images.
+     * @param colorFormat The format of the color images rendered to.
      */
-    void createRenderPass(VkFormat swapChainImageFormat);
+    void createRenderPass(VkFormat colorFormat);
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Creates the graphics pipeline.
+     * @brief Creates the pipeline layout shared by every pipeline variant.
+     */
+    void createPipelineLayout();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates a pipeline variant; the build function of the pipeline library.
      *
      * Sets up all the pipeline stages, including shaders, input assembly, and rasterization.
-     */
-    void createGraphicsPipeline();
+     * Without fragment code the depth-only pre-pass pipeline is created from the same state,
+     * with only the position attribute and no fragment stage. Only reads state that is
+     * fixed after construction, so compile threads may call it concurrently.
+     *
+     * @param desc The variant being built, used in error messages.
+     * @param vertCode SPIR-V of the vertex shader.
+     * @param fragCode SPIR-V of the fragment shader, empty for the pre-pass.
+     * @return The new pipeline.
+     * @throws std::runtime_error if a shader module or the pipeline cannot be created.
+     */
+    VkPipeline buildPipeline(const PipelineDesc& desc, const std::vector<char>& vertCode,
+                             const std::vector<char>& fragCode) const;
 };
 // ================================================================================
 // ================================================================================
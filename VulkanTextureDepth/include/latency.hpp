@@ -0,0 +1,182 @@
+// ================================================================================
+// ================================================================================
+// - File:    latency.hpp
+// - Purpose: This file contains the latency profiles that choose the number of frames
+//            in flight and the present mode, and the PresentPacer that paces frame
+//            starts with VK_KHR_present_wait.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef latency_HPP
+#define latency_HPP
+
+#include <vulkan/vulkan.h>
+#include <optional>
+#include <string>
+#include <vector>
+#include <cstdint>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @enum LatencyMode
+ * @brief Named trade-offs between input latency and GPU utilization.
+ */
+enum class LatencyMode {
+    LowLatency,  /**< One frame in flight, immediate or mailbox presents, paced by present wait. */
+    Balanced,    /**< Two frames in flight with mailbox presents. */
+    Throughput,  /**< Three frames in flight and a deeper swap chain to keep the GPU busy. */
+    PowerSaver   /**< Relaxed vsync so the GPU idles between refreshes. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct LatencyProfile
+ * @brief The swap chain and frame pacing settings selected by a LatencyMode.
+ */
+struct LatencyProfile {
+    LatencyMode mode = LatencyMode::Balanced;  /**< The mode this profile describes. */
+    std::string name;                          /**< Name accepted by parseMode. */
+    uint32_t framesInFlight = 2;               /**< Frames the CPU may record ahead of the GPU. */
+    std::vector<VkPresentModeKHR> presentModes; /**< Present modes in order of preference. */
+    uint32_t extraSwapImages = 1;              /**< Images requested beyond the surface minimum. */
+    bool presentWait = false;                  /**< Wait for the previous present before starting a frame. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the profile of a latency mode.
+     *
+     * @param mode The mode to look up.
+     * @return The profile of the mode.
+     */
+    static LatencyProfile get(LatencyMode mode);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Parses a latency mode from its profile name.
+     *
+     * Accepts "low-latency", "balanced", "throughput" and "power-saver", with
+     * underscores allowed in place of hyphens.
+     *
+     * @param name The name to parse.
+     * @return The mode, or std::nullopt if the name is unknown.
+     */
+    static std::optional<LatencyMode> parseMode(const std::string& name);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Picks the most preferred present mode the surface supports.
+     *
+     * @param available The present modes the surface reports.
+     * @return The first entry of presentModes that is available, or FIFO, which every
+     *         surface supports.
+     */
+    VkPresentModeKHR choosePresentMode(const std::vector<VkPresentModeKHR>& available) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Picks the swap chain image count within the surface's limits.
+     *
+     * @param capabilities The surface capabilities.
+     * @return minImageCount plus extraSwapImages, clamped to maxImageCount when the
+     *         surface has one.
+     */
+    uint32_t chooseImageCount(const VkSurfaceCapabilitiesKHR& capabilities) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns a readable name for a present mode, for logging.
+     */
+    static const char* presentModeName(VkPresentModeKHR presentMode);
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class PresentPacer
+ * @brief Holds frame starts back until the previous present has reached the display.
+ *
+ * Each present is tagged with an increasing VkPresentIdKHR. With pacing enabled, a new
+ * frame waits on the id of the last present before it samples input, so the CPU never
+ * runs more than one present ahead of the display and the input it reads is as fresh as
+ * possible. Pacing requires VK_KHR_present_id and VK_KHR_present_wait; without them the
+ * pacer does nothing and ids are not attached to presents.
+ */
+class PresentPacer {
+public:
+    /**
+     * @brief Loads vkWaitForPresentKHR if the device enabled present wait.
+     *
+     * @param device The Vulkan logical device.
+     * @param supported True if VK_KHR_present_id and VK_KHR_present_wait were enabled.
+     */
+    PresentPacer(VkDevice device, bool supported);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true if presents can be tagged and waited on.
+     */
+    bool isAvailable() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Turns frame pacing on or off. Presents stay tagged while it is off.
+     */
+    void setEnabled(bool enabled);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true if frame starts are paced.
+     */
+    bool isEnabled() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Waits until the last tagged present of a swap chain has been displayed.
+     *
+     * Returns immediately if pacing is off or nothing has been presented to the current
+     * swap chain yet. A present that has not completed within timeoutNs is not waited on
+     * further, so a hidden or occluded window cannot stall the render loop.
+     *
+     * @param swapChain The swap chain the last present went to.
+     * @param timeoutNs The longest time to wait, in nanoseconds.
+     * @throws std::runtime_error if the wait fails for a reason other than a timeout or
+     *         an out-of-date swap chain.
+     */
+    void waitForLastPresent(VkSwapchainKHR swapChain, uint64_t timeoutNs = 100000000) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Tags the next present with a new id if present ids are available.
+     *
+     * @param presentInfo The present to tag; its pNext chain is extended.
+     * @param presentId Receives the id chain; it must outlive the vkQueuePresentKHR call.
+     */
+    void tagPresent(VkPresentInfoKHR& presentInfo, VkPresentIdKHR& presentId);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Forgets the last present, for use once the swap chain has been replaced.
+     *
+     * Present ids belong to a swap chain, so the new one has no present to wait on yet.
+     */
+    void resetSwapChain();
+// ================================================================================
+private:
+    VkDevice device;                                       /**< The Vulkan logical device. */
+    PFN_vkWaitForPresentKHR waitForPresent = nullptr;      /**< Loaded from the device, or null. */
+    bool enabled = false;                                  /**< Frame starts are paced. */
+    uint64_t nextPresentId = 1;                            /**< Id attached to the next present. */
+    uint64_t lastPresentId = 0;                            /**< Id of the last present, 0 if none. */
+};
+// ================================================================================
+// ================================================================================
+#endif /* latency_HPP */
+// eof
@@ -19,43 +19,291 @@
 
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
+#include <array>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include "deletion_queue.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @enum MemoryCategory
+ * @brief What an allocation holds, used to break memory usage down in the statistics.
+ */
+enum class MemoryCategory : uint32_t {
+    Textures,     /**< Sampled images. */
+    Meshes,       /**< Vertex and index buffers. */
+    Staging,      /**< Host-visible upload sources, including the staging ring. */
+    Attachments,  /**< Render targets such as depth, MSAA color and offscreen images. */
+    Other,        /**< Uniform, instance, indirect and any other buffers. */
+    Count
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Returns the lower-case name of a category, as used in the statistics dump.
+ */
+const char* memoryCategoryName(MemoryCategory category);
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct MemoryCategoryStats
+ * @brief Live allocations of one category.
+ */
+struct MemoryCategoryStats {
+    uint32_t allocations = 0;     /**< Allocations currently alive. */
+    VkDeviceSize bytes = 0;       /**< Bytes of device memory they occupy. */
+    VkDeviceSize peakBytes = 0;   /**< Largest value bytes has reached. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct MemoryStats
+ * @brief A snapshot of the allocator's usage, budget and defragmentation counters.
+ */
+struct MemoryStats {
+    std::array<MemoryCategoryStats, static_cast<size_t>(MemoryCategory::Count)> categories{};
+    VkDeviceSize usage = 0;              /**< Bytes in use over every heap, as the driver reports it. */
+    VkDeviceSize budget = 0;             /**< Bytes the process may use over every heap. */
+    bool budgetFromDriver = false;       /**< VK_EXT_memory_budget supplied the numbers, not heap sizes. */
+    uint64_t overBudgetAllocations = 0;  /**< Allocations that only succeeded past the budget. */
+    uint64_t defragmentationPasses = 0;  /**< Passes that moved at least one allocation. */
+    uint64_t allocationsMoved = 0;       /**< Allocations relocated by defragmentation. */
+    VkDeviceSize bytesMoved = 0;         /**< Bytes copied by defragmentation. */
+    VkDeviceSize bytesFreed = 0;         /**< Device memory released by defragmentation. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct StagingRingStats
+ * @brief Usage counters reported by a StagingRing.
+ */
+struct StagingRingStats {
+    VkDeviceSize capacity = 0;        /**< Size of the ring buffer in bytes. */
+    VkDeviceSize inUse = 0;           /**< Bytes currently reserved by unreleased uploads. */
+    VkDeviceSize highWaterMark = 0;   /**< Largest number of bytes ever reserved at once. */
+    uint64_t stallCount = 0;          /**< Number of times an upload had to wait for space. */
+    uint64_t dedicatedFallbacks = 0;  /**< Number of payloads too large for the ring. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class StagingRing
+ * @brief A persistently mapped, host-visible buffer that is sub-allocated as a ring.
+ *
+ * Space is reserved by advancing a monotonically increasing head and released by advancing
+ * the tail to a mark recorded when the reserving work was submitted. Marks must be released in
+ * the order they were taken, which matches the order in which GPU submissions retire.
+ * An allocation never straddles the end of the buffer; the remainder is skipped instead.
+ */
+class StagingRing {
+public:
+    /**
+     * @brief A region of the ring returned by tryAllocate().
+     */
+    struct Region {
+        VkBuffer buffer = VK_NULL_HANDLE; /**< The ring buffer, used as the copy source. */
+        VkDeviceSize offset = 0;          /**< Byte offset of the region inside buffer. */
+        void* mapped = nullptr;           /**< Host pointer to the start of the region. */
+    };
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates and persistently maps the ring buffer.
+     * @param allocator The VMA allocator that owns the buffer memory.
+     * @param capacity The size of the ring in bytes.
+     * @throws std::runtime_error If the buffer cannot be created or mapped.
+     */
+    StagingRing(VmaAllocator allocator, VkDeviceSize capacity);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys the ring buffer. All GPU work reading from it must have completed.
+     */
+    ~StagingRing();
+// --------------------------------------------------------------------------------
+
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Reserves size bytes aligned to alignment without blocking.
+     * @param size The number of bytes to reserve. Must not exceed getCapacity().
+     * @param alignment The required offset alignment, a power of two.
+     * @param region Receives the reserved region on success.
+     * @return True if the space was reserved, false if the ring is too full.
+     */
+    bool tryAllocate(VkDeviceSize size, VkDeviceSize alignment, Region& region);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Flushes host writes to a region so the device can see them on non-coherent memory.
+     * @param region A region returned by tryAllocate().
+     * @param size The number of bytes written.
+     */
+    void flush(const Region& region, VkDeviceSize size);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns a mark covering everything reserved so far.
+     */
+    uint64_t mark() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Releases every reservation made before mark was taken.
+     * @param mark A value returned by mark().
+     */
+    void release(uint64_t mark);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records that an upload had to wait for space in the ring.
+     */
+    void recordStall();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records that a payload was staged in a dedicated buffer because it exceeds the ring.
+     */
+    void recordDedicatedFallback();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the size of the ring in bytes.
+     */
+    VkDeviceSize getCapacity() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns a snapshot of the ring usage counters.
+     */
+    StagingRingStats getStats() const;
+// ================================================================================
+private:
+    VmaAllocator allocator;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VmaAllocation allocation = VK_NULL_HANDLE;
+    uint8_t* mappedData = nullptr;
+    VkDeviceSize capacity;
+    uint64_t head = 0;                /**< Total bytes ever reserved, including wrap padding. */
+    uint64_t tail = 0;                /**< Total bytes ever released. */
+    StagingRingStats stats;
+    mutable std::mutex ringMutex;
+};
 // ================================================================================
 // ================================================================================
 
 /**
  * @class AllocatorManager
  * @brief Manages Vulkan buffers and memory allocations using the Vulkan Memory Allocator (VMA).
+ *
+ * Every buffer and image is created within the memory budget when possible and tagged with
+ * a MemoryCategory, so getStats() can report usage per category. Allocations whose owner
+ * installs a MoveHandler take part in incremental defragmentation, which runs one pass at
+ * a time across frames.
  */
 class AllocatorManager {
 public:
+    static constexpr VkDeviceSize DEFAULT_STAGING_RING_SIZE = 32 * 1024 * 1024;
+    static constexpr VkDeviceSize DEFAULT_DEFRAGMENTATION_BYTES = 16 * 1024 * 1024; /**< Per pass. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Relocates the resource bound to an allocation during defragmentation.
+     *
+     * Called with the allocation's new memory and the command buffer of the frame being
+     * recorded. To accept the move the handler binds a new buffer or image to destination,
+     * records a copy from the old resource into it followed by the barrier its readers
+     * need, switches every later use to the new resource, retires the old VkBuffer or
+     * VkImage, not its memory, through the deletion queue and returns true. Returning false
+     * leaves the allocation where it is.
+     */
+    using MoveHandler = std::function<bool(VmaAllocation destination, VkCommandBuffer commandBuffer,
+                                           DeletionQueue& deletionQueue)>;
+// --------------------------------------------------------------------------------
+
     /**
      * @brief Constructs the AllocatorManager and initializes the VMA allocator.
      * @param physicalDevice The Vulkan physical device.
      * @param device The Vulkan logical device.
      * @param instance The Vulkan instance.
-     * @throws std::runtime_error If the VMA allocator cannot be created.
+     * @param stagingRingSize The size in bytes of the persistently mapped staging ring.
+     * @param memoryBudget True if VK_EXT_memory_budget is enabled on the device, so VMA
+     *        tracks the budget the driver grants the process instead of the heap sizes.
+     * @throws std::runtime_error If the VMA allocator or the staging ring cannot be created.
      */
-    AllocatorManager(VkPhysicalDevice physicalDevice, VkDevice device, VkInstance instance);
+    AllocatorManager(VkPhysicalDevice physicalDevice, VkDevice device, VkInstance instance,
+                     VkDeviceSize stagingRingSize = DEFAULT_STAGING_RING_SIZE,
+                     bool memoryBudget = false);
 // --------------------------------------------------------------------------------
 
     /**
      * @brief Destructor that cleans up the VMA allocator.
+     *
+     * A defragmentation still in progress is ended; the device must be idle.
      */
     ~AllocatorManager();
 // --------------------------------------------------------------------------------
 
     /**
      * @brief Creates a Vulkan buffer and allocates memory for it using VMA.
+     *
+     * The allocation is first attempted within the memory budget. If that fails it is
+     * retried without the limit, which may page memory out, and counted in
+     * MemoryStats::overBudgetAllocations.
+     *
      * @param size The size of the buffer in bytes.
      * @param usage The usage flags for the buffer (e.g., transfer source, vertex buffer).
      * @param memoryUsage The memory usage type (e.g., VMA_MEMORY_USAGE_GPU_ONLY).
      * @param buffer A reference to the created Vulkan buffer.
      * @param allocation A reference to the VMA allocation for the buffer's memory.
+     * @param category The statistics category the buffer is counted in.
      * @throws std::runtime_error If buffer creation or memory allocation fails.
      */
     void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage,
-                      VkBuffer& buffer, VmaAllocation& allocation);
+                      VkBuffer& buffer, VmaAllocation& allocation,
+                      MemoryCategory category = MemoryCategory::Other);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates a Vulkan image and allocates memory for it using VMA.
+     *
+     * Falls back past the memory budget like createBuffer.
+     *
+     * @param imageInfo The complete image description.
+     * @param memoryUsage The memory usage type (e.g., VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED).
+     * @param image Receives the created image.
+     * @param allocation Receives the VMA allocation for the image's memory.
+     * @param category The statistics category the image is counted in.
+     * @throws std::runtime_error If image creation or memory allocation fails.
+     */
+    void createImage(const VkImageCreateInfo& imageInfo, VmaMemoryUsage memoryUsage,
+                     VkImage& image, VmaAllocation& allocation, MemoryCategory category);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Allocates memory that the caller binds resources to itself, for example several
+     * images aliasing one block.
+     *
+     * Falls back past the memory budget like createBuffer.
+     *
+     * @param requirements Size, alignment and memory types every bound resource accepts.
+     * @param memoryUsage The memory usage type.
+     * @param allocation Receives the VMA allocation.
+     * @param category The statistics category the memory is counted in.
+     * @throws std::runtime_error If memory allocation fails.
+     */
+    void allocateMemory(const VkMemoryRequirements& requirements, VmaMemoryUsage memoryUsage,
+                        VmaAllocation& allocation, MemoryCategory category);
 // --------------------------------------------------------------------------------
 
     /**
@@ -83,16 +331,80 @@ public:
 // --------------------------------------------------------------------------------
 
     /**
-     * @brief Copies data from one buffer to another.
-     * @param srcBuffer The source buffer.
-     * @param dstBuffer The destination buffer.
-     * @param size The size of the data to copy.
-     * @param graphicsQueue The graphics queue to submit the copy command.
-     * @param commandPool The command pool to allocate command buffers from.
-     * @throws std::runtime_error If command buffer allocation or submission fails.
+     * @brief Destroys a Vulkan image and frees its associated memory allocation.
+     * @param image The Vulkan image to destroy.
+     * @param allocation The VMA allocation to free.
+     */
+    void destroyImage(VkImage image, VmaAllocation allocation);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Frees memory made by allocateMemory. Resources bound to it must be destroyed first.
+     * @param allocation The VMA allocation to free.
+     */
+    void freeMemory(VmaAllocation allocation);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Lets defragmentation move an allocation, or stops it from doing so.
+     *
+     * The handler is dropped automatically when the allocation is destroyed.
+     *
+     * @param allocation An allocation made by this manager.
+     * @param handler Relocates the allocation's resource, or an empty function to pin it.
+     */
+    void setMoveHandler(VmaAllocation allocation, MoveHandler handler);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Starts an incremental defragmentation unless one is already running.
+     *
+     * @param maxBytesPerPass The most memory a single pass, and therefore a single frame,
+     *        may copy.
+     * @throws std::runtime_error if VMA cannot start the defragmentation.
+     */
+    void beginDefragmentation(VkDeviceSize maxBytesPerPass = DEFAULT_DEFRAGMENTATION_BYTES);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Runs the next defragmentation pass, if one is due, into a frame's commands.
+     *
+     * Call once per frame on the render thread before anything in the frame reads a movable
+     * resource. Allocations without a MoveHandler are left in place. The pass is completed
+     * through the deletion queue once the frame has finished on the GPU, which frees the old
+     * memory; until then no new pass starts. Does nothing when no defragmentation is running.
+     *
+     * @param commandBuffer The frame's primary command buffer, in the recording state.
+     * @param deletionQueue Completes the pass once the frame's copies have executed.
+     */
+    void defragmentStep(VkCommandBuffer commandBuffer, DeletionQueue& deletionQueue);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true while a defragmentation started by beginDefragmentation runs.
      */
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, 
-                    VkQueue graphicsQueue, VkCommandPool commandPool);
+    bool isDefragmenting() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Tells VMA a new frame started, which refreshes the budget it allocates against.
+     * @param frameNumber A number that increases with every frame.
+     */
+    void setCurrentFrame(uint64_t frameNumber);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns usage per category, the memory budget and defragmentation counters.
+     */
+    MemoryStats getStats() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns VMA's JSON statistics for telemetry.
+     * @param detailed Also lists every allocation and the free ranges between them, which
+     *        shows fragmentation but is much larger.
+     */
+    std::string buildStatsString(bool detailed) const;
 // --------------------------------------------------------------------------------
 
     /**
@@ -100,10 +412,65 @@ public:
      * @return The VMA allocator used by this manager.
      */
     VmaAllocator getAllocator() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the logical device the allocator serves.
+     */
+    VkDevice getDevice() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the staging ring used for transient host-to-device uploads.
+     * @return A reference to the StagingRing owned by this manager.
+     */
+    StagingRing& getStagingRing();
 // ================================================================================
 private:
     VkDevice device;
     VmaAllocator allocator;
+    std::unique_ptr<StagingRing> stagingRing;
+    bool memoryBudget;                        /**< VK_EXT_memory_budget feeds the budget. */
+
+    mutable std::mutex statsMutex;            /**< Guards stats and moveHandlers. */
+    MemoryStats stats;
+    std::unordered_map<VmaAllocation, MoveHandler> moveHandlers;
+
+    // Only touched by beginDefragmentation, defragmentStep and the pass they retire
+    VmaDefragmentationContext defragmentation = VK_NULL_HANDLE;
+    VmaDefragmentationPassMoveInfo pass{};    /**< Moves of the pass awaiting completion. */
+    bool passPending = false;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Tags a new allocation with its category and counts it.
+     */
+    void track(VmaAllocation allocation, MemoryCategory category);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Removes an allocation about to be freed from the counters and move handlers.
+     */
+    void untrack(VmaAllocation allocation);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Adds or removes one allocation of a category and updates the category's peak.
+     */
+    void count(MemoryCategory category, VkDeviceSize bytes, bool add);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Completes the pending pass and ends the defragmentation once nothing is left
+     * to move.
+     */
+    void finishPass();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Ends the defragmentation and adds its totals to the statistics.
+     */
+    void endDefragmentation();
 };
 // ================================================================================
 // ================================================================================
@@ -0,0 +1,212 @@
+// ================================================================================
+// ================================================================================
+// - File:    mesh.hpp
+// - Purpose: This file contains the MeshSource classes that provide vertex and
+//            index data to the device-local mesh buffers in ranges, so large meshes
+//            are uploaded in chunks.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef mesh_HPP
+#define mesh_HPP
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+#include "vertex_format.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class MeshSource
+ * @brief Vertex and index data that can be read in ranges.
+ *
+ * BufferManager copies a source into device-local buffers one chunk at a time, so a mesh
+ * never has to exist as a complete std::vector<Vertex> on the host. Indices are always read
+ * as 32-bit values and narrowed to 16 bits per chunk when the mesh is small enough.
+ */
+class MeshSource {
+public:
+    virtual ~MeshSource() = default;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of vertices in the mesh.
+     */
+    virtual uint32_t getVertexCount() const = 0;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of indices in the mesh.
+     */
+    virtual uint32_t getIndexCount() const = 0;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Copies a range of vertices.
+     *
+     * @param first Index of the first vertex to copy.
+     * @param count Number of vertices to copy; first + count must not exceed the vertex count.
+     * @param out Destination of count vertices.
+     */
+    virtual void readVertices(uint32_t first, uint32_t count, Vertex* out) const = 0;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Copies a range of indices as 32-bit values.
+     *
+     * @param first Position of the first index to copy.
+     * @param count Number of indices to copy; first + count must not exceed the index count.
+     * @param out Destination of count indices.
+     */
+    virtual void readIndices(uint32_t first, uint32_t count, uint32_t* out) const = 0;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the object-space bounding sphere, center in xyz and radius in w.
+     */
+    virtual glm::vec4 getBoundingSphere() const = 0;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the smallest index type that can address every vertex.
+     *
+     * 16-bit indices are used up to 65535 vertices, which leaves 0xFFFF free as the
+     * primitive restart value.
+     *
+     * @param vertexCount Number of vertices in the mesh.
+     * @return VK_INDEX_TYPE_UINT16 or VK_INDEX_TYPE_UINT32.
+     */
+    static VkIndexType selectIndexType(uint32_t vertexCount);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the size in bytes of one index of a type.
+     *
+     * @throws std::runtime_error for index types other than UINT16 and UINT32.
+     */
+    static VkDeviceSize indexSize(VkIndexType indexType);
+// ================================================================================
+protected:
+    /**
+     * @brief Computes a bounding sphere around the center of a position range's bounds.
+     *
+     * @param positions The first vertex position, or nullptr.
+     * @param count Number of positions.
+     * @param stride Bytes between consecutive positions.
+     * @return The sphere, or the unit sphere at the origin if there are no positions.
+     */
+    static glm::vec4 boundPositions(const glm::vec3* positions, size_t count, size_t stride);
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class VectorMeshSource
+ * @brief A MeshSource over vertex and index vectors owned by the caller.
+ *
+ * The vectors are referenced, not copied, and must outlive the source.
+ */
+class VectorMeshSource : public MeshSource {
+public:
+    /**
+     * @brief Wraps a mesh with 16-bit indices.
+     */
+    VectorMeshSource(const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Wraps a mesh with 32-bit indices.
+     */
+    VectorMeshSource(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+// --------------------------------------------------------------------------------
+
+    uint32_t getVertexCount() const override;
+    uint32_t getIndexCount() const override;
+    void readVertices(uint32_t first, uint32_t count, Vertex* out) const override;
+    void readIndices(uint32_t first, uint32_t count, uint32_t* out) const override;
+    glm::vec4 getBoundingSphere() const override;
+// ================================================================================
+private:
+    const std::vector<Vertex>& vertices;
+    const std::vector<uint16_t>* indices16 = nullptr;  /**< Set when the indices are 16-bit. */
+    const std::vector<uint32_t>* indices32 = nullptr;  /**< Set when the indices are 32-bit. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class ObjMesh
+ * @brief A Wavefront OBJ mesh parsed line by line from a stream.
+ *
+ * Only the compact parts of the file are kept on the host: the position and texture
+ * coordinate arrays, one position/texcoord pair per unique vertex and the 32-bit index
+ * list. Vertices are assembled only when readVertices asks for a range, so a large
+ * model is never held as a complete Vertex array. Polygons are triangulated as fans,
+ * normals, groups and materials are ignored, and vertices are colored white.
+ */
+class ObjMesh : public MeshSource {
+public:
+    /**
+     * @brief Parses an OBJ file.
+     *
+     * @param path Path to the file.
+     * @throws std::runtime_error if the file cannot be opened or is malformed.
+     */
+    explicit ObjMesh(const std::string& path);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Parses OBJ data from a stream.
+     *
+     * @param in The stream to read until its end.
+     * @param name Name used in error messages.
+     * @throws std::runtime_error if the data is malformed.
+     */
+    ObjMesh(std::istream& in, const std::string& name);
+// --------------------------------------------------------------------------------
+
+    uint32_t getVertexCount() const override;
+    uint32_t getIndexCount() const override;
+    void readVertices(uint32_t first, uint32_t count, Vertex* out) const override;
+    void readIndices(uint32_t first, uint32_t count, uint32_t* out) const override;
+    glm::vec4 getBoundingSphere() const override;
+// ================================================================================
+private:
+    /**
+     * @struct Corner
+     * @brief The attributes of one unique vertex, as indices into the attribute arrays.
+     */
+    struct Corner {
+        uint32_t position;
+        uint32_t texCoord;   /**< UINT32_MAX if the face gave no texture coordinate. */
+    };
+// --------------------------------------------------------------------------------
+
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texCoords;
+    std::vector<Corner> corners;       /**< One entry per unique vertex. */
+    std::vector<uint32_t> indices;
+    glm::vec4 boundingSphere{0.0f, 0.0f, 0.0f, 1.0f};
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Reads every line of the stream.
+     */
+    void parse(std::istream& in, const std::string& name);
+};
+// ================================================================================
+// ================================================================================
+#endif /* mesh_HPP */
+// eof
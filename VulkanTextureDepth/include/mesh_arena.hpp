@@ -0,0 +1,213 @@
+// ================================================================================
+// ================================================================================
+// - File:    mesh_arena.hpp
+// - Purpose: This file contains the MeshArena class, which sub-allocates the
+//            vertex and index data of every mesh from one large vertex buffer and
+//            one large index buffer.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef mesh_arena_HPP
+#define mesh_arena_HPP
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <cstdint>
+#include "memory.hpp"
+#include "upload.hpp"
+#include "mesh.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct MeshRange
+ * @brief The ranges of the arena buffers that hold one mesh.
+ *
+ * firstIndex and vertexOffset are passed straight to vkCmdDrawIndexed or an indirect
+ * command, since indices are stored relative to the mesh's first vertex.
+ */
+struct MeshRange {
+    VmaVirtualAllocation vertexAllocation = VK_NULL_HANDLE; /**< Range of the vertex block. */
+    VmaVirtualAllocation indexAllocation = VK_NULL_HANDLE;  /**< Range of the index block. */
+    uint32_t vertexCount = 0;     /**< Number of vertices in the mesh. */
+    uint32_t indexCount = 0;      /**< Number of indices in the mesh. */
+    int32_t vertexOffset = 0;     /**< First vertex of the mesh in the vertex buffer. */
+    uint32_t firstIndex = 0;      /**< First index of the mesh in the index buffer. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct MeshArenaStats
+ * @brief Occupancy of the arena, in vertices and indices.
+ */
+struct MeshArenaStats {
+    uint32_t meshCount = 0;          /**< Meshes currently allocated. */
+    VkDeviceSize vertexCapacity = 0; /**< Vertices the vertex buffer can hold. */
+    VkDeviceSize verticesUsed = 0;   /**< Vertices in allocated meshes. */
+    VkDeviceSize indexCapacity = 0;  /**< Indices the index buffer can hold. */
+    VkDeviceSize indicesUsed = 0;    /**< Indices in allocated meshes. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class MeshArena
+ * @brief Device-local vertex and index buffers shared by every mesh.
+ *
+ * Each buffer is managed by a VMA virtual block whose unit is one element, a vertex or an
+ * index, so an allocation's offset is directly the mesh's vertexOffset or firstIndex. The
+ * whole scene is drawn with one vertex and one index buffer binding, which is what the
+ * scene's indirect draw list needs.
+ *
+ * Because vertexOffset is added to every index, 16-bit indices address any vertex of the
+ * arena as long as each mesh on its own has at most 65535 vertices. The arena's index type
+ * is fixed on construction; a 16-bit arena rejects larger meshes.
+ *
+ * Both buffers may be moved by the AllocatorManager's defragmentation once every upload
+ * into them has completed, so getVertexBuffer and getIndexBuffer must be read when a
+ * frame is recorded rather than cached.
+ */
+class MeshArena {
+public:
+    /**
+     * @brief Creates the vertex and index buffers and their virtual blocks.
+     *
+     * @param allocatorManager Allocates the device-local buffers.
+     * @param uploadQueue Carries the mesh data into the buffers.
+     * @param indexType VK_INDEX_TYPE_UINT16 or VK_INDEX_TYPE_UINT32.
+     * @param vertexCapacity Number of vertices the vertex buffer holds.
+     * @param indexCapacity Number of indices the index buffer holds.
+     * @throws std::runtime_error if a buffer or virtual block cannot be created.
+     */
+    MeshArena(AllocatorManager& allocatorManager,
+              UploadQueue& uploadQueue,
+              VkIndexType indexType,
+              uint32_t vertexCapacity = 1024 * 1024,
+              uint32_t indexCapacity = 4 * 1024 * 1024);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys the buffers. Every mesh must have been freed or be unused by the GPU.
+     */
+    ~MeshArena();
+// --------------------------------------------------------------------------------
+
+    MeshArena(const MeshArena&) = delete;
+    MeshArena& operator=(const MeshArena&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Reserves ranges for a mesh and queues its data on the UploadQueue in chunks.
+     *
+     * The data is visible to draws ordered after the upload queue's next flush.
+     *
+     * @param mesh The vertex and index data; it is fully read before this returns.
+     * @return The ranges holding the mesh.
+     * @throws std::runtime_error if the arena is full or the mesh has more vertices than
+     *         the arena's index type can address.
+     */
+    MeshRange allocate(const MeshSource& mesh);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns a mesh's ranges to the arena.
+     *
+     * No submitted frame may still draw the mesh; push the call on the DeletionQueue
+     * when freeing a mesh during rendering.
+     *
+     * @param range A range returned by allocate; it is reset to an empty range.
+     */
+    void free(MeshRange& range);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the buffer holding every mesh's vertices.
+     */
+    VkBuffer getVertexBuffer() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the buffer holding every mesh's indices.
+     */
+    VkBuffer getIndexBuffer() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the type of the indices in the index buffer.
+     */
+    VkIndexType getIndexType() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the arena's occupancy.
+     */
+    MeshArenaStats getStats() const;
+// ================================================================================
+private:
+    static constexpr VkDeviceSize UPLOAD_CHUNK_BYTES = 1024 * 1024; /**< Largest single vertex or index upload. */
+    static constexpr VkBufferUsageFlags VERTEX_USAGE = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                                       VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    static constexpr VkBufferUsageFlags INDEX_USAGE = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                                      VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+
+    AllocatorManager& allocatorManager;
+    UploadQueue& uploadQueue;
+    VkIndexType indexType;
+    uint32_t vertexCapacity;
+    uint32_t indexCapacity;
+    uint32_t meshCount = 0;
+    uint64_t uploadTicket = 0;  /**< Upload batch holding the most recent mesh data. */
+
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;
+    VmaAllocation vertexBufferAllocation = VK_NULL_HANDLE;
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+    VmaAllocation indexBufferAllocation = VK_NULL_HANDLE;
+    VmaVirtualBlock vertexBlock = VK_NULL_HANDLE;  /**< Allocates vertices of vertexBuffer. */
+    VmaVirtualBlock indexBlock = VK_NULL_HANDLE;   /**< Allocates indices of indexBuffer. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Packs a mesh's vertices into GpuVertex and copies them into its range one
+     * chunk at a time.
+     */
+    void uploadVertices(const MeshSource& mesh, const MeshRange& range);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Copies a mesh's indices into its range one chunk at a time, narrowing them
+     * on the host when the arena stores 16-bit indices.
+     */
+    void uploadIndices(const MeshSource& mesh, const MeshRange& range);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Moves one of the arena buffers into new memory for defragmentation.
+     *
+     * Refused while uploads into the arena are pending, since they target the old buffer.
+     *
+     * @param buffer The vertex or index buffer; replaced by the new buffer on success.
+     * @param size The size of the buffer in bytes.
+     * @param usage The usage the buffer was created with.
+     * @param readAccess How draws read the buffer after the copy.
+     * @return True if the copy was recorded and the buffer replaced.
+     */
+    bool moveBuffer(VkBuffer& buffer, VkDeviceSize size, VkBufferUsageFlags usage, VkAccessFlags readAccess,
+                    VmaAllocation destination, VkCommandBuffer commandBuffer, DeletionQueue& deletionQueue);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys everything the constructor made; safe on a partial construction.
+     */
+    void destroy();
+};
+// ================================================================================
+// ================================================================================
+#endif /* mesh_arena_HPP */
+// eof
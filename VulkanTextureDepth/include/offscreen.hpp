@@ -0,0 +1,209 @@
+// ================================================================================
+// ================================================================================
+// - File:    offscreen.hpp
+// - Purpose: This file contains the OffscreenTarget class, which replaces the swap
+//            chain when rendering headless, and the optional pipelined readback of
+//            the rendered frames.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef offscreen_HPP
+#define offscreen_HPP
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <vector>
+#include "memory.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct HeadlessConfig
+ * @brief Settings of a VulkanApplication that renders without a window.
+ */
+struct HeadlessConfig {
+    VkExtent2D extent{1200, 1050};               /**< Size of the rendered images. */
+    VkFormat colorFormat = VK_FORMAT_R8G8B8A8_SRGB; /**< Format of the color images. */
+    bool readback = false;                       /**< Copy every frame back to host memory. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct ReadbackFrame
+ * @brief A rendered frame that has been copied to host memory.
+ *
+ * The pixels are tightly packed rows of four bytes per pixel and are only valid for
+ * the duration of the readback callback.
+ */
+struct ReadbackFrame {
+    uint64_t frame = 0;               /**< Number of the frame, counted from the first frame. */
+    VkExtent2D extent{0, 0};          /**< Size of the image in pixels. */
+    VkFormat format = VK_FORMAT_UNDEFINED; /**< Format of the pixels. */
+    const uint8_t* pixels = nullptr;  /**< First byte of the top row. */
+    size_t rowPitch = 0;              /**< Bytes between the starts of consecutive rows. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class OffscreenTarget
+ * @brief VMA-allocated color images that a headless renderer draws into instead of a swap chain.
+ *
+ * There is one color image per frame slot, so a frame never draws into an image that an
+ * earlier frame still in flight is using, and no acquire or present is needed. The render
+ * pass leaves the images in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL.
+ *
+ * With readback enabled, each frame's command buffer ends with a copy of its image into a
+ * persistently mapped host buffer owned by the same slot. The copy is handed to the readback
+ * callback once the slot's fence has been waited on, the next time the slot is used, so
+ * reading frames back never stalls the GPU or waits on the frame just submitted.
+ */
+class OffscreenTarget {
+public:
+    /**
+     * @brief Creates the color images and, if requested, their readback buffers.
+     *
+     * @param allocatorManager Allocates the images and buffers.
+     * @param device The Vulkan logical device.
+     * @param extent Size of the images.
+     * @param format Four-byte color format of the images.
+     * @param imageCount Number of images, one per frame slot.
+     * @param readback Create a readback buffer per image.
+     * @throws std::runtime_error if an image, view or buffer cannot be created.
+     */
+    OffscreenTarget(AllocatorManager& allocatorManager, VkDevice device, VkExtent2D extent,
+                    VkFormat format, uint32_t imageCount, bool readback);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys the images, views and readback buffers.
+     */
+    ~OffscreenTarget();
+// --------------------------------------------------------------------------------
+
+    OffscreenTarget(const OffscreenTarget&) = delete;
+    OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the size of the images.
+     */
+    VkExtent2D getExtent() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the format of the images.
+     */
+    VkFormat getFormat() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the view of every image, indexed by frame slot.
+     */
+    const std::vector<VkImageView>& getImageViews() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true if frames are copied back to host memory.
+     */
+    bool hasReadback() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Sets the function that receives each frame read back.
+     *
+     * Called on the render thread; the frame's pixels must be copied if they are kept.
+     */
+    void setReadbackCallback(std::function<void(const ReadbackFrame&)> callback);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records the copy of an image into its readback buffer.
+     *
+     * Does nothing without readback. Record after the render pass has ended.
+     *
+     * @param commandBuffer The frame's primary command buffer.
+     * @param imageIndex The image the frame rendered to.
+     * @param frame Number of the frame, passed on to the callback.
+     */
+    void recordReadback(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint64_t frame);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Hands the last frame copied from an image to the readback callback.
+     *
+     * Call once the fence of the frame that rendered to the image has been waited on.
+     * Does nothing if no copy of the image is pending.
+     *
+     * @param imageIndex The image whose frame has completed.
+     */
+    void resolveReadback(uint32_t imageIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes a frame as a binary PPM image, dropping the alpha channel.
+     *
+     * @param out The stream to write to; it should be opened in binary mode.
+     * @param frame The frame to write.
+     * @throws std::runtime_error if the frame is not in an RGBA8 or BGRA8 format.
+     */
+    static void writePpm(std::ostream& out, const ReadbackFrame& frame);
+// ================================================================================
+private:
+    /**
+     * @struct Image
+     * @brief One color image and its readback buffer.
+     */
+    struct Image {
+        VkImage image = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkBuffer readbackBuffer = VK_NULL_HANDLE;
+        VmaAllocation readbackAllocation = VK_NULL_HANDLE;
+        uint8_t* mapped = nullptr;        /**< Persistently mapped readback buffer. */
+        bool pending = false;             /**< A copy has been recorded and not yet resolved. */
+        uint64_t frame = 0;               /**< Frame whose copy is pending. */
+    };
+// --------------------------------------------------------------------------------
+
+    AllocatorManager& allocatorManager;
+    VkDevice device;
+    VkExtent2D extent;
+    VkFormat format;
+    bool readback;
+    std::vector<Image> images;
+    std::vector<VkImageView> imageViews;  /**< Views of images, for framebuffer creation. */
+    std::function<void(const ReadbackFrame&)> readbackCallback;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the size in bytes of one image's pixels.
+     */
+    VkDeviceSize getImageBytes() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates the images, views and readback buffers.
+     */
+    void createImages(uint32_t imageCount);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys everything createImages made; safe on a partial creation.
+     */
+    void destroy();
+};
+// ================================================================================
+// ================================================================================
+#endif /* offscreen_HPP */
+// eof
@@ -0,0 +1,117 @@
+// ================================================================================
+// ================================================================================
+// - File:    pipeline_cache.hpp
+// - Purpose: This file contains a VkPipelineCache wrapper that is persisted to disk
+//            between runs and validated against the current physical device.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef pipeline_cache_HPP
+#define pipeline_cache_HPP
+
+#include <vulkan/vulkan.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class PipelineCache
+ * @brief Owns the VkPipelineCache shared by every pipeline and persists it across runs.
+ *
+ * The cache file is loaded at construction and only used if its VkPipelineCacheHeaderVersionOne
+ * header matches the vendorID, deviceID and pipelineCacheUUID of the current device; a file
+ * written by another GPU or driver version is discarded and the cache starts empty. The cache
+ * is written back by save(), which the destructor also calls.
+ */
+class PipelineCache {
+public:
+    /**
+     * @brief Creates the pipeline cache, seeded from cachePath when the file is valid.
+     *
+     * @param device The Vulkan logical device.
+     * @param physicalDevice The Vulkan physical device the cache data must match.
+     * @param cachePath File the cache is loaded from and saved to.
+     * @throws std::runtime_error if the pipeline cache cannot be created.
+     */
+    PipelineCache(VkDevice device, VkPhysicalDevice physicalDevice,
+                  const std::string& cachePath = "pipeline_cache.bin");
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Saves the cache to disk and destroys it.
+     */
+    ~PipelineCache();
+// --------------------------------------------------------------------------------
+
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the VkPipelineCache to pass to vkCreate*Pipelines.
+     */
+    VkPipelineCache getCache() const { return pipelineCache; }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes the current cache contents to disk.
+     *
+     * The data is written to a temporary file that then replaces the cache file, so an
+     * interrupted save never leaves a truncated cache behind.
+     *
+     * @return True if the file was written.
+     */
+    bool save() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true if the cache was seeded from a valid file on disk.
+     */
+    bool wasLoadedFromDisk() const { return loadedFromDisk; }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Adds time spent inside pipeline creation calls that used this cache.
+     */
+    void recordCreationTime(std::chrono::nanoseconds duration);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the total time spent creating pipelines, in milliseconds.
+     */
+    double getCreationMilliseconds() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks whether serialized cache data was produced for the given device.
+     *
+     * @param data The cache file contents.
+     * @param properties Properties of the device the data will be used with.
+     * @return True if the header is complete and matches the vendor, device and cache UUID.
+     */
+    static bool validateHeader(const std::vector<uint8_t>& data, const VkPhysicalDeviceProperties& properties);
+// ================================================================================
+private:
+    VkDevice device;
+    std::string cachePath;
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    bool loadedFromDisk = false;
+
+    std::chrono::nanoseconds creationTime{0};
+    mutable std::mutex timeMutex;
+};
+// ================================================================================
+// ================================================================================
+#endif /* pipeline_cache_HPP */
+// eof
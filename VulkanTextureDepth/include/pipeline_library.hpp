@@ -0,0 +1,279 @@
+// ================================================================================
+// ================================================================================
+// - File:    pipeline_library.hpp
+// - Purpose: This file contains the PipelineLibrary class, which compiles pipeline
+//            variants on background threads and swaps them in at frame boundaries,
+//            and the ShaderWatcher that triggers rebuilds when SPIR-V files change.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef pipeline_library_HPP
+#define pipeline_library_HPP
+
+#include <vulkan/vulkan.h>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "deletion_queue.hpp"
+#include "thread_pool.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class ShaderWatcher
+ * @brief Reports files whose modification time has changed since they were last seen.
+ *
+ * A change is only reported once the file has kept its new time for one whole poll, so a
+ * file that a shader compiler is still writing is not read half-finished.
+ */
+class ShaderWatcher {
+public:
+    /**
+     * @brief Starts watching a file; its current state counts as already seen.
+     *
+     * Watching a file twice has no effect. A missing file is reported once it appears.
+     *
+     * @param path Path to the file.
+     */
+    void watch(const std::string& path);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks every watched file.
+     *
+     * @return The files whose change has settled since the previous call.
+     */
+    std::vector<std::string> poll();
+// ================================================================================
+private:
+    /**
+     * @struct WatchedFile
+     * @brief The last reported and the last observed state of a file.
+     */
+    struct WatchedFile {
+        std::filesystem::file_time_type reported{};   /**< Time of the last reported version. */
+        std::filesystem::file_time_type observed{};   /**< Time seen by the previous poll. */
+        bool exists = false;                          /**< Whether the reported version exists. */
+    };
+// --------------------------------------------------------------------------------
+
+    std::unordered_map<std::string, WatchedFile> files;
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct PipelineDesc
+ * @brief The shaders of one pipeline variant; every fixed-function state comes from the
+ * library's build function.
+ */
+struct PipelineDesc {
+    std::string vertFile;   /**< SPIR-V vertex shader. */
+    std::string fragFile;   /**< SPIR-V fragment shader, empty for a depth-only pipeline. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Identifies a pipeline variant of a PipelineLibrary.
+ */
+using PipelineId = uint32_t;
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class PipelineLibrary
+ * @brief Owns a set of pipeline variants and compiles them without stalling the render loop.
+ *
+ * Defaults are compiled synchronously with createNow, so there is always a pipeline to
+ * draw with. Further variants are queued with request and compiled on the library's own
+ * worker threads, which share the persisted VkPipelineCache through the build function;
+ * until a variant is ready, get returns its fallback.
+ *
+ * Every shader a variant reads is watched. When one changes on disk, for example after
+ * the shader build re-runs glslangValidator, every variant using it is recompiled in the
+ * background while the old pipeline keeps drawing. A rebuild that fails is reported and
+ * the old pipeline is kept.
+ *
+ * Finished compiles are only published by beginFrame, so a recorded frame never sees a
+ * pipeline change halfway. request, createNow and beginFrame must be called from the
+ * render thread outside command recording; get may be called from any recording thread.
+ */
+class PipelineLibrary {
+public:
+    /**
+     * @brief Creates a pipeline from a variant's SPIR-V code; may run on several threads at
+     * once. The fragment code is empty for a depth-only variant.
+     *
+     * @throws std::runtime_error if the pipeline cannot be created.
+     */
+    using BuildFunction = std::function<VkPipeline(const PipelineDesc& desc,
+                                                   const std::vector<char>& vertCode,
+                                                   const std::vector<char>& fragCode)>;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Starts the compile threads.
+     *
+     * @param device The Vulkan logical device that owns the pipelines.
+     * @param build Creates a pipeline from shader code.
+     * @param threadCount Number of compile threads.
+     * @param pollInterval Time between checks of the watched shader files.
+     */
+    PipelineLibrary(VkDevice device, BuildFunction build, size_t threadCount = 2,
+                    std::chrono::milliseconds pollInterval = std::chrono::milliseconds(500));
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Waits for running compiles, discards queued ones and destroys every pipeline.
+     *
+     * No submitted frame may still use the pipelines.
+     */
+    ~PipelineLibrary();
+// --------------------------------------------------------------------------------
+
+    PipelineLibrary(const PipelineLibrary&) = delete;
+    PipelineLibrary& operator=(const PipelineLibrary&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Compiles a variant on the calling thread.
+     *
+     * @param desc The variant's shaders.
+     * @return The variant, ready to draw with.
+     * @throws std::runtime_error if a shader cannot be read or the pipeline cannot be created.
+     */
+    PipelineId createNow(const PipelineDesc& desc);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Queues a variant for compilation in the background.
+     *
+     * @param desc The variant's shaders.
+     * @param fallback A variant get returns until this one is ready, or forever if its
+     *        compile fails.
+     * @return The variant.
+     */
+    PipelineId request(const PipelineDesc& desc, PipelineId fallback);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns a variant's pipeline, or its fallback's while it is not ready.
+     */
+    VkPipeline get(PipelineId id) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true once a variant has a pipeline of its own.
+     */
+    bool isReady(PipelineId id) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Publishes the compiles finished since the last frame and queues rebuilds of
+     * variants whose shaders changed.
+     *
+     * Call once per frame, before recording. Replaced pipelines are destroyed by the
+     * deletion queue once the frames drawing with them have completed.
+     *
+     * @param deletionQueue Destroys the replaced pipelines.
+     * @return The number of pipelines published.
+     */
+    uint32_t beginFrame(DeletionQueue& deletionQueue);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of compiles queued or running.
+     */
+    uint32_t pendingCompiles() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks that a buffer looks like a SPIR-V module: a whole number of words, a
+     * complete header and the SPIR-V magic number.
+     */
+    static bool isSpirv(const std::vector<char>& code);
+// ================================================================================
+private:
+    /**
+     * @struct Variant
+     * @brief A variant and the pipeline it currently draws with. Only the render thread
+     * changes these.
+     */
+    struct Variant {
+        PipelineDesc desc;
+        PipelineId fallback = 0;
+        VkPipeline pipeline = VK_NULL_HANDLE;  /**< Null until the first compile finishes. */
+        uint64_t requested = 0;                /**< Generation of the newest queued compile. */
+    };
+// --------------------------------------------------------------------------------
+
+    /**
+     * @struct Compile
+     * @brief The result of a background compile, waiting for beginFrame.
+     */
+    struct Compile {
+        PipelineId id = 0;
+        uint64_t generation = 0;
+        VkPipeline pipeline = VK_NULL_HANDLE;  /**< Null if the compile failed. */
+        std::string error;
+    };
+// --------------------------------------------------------------------------------
+
+    VkDevice device;
+    BuildFunction build;
+    std::chrono::milliseconds pollInterval;
+    std::chrono::steady_clock::time_point lastPoll;
+
+    std::vector<Variant> variants;
+    ShaderWatcher watcher;
+    uint32_t compilesInFlight = 0;
+
+    mutable std::mutex completedMutex;     /**< Guards completed. */
+    std::vector<Compile> completed;        /**< Compiles finished by the workers. */
+    std::unique_ptr<ThreadPool> compilePool;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Reads the variant's shaders and creates its pipeline.
+     *
+     * @throws std::runtime_error if a shader is missing or not SPIR-V, or creation fails.
+     */
+    VkPipeline compile(const PipelineDesc& desc) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Queues a new generation of a variant's compile.
+     */
+    void queueCompile(PipelineId id);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Watches the shaders of a variant.
+     */
+    void watchShaders(const PipelineDesc& desc);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Reads a SPIR-V file.
+     *
+     * @throws std::runtime_error if the file cannot be read or is not SPIR-V.
+     */
+    static std::vector<char> readSpirv(const std::string& path);
+};
+// ================================================================================
+// ================================================================================
+#endif /* pipeline_library_HPP */
+// eof
@@ -0,0 +1,373 @@
+// ================================================================================
+// ================================================================================
+// - File:    profiler.hpp
+// - Purpose: This file contains the Profiler class, which times each stage of a frame
+//            on the CPU and the GPU and keeps a history of per-frame records.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef profiler_HPP
+#define profiler_HPP
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @enum CpuScope
+ * @brief The stages of VulkanApplication::drawFrame that are timed on the CPU.
+ */
+enum class CpuScope : uint32_t {
+    FenceWait,      /**< Waiting for the frame slot's fence. */
+    Acquire,        /**< vkAcquireNextImageKHR. */
+    UniformUpdate,  /**< Writing the uniform buffer and scene draw list. */
+    Record,         /**< Recording the primary and secondary command buffers. */
+    Submit,         /**< vkQueueSubmit. */
+    Present,        /**< vkQueuePresentKHR. */
+    Count
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @enum GpuTimestamp
+ * @brief The points in a frame's command buffer where timestamps are written.
+ */
+enum class GpuTimestamp : uint32_t {
+    FrameBegin,  /**< Start of the command buffer, before the culling pass. */
+    CullingEnd,  /**< After the culling dispatches, before the render pass. */
+    FrameEnd,    /**< After the render pass. */
+    Count
+};
+// --------------------------------------------------------------------------------
+
+static constexpr size_t CPU_SCOPE_COUNT = static_cast<size_t>(CpuScope::Count);
+static constexpr size_t GPU_TIMESTAMP_COUNT = static_cast<size_t>(GpuTimestamp::Count);
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct FrameTiming
+ * @brief The timings of one frame, in milliseconds.
+ */
+struct FrameTiming {
+    uint64_t frame = 0;                              /**< Frame number, counted from the first frame. */
+    double startMs = 0.0;                            /**< CPU frame start since the profiler was created. */
+    double cpuFrameMs = 0.0;                         /**< CPU time from frame start to the end of present. */
+    std::array<double, CPU_SCOPE_COUNT> scopeStartMs{}; /**< Start of each CPU scope relative to startMs. */
+    std::array<double, CPU_SCOPE_COUNT> scopeMs{};   /**< Duration of each CPU scope. */
+    bool gpuValid = false;                           /**< The GPU fields hold measured values. */
+    double gpuCullingMs = 0.0;                       /**< GPU time spent in the culling pass. */
+    double gpuRenderMs = 0.0;                        /**< GPU time spent in the render pass. */
+    double gpuFrameMs = 0.0;                         /**< GPU time for the whole command buffer. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct FrameSummary
+ * @brief Averages over the most recent frames, used for the on-screen readout.
+ */
+struct FrameSummary {
+    size_t frames = 0;          /**< Number of frames summarized. */
+    double framesPerSecond = 0.0; /**< Frames per second over the summarized span. */
+    double cpuMs = 0.0;         /**< Mean CPU frame time. */
+    double gpuMs = 0.0;         /**< Mean GPU frame time over frames with GPU results. */
+    double worstMs = 0.0;       /**< Longest frame-to-frame interval, the size of the worst hitch. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class FrameTimingRing
+ * @brief A fixed-capacity history of frame records with one writer and any number of readers.
+ *
+ * The render thread pushes records without taking a lock; older records are overwritten
+ * once the ring is full. Each slot carries a sequence number that is odd while the slot is
+ * being written, so a reader on another thread copies a slot and keeps it only if the
+ * sequence was even and unchanged across the copy.
+ */
+class FrameTimingRing {
+public:
+    /**
+     * @brief Creates an empty ring.
+     *
+     * @param capacity Number of records kept before the oldest is overwritten.
+     */
+    explicit FrameTimingRing(size_t capacity);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Appends a record, overwriting the oldest if the ring is full.
+     *
+     * Must only be called from one thread at a time.
+     */
+    void push(const FrameTiming& timing);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Copies the records currently held, oldest first.
+     *
+     * Safe to call from any thread while push runs; a record overwritten during the copy
+     * is skipped.
+     */
+    std::vector<FrameTiming> snapshot() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of records pushed since the ring was created.
+     */
+    uint64_t getPushCount() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of records the ring holds when full.
+     */
+    size_t getCapacity() const;
+// ================================================================================
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};  /**< 2n + 1 while record n is written, 2n + 2 after. */
+        FrameTiming timing;
+    };
+// --------------------------------------------------------------------------------
+
+    size_t capacity;                 /**< Number of slots. */
+    std::unique_ptr<Slot[]> slots;   /**< Ring storage. */
+    std::atomic<uint64_t> head{0};   /**< Number of records pushed. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class Profiler
+ * @brief Times the CPU stages of each frame and the GPU work of its command buffer.
+ *
+ * CPU stages are bracketed with beginScope and endScope, or a ProfileScope, on the render
+ * thread. GPU time is measured with timestamp queries written into each frame's command
+ * buffer; a frame's queries are read once its fence has been waited on, when the results
+ * are guaranteed to be available, so the profiler never stalls the CPU on the GPU. Each
+ * completed frame is then pushed into a FrameTimingRing that can be summarized, written as
+ * CSV or written as a Chrome trace.
+ *
+ * GPU timing is disabled on queue families without timestamp support; CPU timing always
+ * works.
+ */
+class Profiler {
+public:
+    /**
+     * @brief Creates the timestamp query pool.
+     *
+     * @param device The Vulkan logical device.
+     * @param physicalDevice The physical device, for timestamp period and valid bits.
+     * @param queueFamily The queue family the timed command buffers are submitted to.
+     * @param frameSlots Number of frame slots that may be in flight; one query range each.
+     * @param historySize Number of completed frames kept in the ring.
+     * @throws std::runtime_error if the query pool cannot be created.
+     */
+    Profiler(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamily,
+             uint32_t frameSlots, size_t historySize = 1024);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys the query pool.
+     */
+    ~Profiler();
+// --------------------------------------------------------------------------------
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true if GPU timestamps are recorded.
+     */
+    bool hasGpuTimestamps() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Starts timing a frame on the CPU.
+     *
+     * @param frameIndex The frame slot the frame is recorded into.
+     */
+    void beginFrame(uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Marks the start of a CPU scope in the current frame.
+     */
+    void beginScope(CpuScope scope);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Marks the end of a CPU scope in the current frame.
+     */
+    void endScope(CpuScope scope);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Publishes the frame that last used a slot, now that its fence has been waited on.
+     *
+     * Reads the slot's timestamp queries into that frame's record and pushes it into the
+     * history. Does nothing if the slot has no submitted frame.
+     *
+     * @param frameIndex The frame slot whose fence was just waited on.
+     */
+    void resolveFrame(uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Finishes the CPU timing of the current frame after it has been presented.
+     *
+     * The record is held until resolveFrame reads its GPU results, or pushed immediately
+     * when GPU timestamps are unavailable.
+     */
+    void endFrame();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Resets a slot's queries; record before any other command that is timed.
+     *
+     * @param commandBuffer The frame's primary command buffer, outside a render pass.
+     * @param frameIndex The frame slot being recorded.
+     */
+    void resetQueries(VkCommandBuffer commandBuffer, uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes one of a frame's timestamps.
+     *
+     * @param commandBuffer The frame's primary command buffer.
+     * @param frameIndex The frame slot being recorded.
+     * @param timestamp Which timestamp is written.
+     * @param stage The pipeline stage the timestamp waits for.
+     */
+    void writeTimestamp(VkCommandBuffer commandBuffer, uint32_t frameIndex,
+                        GpuTimestamp timestamp, VkPipelineStageFlagBits stage) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the history of completed frames.
+     */
+    const FrameTimingRing& getHistory() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Summarizes the most recent completed frames.
+     *
+     * @param frames The number of recent frames to include.
+     */
+    FrameSummary summarize(size_t frames) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Summarizes a list of records.
+     *
+     * @param timings The frames to summarize, oldest first.
+     */
+    static FrameSummary summarize(const std::vector<FrameTiming>& timings);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes one CSV row per frame, with a header row.
+     */
+    static void writeCsv(std::ostream& out, const std::vector<FrameTiming>& timings);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes frames in the Chrome trace event format for chrome://tracing or Perfetto.
+     *
+     * CPU scopes are placed on thread 1 at their measured times. GPU work has its own
+     * clock, so each frame's GPU events go on thread 2 starting at the frame's submit.
+     */
+    static void writeChromeTrace(std::ostream& out, const std::vector<FrameTiming>& timings);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Converts the interval between two raw timestamps to milliseconds.
+     *
+     * @param begin The earlier timestamp.
+     * @param end The later timestamp.
+     * @param timestampPeriod Nanoseconds per timestamp tick.
+     * @param validBits Number of meaningful low bits; the counter wraps at 2^validBits.
+     */
+    static double ticksToMilliseconds(uint64_t begin, uint64_t end, float timestampPeriod, uint32_t validBits);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the display name of a CPU scope.
+     */
+    static const char* scopeName(CpuScope scope);
+// ================================================================================
+private:
+    using Clock = std::chrono::steady_clock;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @struct PendingFrame
+     * @brief A frame whose CPU timing is done and whose GPU results are not yet read.
+     */
+    struct PendingFrame {
+        FrameTiming timing;
+        bool submitted = false;
+    };
+// --------------------------------------------------------------------------------
+
+    VkDevice device;                          /**< The Vulkan logical device. */
+    VkQueryPool queryPool = VK_NULL_HANDLE;   /**< GPU_TIMESTAMP_COUNT queries per frame slot. */
+    float timestampPeriod = 1.0f;             /**< Nanoseconds per timestamp tick. */
+    uint32_t timestampValidBits = 0;          /**< 0 if the queue family has no timestamps. */
+
+    Clock::time_point origin;                 /**< Time all startMs values are measured from. */
+    Clock::time_point frameStart;             /**< Start of the current frame. */
+    std::array<Clock::time_point, CPU_SCOPE_COUNT> scopeBegin{}; /**< Start of each open scope. */
+    uint32_t currentSlot = 0;                 /**< Slot of the current frame. */
+    uint64_t frameCounter = 0;                /**< Number of the current frame. */
+    FrameTiming current;                      /**< The frame being timed. */
+    std::vector<PendingFrame> pending;        /**< Frames awaiting GPU results, by slot. */
+    FrameTimingRing history;                  /**< Completed frames. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the milliseconds between two points on the CPU clock.
+     */
+    static double millisecondsBetween(Clock::time_point begin, Clock::time_point end);
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class ProfileScope
+ * @brief Times a CPU scope for the lifetime of the object.
+ */
+class ProfileScope {
+public:
+    ProfileScope(Profiler& profiler, CpuScope scope) : profiler(profiler), scope(scope) {
+        profiler.beginScope(scope);
+    }
+    ~ProfileScope() { profiler.endScope(scope); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+// ================================================================================
+private:
+    Profiler& profiler;
+    CpuScope scope;
+};
+// ================================================================================
+// ================================================================================
+#endif /* profiler_HPP */
+// eof
@@ -25,7 +25,9 @@
  * @brief Represents the indices of queue families for a Vulkan physical device.
  *
  * This struct is used to store the indices of the queue families that support
- * graphics and presentation operations for a Vulkan physical device.
+ * graphics and presentation operations for a Vulkan physical device, along with
+ * the optional dedicated transfer and async-compute families when the device
+ * exposes them.
  */
 struct QueueFamilyIndices {
     /**
@@ -40,15 +42,46 @@ struct QueueFamilyIndices {
      * This member stores the index of the queue family that supports presentation operations.
      */
     std::optional<uint32_t> presentFamily;
+    /**
+     * @brief Optional index for a dedicated transfer queue family.
+     *
+     * Set only when the device exposes a family that supports transfer operations but
+     * neither graphics nor compute, which usually maps to a DMA engine.
+     */
+    std::optional<uint32_t> transferFamily;
+    /**
+     * @brief Optional index for an async-compute queue family.
+     *
+     * Set only when the device exposes a family that supports compute but not graphics.
+     */
+    std::optional<uint32_t> computeFamily;
 // --------------------------------------------------------------------------------
     
     /**
      * @brief Checks if both graphics and presentation queue families are found.
      *
-     * @return True if both graphicsFamily and presentFamily have values, false otherwise.
+     * @param requirePresent False for headless rendering, where no family has to present.
+     * @return True if graphicsFamily has a value and, when presentation is required,
+     *         presentFamily has one too.
+     */
+    bool isComplete(bool requirePresent = true) const {
+        return graphicsFamily.has_value() && (presentFamily.has_value() || !requirePresent);
+    }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the family used for uploads, falling back to the graphics family.
+     */
+    uint32_t uploadFamily() const {
+        return transferFamily.has_value() ? transferFamily.value() : graphicsFamily.value();
+    }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the family used for compute work, falling back to the graphics family.
      */
-    bool isComplete() const {
-        return graphicsFamily.has_value() && presentFamily.has_value();
+    uint32_t asyncComputeFamily() const {
+        return computeFamily.has_value() ? computeFamily.value() : graphicsFamily.value();
     }
 };
 // ================================================================================
@@ -67,11 +100,13 @@ public:
      * @brief Finds the queue families that support graphics and presentation operations.
      *
      * This method queries the given Vulkan physical device to find the queue families
-     * that support graphics and presentation operations. It returns a QueueFamilyIndices
-     * struct containing the indices of the found queue families.
+     * that support graphics and presentation operations. It also records a dedicated
+     * transfer family and an async-compute family when the device has them. It returns a
+     * QueueFamilyIndices struct containing the indices of the found queue families.
      *
      * @param device The Vulkan physical device to query.
-     * @param surface The Vulkan surface for presentation support.
+     * @param surface The Vulkan surface for presentation support, or VK_NULL_HANDLE when
+     *        rendering headless, in which case no present family is looked up.
      * @return A QueueFamilyIndices struct containing the indices of the graphics and presentation queue families.
      */
     static QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface);
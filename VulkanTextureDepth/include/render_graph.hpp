@@ -0,0 +1,482 @@
+// ================================================================================
+// ================================================================================
+// - File:    render_graph.hpp
+// - Purpose: This file contains the RenderGraph class, which orders the passes of a
+//            frame from their declared resource accesses and derives the barriers,
+//            transient memory aliasing and queue batches between them.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef render_graph_HPP
+#define render_graph_HPP
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "memory.hpp"
+#include "deletion_queue.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Identifies a resource declared in a RenderGraph.
+ */
+using ResourceId = uint32_t;
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Identifies a pass declared in a RenderGraph.
+ */
+using PassId = uint32_t;
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief The queue a pass prefers to run on.
+ */
+enum class QueueClass : uint32_t {
+    Graphics,      /**< The graphics queue, which also runs compute and transfer work. */
+    AsyncCompute   /**< A dedicated compute queue, or the graphics queue if there is none. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct ResourceAccess
+ * @brief How a pass uses a resource.
+ *
+ * Images with a layout of VK_IMAGE_LAYOUT_UNDEFINED are transitioned by the pass itself, as
+ * a render pass with an undefined initial layout does; the graph then only orders the
+ * pass against earlier accesses. Buffers leave both layouts undefined.
+ */
+struct ResourceAccess {
+    VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;  /**< Stages that touch the resource. */
+    VkAccessFlags2 access = VK_ACCESS_2_NONE;                 /**< Reads and writes those stages make. */
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;         /**< Layout the pass needs the image in. */
+    VkImageLayout layoutAfter = VK_IMAGE_LAYOUT_UNDEFINED;    /**< Layout the pass leaves it in; UNDEFINED for layout. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct TransientImageDesc
+ * @brief An image that exists only within one frame's graph.
+ */
+struct TransientImageDesc {
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkExtent2D extent{0, 0};
+    VkImageUsageFlags usage = 0;
+    VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+    bool operator==(const TransientImageDesc& other) const;
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct GraphBarrier
+ * @brief One dependency derived by RenderGraph::compile.
+ *
+ * A barrier whose queues differ is one half of a queue family ownership transfer: the
+ * release recorded after the last pass on the source queue, or the acquire recorded
+ * before the first pass on the destination queue.
+ */
+struct GraphBarrier {
+    ResourceId resource = 0;
+    VkPipelineStageFlags2 srcStages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 srcAccess = VK_ACCESS_2_NONE;
+    VkPipelineStageFlags2 dstStages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 dstAccess = VK_ACCESS_2_NONE;
+    VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    QueueClass srcQueue = QueueClass::Graphics;
+    QueueClass dstQueue = QueueClass::Graphics;
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct GraphBatch
+ * @brief Consecutive passes on one queue, submitted together.
+ */
+struct GraphBatch {
+    /**
+     * @brief An earlier batch this one waits on with a semaphore.
+     */
+    struct Wait {
+        uint32_t batch = 0;
+        VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;  /**< Stages that wait. */
+    };
+
+    QueueClass queue = QueueClass::Graphics;
+    std::vector<PassId> passes;   /**< In execution order. */
+    std::vector<Wait> waits;      /**< Waits on batches of the other queue. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct TransientBlock
+ * @brief The memory needs and lifetime of a transient image, in executed-pass order.
+ */
+struct TransientBlock {
+    VkDeviceSize size = 0;
+    VkDeviceSize alignment = 1;
+    uint32_t first = 0;   /**< Position of the first pass using the image. */
+    uint32_t last = 0;    /**< Position of the last pass using the image. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct TransientPlacement
+ * @brief Where each transient image lives in the graph's shared memory.
+ */
+struct TransientPlacement {
+    std::vector<VkDeviceSize> offsets;   /**< Offset of each block. */
+    std::vector<int32_t> predecessors;   /**< The block last using the memory before each block, or -1. */
+    VkDeviceSize size = 0;               /**< Bytes needed to hold every block. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class RenderGraph
+ * @brief Declares a frame as passes that read and write resources, then schedules it.
+ *
+ * Passes execute in declaration order. compile() works out the rest:
+ * - Passes that contribute nothing to an exported resource, and are not kept, are culled.
+ * - Barriers are derived from each resource's previous access. Read-after-read needs none,
+ *   reads already made visible are not made visible again, and every barrier before a pass
+ *   is recorded in one vkCmdPipelineBarrier2 call, with accesses that need no layout change
+ *   or ownership transfer folded into a single global memory barrier.
+ * - Transient images whose lifetimes do not overlap share memory.
+ * - AsyncCompute passes are split into batches for the compute queue when the device has
+ *   a dedicated compute family, with semaphore waits and ownership transfers between the
+ *   queues; otherwise they run on the graphics queue.
+ *
+ * The graph is rebuilt every frame: reset, declare, compile, realize, execute. Realized
+ * transient images are kept while the declared transients stay the same.
+ */
+class RenderGraph {
+public:
+    RenderGraph() = default;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys the realized transient images. No submitted frame may still use them.
+     */
+    ~RenderGraph();
+// --------------------------------------------------------------------------------
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Clears the declared passes and resources for the next frame.
+     */
+    void reset();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Declares a buffer that lives outside the graph.
+     */
+    ResourceId importBuffer(const std::string& name, VkBuffer buffer);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Declares an image that lives outside the graph.
+     *
+     * @param name Name used in error messages.
+     * @param image The image.
+     * @param aspect Aspects covered by the graph's image barriers.
+     * @param layout Layout the image is in when the graph starts.
+     */
+    ResourceId importImage(const std::string& name, VkImage image, VkImageAspectFlags aspect, VkImageLayout layout);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Declares an image created by realize and discarded at the end of the frame.
+     */
+    ResourceId createTransientImage(const std::string& name, const TransientImageDesc& desc);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Declares a pass.
+     *
+     * @param name Name used in error messages.
+     * @param queue The queue the pass prefers.
+     * @param execute Records the pass's commands.
+     */
+    PassId addPass(const std::string& name, QueueClass queue, std::function<void(VkCommandBuffer)> execute);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Declares that a pass reads a resource. Accesses of one resource by one pass
+     * are merged.
+     *
+     * @throws std::runtime_error if the pass or resource does not exist.
+     */
+    void read(PassId pass, ResourceId resource, const ResourceAccess& access);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Declares that a pass writes a resource.
+     *
+     * A write without a read discards the resource's earlier contents, so the passes that
+     * produced them may be culled; a pass that only partly overwrites a resource should
+     * declare a read as well.
+     *
+     * @throws std::runtime_error if the pass or resource does not exist.
+     */
+    void write(PassId pass, ResourceId resource, const ResourceAccess& access);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Keeps a pass whose effects are not declared, such as presenting or timestamps.
+     */
+    void keepPass(PassId pass);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Marks a resource as used after the graph, so the passes writing it are kept.
+     *
+     * @param resource The resource.
+     * @param finalAccess How it is used afterwards, such as a host read after the fence or a
+     *        present layout; a barrier to it follows the last pass. Empty stages need none.
+     */
+    void exportResource(ResourceId resource, const ResourceAccess& finalAccess = ResourceAccess{});
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Culls passes, derives barriers and batches and plans transient lifetimes.
+     *
+     * @param graphicsFamily Queue family of the graphics queue.
+     * @param computeFamily Queue family of the async compute queue; when it equals
+     *        graphicsFamily every pass runs on the graphics queue.
+     * @throws std::runtime_error if a pass reads a transient image nothing wrote.
+     */
+    void compile(uint32_t graphicsFamily, uint32_t computeFamily);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates the transient images in aliased memory, reusing the previous frame's
+     * when the transients are unchanged.
+     *
+     * @param device The Vulkan logical device.
+     * @param allocatorManager Allocates the shared memory, counted as attachments.
+     * @param deletionQueue Destroys transients that are replaced while frames use them.
+     * @throws std::runtime_error if an image or its memory cannot be created.
+     */
+    void realize(VkDevice device, AllocatorManager& allocatorManager, DeletionQueue& deletionQueue);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records every batch into its command buffer.
+     *
+     * @param commandBuffers One buffer per batch, in getBatches() order.
+     * @param synchronization2 Records vkCmdPipelineBarrier2; otherwise the same barriers
+     *        are recorded with vkCmdPipelineBarrier.
+     */
+    void execute(const std::vector<VkCommandBuffer>& commandBuffers, bool synchronization2) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true if compile culled a pass.
+     */
+    bool isCulled(PassId pass) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the barriers recorded before a pass.
+     */
+    const std::vector<GraphBarrier>& getBarriersBefore(PassId pass) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the barriers recorded after a pass: ownership releases and final
+     * accesses of exported resources.
+     */
+    const std::vector<GraphBarrier>& getBarriersAfter(PassId pass) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the submission batches of the compiled graph.
+     */
+    const std::vector<GraphBatch>& getBatches() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the lifetimes of the transient images, in declaration order; only
+     * transients used by a remaining pass are listed.
+     */
+    std::vector<TransientBlock> getTransientLifetimes() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns a realized transient image or an imported image.
+     */
+    VkImage getImage(ResourceId resource) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the view of a realized transient image.
+     */
+    VkImageView getImageView(ResourceId resource) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the size of the memory shared by the transient images.
+     */
+    VkDeviceSize getTransientMemorySize() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Places blocks in one allocation so that blocks alive at the same time never
+     * overlap, largest first at the lowest offset that fits.
+     *
+     * @param blocks Sizes, alignments and lifetimes of the blocks.
+     * @return The offset and predecessor of every block and the memory size.
+     */
+    static TransientPlacement placeTransients(const std::vector<TransientBlock>& blocks);
+// ================================================================================
+private:
+    /**
+     * @brief The kinds of resources a graph tracks.
+     */
+    enum class ResourceKind { Buffer, Image, Transient };
+// --------------------------------------------------------------------------------
+
+    /**
+     * @struct Resource
+     * @brief A declared resource and its state while compile walks the passes.
+     */
+    struct Resource {
+        std::string name;
+        ResourceKind kind = ResourceKind::Buffer;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkImage image = VK_NULL_HANDLE;
+        VkImageAspectFlags aspect = 0;
+        VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        TransientImageDesc desc;
+        bool exported = false;
+        ResourceAccess finalAccess;
+    };
+// --------------------------------------------------------------------------------
+
+    /**
+     * @struct Access
+     * @brief One pass's merged use of one resource.
+     */
+    struct Access {
+        ResourceId resource = 0;
+        ResourceAccess usage;
+        bool reads = false;
+        bool writes = false;
+    };
+// --------------------------------------------------------------------------------
+
+    /**
+     * @struct Pass
+     * @brief A declared pass and what compile derived for it.
+     */
+    struct Pass {
+        std::string name;
+        QueueClass queue = QueueClass::Graphics;
+        std::function<void(VkCommandBuffer)> execute;
+        std::vector<Access> accesses;
+        bool kept = false;
+        bool culled = false;
+        std::vector<GraphBarrier> before;
+        std::vector<GraphBarrier> after;
+    };
+// --------------------------------------------------------------------------------
+
+    /**
+     * @struct Realized
+     * @brief A transient image created by realize.
+     */
+    struct Realized {
+        TransientImageDesc desc;
+        uint32_t first = 0;
+        uint32_t last = 0;
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        int32_t predecessor = -1;   /**< The image last using this memory before, or -1. */
+    };
+// --------------------------------------------------------------------------------
+
+    std::vector<Resource> resources;
+    std::vector<Pass> passes;
+    std::vector<GraphBatch> batches;
+    uint32_t graphicsFamily = VK_QUEUE_FAMILY_IGNORED;
+    uint32_t computeFamily = VK_QUEUE_FAMILY_IGNORED;
+
+    /**
+     * @brief Per transient resource: its index in realized, or UINT32_MAX if unused.
+     */
+    std::vector<uint32_t> transientSlots;
+    /**
+     * @brief Per transient slot: the pass and barrier index of its first use, patched by
+     * realize once the memory it inherits is known.
+     */
+    std::vector<std::pair<PassId, size_t>> firstUseBarriers;
+    /**
+     * @brief Per transient slot: stages and accesses of its last use.
+     */
+    std::vector<std::pair<VkPipelineStageFlags2, VkAccessFlags2>> lastUses;
+
+    VkDevice device = VK_NULL_HANDLE;
+    AllocatorManager* allocatorManager = nullptr;
+    std::vector<Realized> realized;
+    VmaAllocation transientMemory = VK_NULL_HANDLE;
+    VkDeviceSize transientMemorySize = 0;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Adds an access to a pass, merging it with the pass's earlier access of the
+     * same resource.
+     */
+    void declare(PassId pass, ResourceId resource, const ResourceAccess& access, bool writes);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Marks passes that contribute nothing to an exported resource as culled.
+     */
+    void cullPasses();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Derives the barriers and batches of the remaining passes.
+     */
+    void deriveBarriers(bool asyncCompute);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the queue family a queue class runs on.
+     */
+    uint32_t familyOf(QueueClass queue) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records a list of barriers as one dependency.
+     */
+    void recordBarriers(VkCommandBuffer commandBuffer, const std::vector<GraphBarrier>& barriers,
+                        bool synchronization2) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys the realized transients, now or through a deletion queue.
+     */
+    void releaseTransients(DeletionQueue* deletionQueue);
+};
+// ================================================================================
+// ================================================================================
+#endif /* render_graph_HPP */
+// eof
@@ -0,0 +1,71 @@
+// ================================================================================
+// ================================================================================
+// - File:    sampler_desc.hpp
+// - Purpose: This file contains the SamplerDesc struct, the hashable sampler state
+//            that the SamplerManager deduplicates samplers by.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef sampler_desc_HPP
+#define sampler_desc_HPP
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct SamplerDesc
+ * @brief The sampler state a texture is sampled with.
+ *
+ * Two descriptions that compare equal always resolve to the same VkSampler, so textures
+ * that share a state share one sampler. The defaults are trilinear, repeating and fully
+ * anisotropic filtering.
+ */
+struct SamplerDesc {
+    VkFilter magFilter = VK_FILTER_LINEAR;
+    VkFilter minFilter = VK_FILTER_LINEAR;
+    VkSamplerMipmapMode mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    VkSamplerAddressMode addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    VkSamplerAddressMode addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    VkSamplerAddressMode addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    float maxAnisotropy = 16.0f;        /**< 1 or less disables anisotropy; clamped to the device limit. */
+    bool compareEnable = false;         /**< Depth comparison, for shadow map samplers. */
+    VkCompareOp compareOp = VK_COMPARE_OP_ALWAYS;
+    float mipLodBias = 0.0f;
+    float minLod = 0.0f;
+    float maxLod = VK_LOD_CLAMP_NONE;   /**< The image view decides how many levels are sampled. */
+    VkBorderColor borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+// --------------------------------------------------------------------------------
+
+    bool operator==(const SamplerDesc& other) const;
+    bool operator!=(const SamplerDesc& other) const { return !(*this == other); }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Builds the create info for this state.
+     *
+     * @param deviceMaxAnisotropy VkPhysicalDeviceLimits::maxSamplerAnisotropy of the device.
+     */
+    VkSamplerCreateInfo toCreateInfo(float deviceMaxAnisotropy) const;
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Hashes every field of a SamplerDesc, treating -0.0 and 0.0 alike so equal
+ * descriptions always hash alike.
+ */
+struct SamplerDescHash {
+    size_t operator()(const SamplerDesc& desc) const;
+};
+// ================================================================================
+// ================================================================================
+#endif /* sampler_desc_HPP */
+// eof
@@ -0,0 +1,297 @@
+// ================================================================================
+// ================================================================================
+// - File:    scene.hpp
+// - Purpose: This file contains the Scene class, which collects mesh instances and
+//            turns them into a GPU-resident indirect draw list each frame.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef scene_HPP
+#define scene_HPP
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <vector>
+#include <cstdint>
+
+#include "memory.hpp"
+#include "devices.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct SceneMesh
+ * @brief A range of the shared index buffer that is drawn as one mesh.
+ */
+struct SceneMesh {
+    uint32_t indexCount = 0;      /**< Number of indices in the mesh. */
+    uint32_t firstIndex = 0;      /**< Offset of the first index in the index buffer. */
+    int32_t vertexOffset = 0;     /**< Value added to every index before fetching a vertex. */
+    glm::vec4 boundingSphere{0.0f, 0.0f, 0.0f, 1.0f}; /**< Object-space center in xyz, radius in w. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct SceneInstance
+ * @brief One placement of a mesh in the scene.
+ */
+struct SceneInstance {
+    uint32_t mesh = 0;            /**< Index of the SceneMesh this instance draws. */
+    glm::mat4 model{1.0f};        /**< Object-to-world transform. */
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @struct InstanceData
+ * @brief Per-instance record read by the vertex shader through gl_InstanceIndex.
+ *
+ * The layout matches the std430 InstanceData block in shader.vert.
+ */
+struct InstanceData {
+    alignas(16) glm::mat4 model;          /**< Object-to-world transform. */
+    alignas(16) glm::vec4 boundingSphere; /**< World-space center in xyz, radius in w. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class Scene
+ * @brief Packs mesh instances into per-frame storage and indirect buffers.
+ *
+ * Instances are grouped by mesh so that every mesh becomes a single indexed draw whose
+ * instanceCount covers all of its placements. The instance records and draw commands
+ * live in host-visible buffers, one set per frame in flight, and are only repacked
+ * when the scene has changed since that frame's copy was last written. Recording the
+ * scene then costs a constant number of calls regardless of how many instances exist.
+ */
+class Scene {
+public:
+    /**
+     * @brief Allocates and maps the per-frame instance, indirect and count buffers.
+     *
+     * @param allocatorManager The allocator used for every scene buffer.
+     * @param features The optional draw features enabled on the logical device.
+     * @param framesInFlight Number of frames that may be recorded before the oldest completes.
+     * @param maxInstances Capacity of each instance buffer.
+     * @param maxMeshes Capacity of each indirect command buffer.
+     * @throws std::runtime_error if a buffer cannot be created or mapped.
+     */
+    Scene(AllocatorManager& allocatorManager,
+          const DeviceFeatureSupport& features,
+          uint32_t framesInFlight,
+          uint32_t maxInstances = 65536,
+          uint32_t maxMeshes = 256);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Unmaps and destroys the scene buffers.
+     */
+    ~Scene();
+// --------------------------------------------------------------------------------
+
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Registers a mesh as a range of the bound index buffer.
+     *
+     * @param indexCount Number of indices in the mesh.
+     * @param firstIndex Offset of the mesh's first index.
+     * @param vertexOffset Value added to each index before the vertex fetch.
+     * @param boundingSphere Object-space bounding sphere, center in xyz and radius in w.
+     * @return The mesh id passed to addInstance.
+     * @throws std::runtime_error if maxMeshes meshes are already registered.
+     */
+    uint32_t addMesh(uint32_t indexCount, uint32_t firstIndex = 0, int32_t vertexOffset = 0,
+                     const glm::vec4& boundingSphere = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Places an instance of a mesh in the scene.
+     *
+     * @param mesh A mesh id returned by addMesh.
+     * @param model The instance's object-to-world transform.
+     * @return The instance id passed to setInstanceTransform.
+     * @throws std::runtime_error if the mesh id is unknown or the scene is full.
+     */
+    uint32_t addInstance(uint32_t mesh, const glm::mat4& model);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Replaces the transform of an existing instance.
+     *
+     * @param instance An instance id returned by addInstance.
+     * @param model The new object-to-world transform.
+     * @throws std::out_of_range if the instance id is unknown.
+     */
+    void setInstanceTransform(uint32_t instance, const glm::mat4& model);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Removes every instance while keeping the registered meshes.
+     */
+    void clearInstances();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Writes the draw list for a frame if the scene changed since it was last written.
+     *
+     * Must be called after the frame's fence has been waited on and before the frame's
+     * command buffer is recorded.
+     *
+     * @param frameIndex The frame in flight whose buffers are written.
+     */
+    void update(uint32_t frameIndex);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records the draws for a frame into a command buffer inside a render pass.
+     *
+     * Uses vkCmdDrawIndexedIndirectCount when drawIndirectCount is enabled, a single
+     * multi-draw vkCmdDrawIndexedIndirect when multiDrawIndirect is enabled, one indirect
+     * call per mesh otherwise, and direct vkCmdDrawIndexed calls on devices without
+     * drawIndirectFirstInstance. The count buffer is only read when the whole list is
+     * recorded. The pipeline, vertex and index buffers and descriptor sets must already
+     * be bound.
+     *
+     * @param commandBuffer The command buffer being recorded.
+     * @param frameIndex The frame in flight whose draw list is used.
+     * @param indirectBuffer Commands to draw in place of the scene's own, laid out like them,
+     *        such as the output of a culling pass. VK_NULL_HANDLE draws the scene's buffer.
+     * @param firstDraw The first draw of the range to record, for splitting the list
+     *        across several command buffers.
+     * @param drawCount The number of draws to record, clamped to the end of the list.
+     */
+    void recordDraws(VkCommandBuffer commandBuffer, uint32_t frameIndex,
+                     VkBuffer indirectBuffer = VK_NULL_HANDLE,
+                     uint32_t firstDraw = 0, uint32_t drawCount = UINT32_MAX) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the instance storage buffer of every frame, indexed by frame.
+     */
+    const std::vector<VkBuffer>& getInstanceBuffers() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the indirect command buffer for a frame.
+     */
+    VkBuffer getIndirectBuffer(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the buffer holding the draw count for a frame.
+     */
+    VkBuffer getCountBuffer(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of draws packed for a frame by its last update.
+     */
+    uint32_t getDrawCount(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the largest instanceCount of any draw packed for a frame.
+     */
+    uint32_t getLargestDraw(uint32_t frameIndex) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of instances in the scene.
+     */
+    uint32_t getInstanceCount() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the capacity of each instance buffer.
+     */
+    uint32_t getMaxInstances() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the capacity of each indirect command buffer.
+     */
+    uint32_t getMaxDraws() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Groups instances by mesh and builds one indexed draw per non-empty mesh.
+     *
+     * Instances are written in mesh order so that each draw's firstInstance selects a
+     * contiguous run of instance records. World-space bounding spheres are derived from
+     * each mesh's object-space sphere and the instance transform.
+     *
+     * @param meshes The registered meshes.
+     * @param instances The instances to pack.
+     * @param instanceData Receives one record per instance; must hold instances.size() entries.
+     * @param commands Receives the draw commands; must hold meshes.size() entries.
+     * @return The number of commands written.
+     */
+    static uint32_t buildDrawList(const std::vector<SceneMesh>& meshes,
+                                  const std::vector<SceneInstance>& instances,
+                                  InstanceData* instanceData,
+                                  VkDrawIndexedIndirectCommand* commands);
+// ================================================================================
+private:
+    /**
+     * @struct FrameBuffers
+     * @brief The host-visible buffers that hold one frame's draw list.
+     */
+    struct FrameBuffers {
+        VkBuffer instanceBuffer = VK_NULL_HANDLE;
+        VmaAllocation instanceAllocation = VK_NULL_HANDLE;
+        InstanceData* instances = nullptr;
+
+        VkBuffer indirectBuffer = VK_NULL_HANDLE;
+        VmaAllocation indirectAllocation = VK_NULL_HANDLE;
+        VkDrawIndexedIndirectCommand* commands = nullptr;
+
+        VkBuffer countBuffer = VK_NULL_HANDLE;
+        VmaAllocation countAllocation = VK_NULL_HANDLE;
+        uint32_t* count = nullptr;
+
+        uint32_t drawCount = 0;   /**< Draws written by the last update. */
+        uint32_t largestDraw = 0; /**< Most instances in any one of those draws. */
+        uint64_t version = 0;     /**< Scene version the buffers were written from. */
+    };
+// --------------------------------------------------------------------------------
+
+    AllocatorManager& allocatorManager;     /**< Allocator for the scene buffers. */
+    DeviceFeatureSupport features;          /**< Selects the draw submission path. */
+    uint32_t maxInstances;                  /**< Capacity of each instance buffer. */
+    uint32_t maxMeshes;                     /**< Capacity of each indirect buffer. */
+
+    std::vector<SceneMesh> meshes;          /**< Registered meshes, indexed by mesh id. */
+    std::vector<SceneInstance> instances;   /**< Scene instances, indexed by instance id. */
+    uint64_t version = 1;                   /**< Bumped on every change to meshes or instances. */
+
+    std::vector<FrameBuffers> frames;       /**< Draw list buffers, one set per frame in flight. */
+    std::vector<VkBuffer> instanceBuffers;  /**< Instance buffer of each frame for descriptor writes. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Creates and maps a host-visible buffer.
+     */
+    void createMappedBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                            VkBuffer& buffer, VmaAllocation& allocation, void** mapped);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Unmaps and destroys every frame's buffers.
+     */
+    void destroyBuffers();
+};
+// ================================================================================
+// ================================================================================
+#endif /* scene_HPP */
+// eof
@@ -0,0 +1,123 @@
+// ================================================================================
+// ================================================================================
+// - File:    texture_loader.hpp
+// - Purpose: This file contains a parser for precompressed KTX2 and DDS texture
+//            containers holding BC1, BC3, BC7 or ASTC data with pre-baked mips.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef texture_loader_HPP
+#define texture_loader_HPP
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+#include <cstdint>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct CompressedTexture
+ * @brief A block-compressed 2D texture and its mip chain, ready to be copied into a VkImage.
+ */
+struct CompressedTexture {
+    VkFormat format = VK_FORMAT_UNDEFINED;   /**< The Vulkan block-compressed format of the data. */
+    uint32_t width = 0;                      /**< Width of mip level 0 in texels. */
+    uint32_t height = 0;                     /**< Height of mip level 0 in texels. */
+    uint32_t mipLevels = 0;                  /**< Number of mip levels stored in data. */
+    std::vector<uint8_t> data;               /**< Packed mip chain, level 0 first. */
+    std::vector<VkDeviceSize> levelOffsets;  /**< Byte offset of each level inside data. */
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class TextureLoader
+ * @brief Reads KTX2 and DDS containers into CompressedTexture objects.
+ *
+ * Only single-layer, single-face 2D textures without supercompression are supported.
+ * Every level is placed at a 16 byte aligned offset, which satisfies the bufferOffset
+ * alignment Vulkan requires for block-compressed copies.
+ */
+class TextureLoader {
+public:
+    /**
+     * @brief Returns true if the path has a .ktx2 or .dds extension.
+     */
+    static bool isCompressedContainer(const std::string& path);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Reads and parses a KTX2 or DDS file.
+     *
+     * @param path Path to the container file.
+     * @return The parsed texture.
+     * @throws std::runtime_error if the file cannot be read or is not a supported container.
+     */
+    static CompressedTexture loadFile(const std::string& path);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Reads only the header of a KTX2 or DDS file and returns its format.
+     *
+     * @param path Path to the container file.
+     * @return The Vulkan format of the texture, or VK_FORMAT_UNDEFINED if the file is missing
+     *         or does not hold a supported format.
+     */
+    static VkFormat peekFormat(const std::string& path);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Parses an in-memory KTX2 container.
+     * @throws std::runtime_error if the data is malformed or uses an unsupported feature.
+     */
+    static CompressedTexture parseKTX2(const std::vector<uint8_t>& bytes);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Parses an in-memory DDS container, with or without the DX10 extension header.
+     * @throws std::runtime_error if the data is malformed or uses an unsupported format.
+     */
+    static CompressedTexture parseDDS(const std::vector<uint8_t>& bytes);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the compressed block dimensions and size of a supported format.
+     *
+     * @param format The Vulkan format.
+     * @param blockWidth Receives the block width in texels.
+     * @param blockHeight Receives the block height in texels.
+     * @param blockBytes Receives the size of one block in bytes.
+     * @return False if the format is not one of the supported BC or ASTC formats.
+     */
+    static bool getBlockInfo(VkFormat format, uint32_t& blockWidth, uint32_t& blockHeight, uint32_t& blockBytes);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of bytes in one mip level of a supported format.
+     */
+    static VkDeviceSize levelSize(VkFormat format, uint32_t width, uint32_t height);
+// ================================================================================
+private:
+    /**
+     * @brief Maps a DXGI_FORMAT value from a DX10 DDS header to a Vulkan format.
+     */
+    static VkFormat formatFromDXGI(uint32_t dxgiFormat);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Maps a legacy DDS FourCC code to a Vulkan format.
+     */
+    static VkFormat formatFromFourCC(uint32_t fourCC);
+};
+// ================================================================================
+// ================================================================================
+#endif /* texture_loader_HPP */
+// eof
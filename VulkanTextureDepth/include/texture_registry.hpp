@@ -0,0 +1,389 @@
+// ================================================================================
+// ================================================================================
+// - File:    texture_registry.hpp
+// - Purpose: This file contains a reference-counted, content-addressed registry
+//            of textures that evicts unused textures under a VRAM budget.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef texture_registry_HPP
+#define texture_registry_HPP
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+#include <future>
+#include <functional>
+
+#include "memory.hpp"
+#include "upload.hpp"
+#include "graphics.hpp"
+#include "thread_pool.hpp"
+#include "bindless.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @struct TextureHandle
+ * @brief A lightweight, copyable reference to a texture owned by a TextureRegistry.
+ *
+ * Handles carry a generation counter so a handle to an evicted texture is detected
+ * instead of silently resolving to whatever now occupies its slot.
+ */
+struct TextureHandle {
+    uint32_t index = 0;       /**< Slot index inside the registry. */
+    uint32_t generation = 0;  /**< Generation of the slot when the handle was issued; 0 is never valid. */
+
+    bool isValid() const { return generation != 0; }
+    bool operator==(const TextureHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const TextureHandle& other) const { return !(*this == other); }
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class TextureRegistry
+ * @brief Loads, deduplicates, reference-counts and evicts textures.
+ *
+ * acquire() returns the existing texture when the same path was loaded before, and also
+ * when a different path holds byte-identical content, identified by an FNV-1a hash of the
+ * file. Every acquire() must be balanced by a release(). A texture whose reference count
+ * drops to zero stays resident and can be revived for free until it is evicted. Eviction
+ * happens in trim(), least recently released first, whenever the resident textures exceed
+ * the configured budget or VMA reports a device-local heap above its budget.
+ *
+ * With a BindlessTextureTable every resident texture also owns a slot of the table. A reload
+ * moves the texture to a fresh slot, since frames in flight may still sample the old one,
+ * and the old slot is freed through the DeletionQueue.
+ *
+ * acquireAsync() moves file reading, decoding and CPU mip generation onto a ThreadPool so
+ * the render thread never waits on disk or stb_image. Only the final copy into the staging
+ * ring is serialized, by the UploadQueue's own lock. Lock order is registry, then upload or
+ * bindless table.
+ */
+class TextureRegistry {
+public:
+    /**
+     * @brief Usage counters reported by getStats().
+     */
+    struct Stats {
+        size_t residentTextures = 0;    /**< Textures currently holding GPU memory. */
+        size_t unreferencedTextures = 0; /**< Resident textures with no outstanding references. */
+        VkDeviceSize residentBytes = 0; /**< GPU memory held by resident textures. */
+        uint64_t cacheHits = 0;         /**< acquire() calls served without loading. */
+        uint64_t cacheMisses = 0;       /**< acquire() calls that loaded a texture. */
+        uint64_t evictions = 0;         /**< Textures destroyed by trim(). */
+        size_t pendingLoads = 0;        /**< acquireAsync() loads not yet resident on the GPU. */
+    };
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Constructs an empty TextureRegistry.
+     *
+     * @param allocatorManager Reference to the AllocatorManager that owns texture memory.
+     * @param device The Vulkan logical device.
+     * @param physicalDevice The Vulkan physical device.
+     * @param uploadQueue Reference to the UploadQueue that carries texture uploads.
+     * @param samplerManager Reference to the SamplerManager textures take their sampler from.
+     * @param threadPool Reference to the ThreadPool that decodes textures for acquireAsync().
+     * @param deletionQueue Reference to the DeletionQueue that destroys images replaced by reloads.
+     * @param budgetBytes Maximum GPU memory held by textures before unreferenced ones are
+     *        evicted. Zero leaves only the VMA heap budget in effect.
+     * @param bindlessTable The table resident textures are written into, or nullptr.
+     */
+    TextureRegistry(AllocatorManager& allocatorManager,
+                    VkDevice device,
+                    VkPhysicalDevice physicalDevice,
+                    UploadQueue& uploadQueue,
+                    SamplerManager& samplerManager,
+                    ThreadPool& threadPool,
+                    DeletionQueue& deletionQueue,
+                    VkDeviceSize budgetBytes = 0,
+                    BindlessTextureTable* bindlessTable = nullptr);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys every texture. No frame in flight may still reference them, and the
+     *        ThreadPool must have been destroyed first so no load is still running.
+     */
+    ~TextureRegistry();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns a handle to the texture at path, loading it on first use.
+     *
+     * @param path Path to the texture file.
+     * @param samplerDesc The sampler state used if the texture has to be loaded.
+     * @return A handle holding one reference to the texture.
+     * @throws std::invalid_argument if path is empty.
+     * @throws std::runtime_error if the texture cannot be loaded.
+     */
+    TextureHandle acquire(const std::string& path, const SamplerDesc& samplerDesc = SamplerDesc{});
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Starts loading the texture at path on the thread pool without blocking.
+     *
+     * The returned future becomes ready, and onResident is invoked, from trim() once the
+     * upload batch holding the texture has completed on the GPU; both happen immediately if
+     * the texture is already resident. Each call holds one reference, released with release()
+     * on the handle the future yields. Concurrent requests for the same path share one load.
+     * The render thread must poll the future rather than block on it, since it is only
+     * resolved by trim().
+     *
+     * @param path Path to the texture file.
+     * @param samplerDesc The sampler state used if the texture has to be loaded.
+     * @param onResident Optional callback receiving the handle once the texture can be sampled.
+     * @return A future yielding the handle, or the exception raised while loading.
+     * @throws std::invalid_argument if path is empty.
+     */
+    std::shared_future<TextureHandle> acquireAsync(const std::string& path,
+                                                   const SamplerDesc& samplerDesc = SamplerDesc{},
+                                                   std::function<void(TextureHandle)> onResident = nullptr);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Rebuilds the texture behind handle from path on the thread pool.
+     *
+     * The handle stays valid throughout and keeps resolving to the old image until trim() swaps
+     * the new one in, which happens once its upload has completed. The old image goes to the
+     * DeletionQueue. The registry holds a reference to the texture until the swap.
+     *
+     * @param handle The texture to replace.
+     * @param path Path to the new texture file; may equal the current path for a hot reload.
+     * @param onSwapped Optional callback run from trim() once the new image view is live. Any
+     *        descriptor set referencing the old view must be rewritten before it is next bound.
+     * @return A future yielding handle after the swap, or the exception raised while loading.
+     * @throws std::invalid_argument if the handle is stale or path is empty.
+     */
+    std::shared_future<TextureHandle> reloadAsync(TextureHandle handle, const std::string& path,
+                                                  std::function<void(TextureHandle)> onSwapped = nullptr);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Adds a reference to a texture.
+     * @throws std::invalid_argument if the handle is stale.
+     */
+    void addRef(TextureHandle handle);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Drops a reference to a texture. The texture stays resident until trim() evicts it.
+     * @throws std::invalid_argument if the handle is stale.
+     */
+    void release(TextureHandle handle);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Resolves a handle to its texture.
+     * @throws std::invalid_argument if the handle is stale.
+     */
+    TextureManager& get(TextureHandle handle);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the bindless table slots of a texture's current image and sampler.
+     *
+     * The texture slot changes when a reload is swapped in, so read it again after every trim().
+     *
+     * @throws std::invalid_argument if the handle is stale.
+     * @throws std::runtime_error if the registry has no bindless table.
+     */
+    BindlessIndices getBindlessIndices(TextureHandle handle);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true if handle refers to a resident texture.
+     */
+    bool isValid(TextureHandle handle) const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Advances the frame counter, resolves finished asynchronous loads, swaps in finished
+     *        reloads, destroys retired images and evicts unreferenced textures while over budget.
+     *
+     * Must be called once per frame after the fence of the frame being recorded has been
+     * waited on. A texture is only evicted once MAX_FRAMES_IN_FLIGHT frames have passed since
+     * its last reference was released, so no frame still in flight can sample it.
+     */
+    void trim();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Changes the texture memory budget. Zero disables the explicit budget.
+     */
+    void setBudget(VkDeviceSize budgetBytes);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns a snapshot of the registry counters.
+     */
+    Stats getStats() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Computes the 64-bit FNV-1a hash of a byte range.
+     */
+    static uint64_t hashBytes(const uint8_t* data, size_t size);
+// ================================================================================
+private:
+    /**
+     * @brief A registry slot. The slot is free when texture is null.
+     */
+    struct Entry {
+        std::unique_ptr<TextureManager> texture;
+        std::string path;
+        uint64_t contentHash = 0;
+        uint32_t generation = 1;
+        uint32_t refCount = 0;
+        uint64_t releasedFrame = 0;                 /**< Frame at which refCount last dropped to zero. */
+        std::list<uint32_t>::iterator lruPosition;  /**< Position in lru while unreferenced. */
+        BindlessIndices bindless;                   /**< Table slots, when there is a bindless table. */
+    };
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief An acquireAsync() request waiting for its texture to load or become resident.
+     */
+    struct PendingLoad {
+        std::promise<TextureHandle> promise;
+        std::shared_future<TextureHandle> future;
+        std::vector<std::function<void(TextureHandle)>> callbacks;
+        uint32_t references = 0;    /**< acquireAsync() calls sharing this load, applied when it lands. */
+        TextureHandle handle;
+        uint64_t uploadTicket = 0;  /**< UploadQueue ticket that must complete before resolving. */
+    };
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief A reloadAsync() request. The slot keeps one extra reference while it is outstanding.
+     */
+    struct PendingReload {
+        std::promise<TextureHandle> promise;
+        std::shared_future<TextureHandle> future;
+        std::function<void(TextureHandle)> callback;
+        TextureHandle handle;
+        std::string path;
+        uint64_t contentHash = 0;
+        uint64_t serial = 0;        /**< TextureManager reload serial, set once the image is built. */
+        std::exception_ptr error;   /**< Set if the load failed. */
+    };
+// --------------------------------------------------------------------------------
+
+    AllocatorManager& allocatorManager;
+    VkDevice device;
+    VkPhysicalDevice physicalDevice;
+    UploadQueue& uploadQueue;
+    SamplerManager& samplerManager;
+    ThreadPool& threadPool;
+    DeletionQueue& deletionQueue;
+    VkDeviceSize budgetBytes;
+    BindlessTextureTable* bindlessTable;
+
+    std::vector<Entry> entries;                            /**< Slots indexed by TextureHandle::index. */
+    std::vector<uint32_t> freeSlots;                       /**< Indices of empty slots. */
+    std::unordered_map<std::string, uint32_t> pathIndex;   /**< Path to slot. */
+    std::unordered_map<uint64_t, uint32_t> contentIndex;   /**< Content hash to slot. */
+    std::list<uint32_t> lru;                               /**< Unreferenced slots, least recently released first. */
+    std::unordered_map<std::string, std::shared_ptr<PendingLoad>> pendingLoads; /**< Loads running on the pool, by path. */
+    std::vector<std::shared_ptr<PendingLoad>> residencyWaiters; /**< Loaded textures whose upload has not completed. */
+    std::vector<std::shared_ptr<PendingReload>> pendingReloads; /**< Reloads not yet swapped in. */
+    std::vector<uint32_t> retiringSlots;                   /**< Slots that may hold superseded reload images. */
+    uint64_t frameCounter = 0;
+    Stats stats;
+
+    mutable std::mutex registryMutex;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the entry for handle or throws if the handle is stale. The caller must hold registryMutex.
+     */
+    Entry& lookup(TextureHandle handle);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Adds a reference to a slot, taking it off the LRU list if needed. The caller must hold registryMutex.
+     */
+    TextureHandle reference(uint32_t index);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Drops a reference to a slot, putting it on the LRU list at zero. The caller must hold registryMutex.
+     */
+    void unreference(uint32_t index);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Swaps in finished reloads and destroys superseded images. The caller must hold registryMutex.
+     *
+     * @param swapped Receives the reloads that went live or failed, to be resolved after unlocking.
+     */
+    void advanceReloads(std::vector<std::shared_ptr<PendingReload>>& swapped);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Points the path and content indices of a slot at a reloaded file. The caller must hold registryMutex.
+     */
+    void reindex(uint32_t index, const std::string& path, uint64_t contentHash);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Places a loaded texture in a free slot and indexes it. The caller must hold registryMutex.
+     *
+     * Existing path and content mappings are kept, so a texture loaded by acquireAsync() while
+     * acquire() loaded the same file stays reachable only through the handles it was issued.
+     *
+     * @return The slot index, with no references taken.
+     */
+    uint32_t insert(std::unique_ptr<TextureManager> texture, const std::string& path, uint64_t contentHash);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Body of an acquireAsync() load. Runs on a pool thread.
+     */
+    void loadAsync(const std::string& path, const SamplerDesc& samplerDesc,
+                   const std::shared_ptr<PendingLoad>& load);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Applies the references of a finished load to a slot and queues it for residency. The caller must hold registryMutex.
+     */
+    void completeLoad(const std::string& path, uint32_t index, const std::shared_ptr<PendingLoad>& load);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Fulfills a load's future and runs its callbacks. Must be called without registryMutex held.
+     */
+    static void resolve(PendingLoad& load);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true if resident textures exceed the explicit budget or a VMA heap budget.
+     */
+    bool overBudget() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Destroys the texture in a slot and returns the slot to the free list.
+     */
+    void evict(uint32_t index);
+};
+// ================================================================================
+// ================================================================================
+#endif /* texture_registry_HPP */
+// eof
@@ -0,0 +1,112 @@
+// ================================================================================
+// ================================================================================
+// - File:    thread_pool.hpp
+// - Purpose: This file contains a fixed-size worker thread pool used for CPU work
+//            such as texture decoding that should not run on the render thread.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef thread_pool_HPP
+#define thread_pool_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class ThreadPool
+ * @brief A fixed set of worker threads that execute submitted tasks in FIFO order.
+ *
+ * Tasks still queued when the pool is destroyed are discarded; their futures report
+ * std::future_errc::broken_promise. Tasks that are already running are allowed to finish.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Starts the worker threads.
+     *
+     * @param threadCount Number of workers. Zero picks one less than the number of hardware
+     *        threads, leaving a core for the render thread, with a minimum of one.
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Discards queued tasks and joins every worker.
+     */
+    ~ThreadPool();
+// --------------------------------------------------------------------------------
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Queues a callable for execution on a worker thread.
+     *
+     * @param task A callable taking no arguments.
+     * @return A future that receives the result of task, or the exception it threw.
+     * @throws std::runtime_error if the pool is shutting down.
+     */
+    template <typename F>
+    std::future<typename std::invoke_result<F>::type> submit(F&& task) {
+        using Result = typename std::invoke_result<F>::type;
+        // std::function requires a copyable target, so the packaged task is shared
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> future = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            if (stopping) {
+                throw std::runtime_error("ThreadPool: submit called on a pool that is shutting down.");
+            }
+            tasks.emplace_back([packaged]() { (*packaged)(); });
+        }
+        taskAvailable.notify_one();
+        return future;
+    }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of worker threads.
+     */
+    size_t size() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the number of tasks waiting for a worker.
+     */
+    size_t pending() const;
+// ================================================================================
+private:
+    std::vector<std::thread> workers;           /**< The worker threads. */
+    std::deque<std::function<void()>> tasks;    /**< Tasks waiting for a worker. */
+    mutable std::mutex poolMutex;               /**< Guards tasks and stopping. */
+    std::condition_variable taskAvailable;      /**< Signaled when a task is queued or the pool stops. */
+    bool stopping = false;                      /**< Set by the destructor to release the workers. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Body of each worker thread.
+     */
+    void workerLoop();
+};
+// ================================================================================
+// ================================================================================
+#endif /* thread_pool_HPP */
+// eof
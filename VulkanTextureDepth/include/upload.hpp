@@ -0,0 +1,315 @@
+// ================================================================================
+// ================================================================================
+// - File:    upload.hpp
+// - Purpose: This file contains a batched, fence-tracked upload queue used to
+//            move vertex, index and texture data from host memory to the GPU
+//            without stalling the render loop.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef upload_HPP
+#define upload_HPP
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+
+#include "memory.hpp"
+// ================================================================================
+// ================================================================================
+
+/**
+ * @class UploadQueue
+ * @brief Records host-to-device transfers into batches and submits them without blocking.
+ *
+ * Every upload copies its payload into the AllocatorManager staging ring and records the
+ * transfer into the currently open command buffer. Nothing is submitted until flush() is
+ * called, at which point the whole batch is submitted with a single fence. The ring space of a
+ * batch is only released once collect() observes that the fence has signaled, so callers never
+ * wait on the GPU unless they explicitly ask to through wait() or waitIdle(), or the ring is
+ * full. Payloads larger than the whole ring are staged in a dedicated buffer instead.
+ *
+ * When the device exposes a dedicated transfer queue family, copies are recorded and submitted
+ * on that queue so they overlap with rendering. Each batch then ends with queue family ownership
+ * release barriers and signals a semaphore; a short acquire command buffer is submitted on the
+ * graphics queue that waits on the semaphore and takes ownership before any draw reads the data.
+ * When the transfer and graphics families are the same, a single submission on the graphics
+ * queue is used and the barriers at the end of each batch make the data visible to later draws.
+ *
+ * Uploads may be recorded from any thread. Only the thread that constructed the queue, which
+ * must be the thread that submits frames, ever submits to the graphics or transfer queue:
+ * flush(), wait(), waitIdle() and the destructor must be called from it. An upload recorded on
+ * another thread that finds the staging ring full waits for submitted batches to retire, and
+ * if the open batch itself holds the space, stages its payload in a dedicated buffer instead
+ * of submitting the batch.
+ */
+class UploadQueue {
+public:
+    /**
+     * @brief Constructs an UploadQueue that records copies for the transfer queue.
+     *
+     * @param device The Vulkan logical device.
+     * @param allocatorManager Reference to the AllocatorManager used for staging memory.
+     * @param transferQueue The Vulkan queue that copy commands are submitted to.
+     * @param transferFamily The queue family index of transferQueue.
+     * @param graphicsQueue The Vulkan queue that consumes the uploaded resources.
+     * @param graphicsFamily The queue family index of graphicsQueue.
+     * @throws std::runtime_error if the command pools cannot be created.
+     */
+    UploadQueue(VkDevice device,
+                AllocatorManager& allocatorManager,
+                VkQueue transferQueue,
+                uint32_t transferFamily,
+                VkQueue graphicsQueue,
+                uint32_t graphicsFamily);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Waits for all submitted batches and releases every Vulkan object owned by the queue.
+     */
+    ~UploadQueue();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Queues a copy of host data into a region of a device buffer.
+     *
+     * @param dstBuffer The destination buffer, which must have VK_BUFFER_USAGE_TRANSFER_DST_BIT.
+     * @param data Pointer to the host data. The data is copied before the call returns.
+     * @param size The number of bytes to copy.
+     * @param dstOffset The byte offset into dstBuffer where the data is written.
+     * @throws std::runtime_error if a dedicated staging buffer cannot be created or mapped.
+     */
+    void uploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Queues a copy of host pixel data into mip level 0 of a 2D color image.
+     *
+     * The image is transitioned from VK_IMAGE_LAYOUT_UNDEFINED to TRANSFER_DST_OPTIMAL before
+     * the copy and to SHADER_READ_ONLY_OPTIMAL when the batch is flushed. If mipLevels is greater
+     * than one, the remaining levels are generated with a chain of linear blits on the graphics
+     * queue when the batch is flushed. The caller must have checked that the image format supports
+     * VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT and created the image with
+     * VK_IMAGE_USAGE_TRANSFER_SRC_BIT.
+     *
+     * @param image The destination image, which must have VK_IMAGE_USAGE_TRANSFER_DST_BIT.
+     * @param data Pointer to tightly packed pixel data. The data is copied before the call returns.
+     * @param size The number of bytes in data.
+     * @param width The width of the image in texels.
+     * @param height The height of the image in texels.
+     * @param mipLevels The number of mip levels in image.
+     * @return The ticket of the batch the copy was recorded into.
+     * @throws std::runtime_error if a dedicated staging buffer cannot be created or mapped.
+     */
+    uint64_t uploadImage(VkImage image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height,
+                         uint32_t mipLevels = 1);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Queues a copy of a complete, pre-built mip chain into a 2D color image.
+     *
+     * Level i is read from data + levelOffsets[i] and has the dimensions of level 0 halved i times,
+     * clamped to one texel. Block-compressed formats are supported since the copy uses tightly
+     * packed rows.
+     *
+     * @param image The destination image, which must have VK_IMAGE_USAGE_TRANSFER_DST_BIT.
+     * @param data Pointer to the packed mip chain. The data is copied before the call returns.
+     * @param size The number of bytes in data.
+     * @param width The width of level 0 in texels.
+     * @param height The height of level 0 in texels.
+     * @param levelOffsets The byte offset of each mip level inside data, one entry per level.
+     * @return The ticket of the batch the copies were recorded into.
+     * @throws std::runtime_error if a dedicated staging buffer cannot be created or mapped.
+     */
+    uint64_t uploadImageLevels(VkImage image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height,
+                               const std::vector<VkDeviceSize>& levelOffsets);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Submits the currently recorded batch, if any.
+     *
+     * @return A ticket identifying the submitted batch, or the ticket of the most recently
+     *         submitted batch if there was nothing to submit.
+     * @throws std::runtime_error if the batch cannot be submitted.
+     */
+    uint64_t flush();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Checks whether the batch identified by ticket has finished executing on the GPU.
+     *
+     * @param ticket A ticket returned by flush().
+     * @return True if the batch is complete, false otherwise.
+     */
+    bool isComplete(uint64_t ticket);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Blocks until the batch identified by ticket has finished executing.
+     *
+     * Any uploads that are still being recorded are flushed first if they belong to ticket.
+     *
+     * @param ticket A ticket returned by flush().
+     */
+    void wait(uint64_t ticket);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Flushes pending uploads and blocks until every submitted batch completes.
+     */
+    void waitIdle();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Releases staging memory for every batch whose fence has signaled.
+     *
+     * This never blocks and is intended to be called once per frame.
+     */
+    void collect();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the ticket that will be assigned to the batch currently being recorded.
+     */
+    uint64_t pendingTicket() const;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns true if copies are submitted on a queue family other than graphics.
+     */
+    bool usesDedicatedTransferQueue() const;
+// ================================================================================
+private:
+    /**
+     * @brief A dedicated staging buffer for an oversized payload, owned by a batch until its fence signals.
+     */
+    struct StagingBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+    };
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief An image whose mip chain is generated from level 0 when its batch is flushed.
+     */
+    struct MipJob {
+        VkImage image = VK_NULL_HANDLE;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipLevels = 1;
+    };
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief The command buffers, sync objects and staging memory of one submitted batch.
+     */
+    struct Batch {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;        /**< Copy commands, recorded for the transfer family. */
+        VkCommandBuffer acquireCommandBuffer = VK_NULL_HANDLE; /**< Ownership acquire, only with a dedicated transfer queue. */
+        VkSemaphore semaphore = VK_NULL_HANDLE;                /**< Orders the acquire after the copies on another queue. */
+        VkFence fence = VK_NULL_HANDLE;                        /**< Signaled when the last submission of the batch completes. */
+        uint64_t ticket = 0;
+        uint64_t ringMark = 0;                                 /**< Staging ring mark released when the batch retires. */
+        std::vector<StagingBuffer> stagingBuffers;
+        std::vector<VkImageMemoryBarrier> releaseBarriers;       /**< Deferred image transitions to SHADER_READ_ONLY_OPTIMAL. */
+        std::vector<VkBufferMemoryBarrier> bufferReleaseBarriers; /**< Buffer ownership transfers, dedicated transfer queue only. */
+        std::vector<MipJob> mipJobs;                             /**< Blit chains recorded on the graphics queue at flush. */
+    };
+// --------------------------------------------------------------------------------
+
+    VkDevice device;                       /**< The Vulkan logical device. */
+    AllocatorManager& allocatorManager;    /**< Allocator used for staging buffers. */
+    VkQueue transferQueue;                 /**< The queue copy commands are submitted to. */
+    uint32_t transferFamily;               /**< Queue family index of transferQueue. */
+    VkQueue graphicsQueue;                 /**< The queue that consumes uploaded resources. */
+    uint32_t graphicsFamily;               /**< Queue family index of graphicsQueue. */
+    bool dedicatedTransfer;                /**< True when transferFamily differs from graphicsFamily. */
+    VkCommandPool commandPool = VK_NULL_HANDLE; /**< Pool for copy command buffers on the transfer family. */
+    VkCommandPool acquirePool = VK_NULL_HANDLE; /**< Pool for acquire command buffers on the graphics family. */
+
+    Batch recording;                       /**< The batch currently accepting uploads. */
+    bool recordingOpen = false;            /**< True once recording.commandBuffer has begun. */
+    std::deque<Batch> inFlight;            /**< Submitted batches ordered by ticket. */
+    std::vector<Batch> freeBatches;        /**< Retired batches whose command buffer and fence can be reused. */
+    uint64_t nextTicket = 1;               /**< Ticket assigned to the next flushed batch. */
+    uint64_t completedTicket = 0;          /**< Highest ticket known to have completed. */
+    std::thread::id submitThread;          /**< The only thread that submits, the constructing one. */
+
+    mutable std::mutex uploadMutex;        /**< Serializes access from loader threads and the render loop. */
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Ensures a command buffer is open for recording, reusing a retired batch if possible.
+     */
+    void beginRecording();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Copies data into staging memory referenced by the open batch.
+     *
+     * The payload is placed in the staging ring, waiting for older batches to retire if the ring
+     * is full. Payloads larger than the ring get a dedicated buffer, as do payloads that only the
+     * open batch's retirement could make room for when called off submitThread. The caller must
+     * hold uploadMutex and must record commands into recording only after this returns, since on
+     * submitThread a full ring may force the open batch to be flushed and a new one begun.
+     *
+     * @param srcOffset Receives the byte offset of the payload inside the returned buffer.
+     * @return The buffer to use as the copy source.
+     */
+    VkBuffer stage(const void* data, VkDeviceSize size, VkDeviceSize& srcOffset);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records the transition into TRANSFER_DST_OPTIMAL and the buffer-to-image copies for
+     *        the given levels and queues the matching release barrier. The caller must hold uploadMutex.
+     */
+    void recordImageCopy(VkImage image, VkBuffer stagingBuffer, const std::vector<VkBufferImageCopy>& regions,
+                         uint32_t mipLevels, bool generateMips);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records the blit chain of a MipJob and leaves every level in SHADER_READ_ONLY_OPTIMAL.
+     * @param commandBuffer A command buffer from a graphics-capable queue family.
+     */
+    void recordMipChain(VkCommandBuffer commandBuffer, const MipJob& job);
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Submits the open batch. The caller must hold uploadMutex.
+     */
+    uint64_t flushLocked();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Records the release barriers, submits the copies on the transfer queue and the
+     *        matching acquire barriers on the graphics queue. The caller must hold uploadMutex.
+     */
+    void submitWithOwnershipTransfer();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Retires completed batches from the front of inFlight. The caller must hold uploadMutex.
+     */
+    void collectLocked();
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Frees the staging memory of a batch and returns it to the free list.
+     */
+    void retire(Batch& batch);
+};
+// ================================================================================
+// ================================================================================
+#endif /* upload_HPP */
+// eof
@@ -0,0 +1,235 @@
+// ================================================================================
+// ================================================================================
+// - File:    vertex_format.hpp
+// - Purpose: This file contains the vertex formats: the full-precision Vertex that
+//            mesh sources produce and the VertexLayout template that describes how
+//            vertices are stored in the vertex buffer, including quantized layouts.
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#ifndef vertex_format_HPP
+#define vertex_format_HPP
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief A full-precision vertex as authored or loaded, before it is packed for the GPU.
+ *
+ * Mesh sources produce these; the MeshArena packs every chunk into GpuVertex on upload.
+ */
+struct Vertex {
+    glm::vec3 pos;
+    glm::vec3 color;
+    glm::vec2 texCoord;
+};
+// ================================================================================
+// ================================================================================
+// Quantized attribute types
+
+/**
+ * @brief Two IEEE half floats, read by the shader as a vec2.
+ */
+struct Half2 {
+    uint16_t value[2];
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Four IEEE half floats, read by the shader as up to a vec4.
+ */
+struct Half4 {
+    uint16_t value[4];
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Four signed normalized 16-bit values covering [-1, 1].
+ */
+struct Snorm16x4 {
+    int16_t value[4];
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Four unsigned normalized 8-bit values covering [0, 1].
+ */
+struct Unorm8x4 {
+    uint8_t value[4];
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief A unit vector folded onto an octahedron and stored as two snorm16 values.
+ *
+ * The shader decodes it with n = vec3(e, 1 - |e.x| - |e.y|); if n.z < 0 then
+ * n.xy = (1 - |n.yx|) * sign(n.xy); n = normalize(n).
+ */
+struct OctNormal16 {
+    int16_t value[2];
+};
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief Maps an attribute's C++ type to the VkFormat the vertex fetch reads it with.
+ */
+template <typename T> struct AttributeFormat;
+
+template <> struct AttributeFormat<glm::vec2> { static constexpr VkFormat value = VK_FORMAT_R32G32_SFLOAT; };
+template <> struct AttributeFormat<glm::vec3> { static constexpr VkFormat value = VK_FORMAT_R32G32B32_SFLOAT; };
+template <> struct AttributeFormat<Half2> { static constexpr VkFormat value = VK_FORMAT_R16G16_SFLOAT; };
+template <> struct AttributeFormat<Half4> { static constexpr VkFormat value = VK_FORMAT_R16G16B16A16_SFLOAT; };
+template <> struct AttributeFormat<Snorm16x4> { static constexpr VkFormat value = VK_FORMAT_R16G16B16A16_SNORM; };
+template <> struct AttributeFormat<Unorm8x4> { static constexpr VkFormat value = VK_FORMAT_R8G8B8A8_UNORM; };
+template <> struct AttributeFormat<OctNormal16> { static constexpr VkFormat value = VK_FORMAT_R16G16_SNORM; };
+// ================================================================================
+// ================================================================================
+// Packing of full-precision values into attribute types
+
+/**
+ * @brief Converts a float to an IEEE half float, rounding to nearest even.
+ *
+ * Values beyond the half range become infinity and NaN stays NaN.
+ */
+uint16_t floatToHalf(float value);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Converts a value in [-1, 1] to snorm16, clamping values outside the range.
+ */
+int16_t packSnorm16(float value);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Converts a value in [0, 1] to unorm8, clamping values outside the range.
+ */
+uint8_t packUnorm8(float value);
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief Encodes a unit vector with the octahedral mapping.
+ *
+ * @param normal A non-zero direction; it does not have to be normalized.
+ */
+OctNormal16 packOctNormal(const glm::vec3& normal);
+// --------------------------------------------------------------------------------
+
+inline void packAttribute(const glm::vec2& in, glm::vec2& out) { out = in; }
+inline void packAttribute(const glm::vec3& in, glm::vec3& out) { out = in; }
+inline void packAttribute(const glm::vec2& in, Half2& out) {
+    out = {{floatToHalf(in.x), floatToHalf(in.y)}};
+}
+inline void packAttribute(const glm::vec3& in, Half4& out) {
+    out = {{floatToHalf(in.x), floatToHalf(in.y), floatToHalf(in.z), floatToHalf(1.0f)}};
+}
+inline void packAttribute(const glm::vec3& in, Snorm16x4& out) {
+    out = {{packSnorm16(in.x), packSnorm16(in.y), packSnorm16(in.z), INT16_MAX}};
+}
+inline void packAttribute(const glm::vec3& in, Unorm8x4& out) {
+    out = {{packUnorm8(in.x), packUnorm8(in.y), packUnorm8(in.z), UINT8_MAX}};
+}
+inline void packAttribute(const glm::vec3& in, OctNormal16& out) { out = packOctNormal(in); }
+// ================================================================================
+// ================================================================================
+
+/**
+ * @brief The full-precision layout: 32 bytes, stored exactly as Vertex.
+ */
+struct FullVertexTraits {
+    using Position = glm::vec3;
+    using Color = glm::vec3;
+    using TexCoord = glm::vec2;
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief The compact layout: 16 bytes with half-float positions and UVs and unorm8 colors.
+ *
+ * Half floats keep 11 bits of mantissa, which suits models authored near the origin;
+ * UVs stay floating point so tiled coordinates outside [0, 1] survive.
+ */
+struct CompactVertexTraits {
+    using Position = Half4;
+    using Color = Unorm8x4;
+    using TexCoord = Half2;
+};
+// --------------------------------------------------------------------------------
+
+/**
+ * @brief A vertex buffer record whose attribute types come from a traits struct.
+ *
+ * The binding and attribute descriptions are generated at compile time from the member
+ * types, so changing the traits is enough to change the vertex format. The vertex fetch
+ * expands every format to floats, so the shaders read the same vec3/vec2 inputs for any
+ * layout.
+ *
+ * @tparam Traits Defines the Position, Color and TexCoord member types, each of which
+ *         must have an AttributeFormat and a packAttribute overload.
+ */
+template <typename Traits>
+struct VertexLayout {
+    typename Traits::Position pos;
+    typename Traits::Color color;
+    typename Traits::TexCoord texCoord;
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the binding description for the vertex input.
+     */
+    static constexpr VkVertexInputBindingDescription getBindingDescription() {
+        return {0, sizeof(VertexLayout), VK_VERTEX_INPUT_RATE_VERTEX};
+    }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Returns the attribute descriptions for the vertex input, one per member, with
+     * the locations used by shader.vert.
+     */
+    static constexpr std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions() {
+        return {{
+            {0, 0, AttributeFormat<typename Traits::Position>::value, offsetof(VertexLayout, pos)},
+            {1, 0, AttributeFormat<typename Traits::Color>::value, offsetof(VertexLayout, color)},
+            {2, 0, AttributeFormat<typename Traits::TexCoord>::value, offsetof(VertexLayout, texCoord)},
+        }};
+    }
+// --------------------------------------------------------------------------------
+
+    /**
+     * @brief Converts a full-precision vertex to this layout.
+     */
+    static VertexLayout pack(const Vertex& vertex) {
+        VertexLayout packed;
+        packAttribute(vertex.pos, packed.pos);
+        packAttribute(vertex.color, packed.color);
+        packAttribute(vertex.texCoord, packed.texCoord);
+        return packed;
+    }
+};
+// ================================================================================
+// ================================================================================
+
+// The vertex buffer layout, chosen with the VULKAN_COMPACT_VERTEX CMake option
+#ifdef VULKAN_COMPACT_VERTEX
+using GpuVertex = VertexLayout<CompactVertexTraits>;
+static_assert(sizeof(GpuVertex) == 16, "The compact vertex must stay 16 bytes");
+#else
+using GpuVertex = VertexLayout<FullVertexTraits>;
+static_assert(sizeof(GpuVertex) == sizeof(Vertex), "The full vertex must match Vertex");
+#endif
+// ================================================================================
+// ================================================================================
+#endif /* vertex_format_HPP */
+// eof
@@ -0,0 +1,165 @@
+// ================================================================================
+// ================================================================================
+// - File:    latency.cpp
+// - Purpose: This file contains the implementation of the latency profiles and the
+//            PresentPacer class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/latency.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+// ================================================================================
+// ================================================================================
+
+LatencyProfile LatencyProfile::get(LatencyMode mode) {
+    LatencyProfile profile;
+    profile.mode = mode;
+    switch (mode) {
+        case LatencyMode::LowLatency:
+            // The CPU waits for the GPU every frame, trading utilization for fresh input
+            profile.name = "low-latency";
+            profile.framesInFlight = 1;
+            profile.presentModes = {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+            profile.extraSwapImages = 1;
+            profile.presentWait = true;
+            break;
+        case LatencyMode::Balanced:
+            profile.name = "balanced";
+            profile.framesInFlight = 2;
+            profile.presentModes = {VK_PRESENT_MODE_MAILBOX_KHR};
+            profile.extraSwapImages = 1;
+            break;
+        case LatencyMode::Throughput:
+            // A deeper queue absorbs frame time spikes without starving the GPU
+            profile.name = "throughput";
+            profile.framesInFlight = 3;
+            profile.presentModes = {VK_PRESENT_MODE_MAILBOX_KHR};
+            profile.extraSwapImages = 2;
+            break;
+        case LatencyMode::PowerSaver:
+            // Late frames tear instead of waiting a whole refresh, so the GPU runs no faster than vsync
+            profile.name = "power-saver";
+            profile.framesInFlight = 2;
+            profile.presentModes = {VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+            profile.extraSwapImages = 1;
+            break;
+    }
+    return profile;
+}
+// --------------------------------------------------------------------------------
+
+std::optional<LatencyMode> LatencyProfile::parseMode(const std::string& name) {
+    std::string normalized = name;
+    std::replace(normalized.begin(), normalized.end(), '_', '-');
+
+    for (LatencyMode mode : {LatencyMode::LowLatency, LatencyMode::Balanced,
+                             LatencyMode::Throughput, LatencyMode::PowerSaver}) {
+        if (get(mode).name == normalized) {
+            return mode;
+        }
+    }
+    return std::nullopt;
+}
+// --------------------------------------------------------------------------------
+
+VkPresentModeKHR LatencyProfile::choosePresentMode(const std::vector<VkPresentModeKHR>& available) const {
+    for (VkPresentModeKHR preferred : presentModes) {
+        if (std::find(available.begin(), available.end(), preferred) != available.end()) {
+            return preferred;
+        }
+    }
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t LatencyProfile::chooseImageCount(const VkSurfaceCapabilitiesKHR& capabilities) const {
+    uint32_t imageCount = capabilities.minImageCount + extraSwapImages;
+    if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount) {
+        imageCount = capabilities.maxImageCount;
+    }
+    return imageCount;
+}
+// --------------------------------------------------------------------------------
+
+const char* LatencyProfile::presentModeName(VkPresentModeKHR presentMode) {
+    switch (presentMode) {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: return "immediate";
+        case VK_PRESENT_MODE_MAILBOX_KHR: return "mailbox";
+        case VK_PRESENT_MODE_FIFO_KHR: return "fifo";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "fifo relaxed";
+        default: return "unknown";
+    }
+}
+// ================================================================================
+// ================================================================================
+
+PresentPacer::PresentPacer(VkDevice device, bool supported)
+    : device(device) {
+    if (supported) {
+        waitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(
+            vkGetDeviceProcAddr(device, "vkWaitForPresentKHR"));
+    }
+}
+// --------------------------------------------------------------------------------
+
+bool PresentPacer::isAvailable() const {
+    return waitForPresent != nullptr;
+}
+// --------------------------------------------------------------------------------
+
+void PresentPacer::setEnabled(bool enabled) {
+    this->enabled = enabled;
+}
+// --------------------------------------------------------------------------------
+
+bool PresentPacer::isEnabled() const {
+    return enabled && isAvailable();
+}
+// --------------------------------------------------------------------------------
+
+void PresentPacer::waitForLastPresent(VkSwapchainKHR swapChain, uint64_t timeoutNs) const {
+    if (!isEnabled() || lastPresentId == 0) {
+        return;
+    }
+
+    VkResult result = waitForPresent(device, swapChain, lastPresentId, timeoutNs);
+    // An out-of-date swap chain is rebuilt by the next acquire or present
+    if (result != VK_SUCCESS && result != VK_TIMEOUT && result != VK_ERROR_OUT_OF_DATE_KHR) {
+        throw std::runtime_error(std::string("Failed to wait for present ") +
+                                 std::to_string(lastPresentId) +
+                                 ". Error code: " +
+                                 std::to_string(static_cast<int>(result)));
+    }
+}
+// --------------------------------------------------------------------------------
+
+void PresentPacer::tagPresent(VkPresentInfoKHR& presentInfo, VkPresentIdKHR& presentId) {
+    if (!isAvailable()) {
+        return;
+    }
+
+    lastPresentId = nextPresentId++;
+    presentId = VkPresentIdKHR{};
+    presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+    presentId.pNext = presentInfo.pNext;
+    presentId.swapchainCount = presentInfo.swapchainCount;
+    presentId.pPresentIds = &lastPresentId;
+    presentInfo.pNext = &presentId;
+}
+// --------------------------------------------------------------------------------
+
+void PresentPacer::resetSwapChain() {
+    lastPresentId = 0;
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -16,6 +16,10 @@
 #include <iostream>
 #include <stdexcept>
 #include <memory>
+#include <optional>
+#include <string>
+#include <fstream>
+#include <vector>
 // ================================================================================
 // ================================================================================ 
 
@@ -64,8 +68,94 @@ int main(int argc, const char * argv[]) {
     
     // Call Application 
     try {
+        // An optional texture path replaces the default texture and --latency=<profile>
+        // selects low-latency, balanced, throughput or power-saver. --headless renders
+        // --frames=<count> frames without a window, and --readback=<file.ppm> also reads
+        // every frame back and writes the last one to the file. --mesh=<file.obj> draws a
+        // Wavefront OBJ model instead of the built-in quads. --reverse-z clears depth to 0 and
+        // keeps nearer fragments with GREATER, --depth-prepass lays depth down before shading and
+        // --msaa=<samples> renders with up to that many samples per pixel
+        std::string texturePath = "../../../data/texture.jpg";
+        LatencyMode latencyMode = LatencyMode::Balanced;
+        DepthConfig depthConfig;
+        bool headless = false;
+        uint32_t frameCount = 300;
+        std::string readbackPath;
+        std::string meshPath;
+        const std::string latencyFlag = "--latency=";
+        const std::string framesFlag = "--frames=";
+        const std::string readbackFlag = "--readback=";
+        const std::string meshFlag = "--mesh=";
+        const std::string msaaFlag = "--msaa=";
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg.rfind(latencyFlag, 0) == 0) {
+                std::optional<LatencyMode> mode = LatencyProfile::parseMode(arg.substr(latencyFlag.size()));
+                if (!mode) {
+                    throw std::runtime_error("Unknown latency profile: " + arg.substr(latencyFlag.size()));
+                }
+                latencyMode = *mode;
+            } else if (arg == "--reverse-z") {
+                depthConfig.reverseZ = true;
+            } else if (arg == "--depth-prepass") {
+                depthConfig.prepass = true;
+            } else if (arg.rfind(msaaFlag, 0) == 0) {
+                depthConfig.msaaSamples = static_cast<uint32_t>(std::stoul(arg.substr(msaaFlag.size())));
+            } else if (arg == "--headless") {
+                headless = true;
+            } else if (arg.rfind(framesFlag, 0) == 0) {
+                frameCount = static_cast<uint32_t>(std::stoul(arg.substr(framesFlag.size())));
+            } else if (arg.rfind(readbackFlag, 0) == 0) {
+                readbackPath = arg.substr(readbackFlag.size());
+            } else if (arg.rfind(meshFlag, 0) == 0) {
+                meshPath = arg.substr(meshFlag.size());
+            } else {
+                texturePath = arg;
+            }
+        }
+
+        std::unique_ptr<MeshSource> mesh;
+        if (meshPath.empty()) {
+            mesh = std::make_unique<VectorMeshSource>(vertices, indices);
+        } else {
+            mesh = std::make_unique<ObjMesh>(meshPath);
+        }
+
+        if (headless) {
+            HeadlessConfig config;
+            config.readback = !readbackPath.empty();
+            VulkanApplication renderer(config, *mesh, texturePath, latencyMode, depthConfig);
+
+            // Frames arrive oldest first, so the copy left at the end is the last frame
+            std::vector<uint8_t> lastPixels;
+            ReadbackFrame lastFrame;
+            if (config.readback) {
+                renderer.setReadbackCallback([&lastPixels, &lastFrame](const ReadbackFrame& frame) {
+                    lastPixels.assign(frame.pixels, frame.pixels + frame.rowPitch * frame.extent.height);
+                    lastFrame = frame;
+                    lastFrame.pixels = lastPixels.data();
+                });
+            }
+            renderer.runFrames(frameCount);
+
+            const FrameSummary summary = renderer.getProfiler().summarize(frameCount);
+            std::cout << "Rendered " << summary.frames << " frames headless: "
+                      << summary.framesPerSecond << " fps, CPU " << summary.cpuMs << " ms, GPU "
+                      << summary.gpuMs << " ms per frame." << std::endl;
+
+            if (config.readback && !lastPixels.empty()) {
+                std::ofstream out(readbackPath, std::ios::binary);
+                if (!out) {
+                    throw std::runtime_error("Failed to open " + readbackPath + " for writing!");
+                }
+                OffscreenTarget::writePpm(out, lastFrame);
+                std::cout << "Wrote frame " << lastFrame.frame << " to " << readbackPath << "." << std::endl;
+            }
+            return EXIT_SUCCESS;
+        }
+
         GLFWwindow* window = create_window(1050, 1200, "Vulkan Application", false);
-        VulkanApplication triangle(window, vertices, indices);
+        VulkanApplication triangle(window, *mesh, texturePath, latencyMode, depthConfig);
 
         triangle.run();
 
@@ -15,29 +15,183 @@
 #include <vk_mem_alloc.h>
 #include "include/memory.hpp"
 #include <iostream>
+#include <algorithm>
+#include <stdexcept>
 // ================================================================================ 
 // ================================================================================
 
-AllocatorManager::AllocatorManager(VkPhysicalDevice physicalDevice, VkDevice device, VkInstance instance) :
-    device(device){
+StagingRing::StagingRing(VmaAllocator allocator, VkDeviceSize capacity) :
+    allocator(allocator), capacity(capacity) {
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = capacity;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocationInfo = {};
+    if (vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer, &allocation, &allocationInfo) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create staging ring buffer!");
+    }
+    if (allocationInfo.pMappedData == nullptr) {
+        vmaDestroyBuffer(allocator, buffer, allocation);
+        throw std::runtime_error("Failed to map staging ring buffer!");
+    }
+    mappedData = static_cast<uint8_t*>(allocationInfo.pMappedData);
+    stats.capacity = capacity;
+}
+// --------------------------------------------------------------------------------
+
+StagingRing::~StagingRing() {
+    if (buffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(allocator, buffer, allocation);
+    }
+}
+// --------------------------------------------------------------------------------
+
+bool StagingRing::tryAllocate(VkDeviceSize size, VkDeviceSize alignment, Region& region) {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    if (size > capacity) {
+        return false;
+    }
+
+    // An empty ring can restart at offset zero instead of paying for wrap padding
+    if (head == tail) {
+        uint64_t restart = (head + capacity - 1) / capacity * capacity;
+        head = tail = restart;
+    }
+
+    uint64_t start = (head + alignment - 1) & ~(static_cast<uint64_t>(alignment) - 1);
+    if (start % capacity + size > capacity) {
+        start = (start / capacity + 1) * capacity;
+    }
+    if (start + size - tail > capacity) {
+        return false;
+    }
+
+    head = start + size;
+    stats.inUse = head - tail;
+    stats.highWaterMark = std::max(stats.highWaterMark, stats.inUse);
+
+    region.buffer = buffer;
+    region.offset = start % capacity;
+    region.mapped = mappedData + region.offset;
+    return true;
+}
+// --------------------------------------------------------------------------------
+
+void StagingRing::flush(const Region& region, VkDeviceSize size) {
+    vmaFlushAllocation(allocator, allocation, region.offset, size);
+}
+// --------------------------------------------------------------------------------
+
+uint64_t StagingRing::mark() const {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    return head;
+}
+// --------------------------------------------------------------------------------
+
+void StagingRing::release(uint64_t mark) {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    tail = std::max(tail, std::min(mark, head));
+    stats.inUse = head - tail;
+}
+// --------------------------------------------------------------------------------
+
+void StagingRing::recordStall() {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    ++stats.stallCount;
+}
+// --------------------------------------------------------------------------------
+
+void StagingRing::recordDedicatedFallback() {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    ++stats.dedicatedFallbacks;
+}
+// --------------------------------------------------------------------------------
+
+VkDeviceSize StagingRing::getCapacity() const {
+    return capacity;
+}
+// --------------------------------------------------------------------------------
+
+StagingRingStats StagingRing::getStats() const {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    return stats;
+}
+// ================================================================================
+// ================================================================================
+
+const char* memoryCategoryName(MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::Textures: return "textures";
+        case MemoryCategory::Meshes: return "meshes";
+        case MemoryCategory::Staging: return "staging";
+        case MemoryCategory::Attachments: return "attachments";
+        case MemoryCategory::Other: return "other";
+        default: return "unknown";
+    }
+}
+// ================================================================================
+// ================================================================================
+
+AllocatorManager::AllocatorManager(VkPhysicalDevice physicalDevice, VkDevice device, VkInstance instance,
+                                   VkDeviceSize stagingRingSize, bool memoryBudget) :
+    device(device), memoryBudget(memoryBudget){
+    // VMA may use core entry points up to the version the device implements
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    uint32_t apiVersion = VK_API_VERSION_1_0;
+    for (uint32_t version : {VK_API_VERSION_1_3, VK_API_VERSION_1_2, VK_API_VERSION_1_1}) {
+        if (properties.apiVersion >= version) {
+            apiVersion = version;
+            break;
+        }
+    }
+
     VmaAllocatorCreateInfo allocatorInfo = {};
     allocatorInfo.physicalDevice = physicalDevice;
     allocatorInfo.device = device;
     allocatorInfo.instance = instance;
+    allocatorInfo.vulkanApiVersion = apiVersion;
+    if (memoryBudget) {
+        allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
 
     if (vmaCreateAllocator(&allocatorInfo, &allocator) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create VMA allocator!");
     }
+
+    try {
+        stagingRing = std::make_unique<StagingRing>(allocator, stagingRingSize);
+    } catch (const std::runtime_error&) {
+        vmaDestroyAllocator(allocator);
+        throw;
+    }
+    // The ring allocates on its own, so it is counted here for its whole lifetime
+    count(MemoryCategory::Staging, stagingRingSize, true);
 }
 // --------------------------------------------------------------------------------
 
 AllocatorManager::~AllocatorManager() {
+    // The device is idle, so a pass still waiting on its frame can complete now
+    if (defragmentation != VK_NULL_HANDLE) {
+        if (passPending) {
+            vmaEndDefragmentationPass(allocator, defragmentation, &pass);
+        }
+        vmaEndDefragmentation(allocator, defragmentation, nullptr);
+    }
+    // The ring buffer must be returned to the allocator before it is destroyed
+    stagingRing.reset();
     vmaDestroyAllocator(allocator);
 }
 // --------------------------------------------------------------------------------
 
 void AllocatorManager::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage, 
-                                    VkBuffer& buffer, VmaAllocation& allocation) {
+                                    VkBuffer& buffer, VmaAllocation& allocation, MemoryCategory category) {
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = size;
@@ -46,13 +200,55 @@ void AllocatorManager::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
 
     VmaAllocationCreateInfo allocInfo = {};
     allocInfo.usage = memoryUsage;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
 
     if (vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer, &allocation, nullptr) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create buffer!");
+        allocInfo.flags &= ~VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+        if (vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer, &allocation, nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create buffer!");
+        }
+        std::lock_guard<std::mutex> lock(statsMutex);
+        ++stats.overBudgetAllocations;
     }
+    track(allocation, category);
 }
 // --------------------------------------------------------------------------------
 
+void AllocatorManager::createImage(const VkImageCreateInfo& imageInfo, VmaMemoryUsage memoryUsage,
+                                   VkImage& image, VmaAllocation& allocation, MemoryCategory category) {
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = memoryUsage;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+
+    if (vmaCreateImage(allocator, &imageInfo, &allocInfo, &image, &allocation, nullptr) != VK_SUCCESS) {
+        allocInfo.flags &= ~VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+        if (vmaCreateImage(allocator, &imageInfo, &allocInfo, &image, &allocation, nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create image!");
+        }
+        std::lock_guard<std::mutex> lock(statsMutex);
+        ++stats.overBudgetAllocations;
+    }
+    track(allocation, category);
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::allocateMemory(const VkMemoryRequirements& requirements, VmaMemoryUsage memoryUsage,
+                                      VmaAllocation& allocation, MemoryCategory category) {
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = memoryUsage;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+
+    if (vmaAllocateMemory(allocator, &requirements, &allocInfo, &allocation, nullptr) != VK_SUCCESS) {
+        allocInfo.flags &= ~VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+        if (vmaAllocateMemory(allocator, &requirements, &allocInfo, &allocation, nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate memory!");
+        }
+        std::lock_guard<std::mutex> lock(statsMutex);
+        ++stats.overBudgetAllocations;
+    }
+    track(allocation, category);
+}
+
 void AllocatorManager::mapMemory(VmaAllocation allocation, void** data) {
     if (vmaMapMemory(allocator, allocation, data) != VK_SUCCESS) {
         throw std::runtime_error("Failed to map memory!");
@@ -66,47 +262,201 @@ void AllocatorManager::unmapMemory(VmaAllocation allocation) {
 // --------------------------------------------------------------------------------
 
 void AllocatorManager::destroyBuffer(VkBuffer buffer, VmaAllocation allocation) {
+    untrack(allocation);
     vmaDestroyBuffer(allocator, buffer, allocation);
 }
 // --------------------------------------------------------------------------------
 
-void AllocatorManager::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkQueue graphicsQueue, VkCommandPool commandPool) {
-    VkCommandBufferAllocateInfo allocInfo = {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = commandPool;
-    allocInfo.commandBufferCount = 1;
+void AllocatorManager::destroyImage(VkImage image, VmaAllocation allocation) {
+    untrack(allocation);
+    vmaDestroyImage(allocator, image, allocation);
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::freeMemory(VmaAllocation allocation) {
+    untrack(allocation);
+    vmaFreeMemory(allocator, allocation);
+}
+// --------------------------------------------------------------------------------
 
-    VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+void AllocatorManager::setMoveHandler(VmaAllocation allocation, MoveHandler handler) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    if (handler) {
+        moveHandlers[allocation] = std::move(handler);
+    } else {
+        moveHandlers.erase(allocation);
+    }
+}
+// --------------------------------------------------------------------------------
 
-    VkCommandBufferBeginInfo beginInfo = {};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+void AllocatorManager::beginDefragmentation(VkDeviceSize maxBytesPerPass) {
+    if (defragmentation != VK_NULL_HANDLE) {
+        return;
+    }
+    VmaDefragmentationInfo info = {};
+    info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+    info.maxBytesPerPass = maxBytesPerPass;
+    if (vmaBeginDefragmentation(allocator, &info, &defragmentation) != VK_SUCCESS) {
+        defragmentation = VK_NULL_HANDLE;
+        throw std::runtime_error("Failed to begin defragmentation!");
+    }
+}
+// --------------------------------------------------------------------------------
 
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+void AllocatorManager::defragmentStep(VkCommandBuffer commandBuffer, DeletionQueue& deletionQueue) {
+    if (defragmentation == VK_NULL_HANDLE || passPending) {
+        return;
+    }
 
-    VkBufferCopy copyRegion = {};
-    copyRegion.size = size;
-    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+    pass = {};
+    if (vmaBeginDefragmentationPass(allocator, defragmentation, &pass) == VK_SUCCESS) {
+        // Nothing left that VMA wants to move
+        endDefragmentation();
+        return;
+    }
 
-    vkEndCommandBuffer(commandBuffer);
+    // Handlers are copied out so they can take the manager's lock themselves
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < pass.moveCount; ++i) {
+        VmaDefragmentationMove& move = pass.pMoves[i];
+        MoveHandler handler;
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            auto it = moveHandlers.find(move.srcAllocation);
+            if (it != moveHandlers.end()) {
+                handler = it->second;
+            }
+        }
+        if (handler && handler(move.dstTmpAllocation, commandBuffer, deletionQueue)) {
+            ++accepted;
+        } else {
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+        }
+    }
+    if (accepted > 0) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        ++stats.defragmentationPasses;
+        stats.allocationsMoved += accepted;
+    }
 
-    VkSubmitInfo submitInfo = {};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
+    // VMA frees the old memory when the pass ends, which must wait for the copies
+    passPending = true;
+    deletionQueue.push([this]() {
+        finishPass();
+    });
+}
+// --------------------------------------------------------------------------------
 
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue);
+bool AllocatorManager::isDefragmenting() const {
+    return defragmentation != VK_NULL_HANDLE;
+}
+// --------------------------------------------------------------------------------
 
-    vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+void AllocatorManager::setCurrentFrame(uint64_t frameNumber) {
+    vmaSetCurrentFrameIndex(allocator, static_cast<uint32_t>(frameNumber));
+}
+// --------------------------------------------------------------------------------
+
+MemoryStats AllocatorManager::getStats() const {
+    MemoryStats snapshot;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        snapshot = stats;
+    }
+
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(allocator, &memoryProperties);
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+    vmaGetHeapBudgets(allocator, budgets);
+    for (uint32_t heap = 0; heap < memoryProperties->memoryHeapCount; ++heap) {
+        snapshot.usage += budgets[heap].usage;
+        snapshot.budget += budgets[heap].budget;
+    }
+    snapshot.budgetFromDriver = memoryBudget;
+    return snapshot;
+}
+// --------------------------------------------------------------------------------
+
+std::string AllocatorManager::buildStatsString(bool detailed) const {
+    char* json = nullptr;
+    vmaBuildStatsString(allocator, &json, detailed ? VK_TRUE : VK_FALSE);
+    std::string result = json ? json : "";
+    vmaFreeStatsString(allocator, json);
+    return result;
 }
 // --------------------------------------------------------------------------------
 
 VmaAllocator AllocatorManager::getAllocator() const { 
     return allocator; 
 }
+// --------------------------------------------------------------------------------
+
+VkDevice AllocatorManager::getDevice() const {
+    return device;
+}
+// --------------------------------------------------------------------------------
+
+StagingRing& AllocatorManager::getStagingRing() {
+    return *stagingRing;
+}
+// ================================================================================
+
+void AllocatorManager::track(VmaAllocation allocation, MemoryCategory category) {
+    // The category rides on the allocation, so it survives defragmentation moves
+    vmaSetAllocationUserData(allocator, allocation,
+                             reinterpret_cast<void*>(static_cast<uintptr_t>(category) + 1));
+    VmaAllocationInfo info = {};
+    vmaGetAllocationInfo(allocator, allocation, &info);
+    count(category, info.size, true);
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::untrack(VmaAllocation allocation) {
+    if (allocation == VK_NULL_HANDLE) {
+        return;
+    }
+    VmaAllocationInfo info = {};
+    vmaGetAllocationInfo(allocator, allocation, &info);
+    const uintptr_t tag = reinterpret_cast<uintptr_t>(info.pUserData);
+    if (tag != 0) {
+        count(static_cast<MemoryCategory>(tag - 1), info.size, false);
+    }
+    std::lock_guard<std::mutex> lock(statsMutex);
+    moveHandlers.erase(allocation);
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::count(MemoryCategory category, VkDeviceSize bytes, bool add) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    MemoryCategoryStats& entry = stats.categories[static_cast<size_t>(category)];
+    if (add) {
+        ++entry.allocations;
+        entry.bytes += bytes;
+        entry.peakBytes = std::max(entry.peakBytes, entry.bytes);
+    } else {
+        entry.allocations -= std::min(entry.allocations, 1u);
+        entry.bytes -= std::min(entry.bytes, bytes);
+    }
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::finishPass() {
+    passPending = false;
+    if (vmaEndDefragmentationPass(allocator, defragmentation, &pass) == VK_SUCCESS) {
+        endDefragmentation();
+    }
+}
+// --------------------------------------------------------------------------------
+
+void AllocatorManager::endDefragmentation() {
+    VmaDefragmentationStats defragmentationStats = {};
+    vmaEndDefragmentation(allocator, defragmentation, &defragmentationStats);
+    defragmentation = VK_NULL_HANDLE;
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.bytesMoved += defragmentationStats.bytesMoved;
+    stats.bytesFreed += defragmentationStats.bytesFreed;
+}
 // ================================================================================
 // ================================================================================
 // eof
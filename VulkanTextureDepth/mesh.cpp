@@ -0,0 +1,248 @@
+// ================================================================================
+// ================================================================================
+// - File:    mesh.cpp
+// - Purpose: This file contains the implementation of the MeshSource classes
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/mesh.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+// ================================================================================
+// ================================================================================
+
+VkIndexType MeshSource::selectIndexType(uint32_t vertexCount) {
+    return vertexCount <= std::numeric_limits<uint16_t>::max() ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+// --------------------------------------------------------------------------------
+
+VkDeviceSize MeshSource::indexSize(VkIndexType indexType) {
+    switch (indexType) {
+        case VK_INDEX_TYPE_UINT16:
+            return sizeof(uint16_t);
+        case VK_INDEX_TYPE_UINT32:
+            return sizeof(uint32_t);
+        default:
+            throw std::runtime_error("Only 16-bit and 32-bit index types are supported!");
+    }
+}
+// ================================================================================
+
+glm::vec4 MeshSource::boundPositions(const glm::vec3* positions, size_t count, size_t stride) {
+    if (positions == nullptr || count == 0) {
+        return glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+    auto at = [positions, stride](size_t i) -> const glm::vec3& {
+        return *reinterpret_cast<const glm::vec3*>(reinterpret_cast<const char*>(positions) + i * stride);
+    };
+
+    glm::vec3 lower = at(0);
+    glm::vec3 upper = at(0);
+    for (size_t i = 1; i < count; ++i) {
+        lower = glm::min(lower, at(i));
+        upper = glm::max(upper, at(i));
+    }
+    const glm::vec3 center = (lower + upper) * 0.5f;
+    float radius = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        radius = std::max(radius, glm::length(at(i) - center));
+    }
+    return glm::vec4(center, radius);
+}
+// ================================================================================
+// ================================================================================
+
+VectorMeshSource::VectorMeshSource(const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices)
+    : vertices(vertices), indices16(&indices) {}
+// --------------------------------------------------------------------------------
+
+VectorMeshSource::VectorMeshSource(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+    : vertices(vertices), indices32(&indices) {}
+// --------------------------------------------------------------------------------
+
+uint32_t VectorMeshSource::getVertexCount() const {
+    return static_cast<uint32_t>(vertices.size());
+}
+// --------------------------------------------------------------------------------
+
+uint32_t VectorMeshSource::getIndexCount() const {
+    return static_cast<uint32_t>(indices16 != nullptr ? indices16->size() : indices32->size());
+}
+// --------------------------------------------------------------------------------
+
+void VectorMeshSource::readVertices(uint32_t first, uint32_t count, Vertex* out) const {
+    std::copy_n(vertices.begin() + first, count, out);
+}
+// --------------------------------------------------------------------------------
+
+void VectorMeshSource::readIndices(uint32_t first, uint32_t count, uint32_t* out) const {
+    if (indices16 != nullptr) {
+        std::copy_n(indices16->begin() + first, count, out);
+    } else {
+        std::copy_n(indices32->begin() + first, count, out);
+    }
+}
+// --------------------------------------------------------------------------------
+
+glm::vec4 VectorMeshSource::getBoundingSphere() const {
+    return boundPositions(vertices.empty() ? nullptr : &vertices[0].pos, vertices.size(), sizeof(Vertex));
+}
+// ================================================================================
+// ================================================================================
+
+ObjMesh::ObjMesh(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Failed to open mesh file " + path + "!");
+    }
+    parse(in, path);
+}
+// --------------------------------------------------------------------------------
+
+ObjMesh::ObjMesh(std::istream& in, const std::string& name) {
+    parse(in, name);
+}
+// --------------------------------------------------------------------------------
+
+uint32_t ObjMesh::getVertexCount() const {
+    return static_cast<uint32_t>(corners.size());
+}
+// --------------------------------------------------------------------------------
+
+uint32_t ObjMesh::getIndexCount() const {
+    return static_cast<uint32_t>(indices.size());
+}
+// --------------------------------------------------------------------------------
+
+void ObjMesh::readVertices(uint32_t first, uint32_t count, Vertex* out) const {
+    for (uint32_t i = 0; i < count; ++i) {
+        const Corner& corner = corners[first + i];
+        out[i].pos = positions[corner.position];
+        out[i].color = glm::vec3(1.0f, 1.0f, 1.0f);
+        out[i].texCoord = corner.texCoord == UINT32_MAX ? glm::vec2(0.0f, 0.0f) : texCoords[corner.texCoord];
+    }
+}
+// --------------------------------------------------------------------------------
+
+void ObjMesh::readIndices(uint32_t first, uint32_t count, uint32_t* out) const {
+    std::copy_n(indices.begin() + first, count, out);
+}
+// --------------------------------------------------------------------------------
+
+glm::vec4 ObjMesh::getBoundingSphere() const {
+    return boundingSphere;
+}
+// ================================================================================
+
+void ObjMesh::parse(std::istream& in, const std::string& name) {
+    std::unordered_map<uint64_t, uint32_t> cornerIndices;
+    std::vector<uint32_t> face;
+    std::string line;
+    size_t lineNumber = 0;
+
+    auto fail = [&name, &lineNumber](const std::string& message) {
+        throw std::runtime_error(name + ":" + std::to_string(lineNumber) + ": " + message);
+    };
+    // OBJ indices are 1-based, and negative values count back from the latest element
+    auto resolve = [&fail](long value, size_t size) -> uint32_t {
+        const long long resolved = value < 0 ? static_cast<long long>(size) + value : value - 1;
+        if (value == 0 || resolved < 0 || resolved >= static_cast<long long>(size)) {
+            fail("index out of range");
+        }
+        return static_cast<uint32_t>(resolved);
+    };
+
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        const char* cursor = line.c_str();
+        while (*cursor == ' ' || *cursor == '\t') {
+            ++cursor;
+        }
+
+        if (cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == '\t')) {
+            char* end = nullptr;
+            glm::vec3 position;
+            for (int axis = 0; axis < 3; ++axis) {
+                position[axis] = std::strtof(cursor + (axis == 0 ? 2 : 0), &end);
+                if (end == cursor + (axis == 0 ? 2 : 0)) {
+                    fail("expected three position coordinates");
+                }
+                cursor = end;
+            }
+            positions.push_back(position);
+        } else if (cursor[0] == 'v' && cursor[1] == 't' && (cursor[2] == ' ' || cursor[2] == '\t')) {
+            char* end = nullptr;
+            const float u = std::strtof(cursor + 3, &end);
+            if (end == cursor + 3) {
+                fail("expected a texture coordinate");
+            }
+            cursor = end;
+            const float v = std::strtof(cursor, &end);
+            // OBJ puts the texture origin at the bottom left, Vulkan samples from the top left
+            texCoords.push_back(glm::vec2(u, end == cursor ? 0.0f : 1.0f - v));
+        } else if (cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t')) {
+            face.clear();
+            cursor += 2;
+            while (true) {
+                char* end = nullptr;
+                const long positionValue = std::strtol(cursor, &end, 10);
+                if (end == cursor) {
+                    break;
+                }
+                cursor = end;
+                uint32_t texCoord = UINT32_MAX;
+                if (*cursor == '/') {
+                    ++cursor;
+                    const long texCoordValue = std::strtol(cursor, &end, 10);
+                    if (end != cursor) {
+                        texCoord = resolve(texCoordValue, texCoords.size());
+                        cursor = end;
+                    }
+                    if (*cursor == '/') {
+                        // Normals are not part of the vertex layout; skip them
+                        ++cursor;
+                        std::strtol(cursor, &end, 10);
+                        cursor = end;
+                    }
+                }
+                const uint32_t position = resolve(positionValue, positions.size());
+
+                const uint64_t key = (static_cast<uint64_t>(position) << 32) | texCoord;
+                auto [entry, inserted] = cornerIndices.try_emplace(key, static_cast<uint32_t>(corners.size()));
+                if (inserted) {
+                    corners.push_back({position, texCoord});
+                }
+                face.push_back(entry->second);
+            }
+            if (face.size() < 3) {
+                fail("a face needs at least three vertices");
+            }
+            for (size_t i = 1; i + 1 < face.size(); ++i) {
+                indices.push_back(face[0]);
+                indices.push_back(face[i]);
+                indices.push_back(face[i + 1]);
+            }
+        }
+    }
+    if (indices.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error(name + " has more indices than a draw can address!");
+    }
+
+    boundingSphere = boundPositions(positions.empty() ? nullptr : positions.data(), positions.size(),
+                                    sizeof(glm::vec3));
+}
+// ================================================================================
+// ================================================================================
+// eof
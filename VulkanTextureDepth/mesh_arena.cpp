@@ -0,0 +1,263 @@
+// ================================================================================
+// ================================================================================
+// - File:    mesh_arena.cpp
+// - Purpose: This file contains the implementation of the MeshArena class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/mesh_arena.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// ================================================================================
+// ================================================================================
+
+MeshArena::MeshArena(AllocatorManager& allocatorManager,
+                     UploadQueue& uploadQueue,
+                     VkIndexType indexType,
+                     uint32_t vertexCapacity,
+                     uint32_t indexCapacity)
+    : allocatorManager(allocatorManager),
+      uploadQueue(uploadQueue),
+      indexType(indexType),
+      vertexCapacity(vertexCapacity),
+      indexCapacity(indexCapacity) {
+    try {
+        allocatorManager.createBuffer(sizeof(GpuVertex) * static_cast<VkDeviceSize>(vertexCapacity),
+                                      VERTEX_USAGE,
+                                      VMA_MEMORY_USAGE_GPU_ONLY, vertexBuffer, vertexBufferAllocation,
+                                      MemoryCategory::Meshes);
+        allocatorManager.createBuffer(MeshSource::indexSize(indexType) * indexCapacity,
+                                      INDEX_USAGE,
+                                      VMA_MEMORY_USAGE_GPU_ONLY, indexBuffer, indexBufferAllocation,
+                                      MemoryCategory::Meshes);
+
+        // The blocks count elements rather than bytes, so offsets are vertex and index numbers
+        VmaVirtualBlockCreateInfo blockInfo{};
+        blockInfo.size = vertexCapacity;
+        if (vmaCreateVirtualBlock(&blockInfo, &vertexBlock) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create the mesh arena vertex block!");
+        }
+        blockInfo.size = indexCapacity;
+        if (vmaCreateVirtualBlock(&blockInfo, &indexBlock) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create the mesh arena index block!");
+        }
+    } catch (...) {
+        destroy();
+        throw;
+    }
+
+    allocatorManager.setMoveHandler(vertexBufferAllocation,
+        [this](VmaAllocation destination, VkCommandBuffer commandBuffer, DeletionQueue& deletionQueue) {
+            return moveBuffer(vertexBuffer, sizeof(GpuVertex) * static_cast<VkDeviceSize>(this->vertexCapacity),
+                              VERTEX_USAGE, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+                              destination, commandBuffer, deletionQueue);
+        });
+    allocatorManager.setMoveHandler(indexBufferAllocation,
+        [this](VmaAllocation destination, VkCommandBuffer commandBuffer, DeletionQueue& deletionQueue) {
+            return moveBuffer(indexBuffer, MeshSource::indexSize(this->indexType) * this->indexCapacity,
+                              INDEX_USAGE, VK_ACCESS_INDEX_READ_BIT,
+                              destination, commandBuffer, deletionQueue);
+        });
+}
+// --------------------------------------------------------------------------------
+
+MeshArena::~MeshArena() {
+    destroy();
+}
+// --------------------------------------------------------------------------------
+
+MeshRange MeshArena::allocate(const MeshSource& mesh) {
+    MeshRange range;
+    range.vertexCount = mesh.getVertexCount();
+    range.indexCount = mesh.getIndexCount();
+    if (range.vertexCount == 0 || range.indexCount == 0) {
+        throw std::runtime_error("Cannot add an empty mesh to the mesh arena!");
+    }
+    if (MeshSource::selectIndexType(range.vertexCount) == VK_INDEX_TYPE_UINT32 && indexType == VK_INDEX_TYPE_UINT16) {
+        throw std::runtime_error("A mesh of " + std::to_string(range.vertexCount) +
+                                 " vertices needs a mesh arena with 32-bit indices!");
+    }
+
+    VmaVirtualAllocationCreateInfo allocInfo{};
+    VkDeviceSize offset = 0;
+    allocInfo.size = range.vertexCount;
+    if (vmaVirtualAllocate(vertexBlock, &allocInfo, &range.vertexAllocation, &offset) != VK_SUCCESS) {
+        throw std::runtime_error("The mesh arena has no room for " + std::to_string(range.vertexCount) + " vertices!");
+    }
+    range.vertexOffset = static_cast<int32_t>(offset);
+
+    allocInfo.size = range.indexCount;
+    if (vmaVirtualAllocate(indexBlock, &allocInfo, &range.indexAllocation, &offset) != VK_SUCCESS) {
+        vmaVirtualFree(vertexBlock, range.vertexAllocation);
+        throw std::runtime_error("The mesh arena has no room for " + std::to_string(range.indexCount) + " indices!");
+    }
+    range.firstIndex = static_cast<uint32_t>(offset);
+
+    try {
+        uploadVertices(mesh, range);
+        uploadIndices(mesh, range);
+        uploadTicket = uploadQueue.pendingTicket();
+    } catch (...) {
+        vmaVirtualFree(vertexBlock, range.vertexAllocation);
+        vmaVirtualFree(indexBlock, range.indexAllocation);
+        throw;
+    }
+    ++meshCount;
+    return range;
+}
+// --------------------------------------------------------------------------------
+
+void MeshArena::free(MeshRange& range) {
+    if (range.vertexAllocation == VK_NULL_HANDLE) {
+        return;
+    }
+    vmaVirtualFree(vertexBlock, range.vertexAllocation);
+    vmaVirtualFree(indexBlock, range.indexAllocation);
+    range = MeshRange{};
+    --meshCount;
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer MeshArena::getVertexBuffer() const {
+    return vertexBuffer;
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer MeshArena::getIndexBuffer() const {
+    return indexBuffer;
+}
+// --------------------------------------------------------------------------------
+
+VkIndexType MeshArena::getIndexType() const {
+    return indexType;
+}
+// --------------------------------------------------------------------------------
+
+MeshArenaStats MeshArena::getStats() const {
+    MeshArenaStats stats;
+    stats.meshCount = meshCount;
+    stats.vertexCapacity = vertexCapacity;
+    stats.indexCapacity = indexCapacity;
+
+    VmaStatistics blockStats{};
+    vmaGetVirtualBlockStatistics(vertexBlock, &blockStats);
+    stats.verticesUsed = blockStats.allocationBytes;
+    vmaGetVirtualBlockStatistics(indexBlock, &blockStats);
+    stats.indicesUsed = blockStats.allocationBytes;
+    return stats;
+}
+// ================================================================================
+
+void MeshArena::uploadVertices(const MeshSource& mesh, const MeshRange& range) {
+    const uint32_t chunkVertices = static_cast<uint32_t>(UPLOAD_CHUNK_BYTES / sizeof(Vertex));
+    std::vector<Vertex> chunk(std::min(chunkVertices, range.vertexCount));
+    std::vector<GpuVertex> packed(chunk.size());
+    for (uint32_t first = 0; first < range.vertexCount; first += chunkVertices) {
+        const uint32_t count = std::min(chunkVertices, range.vertexCount - first);
+        mesh.readVertices(first, count, chunk.data());
+        std::transform(chunk.begin(), chunk.begin() + count, packed.begin(), GpuVertex::pack);
+        const VkDeviceSize dstOffset = sizeof(GpuVertex) * (static_cast<VkDeviceSize>(range.vertexOffset) + first);
+        uploadQueue.uploadBuffer(vertexBuffer, packed.data(), sizeof(GpuVertex) * count, dstOffset);
+    }
+}
+// --------------------------------------------------------------------------------
+
+void MeshArena::uploadIndices(const MeshSource& mesh, const MeshRange& range) {
+    const VkDeviceSize indexBytes = MeshSource::indexSize(indexType);
+    const uint32_t chunkIndices = static_cast<uint32_t>(UPLOAD_CHUNK_BYTES / sizeof(uint32_t));
+    std::vector<uint32_t> chunk(std::min(chunkIndices, range.indexCount));
+    std::vector<uint16_t> narrowed(indexType == VK_INDEX_TYPE_UINT16 ? chunk.size() : 0);
+    for (uint32_t first = 0; first < range.indexCount; first += chunkIndices) {
+        const uint32_t count = std::min(chunkIndices, range.indexCount - first);
+        mesh.readIndices(first, count, chunk.data());
+        const void* data = chunk.data();
+        if (indexType == VK_INDEX_TYPE_UINT16) {
+            std::copy_n(chunk.begin(), count, narrowed.begin());
+            data = narrowed.data();
+        }
+        const VkDeviceSize dstOffset = indexBytes * (static_cast<VkDeviceSize>(range.firstIndex) + first);
+        uploadQueue.uploadBuffer(indexBuffer, data, indexBytes * count, dstOffset);
+    }
+}
+// --------------------------------------------------------------------------------
+
+bool MeshArena::moveBuffer(VkBuffer& buffer, VkDeviceSize size, VkBufferUsageFlags usage, VkAccessFlags readAccess,
+                           VmaAllocation destination, VkCommandBuffer commandBuffer, DeletionQueue& deletionQueue) {
+    if (!uploadQueue.isComplete(uploadTicket)) {
+        return false;
+    }
+
+    VkDevice device = allocatorManager.getDevice();
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VkBuffer moved = VK_NULL_HANDLE;
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &moved) != VK_SUCCESS) {
+        return false;
+    }
+    if (vmaBindBufferMemory(allocatorManager.getAllocator(), destination, moved) != VK_SUCCESS) {
+        vkDestroyBuffer(device, moved, nullptr);
+        return false;
+    }
+
+    VkBufferCopy region{};
+    region.size = size;
+    vkCmdCopyBuffer(commandBuffer, buffer, moved, 1, &region);
+
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = readAccess;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = moved;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                         0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    // Earlier frames still read the old buffer; its memory is freed when the pass ends
+    VkBuffer old = buffer;
+    deletionQueue.push([device, old]() {
+        vkDestroyBuffer(device, old, nullptr);
+    });
+    buffer = moved;
+    return true;
+}
+// --------------------------------------------------------------------------------
+
+void MeshArena::destroy() {
+    if (indexBlock != VK_NULL_HANDLE) {
+        vmaClearVirtualBlock(indexBlock);
+        vmaDestroyVirtualBlock(indexBlock);
+        indexBlock = VK_NULL_HANDLE;
+    }
+    if (vertexBlock != VK_NULL_HANDLE) {
+        vmaClearVirtualBlock(vertexBlock);
+        vmaDestroyVirtualBlock(vertexBlock);
+        vertexBlock = VK_NULL_HANDLE;
+    }
+    if (indexBuffer != VK_NULL_HANDLE) {
+        allocatorManager.destroyBuffer(indexBuffer, indexBufferAllocation);
+        indexBuffer = VK_NULL_HANDLE;
+    }
+    if (vertexBuffer != VK_NULL_HANDLE) {
+        allocatorManager.destroyBuffer(vertexBuffer, vertexBufferAllocation);
+        vertexBuffer = VK_NULL_HANDLE;
+    }
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,236 @@
+// ================================================================================
+// ================================================================================
+// - File:    offscreen.cpp
+// - Purpose: This file contains the implementation of the OffscreenTarget class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/offscreen.hpp"
+
+#include <stdexcept>
+#include <utility>
+// ================================================================================
+// ================================================================================
+
+OffscreenTarget::OffscreenTarget(AllocatorManager& allocatorManager, VkDevice device, VkExtent2D extent,
+                                 VkFormat format, uint32_t imageCount, bool readback)
+    : allocatorManager(allocatorManager),
+      device(device),
+      extent(extent),
+      format(format),
+      readback(readback) {
+    try {
+        createImages(imageCount);
+    } catch (...) {
+        destroy();
+        throw;
+    }
+}
+// --------------------------------------------------------------------------------
+
+OffscreenTarget::~OffscreenTarget() {
+    destroy();
+}
+// --------------------------------------------------------------------------------
+
+VkExtent2D OffscreenTarget::getExtent() const {
+    return extent;
+}
+// --------------------------------------------------------------------------------
+
+VkFormat OffscreenTarget::getFormat() const {
+    return format;
+}
+// --------------------------------------------------------------------------------
+
+const std::vector<VkImageView>& OffscreenTarget::getImageViews() const {
+    return imageViews;
+}
+// --------------------------------------------------------------------------------
+
+bool OffscreenTarget::hasReadback() const {
+    return readback;
+}
+// --------------------------------------------------------------------------------
+
+void OffscreenTarget::setReadbackCallback(std::function<void(const ReadbackFrame&)> callback) {
+    readbackCallback = std::move(callback);
+}
+// --------------------------------------------------------------------------------
+
+void OffscreenTarget::recordReadback(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint64_t frame) {
+    if (!readback) {
+        return;
+    }
+    Image& target = images.at(imageIndex);
+
+    // The render pass has already moved the image to TRANSFER_SRC_OPTIMAL; this only
+    // orders the copy after the color writes
+    VkImageMemoryBarrier imageBarrier{};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = target.image;
+    imageBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageBarrier.subresourceRange.levelCount = 1;
+    imageBarrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;    // Tightly packed rows
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {extent.width, extent.height, 1};
+    vkCmdCopyImageToBuffer(commandBuffer, target.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           target.readbackBuffer, 1, &region);
+
+    // The host reads the buffer after the fence
+    VkMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+
+    target.pending = true;
+    target.frame = frame;
+}
+// --------------------------------------------------------------------------------
+
+void OffscreenTarget::resolveReadback(uint32_t imageIndex) {
+    if (!readback || imageIndex >= images.size() || !images[imageIndex].pending) {
+        return;
+    }
+    Image& target = images[imageIndex];
+    target.pending = false;
+
+    vmaInvalidateAllocation(allocatorManager.getAllocator(), target.readbackAllocation, 0, getImageBytes());
+    if (readbackCallback) {
+        ReadbackFrame frame;
+        frame.frame = target.frame;
+        frame.extent = extent;
+        frame.format = format;
+        frame.pixels = target.mapped;
+        frame.rowPitch = static_cast<size_t>(extent.width) * 4;
+        readbackCallback(frame);
+    }
+}
+// --------------------------------------------------------------------------------
+
+void OffscreenTarget::writePpm(std::ostream& out, const ReadbackFrame& frame) {
+    bool bgra = false;
+    switch (frame.format) {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            break;
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+            bgra = true;
+            break;
+        default:
+            throw std::runtime_error("Only RGBA8 and BGRA8 frames can be written as PPM!");
+    }
+
+    out << "P6\n" << frame.extent.width << ' ' << frame.extent.height << "\n255\n";
+    std::vector<char> row(static_cast<size_t>(frame.extent.width) * 3);
+    for (uint32_t y = 0; y < frame.extent.height; ++y) {
+        const uint8_t* source = frame.pixels + y * frame.rowPitch;
+        for (uint32_t x = 0; x < frame.extent.width; ++x) {
+            const uint8_t* pixel = source + x * 4;
+            row[x * 3 + 0] = static_cast<char>(bgra ? pixel[2] : pixel[0]);
+            row[x * 3 + 1] = static_cast<char>(pixel[1]);
+            row[x * 3 + 2] = static_cast<char>(bgra ? pixel[0] : pixel[2]);
+        }
+        out.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+}
+// ================================================================================
+
+VkDeviceSize OffscreenTarget::getImageBytes() const {
+    return static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+}
+// --------------------------------------------------------------------------------
+
+void OffscreenTarget::createImages(uint32_t imageCount) {
+    images.resize(imageCount);
+    for (Image& target : images) {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = {extent.width, extent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        allocatorManager.createImage(imageInfo, VMA_MEMORY_USAGE_GPU_ONLY, target.image, target.allocation,
+                                     MemoryCategory::Attachments);
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = target.image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = format;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+        if (vkCreateImageView(device, &viewInfo, nullptr, &target.view) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create offscreen image view!");
+        }
+        imageViews.push_back(target.view);
+
+        if (readback) {
+            allocatorManager.createBuffer(getImageBytes(), VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                          VMA_MEMORY_USAGE_GPU_TO_CPU, target.readbackBuffer, target.readbackAllocation,
+                                          MemoryCategory::Staging);
+            allocatorManager.mapMemory(target.readbackAllocation, reinterpret_cast<void**>(&target.mapped));
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+void OffscreenTarget::destroy() {
+    for (Image& target : images) {
+        if (target.readbackBuffer != VK_NULL_HANDLE) {
+            if (target.mapped != nullptr) {
+                allocatorManager.unmapMemory(target.readbackAllocation);
+            }
+            allocatorManager.destroyBuffer(target.readbackBuffer, target.readbackAllocation);
+        }
+        if (target.view != VK_NULL_HANDLE) {
+            vkDestroyImageView(device, target.view, nullptr);
+        }
+        if (target.image != VK_NULL_HANDLE) {
+            allocatorManager.destroyImage(target.image, target.allocation);
+        }
+        target = Image{};
+    }
+    images.clear();
+    imageViews.clear();
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,136 @@
+// ================================================================================
+// ================================================================================
+// - File:    pipeline_cache.cpp
+// - Purpose: This file contains the implementation of the PipelineCache class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/pipeline_cache.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+// ================================================================================
+// ================================================================================
+
+PipelineCache::PipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& cachePath)
+    : device(device),
+      cachePath(cachePath) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    std::vector<uint8_t> data;
+    std::ifstream file(cachePath, std::ios::binary | std::ios::ate);
+    if (file.is_open()) {
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file || !validateHeader(data, properties)) {
+            std::cerr << "Discarding pipeline cache " << cachePath
+                      << ": it was written for a different device or driver." << std::endl;
+            data.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    VkResult result = vkCreatePipelineCache(device, &createInfo, nullptr, &pipelineCache);
+    if (result != VK_SUCCESS && !data.empty()) {
+        // The header matched but the driver still rejected the payload; start empty
+        createInfo.initialDataSize = 0;
+        createInfo.pInitialData = nullptr;
+        data.clear();
+        result = vkCreatePipelineCache(device, &createInfo, nullptr, &pipelineCache);
+    }
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("PipelineCache: Failed to create pipeline cache. Error code: " +
+                                 std::to_string(static_cast<int>(result)));
+    }
+    loadedFromDisk = !data.empty();
+}
+// --------------------------------------------------------------------------------
+
+PipelineCache::~PipelineCache() {
+    if (pipelineCache != VK_NULL_HANDLE) {
+        save();
+        vkDestroyPipelineCache(device, pipelineCache, nullptr);
+        pipelineCache = VK_NULL_HANDLE;
+    }
+}
+// --------------------------------------------------------------------------------
+
+bool PipelineCache::save() const {
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device, pipelineCache, &size, nullptr) != VK_SUCCESS || size == 0) {
+        return false;
+    }
+    std::vector<uint8_t> data(size);
+    if (vkGetPipelineCacheData(device, pipelineCache, &size, data.data()) != VK_SUCCESS) {
+        return false;
+    }
+
+    const std::string temporaryPath = cachePath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to write pipeline cache " << temporaryPath << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(size));
+        if (!file) {
+            std::cerr << "Failed to write pipeline cache " << temporaryPath << std::endl;
+            return false;
+        }
+    }
+
+    // rename() does not replace an existing file on every platform
+    std::remove(cachePath.c_str());
+    if (std::rename(temporaryPath.c_str(), cachePath.c_str()) != 0) {
+        std::cerr << "Failed to replace pipeline cache " << cachePath << std::endl;
+        return false;
+    }
+    return true;
+}
+// --------------------------------------------------------------------------------
+
+void PipelineCache::recordCreationTime(std::chrono::nanoseconds duration) {
+    std::lock_guard<std::mutex> lock(timeMutex);
+    creationTime += duration;
+}
+// --------------------------------------------------------------------------------
+
+double PipelineCache::getCreationMilliseconds() const {
+    std::lock_guard<std::mutex> lock(timeMutex);
+    return std::chrono::duration<double, std::milli>(creationTime).count();
+}
+// --------------------------------------------------------------------------------
+
+bool PipelineCache::validateHeader(const std::vector<uint8_t>& data, const VkPhysicalDeviceProperties& properties) {
+    VkPipelineCacheHeaderVersionOne header;
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    return header.headerSize >= sizeof(header) &&
+           header.headerSize <= data.size() &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == properties.vendorID &&
+           header.deviceID == properties.deviceID &&
+           std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,246 @@
+// ================================================================================
+// ================================================================================
+// - File:    pipeline_library.cpp
+// - Purpose: This file contains the implementation of the PipelineLibrary and
+//            ShaderWatcher classes
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/pipeline_library.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+// ================================================================================
+// ================================================================================
+
+void ShaderWatcher::watch(const std::string& path) {
+    if (files.count(path) != 0) {
+        return;
+    }
+    WatchedFile file;
+    std::error_code error;
+    file.reported = std::filesystem::last_write_time(path, error);
+    file.exists = !error;
+    file.observed = file.reported;
+    files.emplace(path, file);
+}
+// --------------------------------------------------------------------------------
+
+std::vector<std::string> ShaderWatcher::poll() {
+    std::vector<std::string> changed;
+    for (auto& [path, file] : files) {
+        std::error_code error;
+        const std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+        if (error) {
+            // A compiler may delete the old output before writing the new one
+            file.observed = {};
+            continue;
+        }
+        const bool settled = time == file.observed;
+        file.observed = time;
+        if (settled && (!file.exists || time != file.reported)) {
+            file.reported = time;
+            file.exists = true;
+            changed.push_back(path);
+        }
+    }
+    return changed;
+}
+// ================================================================================
+// ================================================================================
+
+PipelineLibrary::PipelineLibrary(VkDevice device, BuildFunction build, size_t threadCount,
+                                 std::chrono::milliseconds pollInterval)
+    : device(device),
+      build(std::move(build)),
+      pollInterval(pollInterval),
+      lastPoll(std::chrono::steady_clock::now()),
+      compilePool(std::make_unique<ThreadPool>(threadCount)) {}
+// --------------------------------------------------------------------------------
+
+PipelineLibrary::~PipelineLibrary() {
+    // Joining the workers first means nothing can add to completed afterwards
+    compilePool.reset();
+    for (const Compile& result : completed) {
+        if (result.pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, result.pipeline, nullptr);
+        }
+    }
+    for (const Variant& variant : variants) {
+        if (variant.pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, variant.pipeline, nullptr);
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+PipelineId PipelineLibrary::createNow(const PipelineDesc& desc) {
+    Variant variant;
+    variant.desc = desc;
+    variant.pipeline = compile(desc);
+    variant.fallback = static_cast<PipelineId>(variants.size());
+    variants.push_back(variant);
+    watchShaders(desc);
+    return variant.fallback;
+}
+// --------------------------------------------------------------------------------
+
+PipelineId PipelineLibrary::request(const PipelineDesc& desc, PipelineId fallback) {
+    if (fallback >= variants.size()) {
+        throw std::runtime_error("PipelineLibrary: Unknown fallback pipeline " + std::to_string(fallback) + "!");
+    }
+    Variant variant;
+    variant.desc = desc;
+    variant.fallback = fallback;
+    const PipelineId id = static_cast<PipelineId>(variants.size());
+    variants.push_back(variant);
+    watchShaders(desc);
+    queueCompile(id);
+    return id;
+}
+// --------------------------------------------------------------------------------
+
+VkPipeline PipelineLibrary::get(PipelineId id) const {
+    // Fallbacks were created before the variants that use them, so the chain ends
+    while (variants[id].pipeline == VK_NULL_HANDLE && variants[id].fallback != id) {
+        id = variants[id].fallback;
+    }
+    return variants[id].pipeline;
+}
+// --------------------------------------------------------------------------------
+
+bool PipelineLibrary::isReady(PipelineId id) const {
+    return id < variants.size() && variants[id].pipeline != VK_NULL_HANDLE;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t PipelineLibrary::beginFrame(DeletionQueue& deletionQueue) {
+    std::vector<Compile> finished;
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        finished.swap(completed);
+    }
+
+    uint32_t published = 0;
+    for (const Compile& result : finished) {
+        --compilesInFlight;
+        Variant& variant = variants[result.id];
+        if (result.generation != variant.requested) {
+            // A newer compile of the same variant is already queued
+            if (result.pipeline != VK_NULL_HANDLE) {
+                vkDestroyPipeline(device, result.pipeline, nullptr);
+            }
+            continue;
+        }
+        if (result.pipeline == VK_NULL_HANDLE) {
+            std::cerr << "Pipeline " << variant.desc.vertFile
+                      << (variant.desc.fragFile.empty() ? "" : " + " + variant.desc.fragFile)
+                      << " failed to compile, keeping the previous pipeline: " << result.error << std::endl;
+            continue;
+        }
+        if (variant.pipeline != VK_NULL_HANDLE) {
+            VkDevice device = this->device;
+            VkPipeline old = variant.pipeline;
+            deletionQueue.push([device, old]() {
+                vkDestroyPipeline(device, old, nullptr);
+            });
+        }
+        variant.pipeline = result.pipeline;
+        ++published;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - lastPoll >= pollInterval) {
+        lastPoll = now;
+        for (const std::string& path : watcher.poll()) {
+            std::cout << "Shader " << path << " changed, rebuilding its pipelines." << std::endl;
+            for (PipelineId id = 0; id < variants.size(); ++id) {
+                if (variants[id].desc.vertFile == path || variants[id].desc.fragFile == path) {
+                    queueCompile(id);
+                }
+            }
+        }
+    }
+    return published;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t PipelineLibrary::pendingCompiles() const {
+    return compilesInFlight;
+}
+// --------------------------------------------------------------------------------
+
+bool PipelineLibrary::isSpirv(const std::vector<char>& code) {
+    // Magic, version, generator, bound and schema words
+    constexpr size_t headerBytes = 5 * sizeof(uint32_t);
+    constexpr uint32_t magic = 0x07230203u;
+    if (code.size() < headerBytes || code.size() % sizeof(uint32_t) != 0) {
+        return false;
+    }
+    uint32_t first = 0;
+    std::memcpy(&first, code.data(), sizeof(first));
+    return first == magic;
+}
+// ================================================================================
+
+VkPipeline PipelineLibrary::compile(const PipelineDesc& desc) const {
+    const std::vector<char> vertCode = readSpirv(desc.vertFile);
+    const std::vector<char> fragCode = desc.fragFile.empty() ? std::vector<char>() : readSpirv(desc.fragFile);
+    return build(desc, vertCode, fragCode);
+}
+// --------------------------------------------------------------------------------
+
+void PipelineLibrary::queueCompile(PipelineId id) {
+    Variant& variant = variants[id];
+    const uint64_t generation = ++variant.requested;
+    const PipelineDesc desc = variant.desc;
+    compilePool->submit([this, id, generation, desc]() {
+        Compile result;
+        result.id = id;
+        result.generation = generation;
+        try {
+            result.pipeline = compile(desc);
+        } catch (const std::exception& e) {
+            result.error = e.what();
+        }
+        std::lock_guard<std::mutex> lock(completedMutex);
+        completed.push_back(std::move(result));
+    });
+    ++compilesInFlight;
+}
+// --------------------------------------------------------------------------------
+
+void PipelineLibrary::watchShaders(const PipelineDesc& desc) {
+    watcher.watch(desc.vertFile);
+    if (!desc.fragFile.empty()) {
+        watcher.watch(desc.fragFile);
+    }
+}
+// --------------------------------------------------------------------------------
+
+std::vector<char> PipelineLibrary::readSpirv(const std::string& path) {
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open shader " + path + "!");
+    }
+    std::vector<char> code(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(code.data(), static_cast<std::streamsize>(code.size()));
+    if (!file || !isSpirv(code)) {
+        throw std::runtime_error("shader " + path + " is not a SPIR-V module!");
+    }
+    return code;
+}
+// ================================================================================
+// ================================================================================
+// eof
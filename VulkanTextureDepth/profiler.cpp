@@ -0,0 +1,332 @@
+// ================================================================================
+// ================================================================================
+// - File:    profiler.cpp
+// - Purpose: This file contains the implementation of the FrameTimingRing and
+//            Profiler classes
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/profiler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+// ================================================================================
+// ================================================================================
+
+FrameTimingRing::FrameTimingRing(size_t capacity)
+    : capacity(std::max<size_t>(capacity, 1)),
+      slots(new Slot[this->capacity]) {}
+// --------------------------------------------------------------------------------
+
+void FrameTimingRing::push(const FrameTiming& timing) {
+    const uint64_t index = head.load(std::memory_order_relaxed);
+    Slot& slot = slots[index % capacity];
+
+    // An odd sequence tells readers the slot is being rewritten
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timing = timing;
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    head.store(index + 1, std::memory_order_release);
+}
+// --------------------------------------------------------------------------------
+
+std::vector<FrameTiming> FrameTimingRing::snapshot() const {
+    const uint64_t end = head.load(std::memory_order_acquire);
+    const uint64_t begin = end > capacity ? end - capacity : 0;
+
+    std::vector<FrameTiming> timings;
+    timings.reserve(static_cast<size_t>(end - begin));
+    for (uint64_t index = begin; index < end; ++index) {
+        const Slot& slot = slots[index % capacity];
+        const uint64_t expected = 2 * index + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != expected) {
+            continue;
+        }
+        FrameTiming copy = slot.timing;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // The writer lapped this slot while it was being copied
+        if (slot.sequence.load(std::memory_order_relaxed) == expected) {
+            timings.push_back(copy);
+        }
+    }
+    return timings;
+}
+// --------------------------------------------------------------------------------
+
+uint64_t FrameTimingRing::getPushCount() const {
+    return head.load(std::memory_order_acquire);
+}
+// --------------------------------------------------------------------------------
+
+size_t FrameTimingRing::getCapacity() const {
+    return capacity;
+}
+// ================================================================================
+// ================================================================================
+
+Profiler::Profiler(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamily,
+                   uint32_t frameSlots, size_t historySize)
+    : device(device),
+      origin(Clock::now()),
+      frameStart(origin),
+      pending(frameSlots),
+      history(historySize) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    timestampPeriod = properties.limits.timestampPeriod;
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+    if (queueFamily < familyCount) {
+        timestampValidBits = families[queueFamily].timestampValidBits;
+    }
+    if (timestampValidBits == 0) {
+        return;
+    }
+
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = frameSlots * static_cast<uint32_t>(GPU_TIMESTAMP_COUNT);
+    if (vkCreateQueryPool(device, &poolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create timestamp query pool!");
+    }
+}
+// --------------------------------------------------------------------------------
+
+Profiler::~Profiler() {
+    if (queryPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, queryPool, nullptr);
+    }
+}
+// --------------------------------------------------------------------------------
+
+bool Profiler::hasGpuTimestamps() const {
+    return queryPool != VK_NULL_HANDLE;
+}
+// --------------------------------------------------------------------------------
+
+void Profiler::beginFrame(uint32_t frameIndex) {
+    frameStart = Clock::now();
+    currentSlot = frameIndex;
+    current = FrameTiming{};
+    current.frame = frameCounter++;
+    current.startMs = millisecondsBetween(origin, frameStart);
+}
+// --------------------------------------------------------------------------------
+
+void Profiler::beginScope(CpuScope scope) {
+    scopeBegin[static_cast<size_t>(scope)] = Clock::now();
+}
+// --------------------------------------------------------------------------------
+
+void Profiler::endScope(CpuScope scope) {
+    const size_t index = static_cast<size_t>(scope);
+    const Clock::time_point end = Clock::now();
+    current.scopeStartMs[index] = millisecondsBetween(frameStart, scopeBegin[index]);
+    current.scopeMs[index] = millisecondsBetween(scopeBegin[index], end);
+}
+// --------------------------------------------------------------------------------
+
+void Profiler::resolveFrame(uint32_t frameIndex) {
+    if (frameIndex >= pending.size() || !pending[frameIndex].submitted) {
+        return;
+    }
+    PendingFrame& frame = pending[frameIndex];
+    frame.submitted = false;
+
+    // Each timestamp is followed by its availability word
+    std::array<uint64_t, GPU_TIMESTAMP_COUNT * 2> results{};
+    VkResult result = vkGetQueryPoolResults(device, queryPool,
+                                            frameIndex * static_cast<uint32_t>(GPU_TIMESTAMP_COUNT),
+                                            static_cast<uint32_t>(GPU_TIMESTAMP_COUNT),
+                                            sizeof(results), results.data(), sizeof(uint64_t) * 2,
+                                            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    bool available = result == VK_SUCCESS;
+    for (size_t i = 0; available && i < GPU_TIMESTAMP_COUNT; ++i) {
+        available = results[i * 2 + 1] != 0;
+    }
+
+    if (available) {
+        const uint64_t begin = results[static_cast<size_t>(GpuTimestamp::FrameBegin) * 2];
+        const uint64_t culled = results[static_cast<size_t>(GpuTimestamp::CullingEnd) * 2];
+        const uint64_t end = results[static_cast<size_t>(GpuTimestamp::FrameEnd) * 2];
+        frame.timing.gpuValid = true;
+        frame.timing.gpuCullingMs = ticksToMilliseconds(begin, culled, timestampPeriod, timestampValidBits);
+        frame.timing.gpuRenderMs = ticksToMilliseconds(culled, end, timestampPeriod, timestampValidBits);
+        frame.timing.gpuFrameMs = ticksToMilliseconds(begin, end, timestampPeriod, timestampValidBits);
+    }
+    history.push(frame.timing);
+}
+// --------------------------------------------------------------------------------
+
+void Profiler::endFrame() {
+    current.cpuFrameMs = millisecondsBetween(frameStart, Clock::now());
+    if (!hasGpuTimestamps() || currentSlot >= pending.size()) {
+        history.push(current);
+        return;
+    }
+    pending[currentSlot].timing = current;
+    pending[currentSlot].submitted = true;
+}
+// --------------------------------------------------------------------------------
+
+void Profiler::resetQueries(VkCommandBuffer commandBuffer, uint32_t frameIndex) const {
+    if (!hasGpuTimestamps()) {
+        return;
+    }
+    vkCmdResetQueryPool(commandBuffer, queryPool,
+                        frameIndex * static_cast<uint32_t>(GPU_TIMESTAMP_COUNT),
+                        static_cast<uint32_t>(GPU_TIMESTAMP_COUNT));
+}
+// --------------------------------------------------------------------------------
+
+void Profiler::writeTimestamp(VkCommandBuffer commandBuffer, uint32_t frameIndex,
+                              GpuTimestamp timestamp, VkPipelineStageFlagBits stage) const {
+    if (!hasGpuTimestamps()) {
+        return;
+    }
+    vkCmdWriteTimestamp(commandBuffer, stage, queryPool,
+                        frameIndex * static_cast<uint32_t>(GPU_TIMESTAMP_COUNT) +
+                        static_cast<uint32_t>(timestamp));
+}
+// --------------------------------------------------------------------------------
+
+const FrameTimingRing& Profiler::getHistory() const {
+    return history;
+}
+// --------------------------------------------------------------------------------
+
+FrameSummary Profiler::summarize(size_t frames) const {
+    std::vector<FrameTiming> timings = history.snapshot();
+    if (timings.size() > frames) {
+        timings.erase(timings.begin(), timings.end() - static_cast<std::ptrdiff_t>(frames));
+    }
+    return summarize(timings);
+}
+// --------------------------------------------------------------------------------
+
+FrameSummary Profiler::summarize(const std::vector<FrameTiming>& timings) {
+    FrameSummary summary;
+    summary.frames = timings.size();
+    if (timings.empty()) {
+        return summary;
+    }
+
+    size_t gpuFrames = 0;
+    for (size_t i = 0; i < timings.size(); ++i) {
+        const FrameTiming& timing = timings[i];
+        summary.cpuMs += timing.cpuFrameMs;
+        if (timing.gpuValid) {
+            summary.gpuMs += timing.gpuFrameMs;
+            ++gpuFrames;
+        }
+        // A hitch shows up as a long gap between consecutive frame starts
+        const double intervalMs = i > 0 ? timing.startMs - timings[i - 1].startMs : timing.cpuFrameMs;
+        summary.worstMs = std::max(summary.worstMs, intervalMs);
+    }
+    summary.cpuMs /= static_cast<double>(timings.size());
+    if (gpuFrames > 0) {
+        summary.gpuMs /= static_cast<double>(gpuFrames);
+    }
+
+    const double spanMs = timings.back().startMs + timings.back().cpuFrameMs - timings.front().startMs;
+    if (spanMs > 0.0) {
+        summary.framesPerSecond = 1000.0 * static_cast<double>(timings.size()) / spanMs;
+    }
+    return summary;
+}
+// --------------------------------------------------------------------------------
+
+void Profiler::writeCsv(std::ostream& out, const std::vector<FrameTiming>& timings) {
+    out << "frame,start_ms,cpu_frame_ms";
+    for (size_t i = 0; i < CPU_SCOPE_COUNT; ++i) {
+        out << ',' << scopeName(static_cast<CpuScope>(i)) << "_ms";
+    }
+    out << ",gpu_culling_ms,gpu_render_ms,gpu_frame_ms\n";
+
+    for (const FrameTiming& timing : timings) {
+        out << timing.frame << ',' << timing.startMs << ',' << timing.cpuFrameMs;
+        for (double scopeMs : timing.scopeMs) {
+            out << ',' << scopeMs;
+        }
+        // Frames without GPU results leave the GPU columns empty
+        if (timing.gpuValid) {
+            out << ',' << timing.gpuCullingMs << ',' << timing.gpuRenderMs << ',' << timing.gpuFrameMs << '\n';
+        } else {
+            out << ",,,\n";
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+void Profiler::writeChromeTrace(std::ostream& out, const std::vector<FrameTiming>& timings) {
+    // Trace event timestamps and durations are in microseconds
+    bool first = true;
+    auto writeEvent = [&out, &first](const char* name, const char* category, int thread,
+                                     double startMs, double durationMs, uint64_t frame) {
+        out << (first ? "\n" : ",\n")
+            << "{\"name\":\"" << name << "\",\"cat\":\"" << category << "\",\"ph\":\"X\""
+            << ",\"pid\":1,\"tid\":" << thread
+            << ",\"ts\":" << startMs * 1000.0 << ",\"dur\":" << durationMs * 1000.0
+            << ",\"args\":{\"frame\":" << frame << "}}";
+        first = false;
+    };
+
+    out << "{\"traceEvents\":[";
+    for (const FrameTiming& timing : timings) {
+        writeEvent("Frame", "cpu", 1, timing.startMs, timing.cpuFrameMs, timing.frame);
+        for (size_t i = 0; i < CPU_SCOPE_COUNT; ++i) {
+            writeEvent(scopeName(static_cast<CpuScope>(i)), "cpu", 1,
+                       timing.startMs + timing.scopeStartMs[i], timing.scopeMs[i], timing.frame);
+        }
+        if (timing.gpuValid) {
+            const double gpuStartMs = timing.startMs +
+                                      timing.scopeStartMs[static_cast<size_t>(CpuScope::Submit)];
+            writeEvent("GPU frame", "gpu", 2, gpuStartMs, timing.gpuFrameMs, timing.frame);
+            writeEvent("Culling", "gpu", 2, gpuStartMs, timing.gpuCullingMs, timing.frame);
+            writeEvent("Render pass", "gpu", 2, gpuStartMs + timing.gpuCullingMs,
+                       timing.gpuRenderMs, timing.frame);
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+// --------------------------------------------------------------------------------
+
+double Profiler::ticksToMilliseconds(uint64_t begin, uint64_t end, float timestampPeriod, uint32_t validBits) {
+    const uint64_t mask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+    // Masked subtraction stays correct when the counter wraps between the two timestamps
+    const uint64_t ticks = (end - begin) & mask;
+    return static_cast<double>(ticks) * static_cast<double>(timestampPeriod) / 1.0e6;
+}
+// --------------------------------------------------------------------------------
+
+const char* Profiler::scopeName(CpuScope scope) {
+    switch (scope) {
+        case CpuScope::FenceWait: return "fence_wait";
+        case CpuScope::Acquire: return "acquire";
+        case CpuScope::UniformUpdate: return "uniform_update";
+        case CpuScope::Record: return "record";
+        case CpuScope::Submit: return "submit";
+        case CpuScope::Present: return "present";
+        default: return "unknown";
+    }
+}
+// ================================================================================
+
+double Profiler::millisecondsBetween(Clock::time_point begin, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -28,21 +28,33 @@ QueueFamilyIndices QueueFamily::findQueueFamilies(VkPhysicalDevice device, VkSur
     std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
-    int i = 0;
+    // Every family is visited, since the dedicated transfer and compute families are
+    // usually listed after the graphics family
+    uint32_t i = 0;
     for (const auto& queueFamily : queueFamilies) {
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+        const bool graphics = queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT;
+        const bool compute = queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT;
+        const bool transfer = queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT;
+
+        if (graphics && !indices.graphicsFamily.has_value()) {
             indices.graphicsFamily = i;
         }
 
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        if (surface != VK_NULL_HANDLE) {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        }
 
-        if (presentSupport) {
+        if (presentSupport && !indices.presentFamily.has_value()) {
             indices.presentFamily = i;
         }
 
-        if (indices.isComplete()) {
-            break;
+        if (transfer && !graphics && !compute && !indices.transferFamily.has_value()) {
+            indices.transferFamily = i;
+        }
+
+        if (compute && !graphics && !indices.computeFamily.has_value()) {
+            indices.computeFamily = i;
         }
 
         i++;
@@ -51,7 +63,7 @@ QueueFamilyIndices QueueFamily::findQueueFamilies(VkPhysicalDevice device, VkSur
     if (!indices.graphicsFamily.has_value()) {
         std::cerr << "Failed to find graphics queue family." << std::endl;
     }
-    if (!indices.presentFamily.has_value()) {
+    if (surface != VK_NULL_HANDLE && !indices.presentFamily.has_value()) {
         std::cerr << "Failed to find present queue family." << std::endl;
     }
 
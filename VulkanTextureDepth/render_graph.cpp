@@ -0,0 +1,814 @@
+// ================================================================================
+// ================================================================================
+// - File:    render_graph.cpp
+// - Purpose: This file contains the implementation of the RenderGraph class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/render_graph.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+// ================================================================================
+// ================================================================================
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+}
+// --------------------------------------------------------------------------------
+
+static bool lifetimesOverlap(const TransientBlock& a, const TransientBlock& b) {
+    return a.first <= b.last && b.first <= a.last;
+}
+// --------------------------------------------------------------------------------
+
+// The synchronization2 bits that have no legacy equal fold into the stage or access that
+// contains them
+static VkPipelineStageFlags legacyStages(VkPipelineStageFlags2 stages, VkPipelineStageFlags none) {
+    VkPipelineStageFlags legacy = static_cast<VkPipelineStageFlags>(stages & 0xFFFFFFFFull);
+    if (stages & (VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_RESOLVE_BIT |
+                  VK_PIPELINE_STAGE_2_BLIT_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT)) {
+        legacy |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
+    if (stages & (VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT)) {
+        legacy |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    }
+    return legacy != 0 ? legacy : none;
+}
+// --------------------------------------------------------------------------------
+
+static VkAccessFlags legacyAccess(VkAccessFlags2 access) {
+    VkAccessFlags legacy = static_cast<VkAccessFlags>(access & 0xFFFFFFFFull);
+    if (access & (VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT)) {
+        legacy |= VK_ACCESS_SHADER_READ_BIT;
+    }
+    if (access & VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT) {
+        legacy |= VK_ACCESS_SHADER_WRITE_BIT;
+    }
+    return legacy;
+}
+// ================================================================================
+// ================================================================================
+
+bool TransientImageDesc::operator==(const TransientImageDesc& other) const {
+    return format == other.format && extent.width == other.extent.width &&
+           extent.height == other.extent.height && usage == other.usage &&
+           aspect == other.aspect && samples == other.samples;
+}
+// ================================================================================
+// ================================================================================
+
+RenderGraph::~RenderGraph() {
+    releaseTransients(nullptr);
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::reset() {
+    resources.clear();
+    passes.clear();
+    batches.clear();
+    transientSlots.clear();
+    firstUseBarriers.clear();
+    lastUses.clear();
+}
+// --------------------------------------------------------------------------------
+
+ResourceId RenderGraph::importBuffer(const std::string& name, VkBuffer buffer) {
+    Resource resource;
+    resource.name = name;
+    resource.kind = ResourceKind::Buffer;
+    resource.buffer = buffer;
+    resources.push_back(resource);
+    return static_cast<ResourceId>(resources.size() - 1);
+}
+// --------------------------------------------------------------------------------
+
+ResourceId RenderGraph::importImage(const std::string& name, VkImage image, VkImageAspectFlags aspect,
+                                    VkImageLayout layout) {
+    Resource resource;
+    resource.name = name;
+    resource.kind = ResourceKind::Image;
+    resource.image = image;
+    resource.aspect = aspect;
+    resource.initialLayout = layout;
+    resources.push_back(resource);
+    return static_cast<ResourceId>(resources.size() - 1);
+}
+// --------------------------------------------------------------------------------
+
+ResourceId RenderGraph::createTransientImage(const std::string& name, const TransientImageDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.kind = ResourceKind::Transient;
+    resource.aspect = desc.aspect;
+    resource.desc = desc;
+    resources.push_back(resource);
+    return static_cast<ResourceId>(resources.size() - 1);
+}
+// --------------------------------------------------------------------------------
+
+PassId RenderGraph::addPass(const std::string& name, QueueClass queue, std::function<void(VkCommandBuffer)> execute) {
+    Pass pass;
+    pass.name = name;
+    pass.queue = queue;
+    pass.execute = std::move(execute);
+    passes.push_back(std::move(pass));
+    return static_cast<PassId>(passes.size() - 1);
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::read(PassId pass, ResourceId resource, const ResourceAccess& access) {
+    declare(pass, resource, access, false);
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::write(PassId pass, ResourceId resource, const ResourceAccess& access) {
+    declare(pass, resource, access, true);
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::keepPass(PassId pass) {
+    passes.at(pass).kept = true;
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::exportResource(ResourceId resource, const ResourceAccess& finalAccess) {
+    Resource& exported = resources.at(resource);
+    exported.exported = true;
+    exported.finalAccess = finalAccess;
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::compile(uint32_t graphicsFamily, uint32_t computeFamily) {
+    this->graphicsFamily = graphicsFamily;
+    this->computeFamily = computeFamily;
+    for (Pass& pass : passes) {
+        pass.before.clear();
+        pass.after.clear();
+    }
+    cullPasses();
+    deriveBarriers(graphicsFamily != computeFamily);
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::realize(VkDevice device, AllocatorManager& allocatorManager, DeletionQueue& deletionQueue) {
+    const std::vector<TransientBlock> lifetimes = getTransientLifetimes();
+    std::vector<ResourceId> used(firstUseBarriers.size());
+    for (ResourceId id = 0; id < transientSlots.size(); ++id) {
+        if (transientSlots[id] != UINT32_MAX) {
+            used[transientSlots[id]] = id;
+        }
+    }
+
+    bool unchanged = realized.size() == used.size();
+    for (size_t i = 0; unchanged && i < used.size(); ++i) {
+        unchanged = realized[i].desc == resources[used[i]].desc &&
+                    realized[i].first == lifetimes[i].first && realized[i].last == lifetimes[i].last;
+    }
+
+    if (!unchanged) {
+        releaseTransients(&deletionQueue);
+        this->device = device;
+        this->allocatorManager = &allocatorManager;
+        if (used.empty()) {
+            return;
+        }
+
+        try {
+            std::vector<TransientBlock> blocks = lifetimes;
+            VkMemoryRequirements combined{0, 1, ~0u};
+            for (size_t i = 0; i < used.size(); ++i) {
+                const TransientImageDesc& desc = resources[used[i]].desc;
+                VkImageCreateInfo imageInfo{};
+                imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+                imageInfo.imageType = VK_IMAGE_TYPE_2D;
+                imageInfo.format = desc.format;
+                imageInfo.extent = {desc.extent.width, desc.extent.height, 1};
+                imageInfo.mipLevels = 1;
+                imageInfo.arrayLayers = 1;
+                imageInfo.samples = desc.samples;
+                imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+                imageInfo.usage = desc.usage;
+                imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+                imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+                Realized image;
+                image.desc = desc;
+                image.first = lifetimes[i].first;
+                image.last = lifetimes[i].last;
+                if (vkCreateImage(device, &imageInfo, nullptr, &image.image) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to create transient image " + resources[used[i]].name + "!");
+                }
+                realized.push_back(image);
+
+                VkMemoryRequirements requirements;
+                vkGetImageMemoryRequirements(device, image.image, &requirements);
+                blocks[i].size = requirements.size;
+                blocks[i].alignment = requirements.alignment;
+                combined.alignment = std::max(combined.alignment, requirements.alignment);
+                combined.memoryTypeBits &= requirements.memoryTypeBits;
+            }
+            if (combined.memoryTypeBits == 0) {
+                throw std::runtime_error("The transient images of the render graph share no memory type!");
+            }
+
+            const TransientPlacement placement = placeTransients(blocks);
+            combined.size = placement.size;
+            allocatorManager.allocateMemory(combined, VMA_MEMORY_USAGE_GPU_ONLY, transientMemory,
+                                            MemoryCategory::Attachments);
+            transientMemorySize = placement.size;
+
+            for (size_t i = 0; i < realized.size(); ++i) {
+                realized[i].offset = placement.offsets[i];
+                realized[i].predecessor = placement.predecessors[i];
+                if (vmaBindImageMemory2(allocatorManager.getAllocator(), transientMemory, realized[i].offset,
+                                        realized[i].image, nullptr) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to bind transient image memory!");
+                }
+
+                VkImageViewCreateInfo viewInfo{};
+                viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+                viewInfo.image = realized[i].image;
+                viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+                viewInfo.format = realized[i].desc.format;
+                viewInfo.subresourceRange.aspectMask = realized[i].desc.aspect;
+                viewInfo.subresourceRange.baseMipLevel = 0;
+                viewInfo.subresourceRange.levelCount = 1;
+                viewInfo.subresourceRange.baseArrayLayer = 0;
+                viewInfo.subresourceRange.layerCount = 1;
+                if (vkCreateImageView(device, &viewInfo, nullptr, &realized[i].view) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to create transient image view!");
+                }
+            }
+        } catch (...) {
+            releaseTransients(nullptr);
+            throw;
+        }
+    }
+
+    // A transient sharing memory with an earlier one only waits for that image's last use
+    for (size_t i = 0; i < realized.size(); ++i) {
+        if (realized[i].predecessor < 0) {
+            continue;
+        }
+        GraphBarrier& barrier = passes[firstUseBarriers[i].first].before[firstUseBarriers[i].second];
+        barrier.srcStages = lastUses[realized[i].predecessor].first;
+        barrier.srcAccess = lastUses[realized[i].predecessor].second;
+    }
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::execute(const std::vector<VkCommandBuffer>& commandBuffers, bool synchronization2) const {
+    if (commandBuffers.size() < batches.size()) {
+        throw std::runtime_error("The render graph needs one command buffer per batch!");
+    }
+    if (realized.size() != firstUseBarriers.size()) {
+        throw std::runtime_error("The render graph's transient images have not been realized!");
+    }
+
+    for (size_t b = 0; b < batches.size(); ++b) {
+        VkCommandBuffer commandBuffer = commandBuffers[b];
+        // The barriers after one pass and before the next are recorded as one dependency
+        std::vector<GraphBarrier> pending;
+        for (PassId id : batches[b].passes) {
+            const Pass& pass = passes[id];
+            pending.insert(pending.end(), pass.before.begin(), pass.before.end());
+            recordBarriers(commandBuffer, pending, synchronization2);
+            if (pass.execute) {
+                pass.execute(commandBuffer);
+            }
+            pending = pass.after;
+        }
+        recordBarriers(commandBuffer, pending, synchronization2);
+    }
+}
+// --------------------------------------------------------------------------------
+
+bool RenderGraph::isCulled(PassId pass) const {
+    return passes.at(pass).culled;
+}
+// --------------------------------------------------------------------------------
+
+const std::vector<GraphBarrier>& RenderGraph::getBarriersBefore(PassId pass) const {
+    return passes.at(pass).before;
+}
+// --------------------------------------------------------------------------------
+
+const std::vector<GraphBarrier>& RenderGraph::getBarriersAfter(PassId pass) const {
+    return passes.at(pass).after;
+}
+// --------------------------------------------------------------------------------
+
+const std::vector<GraphBatch>& RenderGraph::getBatches() const {
+    return batches;
+}
+// --------------------------------------------------------------------------------
+
+std::vector<TransientBlock> RenderGraph::getTransientLifetimes() const {
+    std::vector<TransientBlock> lifetimes(firstUseBarriers.size());
+    uint32_t position = 0;
+    for (const Pass& pass : passes) {
+        if (pass.culled) {
+            continue;
+        }
+        for (const Access& access : pass.accesses) {
+            const uint32_t slot = transientSlots[access.resource];
+            if (slot == UINT32_MAX) {
+                continue;
+            }
+            if (firstUseBarriers[slot].first == static_cast<PassId>(&pass - passes.data())) {
+                lifetimes[slot].first = position;
+            }
+            lifetimes[slot].last = position;
+        }
+        ++position;
+    }
+    return lifetimes;
+}
+// --------------------------------------------------------------------------------
+
+VkImage RenderGraph::getImage(ResourceId resource) const {
+    const Resource& image = resources.at(resource);
+    if (image.kind != ResourceKind::Transient) {
+        return image.image;
+    }
+    const uint32_t slot = resource < transientSlots.size() ? transientSlots[resource] : UINT32_MAX;
+    return slot < realized.size() ? realized[slot].image : VK_NULL_HANDLE;
+}
+// --------------------------------------------------------------------------------
+
+VkImageView RenderGraph::getImageView(ResourceId resource) const {
+    const uint32_t slot = resource < transientSlots.size() ? transientSlots[resource] : UINT32_MAX;
+    return slot < realized.size() ? realized[slot].view : VK_NULL_HANDLE;
+}
+// --------------------------------------------------------------------------------
+
+VkDeviceSize RenderGraph::getTransientMemorySize() const {
+    return transientMemorySize;
+}
+// --------------------------------------------------------------------------------
+
+TransientPlacement RenderGraph::placeTransients(const std::vector<TransientBlock>& blocks) {
+    TransientPlacement placement;
+    placement.offsets.assign(blocks.size(), 0);
+    placement.predecessors.assign(blocks.size(), -1);
+
+    std::vector<size_t> order(blocks.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&blocks](size_t a, size_t b) {
+        return blocks[a].size > blocks[b].size;
+    });
+
+    std::vector<size_t> placed;
+    for (size_t i : order) {
+        // Ranges taken by placed blocks that are alive at the same time, lowest first
+        std::vector<std::pair<VkDeviceSize, VkDeviceSize>> taken;
+        for (size_t j : placed) {
+            if (lifetimesOverlap(blocks[i], blocks[j])) {
+                taken.emplace_back(placement.offsets[j], placement.offsets[j] + blocks[j].size);
+            }
+        }
+        std::sort(taken.begin(), taken.end());
+
+        VkDeviceSize offset = 0;
+        for (const auto& range : taken) {
+            if (alignUp(offset, blocks[i].alignment) + blocks[i].size <= range.first) {
+                break;
+            }
+            offset = std::max(offset, range.second);
+        }
+        placement.offsets[i] = alignUp(offset, blocks[i].alignment);
+        placement.size = std::max(placement.size, placement.offsets[i] + blocks[i].size);
+        placed.push_back(i);
+    }
+
+    // The most recent earlier block in the same memory is the one a block must wait for
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        for (size_t j = 0; j < blocks.size(); ++j) {
+            const bool earlier = blocks[j].last < blocks[i].first;
+            const bool sharesMemory = placement.offsets[j] < placement.offsets[i] + blocks[i].size &&
+                                      placement.offsets[i] < placement.offsets[j] + blocks[j].size;
+            if (earlier && sharesMemory &&
+                (placement.predecessors[i] < 0 || blocks[j].last > blocks[placement.predecessors[i]].last)) {
+                placement.predecessors[i] = static_cast<int32_t>(j);
+            }
+        }
+    }
+    return placement;
+}
+// ================================================================================
+
+void RenderGraph::declare(PassId pass, ResourceId resource, const ResourceAccess& access, bool writes) {
+    if (pass >= passes.size() || resource >= resources.size()) {
+        throw std::runtime_error("RenderGraph: a pass or resource of an access does not exist!");
+    }
+    std::vector<Access>& accesses = passes[pass].accesses;
+    auto existing = std::find_if(accesses.begin(), accesses.end(), [resource](const Access& a) {
+        return a.resource == resource;
+    });
+    if (existing == accesses.end()) {
+        Access added;
+        added.resource = resource;
+        added.usage = access;
+        added.reads = !writes;
+        added.writes = writes;
+        accesses.push_back(added);
+        return;
+    }
+    if (access.layout != existing->usage.layout && access.layout != VK_IMAGE_LAYOUT_UNDEFINED &&
+        existing->usage.layout != VK_IMAGE_LAYOUT_UNDEFINED) {
+        throw std::runtime_error("Pass " + passes[pass].name + " uses " + resources[resource].name +
+                                 " in two layouts!");
+    }
+    existing->usage.stages |= access.stages;
+    existing->usage.access |= access.access;
+    if (existing->usage.layout == VK_IMAGE_LAYOUT_UNDEFINED) {
+        existing->usage.layout = access.layout;
+    }
+    if (access.layoutAfter != VK_IMAGE_LAYOUT_UNDEFINED) {
+        existing->usage.layoutAfter = access.layoutAfter;
+    }
+    existing->reads = existing->reads || !writes;
+    existing->writes = existing->writes || writes;
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::cullPasses() {
+    // Walk backwards from the exported resources, keeping each pass that produces
+    // something a kept pass or the caller still reads
+    std::vector<bool> live(resources.size());
+    for (size_t i = 0; i < resources.size(); ++i) {
+        live[i] = resources[i].exported;
+    }
+    for (size_t p = passes.size(); p-- > 0;) {
+        Pass& pass = passes[p];
+        bool needed = pass.kept;
+        for (const Access& access : pass.accesses) {
+            needed = needed || (access.writes && live[access.resource]);
+        }
+        pass.culled = !needed;
+        if (!needed) {
+            continue;
+        }
+        for (const Access& access : pass.accesses) {
+            if (access.writes && !access.reads) {
+                live[access.resource] = false;
+            }
+        }
+        for (const Access& access : pass.accesses) {
+            if (access.reads) {
+                live[access.resource] = true;
+            }
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::deriveBarriers(bool asyncCompute) {
+    /**
+     * @brief What the walk knows about a resource after the passes so far.
+     */
+    struct State {
+        bool touched = false;
+        VkPipelineStageFlags2 writeStages = VK_PIPELINE_STAGE_2_NONE;   /**< Stages of the last write. */
+        VkAccessFlags2 writeAccess = VK_ACCESS_2_NONE;
+        VkPipelineStageFlags2 readStages = VK_PIPELINE_STAGE_2_NONE;    /**< Reads since the last write. */
+        VkPipelineStageFlags2 visibleStages = VK_PIPELINE_STAGE_2_NONE; /**< Reads the last write is visible to. */
+        VkAccessFlags2 visibleAccess = VK_ACCESS_2_NONE;
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        QueueClass queue = QueueClass::Graphics;
+        PassId lastPass = 0;
+        uint32_t lastBatch = 0;
+    };
+
+    std::vector<State> states(resources.size());
+    for (size_t i = 0; i < resources.size(); ++i) {
+        states[i].layout = resources[i].initialLayout;
+    }
+    batches.clear();
+    transientSlots.assign(resources.size(), UINT32_MAX);
+    firstUseBarriers.clear();
+    lastUses.clear();
+
+    for (PassId id = 0; id < passes.size(); ++id) {
+        Pass& pass = passes[id];
+        if (pass.culled) {
+            continue;
+        }
+        const QueueClass queue = asyncCompute ? pass.queue : QueueClass::Graphics;
+        if (batches.empty() || batches.back().queue != queue) {
+            GraphBatch batch;
+            batch.queue = queue;
+            batches.push_back(batch);
+        }
+        const uint32_t batchIndex = static_cast<uint32_t>(batches.size() - 1);
+        batches.back().passes.push_back(id);
+
+        for (const Access& access : pass.accesses) {
+            const Resource& resource = resources[access.resource];
+            State& state = states[access.resource];
+            const ResourceAccess& usage = access.usage;
+            const bool image = resource.kind != ResourceKind::Buffer;
+            const bool layoutChange = image && usage.layout != VK_IMAGE_LAYOUT_UNDEFINED &&
+                                      usage.layout != state.layout;
+            bool synchronized = false;
+
+            if (resource.kind == ResourceKind::Transient && !state.touched) {
+                if (!access.writes) {
+                    throw std::runtime_error("Pass " + pass.name + " reads " + resource.name +
+                                             " before any pass writes it!");
+                }
+                // Until realize knows which image held the memory before, wait for everything
+                GraphBarrier barrier;
+                barrier.resource = access.resource;
+                barrier.srcStages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+                barrier.srcAccess = VK_ACCESS_2_MEMORY_WRITE_BIT;
+                barrier.dstStages = usage.stages;
+                barrier.dstAccess = usage.access;
+                barrier.newLayout = usage.layout;
+                barrier.srcQueue = queue;
+                barrier.dstQueue = queue;
+                transientSlots[access.resource] = static_cast<uint32_t>(firstUseBarriers.size());
+                firstUseBarriers.emplace_back(id, pass.before.size());
+                lastUses.emplace_back(usage.stages, usage.access);
+                pass.before.push_back(barrier);
+                synchronized = true;
+            } else if (state.touched && state.queue != queue) {
+                // Exclusive resources change queue with a release on the old queue and an
+                // acquire on the new one, ordered by a semaphore between the batches
+                GraphBarrier release;
+                release.resource = access.resource;
+                release.srcStages = state.writeStages | state.readStages;
+                release.srcAccess = state.writeAccess;
+                release.oldLayout = state.layout;
+                release.newLayout = layoutChange ? usage.layout : state.layout;
+                release.srcQueue = state.queue;
+                release.dstQueue = queue;
+                passes[state.lastPass].after.push_back(release);
+
+                GraphBarrier acquire = release;
+                acquire.srcStages = VK_PIPELINE_STAGE_2_NONE;
+                acquire.srcAccess = VK_ACCESS_2_NONE;
+                acquire.dstStages = usage.stages;
+                acquire.dstAccess = usage.access;
+                pass.before.push_back(acquire);
+
+                std::vector<GraphBatch::Wait>& waits = batches.back().waits;
+                auto wait = std::find_if(waits.begin(), waits.end(), [&state](const GraphBatch::Wait& w) {
+                    return w.batch == state.lastBatch;
+                });
+                if (wait == waits.end()) {
+                    waits.push_back({state.lastBatch, usage.stages});
+                } else {
+                    wait->stages |= usage.stages;
+                }
+                synchronized = true;
+            } else if (state.touched || layoutChange) {
+                // Writes wait for every earlier access; reads only for a write not yet
+                // visible to them
+                const bool hazard = access.writes
+                    ? state.touched
+                    : state.writeAccess != VK_ACCESS_2_NONE &&
+                      ((usage.stages & ~state.visibleStages) != 0 || (usage.access & ~state.visibleAccess) != 0);
+                if (hazard || layoutChange) {
+                    GraphBarrier barrier;
+                    barrier.resource = access.resource;
+                    barrier.srcStages = state.writeStages;
+                    if (access.writes || layoutChange) {
+                        barrier.srcStages |= state.readStages;
+                    }
+                    barrier.srcAccess = state.writeAccess;
+                    barrier.dstStages = usage.stages;
+                    barrier.dstAccess = usage.access;
+                    if (layoutChange) {
+                        barrier.oldLayout = state.layout;
+                        barrier.newLayout = usage.layout;
+                    }
+                    barrier.srcQueue = queue;
+                    barrier.dstQueue = queue;
+                    pass.before.push_back(barrier);
+                    synchronized = true;
+                }
+            }
+
+            if (access.writes) {
+                state.writeStages = usage.stages;
+                state.writeAccess = usage.access;
+                state.readStages = VK_PIPELINE_STAGE_2_NONE;
+                state.visibleStages = VK_PIPELINE_STAGE_2_NONE;
+                state.visibleAccess = VK_ACCESS_2_NONE;
+            } else {
+                state.readStages |= usage.stages;
+                if (synchronized) {
+                    state.visibleStages |= usage.stages;
+                    state.visibleAccess |= usage.access;
+                }
+            }
+            if (usage.layoutAfter != VK_IMAGE_LAYOUT_UNDEFINED) {
+                state.layout = usage.layoutAfter;
+            } else if (usage.layout != VK_IMAGE_LAYOUT_UNDEFINED) {
+                state.layout = usage.layout;
+            }
+            state.touched = true;
+            state.queue = queue;
+            state.lastPass = id;
+            state.lastBatch = batchIndex;
+            if (transientSlots[access.resource] != UINT32_MAX) {
+                lastUses[transientSlots[access.resource]] = {usage.stages, usage.access};
+            }
+        }
+    }
+
+    // Exported resources are handed to their consumer after the last pass that used them
+    for (ResourceId id = 0; id < resources.size(); ++id) {
+        const Resource& resource = resources[id];
+        const State& state = states[id];
+        const ResourceAccess& handoff = resource.finalAccess;
+        if (!resource.exported || !state.touched || handoff.stages == VK_PIPELINE_STAGE_2_NONE) {
+            continue;
+        }
+        const bool layoutChange = resource.kind != ResourceKind::Buffer &&
+                                  handoff.layout != VK_IMAGE_LAYOUT_UNDEFINED && handoff.layout != state.layout;
+        if (state.writeAccess == VK_ACCESS_2_NONE && !layoutChange) {
+            continue;
+        }
+        GraphBarrier barrier;
+        barrier.resource = id;
+        barrier.srcStages = state.writeStages | (layoutChange ? state.readStages : VK_PIPELINE_STAGE_2_NONE);
+        barrier.srcAccess = state.writeAccess;
+        barrier.dstStages = handoff.stages;
+        barrier.dstAccess = handoff.access;
+        if (layoutChange) {
+            barrier.oldLayout = state.layout;
+            barrier.newLayout = handoff.layout;
+        }
+        barrier.srcQueue = state.queue;
+        barrier.dstQueue = state.queue;
+        passes[state.lastPass].after.push_back(barrier);
+    }
+}
+// --------------------------------------------------------------------------------
+
+uint32_t RenderGraph::familyOf(QueueClass queue) const {
+    return queue == QueueClass::AsyncCompute ? computeFamily : graphicsFamily;
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::recordBarriers(VkCommandBuffer commandBuffer, const std::vector<GraphBarrier>& barriers,
+                                 bool synchronization2) const {
+    if (barriers.empty()) {
+        return;
+    }
+
+    // Accesses that keep their layout and queue need no resource-specific barrier
+    VkMemoryBarrier2 memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    bool global = false;
+    std::vector<VkImageMemoryBarrier2> imageBarriers;
+    std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+    for (const GraphBarrier& barrier : barriers) {
+        const Resource& resource = resources[barrier.resource];
+        const bool ownership = barrier.srcQueue != barrier.dstQueue;
+        const uint32_t srcFamily = ownership ? familyOf(barrier.srcQueue) : VK_QUEUE_FAMILY_IGNORED;
+        const uint32_t dstFamily = ownership ? familyOf(barrier.dstQueue) : VK_QUEUE_FAMILY_IGNORED;
+        const bool image = resource.kind != ResourceKind::Buffer;
+        if (image && (barrier.oldLayout != barrier.newLayout || ownership)) {
+            VkImageMemoryBarrier2 imageBarrier{};
+            imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+            imageBarrier.srcStageMask = barrier.srcStages;
+            imageBarrier.srcAccessMask = barrier.srcAccess;
+            imageBarrier.dstStageMask = barrier.dstStages;
+            imageBarrier.dstAccessMask = barrier.dstAccess;
+            imageBarrier.oldLayout = barrier.oldLayout;
+            imageBarrier.newLayout = barrier.newLayout;
+            imageBarrier.srcQueueFamilyIndex = srcFamily;
+            imageBarrier.dstQueueFamilyIndex = dstFamily;
+            imageBarrier.image = getImage(barrier.resource);
+            imageBarrier.subresourceRange.aspectMask = resource.aspect;
+            imageBarrier.subresourceRange.baseMipLevel = 0;
+            imageBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+            imageBarrier.subresourceRange.baseArrayLayer = 0;
+            imageBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+            imageBarriers.push_back(imageBarrier);
+        } else if (!image && ownership) {
+            VkBufferMemoryBarrier2 bufferBarrier{};
+            bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+            bufferBarrier.srcStageMask = barrier.srcStages;
+            bufferBarrier.srcAccessMask = barrier.srcAccess;
+            bufferBarrier.dstStageMask = barrier.dstStages;
+            bufferBarrier.dstAccessMask = barrier.dstAccess;
+            bufferBarrier.srcQueueFamilyIndex = srcFamily;
+            bufferBarrier.dstQueueFamilyIndex = dstFamily;
+            bufferBarrier.buffer = resource.buffer;
+            bufferBarrier.offset = 0;
+            bufferBarrier.size = VK_WHOLE_SIZE;
+            bufferBarriers.push_back(bufferBarrier);
+        } else {
+            memoryBarrier.srcStageMask |= barrier.srcStages;
+            memoryBarrier.srcAccessMask |= barrier.srcAccess;
+            memoryBarrier.dstStageMask |= barrier.dstStages;
+            memoryBarrier.dstAccessMask |= barrier.dstAccess;
+            global = true;
+        }
+    }
+
+    if (synchronization2) {
+        VkDependencyInfo dependency{};
+        dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependency.memoryBarrierCount = global ? 1 : 0;
+        dependency.pMemoryBarriers = &memoryBarrier;
+        dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+        dependency.pBufferMemoryBarriers = bufferBarriers.data();
+        dependency.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+        dependency.pImageMemoryBarriers = imageBarriers.data();
+        vkCmdPipelineBarrier2(commandBuffer, &dependency);
+        return;
+    }
+
+    // Without synchronization2 one call carries the union of every barrier's stages
+    VkPipelineStageFlags2 srcStages = memoryBarrier.srcStageMask;
+    VkPipelineStageFlags2 dstStages = memoryBarrier.dstStageMask;
+    VkMemoryBarrier legacyMemory{};
+    legacyMemory.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    legacyMemory.srcAccessMask = legacyAccess(memoryBarrier.srcAccessMask);
+    legacyMemory.dstAccessMask = legacyAccess(memoryBarrier.dstAccessMask);
+    std::vector<VkImageMemoryBarrier> legacyImages;
+    for (const VkImageMemoryBarrier2& barrier : imageBarriers) {
+        srcStages |= barrier.srcStageMask;
+        dstStages |= barrier.dstStageMask;
+        VkImageMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        legacy.srcAccessMask = legacyAccess(barrier.srcAccessMask);
+        legacy.dstAccessMask = legacyAccess(barrier.dstAccessMask);
+        legacy.oldLayout = barrier.oldLayout;
+        legacy.newLayout = barrier.newLayout;
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.image = barrier.image;
+        legacy.subresourceRange = barrier.subresourceRange;
+        legacyImages.push_back(legacy);
+    }
+    std::vector<VkBufferMemoryBarrier> legacyBuffers;
+    for (const VkBufferMemoryBarrier2& barrier : bufferBarriers) {
+        srcStages |= barrier.srcStageMask;
+        dstStages |= barrier.dstStageMask;
+        VkBufferMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        legacy.srcAccessMask = legacyAccess(barrier.srcAccessMask);
+        legacy.dstAccessMask = legacyAccess(barrier.dstAccessMask);
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.buffer = barrier.buffer;
+        legacy.offset = barrier.offset;
+        legacy.size = barrier.size;
+        legacyBuffers.push_back(legacy);
+    }
+    vkCmdPipelineBarrier(commandBuffer,
+                         legacyStages(srcStages, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+                         legacyStages(dstStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT),
+                         0, global ? 1 : 0, &legacyMemory,
+                         static_cast<uint32_t>(legacyBuffers.size()), legacyBuffers.data(),
+                         static_cast<uint32_t>(legacyImages.size()), legacyImages.data());
+}
+// --------------------------------------------------------------------------------
+
+void RenderGraph::releaseTransients(DeletionQueue* deletionQueue) {
+    if (realized.empty() && transientMemory == VK_NULL_HANDLE) {
+        return;
+    }
+    VkDevice device = this->device;
+    AllocatorManager* allocator = allocatorManager;
+    std::vector<Realized> images = std::move(realized);
+    VmaAllocation memory = transientMemory;
+    auto destroy = [device, allocator, images, memory]() {
+        for (const Realized& image : images) {
+            if (image.view != VK_NULL_HANDLE) {
+                vkDestroyImageView(device, image.view, nullptr);
+            }
+            vkDestroyImage(device, image.image, nullptr);
+        }
+        if (memory != VK_NULL_HANDLE) {
+            allocator->freeMemory(memory);
+        }
+    };
+    realized.clear();
+    transientMemory = VK_NULL_HANDLE;
+    transientMemorySize = 0;
+    if (deletionQueue) {
+        deletionQueue->push(destroy);
+    } else {
+        destroy();
+    }
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,102 @@
+// ================================================================================
+// ================================================================================
+// - File:    sampler_desc.cpp
+// - Purpose: This file contains the comparison, hashing and create info of the
+//            SamplerDesc struct
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/sampler_desc.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+// ================================================================================
+// ================================================================================
+
+// 64-bit FNV-1a, fed one field at a time so struct padding never reaches the hash
+static void hashValue(uint64_t& hash, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        hash ^= (value >> (8 * i)) & 0xFFu;
+        hash *= 1099511628211ull;
+    }
+}
+// --------------------------------------------------------------------------------
+
+// Hashes a float's bits after adding zero, which turns -0.0 into the 0.0 it equals
+static void hashFloat(uint64_t& hash, float value) {
+    value += 0.0f;
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    hashValue(hash, bits);
+}
+// ================================================================================
+// ================================================================================
+
+bool SamplerDesc::operator==(const SamplerDesc& other) const {
+    return magFilter == other.magFilter &&
+           minFilter == other.minFilter &&
+           mipmapMode == other.mipmapMode &&
+           addressModeU == other.addressModeU &&
+           addressModeV == other.addressModeV &&
+           addressModeW == other.addressModeW &&
+           maxAnisotropy == other.maxAnisotropy &&
+           compareEnable == other.compareEnable &&
+           compareOp == other.compareOp &&
+           mipLodBias == other.mipLodBias &&
+           minLod == other.minLod &&
+           maxLod == other.maxLod &&
+           borderColor == other.borderColor;
+}
+// --------------------------------------------------------------------------------
+
+VkSamplerCreateInfo SamplerDesc::toCreateInfo(float deviceMaxAnisotropy) const {
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = magFilter;
+    samplerInfo.minFilter = minFilter;
+    samplerInfo.mipmapMode = mipmapMode;
+    samplerInfo.addressModeU = addressModeU;
+    samplerInfo.addressModeV = addressModeV;
+    samplerInfo.addressModeW = addressModeW;
+    const float anisotropy = std::min(maxAnisotropy, deviceMaxAnisotropy);
+    samplerInfo.anisotropyEnable = anisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+    samplerInfo.maxAnisotropy = anisotropy > 1.0f ? anisotropy : 1.0f;
+    samplerInfo.compareEnable = compareEnable ? VK_TRUE : VK_FALSE;
+    samplerInfo.compareOp = compareOp;
+    samplerInfo.mipLodBias = mipLodBias;
+    samplerInfo.minLod = minLod;
+    samplerInfo.maxLod = maxLod;
+    samplerInfo.borderColor = borderColor;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    return samplerInfo;
+}
+// --------------------------------------------------------------------------------
+
+size_t SamplerDescHash::operator()(const SamplerDesc& desc) const {
+    uint64_t hash = 14695981039346656037ull;
+    hashValue(hash, static_cast<uint32_t>(desc.magFilter));
+    hashValue(hash, static_cast<uint32_t>(desc.minFilter));
+    hashValue(hash, static_cast<uint32_t>(desc.mipmapMode));
+    hashValue(hash, static_cast<uint32_t>(desc.addressModeU));
+    hashValue(hash, static_cast<uint32_t>(desc.addressModeV));
+    hashValue(hash, static_cast<uint32_t>(desc.addressModeW));
+    hashFloat(hash, desc.maxAnisotropy);
+    hashValue(hash, desc.compareEnable ? 1u : 0u);
+    hashValue(hash, static_cast<uint32_t>(desc.compareOp));
+    hashFloat(hash, desc.mipLodBias);
+    hashFloat(hash, desc.minLod);
+    hashFloat(hash, desc.maxLod);
+    hashValue(hash, static_cast<uint32_t>(desc.borderColor));
+    return static_cast<size_t>(hash);
+}
+// ================================================================================
+// ================================================================================
+// eof
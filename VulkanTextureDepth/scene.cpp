@@ -0,0 +1,286 @@
+// ================================================================================
+// ================================================================================
+// - File:    scene.cpp
+// - Purpose: This file contains the implementation of the Scene class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/scene.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+// ================================================================================
+// ================================================================================
+
+Scene::Scene(AllocatorManager& allocatorManager,
+             const DeviceFeatureSupport& features,
+             uint32_t framesInFlight,
+             uint32_t maxInstances,
+             uint32_t maxMeshes)
+    : allocatorManager(allocatorManager),
+      features(features),
+      maxInstances(maxInstances),
+      maxMeshes(maxMeshes),
+      frames(framesInFlight) {
+    // The storage bit lets a compute pass rewrite the draw list on the GPU
+    const VkBufferUsageFlags drawListUsage =
+        VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+    try {
+        for (FrameBuffers& frame : frames) {
+            createMappedBuffer(sizeof(InstanceData) * maxInstances, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                               frame.instanceBuffer, frame.instanceAllocation,
+                               reinterpret_cast<void**>(&frame.instances));
+            createMappedBuffer(sizeof(VkDrawIndexedIndirectCommand) * maxMeshes, drawListUsage,
+                               frame.indirectBuffer, frame.indirectAllocation,
+                               reinterpret_cast<void**>(&frame.commands));
+            createMappedBuffer(sizeof(uint32_t), drawListUsage,
+                               frame.countBuffer, frame.countAllocation,
+                               reinterpret_cast<void**>(&frame.count));
+            *frame.count = 0;
+            instanceBuffers.push_back(frame.instanceBuffer);
+        }
+    } catch (...) {
+        destroyBuffers();
+        throw;
+    }
+}
+// --------------------------------------------------------------------------------
+
+Scene::~Scene() {
+    destroyBuffers();
+}
+// --------------------------------------------------------------------------------
+
+uint32_t Scene::addMesh(uint32_t indexCount, uint32_t firstIndex, int32_t vertexOffset,
+                        const glm::vec4& boundingSphere) {
+    if (meshes.size() >= maxMeshes) {
+        throw std::runtime_error("Scene: mesh capacity of " + std::to_string(maxMeshes) + " exceeded.");
+    }
+    SceneMesh mesh;
+    mesh.indexCount = indexCount;
+    mesh.firstIndex = firstIndex;
+    mesh.vertexOffset = vertexOffset;
+    mesh.boundingSphere = boundingSphere;
+    meshes.push_back(mesh);
+    ++version;
+    return static_cast<uint32_t>(meshes.size() - 1);
+}
+// --------------------------------------------------------------------------------
+
+uint32_t Scene::addInstance(uint32_t mesh, const glm::mat4& model) {
+    if (mesh >= meshes.size()) {
+        throw std::runtime_error("Scene: addInstance called with an unknown mesh id.");
+    }
+    if (instances.size() >= maxInstances) {
+        throw std::runtime_error("Scene: instance capacity of " + std::to_string(maxInstances) + " exceeded.");
+    }
+    SceneInstance instance;
+    instance.mesh = mesh;
+    instance.model = model;
+    instances.push_back(instance);
+    ++version;
+    return static_cast<uint32_t>(instances.size() - 1);
+}
+// --------------------------------------------------------------------------------
+
+void Scene::setInstanceTransform(uint32_t instance, const glm::mat4& model) {
+    if (instance >= instances.size()) {
+        throw std::out_of_range("Scene: instance id is out of bounds!");
+    }
+    instances[instance].model = model;
+    ++version;
+}
+// --------------------------------------------------------------------------------
+
+void Scene::clearInstances() {
+    instances.clear();
+    ++version;
+}
+// --------------------------------------------------------------------------------
+
+void Scene::update(uint32_t frameIndex) {
+    FrameBuffers& frame = frames.at(frameIndex);
+    if (frame.version == version) {
+        return;
+    }
+
+    frame.drawCount = buildDrawList(meshes, instances, frame.instances, frame.commands);
+    *frame.count = frame.drawCount;
+    frame.largestDraw = 0;
+    for (uint32_t i = 0; i < frame.drawCount; ++i) {
+        frame.largestDraw = std::max(frame.largestDraw, frame.commands[i].instanceCount);
+    }
+    frame.version = version;
+
+    // CPU_TO_GPU memory is not guaranteed to be coherent
+    VmaAllocator allocator = allocatorManager.getAllocator();
+    vmaFlushAllocation(allocator, frame.instanceAllocation, 0, sizeof(InstanceData) * instances.size());
+    vmaFlushAllocation(allocator, frame.indirectAllocation, 0,
+                       sizeof(VkDrawIndexedIndirectCommand) * frame.drawCount);
+    vmaFlushAllocation(allocator, frame.countAllocation, 0, sizeof(uint32_t));
+}
+// --------------------------------------------------------------------------------
+
+void Scene::recordDraws(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkBuffer indirectBuffer,
+                        uint32_t firstDraw, uint32_t drawCount) const {
+    const FrameBuffers& frame = frames.at(frameIndex);
+    if (firstDraw >= frame.drawCount) {
+        return;
+    }
+    drawCount = std::min(drawCount, frame.drawCount - firstDraw);
+    if (indirectBuffer == VK_NULL_HANDLE) {
+        indirectBuffer = frame.indirectBuffer;
+    }
+    const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+    const VkDeviceSize offset = static_cast<VkDeviceSize>(firstDraw) * stride;
+
+    if (!features.drawIndirectFirstInstance) {
+        // Indirect commands must use firstInstance 0 here, so issue the packed draws directly
+        for (uint32_t i = firstDraw; i < firstDraw + drawCount; ++i) {
+            const VkDrawIndexedIndirectCommand& command = frame.commands[i];
+            vkCmdDrawIndexed(commandBuffer, command.indexCount, command.instanceCount,
+                             command.firstIndex, command.vertexOffset, command.firstInstance);
+        }
+    } else if (features.drawIndirectCount && drawCount == frame.drawCount) {
+        vkCmdDrawIndexedIndirectCount(commandBuffer, indirectBuffer, 0,
+                                      frame.countBuffer, 0, maxMeshes, stride);
+    } else if (features.multiDrawIndirect) {
+        vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffer, offset, drawCount, stride);
+    } else {
+        for (uint32_t i = 0; i < drawCount; ++i) {
+            vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffer,
+                                     offset + static_cast<VkDeviceSize>(i) * stride, 1, stride);
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+const std::vector<VkBuffer>& Scene::getInstanceBuffers() const {
+    return instanceBuffers;
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer Scene::getIndirectBuffer(uint32_t frameIndex) const {
+    return frames.at(frameIndex).indirectBuffer;
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer Scene::getCountBuffer(uint32_t frameIndex) const {
+    return frames.at(frameIndex).countBuffer;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t Scene::getDrawCount(uint32_t frameIndex) const {
+    return frames.at(frameIndex).drawCount;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t Scene::getLargestDraw(uint32_t frameIndex) const {
+    return frames.at(frameIndex).largestDraw;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t Scene::getInstanceCount() const {
+    return static_cast<uint32_t>(instances.size());
+}
+// --------------------------------------------------------------------------------
+
+uint32_t Scene::getMaxInstances() const {
+    return maxInstances;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t Scene::getMaxDraws() const {
+    return maxMeshes;
+}
+// --------------------------------------------------------------------------------
+
+uint32_t Scene::buildDrawList(const std::vector<SceneMesh>& meshes,
+                              const std::vector<SceneInstance>& instances,
+                              InstanceData* instanceData,
+                              VkDrawIndexedIndirectCommand* commands) {
+    // Counting sort by mesh id keeps each mesh's instances contiguous
+    std::vector<uint32_t> offsets(meshes.size() + 1, 0);
+    for (const SceneInstance& instance : instances) {
+        ++offsets[instance.mesh + 1];
+    }
+    for (size_t i = 1; i < offsets.size(); ++i) {
+        offsets[i] += offsets[i - 1];
+    }
+
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (const SceneInstance& instance : instances) {
+        const glm::vec4& sphere = meshes[instance.mesh].boundingSphere;
+        const glm::mat4& model = instance.model;
+        // The largest axis scale bounds the radius under non-uniform scaling
+        const float scale = std::sqrt(std::max({glm::dot(glm::vec3(model[0]), glm::vec3(model[0])),
+                                                glm::dot(glm::vec3(model[1]), glm::vec3(model[1])),
+                                                glm::dot(glm::vec3(model[2]), glm::vec3(model[2]))}));
+
+        InstanceData& data = instanceData[cursor[instance.mesh]++];
+        data.model = model;
+        data.boundingSphere = glm::vec4(glm::vec3(model * glm::vec4(glm::vec3(sphere), 1.0f)),
+                                        sphere.w * scale);
+    }
+
+    uint32_t drawCount = 0;
+    for (size_t mesh = 0; mesh < meshes.size(); ++mesh) {
+        const uint32_t instanceCount = offsets[mesh + 1] - offsets[mesh];
+        if (instanceCount == 0) {
+            continue;
+        }
+        VkDrawIndexedIndirectCommand& command = commands[drawCount++];
+        command.indexCount = meshes[mesh].indexCount;
+        command.instanceCount = instanceCount;
+        command.firstIndex = meshes[mesh].firstIndex;
+        command.vertexOffset = meshes[mesh].vertexOffset;
+        command.firstInstance = offsets[mesh];
+    }
+    return drawCount;
+}
+// ================================================================================
+
+void Scene::createMappedBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                               VkBuffer& buffer, VmaAllocation& allocation, void** mapped) {
+    allocatorManager.createBuffer(size, usage, VMA_MEMORY_USAGE_CPU_TO_GPU, buffer, allocation);
+    allocatorManager.mapMemory(allocation, mapped);
+}
+// --------------------------------------------------------------------------------
+
+void Scene::destroyBuffers() {
+    for (FrameBuffers& frame : frames) {
+        if (frame.instanceBuffer != VK_NULL_HANDLE) {
+            if (frame.instances != nullptr) {
+                allocatorManager.unmapMemory(frame.instanceAllocation);
+            }
+            allocatorManager.destroyBuffer(frame.instanceBuffer, frame.instanceAllocation);
+        }
+        if (frame.indirectBuffer != VK_NULL_HANDLE) {
+            if (frame.commands != nullptr) {
+                allocatorManager.unmapMemory(frame.indirectAllocation);
+            }
+            allocatorManager.destroyBuffer(frame.indirectBuffer, frame.indirectAllocation);
+        }
+        if (frame.countBuffer != VK_NULL_HANDLE) {
+            if (frame.count != nullptr) {
+                allocatorManager.unmapMemory(frame.countAllocation);
+            }
+            allocatorManager.destroyBuffer(frame.countBuffer, frame.countAllocation);
+        }
+        frame = FrameBuffers{};
+    }
+    instanceBuffers.clear();
+}
+// ================================================================================
+// ================================================================================
+// eof
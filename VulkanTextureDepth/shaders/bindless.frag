@@ -0,0 +1,21 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Every resident texture and sampler, written by the BindlessTextureTable
+layout(set = 1, binding = 0) uniform texture2D textures[];
+layout(set = 1, binding = 1) uniform sampler samplers[];
+
+// Follows the vertex stage's DrawConstants in the push constant block
+layout(push_constant) uniform BindlessIndices {
+    layout(offset = 64) uint textureIndex;
+    uint samplerIndex;
+} indices;
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = texture(sampler2D(textures[indices.textureIndex], samplers[indices.samplerIndex]), fragTexCoord);
+}
@@ -0,0 +1,30 @@
+#version 450
+
+// Position-only variant of shader.vert for the depth pre-pass
+layout(binding = 0) uniform CameraUniforms {
+    mat4 view;
+    mat4 proj;
+    mat4 viewProj;
+} camera;
+
+layout(push_constant) uniform DrawConstants {
+    mat4 model;
+} draw;
+
+struct InstanceData {
+    mat4 model;
+    vec4 boundingSphere;
+};
+
+layout(std430, binding = 2) readonly buffer InstanceBuffer {
+    InstanceData instances[];
+};
+
+layout(location = 0) in vec3 inPosition;
+
+invariant gl_Position;
+
+void main() {
+    mat4 instanceModel = instances[gl_InstanceIndex].model;
+    gl_Position = camera.viewProj * (draw.model * (instanceModel * vec4(inPosition, 1.0)));
+}
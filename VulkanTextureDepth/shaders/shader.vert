@@ -1,10 +1,24 @@
 #version 450
 
-layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
+// Shared by every draw of a frame; bound with a dynamic offset into the uniform ring
+layout(binding = 0) uniform CameraUniforms {
     mat4 view;
     mat4 proj;
-} ubo;
+    mat4 viewProj;
+} camera;
+
+layout(push_constant) uniform DrawConstants {
+    mat4 model;
+} draw;
+
+struct InstanceData {
+    mat4 model;
+    vec4 boundingSphere;
+};
+
+layout(std430, binding = 2) readonly buffer InstanceBuffer {
+    InstanceData instances[];
+};
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
@@ -13,8 +27,12 @@ layout(location = 2) in vec2 inTexCoord;
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 
+// Must match depth.vert bit for bit, since shading after a pre-pass tests depth for equality
+invariant gl_Position;
+
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    mat4 instanceModel = instances[gl_InstanceIndex].model;
+    gl_Position = camera.viewProj * (draw.model * (instanceModel * vec4(inPosition, 1.0)));
     fragColor = inColor;
     fragTexCoord = inTexCoord;
 }
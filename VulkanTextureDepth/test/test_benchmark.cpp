@@ -0,0 +1,73 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_benchmark.cpp
+// - Purpose: Unit tests for the benchmark statistics and report
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/benchmark.hpp"
+// ================================================================================
+// ================================================================================
+
+TEST(BenchmarkTest, PercentileInterpolatesBetweenRanks) {
+    const std::vector<double> values = {4.0, 1.0, 3.0, 2.0};
+    EXPECT_DOUBLE_EQ(Benchmark::percentile(values, 0.0), 1.0);
+    EXPECT_DOUBLE_EQ(Benchmark::percentile(values, 0.5), 2.5);
+    EXPECT_DOUBLE_EQ(Benchmark::percentile(values, 1.0), 4.0);
+    EXPECT_DOUBLE_EQ(Benchmark::percentile({}, 0.5), 0.0);
+}
+// --------------------------------------------------------------------------------
+
+TEST(BenchmarkTest, SummarizeSkipsWarmupFrames) {
+    BenchmarkScene scene;
+    scene.warmupFrames = 2;
+
+    std::vector<FrameTiming> timings(6);
+    const double starts[] = {0.0, 50.0, 100.0, 110.0, 120.0, 135.0};
+    for (size_t i = 0; i < timings.size(); ++i) {
+        timings[i].frame = i;
+        timings[i].startMs = starts[i];
+        timings[i].cpuFrameMs = i < 2 ? 40.0 : 5.0;
+        timings[i].gpuValid = i != 3;
+        timings[i].gpuFrameMs = 2.0;
+    }
+
+    // 40 ms measured from the start of frame 2 to the end of frame 5
+    const BenchmarkResult result = Benchmark::summarize(scene, timings, 4 * 1024 * 1024);
+    EXPECT_EQ(result.frameMs.samples, 3u);
+    EXPECT_DOUBLE_EQ(result.frameMs.p50, 10.0);
+    EXPECT_DOUBLE_EQ(result.frameMs.max, 15.0);
+    EXPECT_EQ(result.cpuMs.samples, 4u);
+    EXPECT_DOUBLE_EQ(result.cpuMs.mean, 5.0);
+    EXPECT_EQ(result.gpuMs.samples, 3u);
+    EXPECT_DOUBLE_EQ(result.uploadMiBPerSecond, 100.0);
+}
+// --------------------------------------------------------------------------------
+
+TEST(BenchmarkTest, WritesOneObjectPerScene) {
+    std::vector<BenchmarkResult> results(2);
+    results[0].scene.name = "baseline";
+    results[1].scene.name = "many_quads";
+    results[1].headless = true;
+
+    std::ostringstream out;
+    Benchmark::writeJson(out, results);
+    const std::string json = out.str();
+    EXPECT_NE(json.find("\"name\": \"baseline\""), std::string::npos);
+    EXPECT_NE(json.find("\"mode\": \"headless\""), std::string::npos);
+    EXPECT_NE(json.find("\"p99\""), std::string::npos);
+    EXPECT_EQ(json.front(), '{');
+}
+// ================================================================================
+// ================================================================================
+// eof
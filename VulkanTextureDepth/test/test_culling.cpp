@@ -0,0 +1,65 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_culling.cpp
+// - Purpose: Unit tests for the CullingPass frustum math
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include "../include/culling.hpp"
+#include "../include/depth_config.hpp"
+// ================================================================================
+// ================================================================================
+
+TEST(CullingPassTest, IdentityMatrixGivesTheVulkanClipVolume) {
+    std::array<glm::vec4, 6> planes = CullingPass::extractFrustumPlanes(glm::mat4(1.0f));
+
+    EXPECT_TRUE(CullingPass::isSphereVisible(planes, glm::vec4(0.0f, 0.0f, 0.5f, 0.1f)));
+    // Depth runs from 0 to 1, so a sphere just behind z = 0 is rejected
+    EXPECT_FALSE(CullingPass::isSphereVisible(planes, glm::vec4(0.0f, 0.0f, -0.5f, 0.1f)));
+    EXPECT_FALSE(CullingPass::isSphereVisible(planes, glm::vec4(0.0f, 0.0f, 1.5f, 0.1f)));
+    EXPECT_FALSE(CullingPass::isSphereVisible(planes, glm::vec4(3.0f, 0.0f, 0.5f, 0.5f)));
+    EXPECT_FALSE(CullingPass::isSphereVisible(planes, glm::vec4(0.0f, -3.0f, 0.5f, 0.5f)));
+}
+// --------------------------------------------------------------------------------
+
+TEST(CullingPassTest, KeepsSpheresThatStraddleAPlane) {
+    std::array<glm::vec4, 6> planes = CullingPass::extractFrustumPlanes(glm::mat4(1.0f));
+    EXPECT_TRUE(CullingPass::isSphereVisible(planes, glm::vec4(1.4f, 0.0f, 0.5f, 0.5f)));
+    EXPECT_TRUE(CullingPass::isSphereVisible(planes, glm::vec4(0.0f, 0.0f, -0.05f, 0.1f)));
+}
+// --------------------------------------------------------------------------------
+
+TEST(CullingPassTest, NormalizesPlanesSoDistancesAreInWorldUnits) {
+    glm::mat4 viewProj(1.0f);
+    viewProj[0][0] = 0.5f; // Visible x range becomes [-2, 2]
+    std::array<glm::vec4, 6> planes = CullingPass::extractFrustumPlanes(viewProj);
+
+    EXPECT_FLOAT_EQ(planes[0].x, 1.0f);
+    EXPECT_FLOAT_EQ(planes[0].w, 2.0f);
+    EXPECT_FLOAT_EQ(planes[1].x, -1.0f);
+    EXPECT_FLOAT_EQ(planes[1].w, 2.0f);
+    EXPECT_TRUE(CullingPass::isSphereVisible(planes, glm::vec4(2.3f, 0.0f, 0.5f, 0.5f)));
+    EXPECT_FALSE(CullingPass::isSphereVisible(planes, glm::vec4(2.6f, 0.0f, 0.5f, 0.5f)));
+}
+// --------------------------------------------------------------------------------
+
+TEST(CullingPassTest, KeepsSpheresBetweenNearAndFarInBothDepthModes) {
+    DepthConfig config;
+    for (const bool reverseZ : {false, true}) {
+        config.reverseZ = reverseZ;
+        std::array<glm::vec4, 6> planes = CullingPass::extractFrustumPlanes(config.projection(0.8f, 1.0f, 0.1f, 10.0f));
+        EXPECT_TRUE(CullingPass::isSphereVisible(planes, glm::vec4(0.0f, 0.0f, -3.5f, 0.1f))) << reverseZ;
+        EXPECT_FALSE(CullingPass::isSphereVisible(planes, glm::vec4(0.0f, 0.0f, 1.0f, 0.1f))) << reverseZ;
+        EXPECT_FALSE(CullingPass::isSphereVisible(planes, glm::vec4(0.0f, 0.0f, -12.0f, 0.1f))) << reverseZ;
+    }
+}
+// ================================================================================
+// ================================================================================
+// eof
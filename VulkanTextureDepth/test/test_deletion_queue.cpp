@@ -0,0 +1,90 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_deletion_queue.cpp
+// - Purpose: Unit tests for the DeletionQueue class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <vector>
+#include "../include/deletion_queue.hpp"
+// ================================================================================
+// ================================================================================
+
+TEST(DeletionQueueTest, WaitsForEveryFrameInFlight) {
+    DeletionQueue queue(2);
+    bool deleted = false;
+    queue.push([&deleted]() { deleted = true; });
+
+    queue.onFenceWaited();
+    EXPECT_FALSE(deleted);
+    queue.onFenceWaited();
+    EXPECT_TRUE(deleted);
+    EXPECT_EQ(queue.size(), 0u);
+}
+// --------------------------------------------------------------------------------
+
+TEST(DeletionQueueTest, RunsDeletersInRetirementOrder) {
+    DeletionQueue queue(2);
+    std::vector<int> order;
+    queue.push([&order]() { order.push_back(1); });
+    queue.onFenceWaited();
+    queue.push([&order]() { order.push_back(2); });
+
+    queue.onFenceWaited();
+    EXPECT_EQ(order, std::vector<int>({1}));
+    queue.onFenceWaited();
+    EXPECT_EQ(order, std::vector<int>({1, 2}));
+}
+// --------------------------------------------------------------------------------
+
+TEST(DeletionQueueTest, DeleterMayPushFurtherWork) {
+    DeletionQueue queue(1);
+    int runs = 0;
+    queue.push([&queue, &runs]() {
+        ++runs;
+        queue.push([&runs]() { ++runs; });
+    });
+
+    queue.onFenceWaited();
+    EXPECT_EQ(runs, 1);
+    queue.onFenceWaited();
+    EXPECT_EQ(runs, 2);
+}
+// --------------------------------------------------------------------------------
+
+TEST(DeletionQueueTest, FrameCountChangeAppliesToLaterPushes) {
+    DeletionQueue queue(3);
+    std::vector<int> order;
+    queue.push([&order]() { order.push_back(1); });
+    queue.setFramesInFlight(1);
+    queue.push([&order]() { order.push_back(2); });
+
+    queue.onFenceWaited();
+    EXPECT_TRUE(order.empty());
+    queue.onFenceWaited();
+    queue.onFenceWaited();
+    EXPECT_EQ(order, std::vector<int>({1, 2}));
+}
+// --------------------------------------------------------------------------------
+
+TEST(DeletionQueueTest, FlushAndDestructorRunEverything) {
+    int runs = 0;
+    {
+        DeletionQueue queue(3);
+        queue.push([&runs]() { ++runs; });
+        queue.flush();
+        EXPECT_EQ(runs, 1);
+        queue.push([&runs]() { ++runs; });
+    }
+    EXPECT_EQ(runs, 2);
+}
+// ================================================================================
+// ================================================================================
+// eof
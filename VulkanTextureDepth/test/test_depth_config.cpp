@@ -0,0 +1,103 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_depth_config.cpp
+// - Purpose: Unit tests for the depth configuration
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "../include/depth_config.hpp"
+// ================================================================================
+// ================================================================================
+
+TEST(DepthConfigTest, StandardDepthKeepsTheNearestFragment) {
+    const DepthConfig config;
+    EXPECT_EQ(config.depthCompareOp(), VK_COMPARE_OP_LESS);
+    EXPECT_EQ(config.shadingCompareOp(), VK_COMPARE_OP_LESS);
+    EXPECT_TRUE(config.shadingWritesDepth());
+    EXPECT_EQ(config.clearDepth(), 1.0f);
+}
+// --------------------------------------------------------------------------------
+
+TEST(DepthConfigTest, ReverseZClearsToZeroAndUsesFloatFormats) {
+    DepthConfig config;
+    config.reverseZ = true;
+    EXPECT_EQ(config.depthCompareOp(), VK_COMPARE_OP_GREATER);
+    EXPECT_EQ(config.clearDepth(), 0.0f);
+
+    const std::vector<VkFormat> formats = config.formatCandidates();
+    ASSERT_FALSE(formats.empty());
+    EXPECT_EQ(formats.front(), VK_FORMAT_D32_SFLOAT);
+    EXPECT_EQ(std::find(formats.begin(), formats.end(), VK_FORMAT_D24_UNORM_S8_UINT), formats.end());
+}
+// --------------------------------------------------------------------------------
+
+TEST(DepthConfigTest, PrepassShadesOnlyEqualDepth) {
+    DepthConfig config;
+    config.prepass = true;
+    config.reverseZ = true;
+    EXPECT_EQ(config.depthCompareOp(), VK_COMPARE_OP_GREATER);
+    EXPECT_EQ(config.shadingCompareOp(), VK_COMPARE_OP_EQUAL);
+    EXPECT_FALSE(config.shadingWritesDepth());
+}
+// --------------------------------------------------------------------------------
+
+TEST(DepthConfigTest, SampleCountIsCappedByTheDevice) {
+    DepthConfig config;
+    const VkSampleCountFlags supported = VK_SAMPLE_COUNT_1_BIT | VK_SAMPLE_COUNT_2_BIT | VK_SAMPLE_COUNT_4_BIT;
+    EXPECT_EQ(config.sampleCount(supported), VK_SAMPLE_COUNT_1_BIT);
+
+    config.msaaSamples = 4;
+    EXPECT_EQ(config.sampleCount(supported), VK_SAMPLE_COUNT_4_BIT);
+    config.msaaSamples = 8;
+    EXPECT_EQ(config.sampleCount(supported), VK_SAMPLE_COUNT_4_BIT);
+    config.msaaSamples = 3;
+    EXPECT_EQ(config.sampleCount(supported), VK_SAMPLE_COUNT_2_BIT);
+    config.msaaSamples = 0;
+    EXPECT_EQ(config.sampleCount(supported), VK_SAMPLE_COUNT_1_BIT);
+}
+// --------------------------------------------------------------------------------
+
+// Depth in Vulkan's [0, 1] clip range of a point straight ahead of the camera
+static float projectedDepth(const DepthConfig& config, float distance) {
+    const glm::vec4 clip = config.projection(0.8f, 1.5f, 0.1f, 10.0f) * glm::vec4(0.0f, 0.0f, -distance, 1.0f);
+    return clip.z / clip.w;
+}
+// --------------------------------------------------------------------------------
+
+TEST(DepthConfigTest, ProjectionKeepsVisibleDepthInsideTheVulkanRange) {
+    DepthConfig config;
+    for (const bool reverseZ : {false, true}) {
+        config.reverseZ = reverseZ;
+        for (const float distance : {0.2f, 1.0f, 3.46f, 9.5f}) {
+            const float depth = projectedDepth(config, distance);
+            EXPECT_GE(depth, 0.0f) << "reverseZ " << reverseZ << " at " << distance;
+            EXPECT_LE(depth, 1.0f) << "reverseZ " << reverseZ << " at " << distance;
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+TEST(DepthConfigTest, ProjectionMapsTheFarPlaneToTheClearDepth) {
+    DepthConfig config;
+    EXPECT_NEAR(projectedDepth(config, 0.1f), 0.0f, 1e-5f);
+    EXPECT_NEAR(projectedDepth(config, 10.0f), 1.0f, 1e-5f);
+    EXPECT_NEAR(projectedDepth(config, 10.0f), config.clearDepth(), 1e-5f);
+    EXPECT_LT(projectedDepth(config, 1.0f), projectedDepth(config, 2.0f));
+
+    config.reverseZ = true;
+    EXPECT_NEAR(projectedDepth(config, 0.1f), 1.0f, 1e-5f);
+    EXPECT_NEAR(projectedDepth(config, 10.0f), 0.0f, 1e-5f);
+    EXPECT_NEAR(projectedDepth(config, 10.0f), config.clearDepth(), 1e-5f);
+    EXPECT_GT(projectedDepth(config, 1.0f), projectedDepth(config, 2.0f));
+}
+// ================================================================================
+// ================================================================================
+// eof
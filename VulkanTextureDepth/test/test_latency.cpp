@@ -0,0 +1,63 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_latency.cpp
+// - Purpose: Unit tests for the latency profiles
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <vector>
+#include "../include/latency.hpp"
+// ================================================================================
+// ================================================================================
+
+TEST(LatencyProfileTest, ParsesEveryProfileName) {
+    EXPECT_EQ(LatencyProfile::parseMode("low-latency"), LatencyMode::LowLatency);
+    EXPECT_EQ(LatencyProfile::parseMode("balanced"), LatencyMode::Balanced);
+    EXPECT_EQ(LatencyProfile::parseMode("throughput"), LatencyMode::Throughput);
+    EXPECT_EQ(LatencyProfile::parseMode("power_saver"), LatencyMode::PowerSaver);
+    EXPECT_FALSE(LatencyProfile::parseMode("fastest").has_value());
+}
+// --------------------------------------------------------------------------------
+
+TEST(LatencyProfileTest, FrameCountsOrderedByLatency) {
+    EXPECT_EQ(LatencyProfile::get(LatencyMode::LowLatency).framesInFlight, 1u);
+    EXPECT_EQ(LatencyProfile::get(LatencyMode::Balanced).framesInFlight, 2u);
+    EXPECT_EQ(LatencyProfile::get(LatencyMode::Throughput).framesInFlight, 3u);
+    EXPECT_TRUE(LatencyProfile::get(LatencyMode::LowLatency).presentWait);
+    EXPECT_FALSE(LatencyProfile::get(LatencyMode::Throughput).presentWait);
+}
+// --------------------------------------------------------------------------------
+
+TEST(LatencyProfileTest, PresentModeFallsBackToFifo) {
+    const LatencyProfile lowLatency = LatencyProfile::get(LatencyMode::LowLatency);
+    EXPECT_EQ(lowLatency.choosePresentMode({VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR}),
+              VK_PRESENT_MODE_MAILBOX_KHR);
+    EXPECT_EQ(lowLatency.choosePresentMode({VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR}),
+              VK_PRESENT_MODE_IMMEDIATE_KHR);
+
+    const LatencyProfile powerSaver = LatencyProfile::get(LatencyMode::PowerSaver);
+    EXPECT_EQ(powerSaver.choosePresentMode({VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR}),
+              VK_PRESENT_MODE_FIFO_KHR);
+}
+// --------------------------------------------------------------------------------
+
+TEST(LatencyProfileTest, ImageCountRespectsSurfaceLimits) {
+    const LatencyProfile throughput = LatencyProfile::get(LatencyMode::Throughput);
+    VkSurfaceCapabilitiesKHR capabilities{};
+    capabilities.minImageCount = 2;
+    capabilities.maxImageCount = 0;
+    EXPECT_EQ(throughput.chooseImageCount(capabilities), 4u);
+
+    capabilities.maxImageCount = 3;
+    EXPECT_EQ(throughput.chooseImageCount(capabilities), 3u);
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,97 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_mesh.cpp
+// - Purpose: Unit tests for index type selection and OBJ mesh parsing
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "../include/mesh.hpp"
+// ================================================================================
+// ================================================================================
+
+TEST(MeshSourceTest, SelectsIndexTypeFromVertexCount) {
+    EXPECT_EQ(MeshSource::selectIndexType(4), VK_INDEX_TYPE_UINT16);
+    EXPECT_EQ(MeshSource::selectIndexType(65535), VK_INDEX_TYPE_UINT16);
+    EXPECT_EQ(MeshSource::selectIndexType(65536), VK_INDEX_TYPE_UINT32);
+    EXPECT_EQ(MeshSource::indexSize(VK_INDEX_TYPE_UINT16), 2u);
+    EXPECT_EQ(MeshSource::indexSize(VK_INDEX_TYPE_UINT32), 4u);
+}
+// --------------------------------------------------------------------------------
+
+TEST(MeshSourceTest, VectorSourceReadsRangesOfEitherIndexWidth) {
+    const std::vector<Vertex> vertices = {
+        {{-1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f}},
+        {{1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}, {1.0f, 0.0f}},
+        {{1.0f, 2.0f, 0.0f}, {1.0f, 1.0f, 1.0f}, {1.0f, 1.0f}},
+    };
+    const std::vector<uint32_t> indices = {0, 1, 2, 2, 1, 0};
+    const VectorMeshSource mesh(vertices, indices);
+    EXPECT_EQ(mesh.getVertexCount(), 3u);
+    EXPECT_EQ(mesh.getIndexCount(), 6u);
+
+    uint32_t range[2] = {};
+    mesh.readIndices(2, 2, range);
+    EXPECT_EQ(range[0], 2u);
+    EXPECT_EQ(range[1], 2u);
+
+    const glm::vec4 sphere = mesh.getBoundingSphere();
+    EXPECT_FLOAT_EQ(sphere.x, 0.0f);
+    EXPECT_FLOAT_EQ(sphere.y, 1.0f);
+    EXPECT_FLOAT_EQ(sphere.w, std::sqrt(2.0f));
+
+    const std::vector<uint16_t> shortIndices = {2, 0, 1};
+    const VectorMeshSource shortMesh(vertices, shortIndices);
+    shortMesh.readIndices(0, 2, range);
+    EXPECT_EQ(range[0], 2u);
+    EXPECT_EQ(range[1], 0u);
+}
+// --------------------------------------------------------------------------------
+
+TEST(ObjMeshTest, SharesCornersAndTriangulatesPolygons) {
+    std::istringstream obj(
+        "# a unit quad and a triangle reusing two of its corners\n"
+        "v 0 0 0\n"
+        "v 1 0 0\n"
+        "v 1 1 0\n"
+        "v 0 1 0\n"
+        "vt 0 0\n"
+        "vt 1 0.25\n"
+        "vn 0 0 1\n"
+        "f 1/1/1 2/2/1 3/2/1 4/1/1\n"
+        "f -4/1 -3/2 -1\n");
+    const ObjMesh mesh(obj, "quad.obj");
+
+    // Corner 4/- differs from 4/1, so it is a fifth vertex
+    EXPECT_EQ(mesh.getVertexCount(), 5u);
+    ASSERT_EQ(mesh.getIndexCount(), 9u);
+    std::vector<uint32_t> indices(9);
+    mesh.readIndices(0, 9, indices.data());
+    EXPECT_EQ(indices, (std::vector<uint32_t>{0, 1, 2, 0, 2, 3, 0, 1, 4}));
+
+    Vertex vertices[2];
+    mesh.readVertices(1, 2, vertices);
+    EXPECT_FLOAT_EQ(vertices[0].pos.x, 1.0f);
+    EXPECT_FLOAT_EQ(vertices[0].texCoord.y, 0.75f);
+    EXPECT_FLOAT_EQ(vertices[1].pos.y, 1.0f);
+    EXPECT_FLOAT_EQ(vertices[1].color.x, 1.0f);
+}
+// --------------------------------------------------------------------------------
+
+TEST(ObjMeshTest, RejectsOutOfRangeIndices) {
+    std::istringstream obj("v 0 0 0\nv 1 0 0\nf 1 2 3\n");
+    EXPECT_THROW(ObjMesh(obj, "bad.obj"), std::runtime_error);
+}
+// ================================================================================
+// ================================================================================
+// eof
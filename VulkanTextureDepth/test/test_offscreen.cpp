@@ -0,0 +1,61 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_offscreen.cpp
+// - Purpose: Unit tests for writing read-back offscreen frames
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../include/offscreen.hpp"
+// ================================================================================
+// ================================================================================
+
+TEST(OffscreenTargetTest, WritesPpmWithoutAlphaAndRowPadding) {
+    // Two pixels per row with four bytes of padding after each row
+    const std::vector<uint8_t> pixels = {
+        10, 20, 30, 255,   40, 50, 60, 255,   0, 0, 0, 0,
+        70, 80, 90, 255,   11, 12, 13, 255,   0, 0, 0, 0,
+    };
+    ReadbackFrame frame;
+    frame.extent = {2, 2};
+    frame.format = VK_FORMAT_R8G8B8A8_SRGB;
+    frame.pixels = pixels.data();
+    frame.rowPitch = 12;
+
+    std::ostringstream out;
+    OffscreenTarget::writePpm(out, frame);
+
+    const std::string header = "P6\n2 2\n255\n";
+    const std::string expected = header + std::string("\x0a\x14\x1e\x28\x32\x3c\x46\x50\x5a\x0b\x0c\x0d", 12);
+    EXPECT_EQ(out.str(), expected);
+}
+// --------------------------------------------------------------------------------
+
+TEST(OffscreenTargetTest, SwapsBgraChannels) {
+    const std::vector<uint8_t> pixels = {1, 2, 3, 4};
+    ReadbackFrame frame;
+    frame.extent = {1, 1};
+    frame.format = VK_FORMAT_B8G8R8A8_UNORM;
+    frame.pixels = pixels.data();
+    frame.rowPitch = 4;
+
+    std::ostringstream out;
+    OffscreenTarget::writePpm(out, frame);
+    EXPECT_EQ(out.str().substr(out.str().size() - 3), std::string("\x03\x02\x01", 3));
+
+    frame.format = VK_FORMAT_R16G16B16A16_SFLOAT;
+    EXPECT_THROW(OffscreenTarget::writePpm(out, frame), std::runtime_error);
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,93 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_pipeline_cache.cpp
+// - Purpose: Unit tests for PipelineCache header validation
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+#include "../include/pipeline_cache.hpp"
+// ================================================================================
+// ================================================================================
+
+class PipelineCacheHeaderTest : public ::testing::Test {
+protected:
+    VkPhysicalDeviceProperties properties{};
+    std::vector<uint8_t> data;
+
+    void SetUp() override {
+        properties.vendorID = 0x10DE;
+        properties.deviceID = 0x2684;
+        for (uint32_t i = 0; i < VK_UUID_SIZE; ++i) {
+            properties.pipelineCacheUUID[i] = static_cast<uint8_t>(i * 7 + 1);
+        }
+
+        VkPipelineCacheHeaderVersionOne header{};
+        header.headerSize = sizeof(header);
+        header.headerVersion = VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+        header.vendorID = properties.vendorID;
+        header.deviceID = properties.deviceID;
+        std::memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+        data.resize(sizeof(header) + 64, 0xCD);
+        std::memcpy(data.data(), &header, sizeof(header));
+    }
+
+    VkPipelineCacheHeaderVersionOne header() const {
+        VkPipelineCacheHeaderVersionOne value;
+        std::memcpy(&value, data.data(), sizeof(value));
+        return value;
+    }
+
+    void setHeader(const VkPipelineCacheHeaderVersionOne& value) {
+        std::memcpy(data.data(), &value, sizeof(value));
+    }
+};
+// --------------------------------------------------------------------------------
+
+TEST_F(PipelineCacheHeaderTest, AcceptsMatchingDevice) {
+    EXPECT_TRUE(PipelineCache::validateHeader(data, properties));
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(PipelineCacheHeaderTest, RejectsOtherVendorOrDevice) {
+    VkPipelineCacheHeaderVersionOne value = header();
+    value.vendorID = 0x1002;
+    setHeader(value);
+    EXPECT_FALSE(PipelineCache::validateHeader(data, properties));
+
+    value = header();
+    value.vendorID = properties.vendorID;
+    value.deviceID = 0x1234;
+    setHeader(value);
+    EXPECT_FALSE(PipelineCache::validateHeader(data, properties));
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(PipelineCacheHeaderTest, RejectsDriverUpdate) {
+    properties.pipelineCacheUUID[3] ^= 0xFF;
+    EXPECT_FALSE(PipelineCache::validateHeader(data, properties));
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(PipelineCacheHeaderTest, RejectsTruncatedOrMalformedData) {
+    std::vector<uint8_t> truncated(data.begin(), data.begin() + 16);
+    EXPECT_FALSE(PipelineCache::validateHeader(truncated, properties));
+    EXPECT_FALSE(PipelineCache::validateHeader({}, properties));
+
+    VkPipelineCacheHeaderVersionOne value = header();
+    value.headerSize = static_cast<uint32_t>(data.size() + 1);
+    setHeader(value);
+    EXPECT_FALSE(PipelineCache::validateHeader(data, properties));
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,102 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_pipeline_library.cpp
+// - Purpose: Unit tests for the ShaderWatcher and the SPIR-V check of PipelineLibrary
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../include/pipeline_library.hpp"
+// ================================================================================
+// ================================================================================
+
+class ShaderWatcherTest : public ::testing::Test {
+protected:
+    std::string path = (std::filesystem::temp_directory_path() / "shader_watcher_test.spv").string();
+
+    void SetUp() override {
+        std::ofstream(path) << "v1";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+    }
+
+    void touch(int secondsLater) {
+        std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) +
+                                               std::chrono::seconds(secondsLater));
+    }
+};
+// --------------------------------------------------------------------------------
+
+TEST_F(ShaderWatcherTest, ReportsNothingForUnchangedFiles) {
+    ShaderWatcher watcher;
+    watcher.watch(path);
+    EXPECT_TRUE(watcher.poll().empty());
+    EXPECT_TRUE(watcher.poll().empty());
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(ShaderWatcherTest, ReportsAChangeOnceItHasSettled) {
+    ShaderWatcher watcher;
+    watcher.watch(path);
+    touch(5);
+    EXPECT_TRUE(watcher.poll().empty());
+    EXPECT_EQ(watcher.poll(), std::vector<std::string>{path});
+    EXPECT_TRUE(watcher.poll().empty());
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(ShaderWatcherTest, WaitsWhileTheFileKeepsChanging) {
+    ShaderWatcher watcher;
+    watcher.watch(path);
+    touch(5);
+    EXPECT_TRUE(watcher.poll().empty());
+    touch(5);
+    EXPECT_TRUE(watcher.poll().empty());
+    EXPECT_EQ(watcher.poll().size(), 1u);
+}
+// --------------------------------------------------------------------------------
+
+TEST_F(ShaderWatcherTest, ReportsAFileThatAppearsLater) {
+    ShaderWatcher watcher;
+    std::filesystem::remove(path);
+    watcher.watch(path);
+    EXPECT_TRUE(watcher.poll().empty());
+    std::ofstream(path) << "v2";
+    EXPECT_TRUE(watcher.poll().empty());
+    EXPECT_EQ(watcher.poll().size(), 1u);
+}
+// ================================================================================
+// ================================================================================
+
+TEST(PipelineLibraryTest, RecognizesSpirvModules) {
+    const uint32_t header[5] = {0x07230203u, 0x00010000u, 0u, 16u, 0u};
+    std::vector<char> code(sizeof(header));
+    std::memcpy(code.data(), header, sizeof(header));
+    EXPECT_TRUE(PipelineLibrary::isSpirv(code));
+
+    // A shader compiler still writing the file leaves a partial word or header
+    code.pop_back();
+    EXPECT_FALSE(PipelineLibrary::isSpirv(code));
+    EXPECT_FALSE(PipelineLibrary::isSpirv(std::vector<char>(code.begin(), code.begin() + 8)));
+    EXPECT_FALSE(PipelineLibrary::isSpirv({}));
+
+    std::vector<char> glsl(20, '#');
+    EXPECT_FALSE(PipelineLibrary::isSpirv(glsl));
+}
+// ================================================================================
+// ================================================================================
+// eof
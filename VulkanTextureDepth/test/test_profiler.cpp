@@ -0,0 +1,95 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_profiler.cpp
+// - Purpose: Unit tests for the frame timing history and profiler reports
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/profiler.hpp"
+// ================================================================================
+// ================================================================================
+
+static FrameTiming makeTiming(uint64_t frame, double startMs, double cpuMs) {
+    FrameTiming timing;
+    timing.frame = frame;
+    timing.startMs = startMs;
+    timing.cpuFrameMs = cpuMs;
+    return timing;
+}
+// --------------------------------------------------------------------------------
+
+TEST(FrameTimingRingTest, KeepsMostRecentRecordsOldestFirst) {
+    FrameTimingRing ring(4);
+    for (uint64_t i = 0; i < 6; ++i) {
+        ring.push(makeTiming(i, static_cast<double>(i), 1.0));
+    }
+
+    std::vector<FrameTiming> timings = ring.snapshot();
+    ASSERT_EQ(timings.size(), 4u);
+    EXPECT_EQ(timings.front().frame, 2u);
+    EXPECT_EQ(timings.back().frame, 5u);
+    EXPECT_EQ(ring.getPushCount(), 6u);
+}
+// --------------------------------------------------------------------------------
+
+TEST(ProfilerTest, TimestampIntervalSurvivesCounterWrap) {
+    // A 32-bit counter that wraps between the two timestamps
+    const uint64_t begin = 0xFFFFFFF0ull;
+    const uint64_t end = 0x00000010ull;
+    EXPECT_DOUBLE_EQ(Profiler::ticksToMilliseconds(begin, end, 1000.0f, 32), 0.032);
+    EXPECT_DOUBLE_EQ(Profiler::ticksToMilliseconds(0, 2000000, 0.5f, 64), 1.0);
+}
+// --------------------------------------------------------------------------------
+
+TEST(ProfilerTest, SummaryReportsWorstFrameInterval) {
+    std::vector<FrameTiming> timings = {
+        makeTiming(0, 0.0, 4.0),
+        makeTiming(1, 10.0, 6.0),
+        makeTiming(2, 40.0, 5.0),
+    };
+    timings[1].gpuValid = true;
+    timings[1].gpuFrameMs = 3.0;
+
+    FrameSummary summary = Profiler::summarize(timings);
+    EXPECT_EQ(summary.frames, 3u);
+    EXPECT_DOUBLE_EQ(summary.cpuMs, 5.0);
+    // Frames without GPU results do not pull the GPU mean down
+    EXPECT_DOUBLE_EQ(summary.gpuMs, 3.0);
+    EXPECT_DOUBLE_EQ(summary.worstMs, 30.0);
+    EXPECT_NEAR(summary.framesPerSecond, 3000.0 / 45.0, 1e-9);
+}
+// --------------------------------------------------------------------------------
+
+TEST(ProfilerTest, CsvHasHeaderAndOneRowPerFrame) {
+    std::vector<FrameTiming> timings = {makeTiming(0, 0.0, 4.0), makeTiming(1, 16.0, 4.0)};
+    timings[0].gpuValid = true;
+
+    std::ostringstream out;
+    Profiler::writeCsv(out, timings);
+
+    std::istringstream lines(out.str());
+    std::string header;
+    std::getline(lines, header);
+    EXPECT_EQ(header.rfind("frame,start_ms,cpu_frame_ms,fence_wait_ms", 0), 0u);
+
+    std::vector<std::string> rows;
+    for (std::string row; std::getline(lines, row);) {
+        rows.push_back(row);
+    }
+    ASSERT_EQ(rows.size(), 2u);
+    // The second frame has no GPU results, so its GPU columns are empty
+    EXPECT_EQ(rows[1].substr(rows[1].size() - 3), ",,,");
+}
+// ================================================================================
+// ================================================================================
+// eof
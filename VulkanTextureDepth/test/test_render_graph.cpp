@@ -0,0 +1,298 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_render_graph.cpp
+// - Purpose: Unit tests for pass culling, barrier derivation, queue batching and
+//            transient aliasing in the RenderGraph
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <vector>
+#include "../include/render_graph.hpp"
+// ================================================================================
+// ================================================================================
+
+static const ResourceAccess computeWrite{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT};
+static const ResourceAccess computeRead{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT};
+static const ResourceAccess indirectRead{VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+                                         VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT};
+static const ResourceAccess vertexRead{VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT};
+// ================================================================================
+// ================================================================================
+
+TEST(RenderGraphTest, CullsPassesWhoseOutputsAreNeverRead) {
+    RenderGraph graph;
+    const ResourceId used = graph.importBuffer("used", VK_NULL_HANDLE);
+    const ResourceId unused = graph.importBuffer("unused", VK_NULL_HANDLE);
+    const PassId producer = graph.addPass("producer", QueueClass::Graphics, nullptr);
+    const PassId orphan = graph.addPass("orphan", QueueClass::Graphics, nullptr);
+    const PassId consumer = graph.addPass("consumer", QueueClass::Graphics, nullptr);
+    graph.write(producer, used, computeWrite);
+    graph.write(orphan, unused, computeWrite);
+    graph.read(consumer, used, indirectRead);
+    graph.keepPass(consumer);
+    graph.compile(0, 0);
+
+    EXPECT_FALSE(graph.isCulled(producer));
+    EXPECT_TRUE(graph.isCulled(orphan));
+    EXPECT_FALSE(graph.isCulled(consumer));
+}
+// --------------------------------------------------------------------------------
+
+TEST(RenderGraphTest, CullsAWriteThatALaterWriteDiscards) {
+    RenderGraph graph;
+    const ResourceId buffer = graph.importBuffer("buffer", VK_NULL_HANDLE);
+    const PassId overwritten = graph.addPass("overwritten", QueueClass::Graphics, nullptr);
+    const PassId last = graph.addPass("final", QueueClass::Graphics, nullptr);
+    graph.write(overwritten, buffer, computeWrite);
+    graph.write(last, buffer, computeWrite);
+    graph.exportResource(buffer);
+    graph.compile(0, 0);
+
+    EXPECT_TRUE(graph.isCulled(overwritten));
+    EXPECT_FALSE(graph.isCulled(last));
+}
+// --------------------------------------------------------------------------------
+
+TEST(RenderGraphTest, OrdersAReadAfterAWrite) {
+    RenderGraph graph;
+    const ResourceId commands = graph.importBuffer("commands", VK_NULL_HANDLE);
+    const PassId cull = graph.addPass("cull", QueueClass::Graphics, nullptr);
+    const PassId draw = graph.addPass("draw", QueueClass::Graphics, nullptr);
+    graph.write(cull, commands, computeWrite);
+    graph.read(draw, commands, indirectRead);
+    graph.keepPass(draw);
+    graph.compile(0, 0);
+
+    EXPECT_TRUE(graph.getBarriersBefore(cull).empty());
+    ASSERT_EQ(graph.getBarriersBefore(draw).size(), 1u);
+    const GraphBarrier& barrier = graph.getBarriersBefore(draw)[0];
+    EXPECT_EQ(barrier.srcStages, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+    EXPECT_EQ(barrier.srcAccess, VK_ACCESS_2_SHADER_WRITE_BIT);
+    EXPECT_EQ(barrier.dstStages, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT);
+    EXPECT_EQ(barrier.dstAccess, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+}
+// --------------------------------------------------------------------------------
+
+TEST(RenderGraphTest, ReadsThatAreAlreadyVisibleNeedNoBarrier) {
+    RenderGraph graph;
+    const ResourceId buffer = graph.importBuffer("buffer", VK_NULL_HANDLE);
+    const ResourceId input = graph.importBuffer("input", VK_NULL_HANDLE);
+    const PassId writer = graph.addPass("writer", QueueClass::Graphics, nullptr);
+    const PassId first = graph.addPass("first", QueueClass::Graphics, nullptr);
+    const PassId second = graph.addPass("second", QueueClass::Graphics, nullptr);
+    const PassId third = graph.addPass("third", QueueClass::Graphics, nullptr);
+    graph.write(writer, buffer, computeWrite);
+    graph.read(first, buffer, vertexRead);
+    graph.read(first, input, vertexRead);
+    graph.read(second, buffer, vertexRead);
+    graph.read(second, input, computeRead);
+    graph.read(third, buffer, indirectRead);
+    graph.keepPass(first);
+    graph.keepPass(second);
+    graph.keepPass(third);
+    graph.compile(0, 0);
+
+    // Nothing writes input, and the vertex shader already sees the write to buffer
+    EXPECT_EQ(graph.getBarriersBefore(first).size(), 1u);
+    EXPECT_TRUE(graph.getBarriersBefore(second).empty());
+    ASSERT_EQ(graph.getBarriersBefore(third).size(), 1u);
+    EXPECT_EQ(graph.getBarriersBefore(third)[0].dstStages, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT);
+}
+// --------------------------------------------------------------------------------
+
+TEST(RenderGraphTest, AccessesOfOnePassAreMerged) {
+    RenderGraph graph;
+    const ResourceId buffer = graph.importBuffer("buffer", VK_NULL_HANDLE);
+    const PassId writer = graph.addPass("writer", QueueClass::Graphics, nullptr);
+    const PassId draw = graph.addPass("draw", QueueClass::Graphics, nullptr);
+    graph.write(writer, buffer, computeWrite);
+    graph.read(draw, buffer, indirectRead);
+    graph.read(draw, buffer, vertexRead);
+    graph.keepPass(draw);
+    graph.compile(0, 0);
+
+    ASSERT_EQ(graph.getBarriersBefore(draw).size(), 1u);
+    EXPECT_EQ(graph.getBarriersBefore(draw)[0].dstStages,
+              VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+}
+// --------------------------------------------------------------------------------
+
+TEST(RenderGraphTest, WaitsForReadsBeforeOverwriting) {
+    RenderGraph graph;
+    const ResourceId buffer = graph.importBuffer("buffer", VK_NULL_HANDLE);
+    const PassId writer = graph.addPass("writer", QueueClass::Graphics, nullptr);
+    const PassId reader = graph.addPass("reader", QueueClass::Graphics, nullptr);
+    const PassId rewriter = graph.addPass("rewriter", QueueClass::Graphics, nullptr);
+    graph.write(writer, buffer, computeWrite);
+    graph.read(reader, buffer, vertexRead);
+    graph.write(rewriter, buffer, computeWrite);
+    graph.keepPass(writer);
+    graph.keepPass(reader);
+    graph.keepPass(rewriter);
+    graph.compile(0, 0);
+
+    ASSERT_EQ(graph.getBarriersBefore(rewriter).size(), 1u);
+    EXPECT_EQ(graph.getBarriersBefore(rewriter)[0].srcStages,
+              VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+}
+// --------------------------------------------------------------------------------
+
+TEST(RenderGraphTest, TransitionsImagesToTheLayoutAPassNeeds) {
+    RenderGraph graph;
+    const ResourceId image = graph.importImage("image", VK_NULL_HANDLE, VK_IMAGE_ASPECT_COLOR_BIT,
+                                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    const PassId sample = graph.addPass("sample", QueueClass::Graphics, nullptr);
+    const PassId again = graph.addPass("again", QueueClass::Graphics, nullptr);
+    const ResourceAccess sampled{VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    graph.read(sample, image, sampled);
+    graph.read(again, image, sampled);
+    graph.keepPass(sample);
+    graph.keepPass(again);
+    graph.compile(0, 0);
+
+    ASSERT_EQ(graph.getBarriersBefore(sample).size(), 1u);
+    EXPECT_EQ(graph.getBarriersBefore(sample)[0].oldLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    EXPECT_EQ(graph.getBarriersBefore(sample)[0].newLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    EXPECT_TRUE(graph.getBarriersBefore(again).empty());
+}
+// --------------------------------------------------------------------------------
+
+TEST(RenderGraphTest, HandsExportedResourcesToTheirConsumer) {
+    RenderGraph graph;
+    const ResourceId stats = graph.importBuffer("stats", VK_NULL_HANDLE);
+    const PassId cull = graph.addPass("cull", QueueClass::Graphics, nullptr);
+    graph.write(cull, stats, computeWrite);
+    graph.exportResource(stats, {VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT});
+    graph.compile(0, 0);
+
+    ASSERT_EQ(graph.getBarriersAfter(cull).size(), 1u);
+    EXPECT_EQ(graph.getBarriersAfter(cull)[0].dstStages, VK_PIPELINE_STAGE_2_HOST_BIT);
+    EXPECT_EQ(graph.getBarriersAfter(cull)[0].dstAccess, VK_ACCESS_2_HOST_READ_BIT);
+}
+// --------------------------------------------------------------------------------
+
+TEST(RenderGraphTest, RejectsReadingATransientBeforeItIsWritten) {
+    RenderGraph graph;
+    const ResourceId transient = graph.createTransientImage("transient", TransientImageDesc{});
+    const PassId reader = graph.addPass("reader", QueueClass::Graphics, nullptr);
+    graph.read(reader, transient, computeRead);
+    graph.keepPass(reader);
+    EXPECT_THROW(graph.compile(0, 0), std::runtime_error);
+    EXPECT_THROW(graph.read(reader + 1, transient, computeRead), std::runtime_error);
+}
+// ================================================================================
+// ================================================================================
+
+TEST(RenderGraphTest, SplitsAsyncComputeIntoBatchesWithDedicatedFamilies) {
+    RenderGraph graph;
+    const ResourceId buffer = graph.importBuffer("buffer", VK_NULL_HANDLE);
+    const PassId compute = graph.addPass("compute", QueueClass::AsyncCompute, nullptr);
+    const PassId draw = graph.addPass("draw", QueueClass::Graphics, nullptr);
+    graph.write(compute, buffer, computeWrite);
+    graph.read(draw, buffer, vertexRead);
+    graph.keepPass(draw);
+    graph.compile(0, 1);
+
+    const std::vector<GraphBatch>& batches = graph.getBatches();
+    ASSERT_EQ(batches.size(), 2u);
+    EXPECT_EQ(batches[0].queue, QueueClass::AsyncCompute);
+    EXPECT_EQ(batches[1].queue, QueueClass::Graphics);
+    ASSERT_EQ(batches[1].waits.size(), 1u);
+    EXPECT_EQ(batches[1].waits[0].batch, 0u);
+    EXPECT_EQ(batches[1].waits[0].stages, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+
+    // The buffer's ownership is released by the compute queue and acquired by graphics
+    ASSERT_EQ(graph.getBarriersAfter(compute).size(), 1u);
+    EXPECT_EQ(graph.getBarriersAfter(compute)[0].srcQueue, QueueClass::AsyncCompute);
+    EXPECT_EQ(graph.getBarriersAfter(compute)[0].dstQueue, QueueClass::Graphics);
+    ASSERT_EQ(graph.getBarriersBefore(draw).size(), 1u);
+    EXPECT_EQ(graph.getBarriersBefore(draw)[0].dstStages, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+}
+// --------------------------------------------------------------------------------
+
+TEST(RenderGraphTest, RunsAsyncComputeOnGraphicsWithoutADedicatedFamily) {
+    RenderGraph graph;
+    const ResourceId buffer = graph.importBuffer("buffer", VK_NULL_HANDLE);
+    const PassId compute = graph.addPass("compute", QueueClass::AsyncCompute, nullptr);
+    const PassId draw = graph.addPass("draw", QueueClass::Graphics, nullptr);
+    graph.write(compute, buffer, computeWrite);
+    graph.read(draw, buffer, vertexRead);
+    graph.keepPass(draw);
+    graph.compile(0, 0);
+
+    ASSERT_EQ(graph.getBatches().size(), 1u);
+    EXPECT_EQ(graph.getBatches()[0].passes, (std::vector<PassId>{compute, draw}));
+    EXPECT_TRUE(graph.getBarriersAfter(compute).empty());
+    ASSERT_EQ(graph.getBarriersBefore(draw).size(), 1u);
+    EXPECT_EQ(graph.getBarriersBefore(draw)[0].srcQueue, graph.getBarriersBefore(draw)[0].dstQueue);
+}
+// ================================================================================
+// ================================================================================
+
+TEST(RenderGraphTest, TracksTransientLifetimesInExecutedPassOrder) {
+    RenderGraph graph;
+    TransientImageDesc desc;
+    desc.format = VK_FORMAT_R8G8B8A8_UNORM;
+    const ResourceId a = graph.createTransientImage("a", desc);
+    const ResourceId b = graph.createTransientImage("b", desc);
+    const PassId writeA = graph.addPass("write a", QueueClass::Graphics, nullptr);
+    const PassId readA = graph.addPass("read a", QueueClass::Graphics, nullptr);
+    const PassId writeB = graph.addPass("write b", QueueClass::Graphics, nullptr);
+    graph.write(writeA, a, computeWrite);
+    graph.read(readA, a, computeRead);
+    graph.write(writeB, b, computeWrite);
+    graph.keepPass(readA);
+    graph.keepPass(writeB);
+    graph.compile(0, 0);
+
+    const std::vector<TransientBlock> lifetimes = graph.getTransientLifetimes();
+    ASSERT_EQ(lifetimes.size(), 2u);
+    EXPECT_EQ(lifetimes[0].first, 0u);
+    EXPECT_EQ(lifetimes[0].last, 1u);
+    EXPECT_EQ(lifetimes[1].first, 2u);
+    EXPECT_EQ(lifetimes[1].last, 2u);
+
+    // A transient's first use discards whatever the memory held
+    ASSERT_EQ(graph.getBarriersBefore(writeB).size(), 1u);
+    EXPECT_EQ(graph.getBarriersBefore(writeB)[0].oldLayout, VK_IMAGE_LAYOUT_UNDEFINED);
+}
+// --------------------------------------------------------------------------------
+
+TEST(RenderGraphTest, AliasesTransientsWithDisjointLifetimes) {
+    std::vector<TransientBlock> blocks(3);
+    blocks[0] = {1024, 256, 0, 1};
+    blocks[1] = {512, 256, 0, 2};
+    blocks[2] = {1024, 256, 2, 3};
+    const TransientPlacement placement = RenderGraph::placeTransients(blocks);
+
+    // The first and last never live together, so they share the same memory
+    EXPECT_EQ(placement.offsets[0], placement.offsets[2]);
+    EXPECT_EQ(placement.offsets[1], 1024u);
+    EXPECT_EQ(placement.size, 1536u);
+    EXPECT_EQ(placement.predecessors[0], -1);
+    EXPECT_EQ(placement.predecessors[1], -1);
+    EXPECT_EQ(placement.predecessors[2], 0);
+}
+// --------------------------------------------------------------------------------
+
+TEST(RenderGraphTest, PlacesOverlappingTransientsAtAlignedOffsets) {
+    std::vector<TransientBlock> blocks(2);
+    blocks[0] = {1000, 16, 0, 1};
+    blocks[1] = {100, 4096, 1, 2};
+    const TransientPlacement placement = RenderGraph::placeTransients(blocks);
+
+    EXPECT_EQ(placement.offsets[0], 0u);
+    EXPECT_EQ(placement.offsets[1], 4096u);
+    EXPECT_EQ(placement.size, 4196u);
+}
+// ================================================================================
+// ================================================================================
+// eof
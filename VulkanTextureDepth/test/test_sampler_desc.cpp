@@ -0,0 +1,69 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_sampler_desc.cpp
+// - Purpose: Unit tests for sampler state comparison, hashing and create info
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <unordered_set>
+#include "../include/sampler_desc.hpp"
+// ================================================================================
+// ================================================================================
+
+TEST(SamplerDescTest, EqualStatesHashAlike) {
+    SamplerDesc a;
+    SamplerDesc b;
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(SamplerDescHash{}(a), SamplerDescHash{}(b));
+
+    // -0.0 equals 0.0, so it must not split the cache
+    b.mipLodBias = -0.0f;
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(SamplerDescHash{}(a), SamplerDescHash{}(b));
+}
+// --------------------------------------------------------------------------------
+
+TEST(SamplerDescTest, DistinctStatesDeduplicateSeparately) {
+    SamplerDesc nearest;
+    nearest.magFilter = VK_FILTER_NEAREST;
+    nearest.minFilter = VK_FILTER_NEAREST;
+    SamplerDesc clamped;
+    clamped.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    SamplerDesc shadow;
+    shadow.compareEnable = true;
+    shadow.compareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+    EXPECT_NE(SamplerDesc{}, nearest);
+    EXPECT_NE(SamplerDesc{}, clamped);
+    EXPECT_NE(SamplerDesc{}, shadow);
+
+    std::unordered_set<SamplerDesc, SamplerDescHash> states = {SamplerDesc{}, nearest, clamped, shadow,
+                                                               SamplerDesc{}, nearest};
+    EXPECT_EQ(states.size(), 4u);
+}
+// --------------------------------------------------------------------------------
+
+TEST(SamplerDescTest, ClampsAnisotropyToTheDevice) {
+    SamplerDesc desc;
+    VkSamplerCreateInfo info = desc.toCreateInfo(8.0f);
+    EXPECT_EQ(info.sType, VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO);
+    EXPECT_EQ(info.anisotropyEnable, VK_TRUE);
+    EXPECT_FLOAT_EQ(info.maxAnisotropy, 8.0f);
+    EXPECT_EQ(info.compareEnable, VK_FALSE);
+    EXPECT_FLOAT_EQ(info.maxLod, VK_LOD_CLAMP_NONE);
+
+    desc.maxAnisotropy = 1.0f;
+    info = desc.toCreateInfo(16.0f);
+    EXPECT_EQ(info.anisotropyEnable, VK_FALSE);
+    EXPECT_FLOAT_EQ(info.maxAnisotropy, 1.0f);
+}
+// ================================================================================
+// ================================================================================
+// eof
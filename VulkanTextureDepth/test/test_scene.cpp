@@ -0,0 +1,89 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_scene.cpp
+// - Purpose: Unit tests for the Scene draw list packing
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <vector>
+#include "../include/scene.hpp"
+// ================================================================================
+// ================================================================================
+
+static SceneMesh makeMesh(uint32_t indexCount, uint32_t firstIndex) {
+    SceneMesh mesh;
+    mesh.indexCount = indexCount;
+    mesh.firstIndex = firstIndex;
+    return mesh;
+}
+// --------------------------------------------------------------------------------
+
+static SceneInstance makeInstance(uint32_t mesh, float x) {
+    SceneInstance instance;
+    instance.mesh = mesh;
+    instance.model[3] = glm::vec4(x, 0.0f, 0.0f, 1.0f);
+    return instance;
+}
+// --------------------------------------------------------------------------------
+
+TEST(SceneTest, GroupsInstancesIntoOneDrawPerMesh) {
+    std::vector<SceneMesh> meshes = {makeMesh(6, 0), makeMesh(12, 6), makeMesh(3, 18)};
+    std::vector<SceneInstance> instances = {makeInstance(2, 0.0f), makeInstance(0, 1.0f),
+                                            makeInstance(2, 2.0f), makeInstance(0, 3.0f),
+                                            makeInstance(0, 4.0f)};
+    std::vector<InstanceData> data(instances.size());
+    std::vector<VkDrawIndexedIndirectCommand> commands(meshes.size());
+
+    uint32_t drawCount = Scene::buildDrawList(meshes, instances, data.data(), commands.data());
+
+    // Mesh 1 has no instances and is skipped
+    ASSERT_EQ(drawCount, 2u);
+    EXPECT_EQ(commands[0].indexCount, 6u);
+    EXPECT_EQ(commands[0].instanceCount, 3u);
+    EXPECT_EQ(commands[0].firstInstance, 0u);
+    EXPECT_EQ(commands[1].indexCount, 3u);
+    EXPECT_EQ(commands[1].firstIndex, 18u);
+    EXPECT_EQ(commands[1].instanceCount, 2u);
+    EXPECT_EQ(commands[1].firstInstance, 3u);
+
+    // Instances keep their submission order within a mesh
+    EXPECT_FLOAT_EQ(data[0].model[3].x, 1.0f);
+    EXPECT_FLOAT_EQ(data[1].model[3].x, 3.0f);
+    EXPECT_FLOAT_EQ(data[2].model[3].x, 4.0f);
+    EXPECT_FLOAT_EQ(data[3].model[3].x, 0.0f);
+    EXPECT_FLOAT_EQ(data[4].model[3].x, 2.0f);
+}
+// --------------------------------------------------------------------------------
+
+TEST(SceneTest, TransformsBoundingSpheresToWorldSpace) {
+    SceneMesh mesh = makeMesh(3, 0);
+    mesh.boundingSphere = glm::vec4(1.0f, 0.0f, 0.0f, 0.5f);
+    SceneInstance instance = makeInstance(0, 10.0f);
+    instance.model[1] = glm::vec4(0.0f, 4.0f, 0.0f, 0.0f);
+
+    InstanceData data;
+    VkDrawIndexedIndirectCommand command;
+    Scene::buildDrawList({mesh}, {instance}, &data, &command);
+
+    EXPECT_FLOAT_EQ(data.boundingSphere.x, 11.0f);
+    EXPECT_FLOAT_EQ(data.boundingSphere.y, 0.0f);
+    // The radius grows with the largest axis scale
+    EXPECT_FLOAT_EQ(data.boundingSphere.w, 2.0f);
+}
+// --------------------------------------------------------------------------------
+
+TEST(SceneTest, EmptySceneProducesNoDraws) {
+    std::vector<SceneMesh> meshes = {makeMesh(6, 0)};
+    std::vector<VkDrawIndexedIndirectCommand> commands(meshes.size());
+    EXPECT_EQ(Scene::buildDrawList(meshes, {}, nullptr, commands.data()), 0u);
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,166 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_texture_loader.cpp
+// - Purpose: Unit tests for the KTX2 and DDS parsing in TextureLoader
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <vulkan/vulkan.h>
+#include <gtest/gtest.h>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "../include/texture_loader.hpp"
+// ================================================================================
+// ================================================================================
+// Helpers that build minimal containers in memory
+
+static void putU32(std::vector<uint8_t>& bytes, size_t offset, uint32_t value) {
+    if (bytes.size() < offset + 4) {
+        bytes.resize(offset + 4, 0);
+    }
+    memcpy(bytes.data() + offset, &value, 4);
+}
+// --------------------------------------------------------------------------------
+
+static void putU64(std::vector<uint8_t>& bytes, size_t offset, uint64_t value) {
+    if (bytes.size() < offset + 8) {
+        bytes.resize(offset + 8, 0);
+    }
+    memcpy(bytes.data() + offset, &value, 8);
+}
+// --------------------------------------------------------------------------------
+
+static std::vector<uint8_t> makeKTX2(VkFormat format, uint32_t width, uint32_t height,
+                                     const std::vector<std::vector<uint8_t>>& levels) {
+    static const uint8_t identifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+    std::vector<uint8_t> bytes(80 + levels.size() * 24, 0);
+    memcpy(bytes.data(), identifier, sizeof(identifier));
+    putU32(bytes, 12, static_cast<uint32_t>(format));
+    putU32(bytes, 16, 1);
+    putU32(bytes, 20, width);
+    putU32(bytes, 24, height);
+    putU32(bytes, 36, 1);
+    putU32(bytes, 40, static_cast<uint32_t>(levels.size()));
+
+    for (size_t level = 0; level < levels.size(); ++level) {
+        const size_t offset = bytes.size();
+        bytes.insert(bytes.end(), levels[level].begin(), levels[level].end());
+        putU64(bytes, 80 + level * 24, offset);
+        putU64(bytes, 80 + level * 24 + 8, levels[level].size());
+        putU64(bytes, 80 + level * 24 + 16, levels[level].size());
+    }
+    return bytes;
+}
+// --------------------------------------------------------------------------------
+
+static std::vector<uint8_t> makeDDS(const char* fourCC, uint32_t width, uint32_t height, uint32_t mipCount,
+                                    const std::vector<uint8_t>& payload, uint32_t dxgiFormat = 0) {
+    std::vector<uint8_t> bytes(128, 0);
+    memcpy(bytes.data(), "DDS ", 4);
+    putU32(bytes, 4, 124);
+    putU32(bytes, 12, height);
+    putU32(bytes, 16, width);
+    putU32(bytes, 28, mipCount);
+    putU32(bytes, 76, 32);
+    memcpy(bytes.data() + 84, fourCC, 4);
+    if (std::strncmp(fourCC, "DX10", 4) == 0) {
+        bytes.resize(148, 0);
+        putU32(bytes, 128, dxgiFormat);
+        putU32(bytes, 132, 3);  // DDS_DIMENSION_TEXTURE2D
+        putU32(bytes, 140, 1);  // arraySize
+    }
+    bytes.insert(bytes.end(), payload.begin(), payload.end());
+    return bytes;
+}
+// ================================================================================
+// ================================================================================
+// Block size and level size calculations
+
+TEST(TextureLoaderTest, LevelSizeRoundsUpToWholeBlocks) {
+    EXPECT_EQ(TextureLoader::levelSize(VK_FORMAT_BC1_RGBA_SRGB_BLOCK, 4, 4), 8u);
+    EXPECT_EQ(TextureLoader::levelSize(VK_FORMAT_BC7_SRGB_BLOCK, 5, 5), 64u);
+    EXPECT_EQ(TextureLoader::levelSize(VK_FORMAT_BC3_SRGB_BLOCK, 1, 1), 16u);
+    EXPECT_EQ(TextureLoader::levelSize(VK_FORMAT_ASTC_8x8_SRGB_BLOCK, 16, 9), 64u);
+    EXPECT_EQ(TextureLoader::levelSize(VK_FORMAT_R8G8B8A8_SRGB, 4, 4), 0u);
+}
+// --------------------------------------------------------------------------------
+
+TEST(TextureLoaderTest, RecognizesContainerExtensions) {
+    EXPECT_TRUE(TextureLoader::isCompressedContainer("textures/wall.ktx2"));
+    EXPECT_TRUE(TextureLoader::isCompressedContainer("textures/WALL.DDS"));
+    EXPECT_FALSE(TextureLoader::isCompressedContainer("textures/wall.jpg"));
+}
+// ================================================================================
+// ================================================================================
+// KTX2 parsing
+
+TEST(TextureLoaderTest, ParsesKTX2MipChain) {
+    const std::vector<std::vector<uint8_t>> levels = {
+        std::vector<uint8_t>(64, 0x11),  // 8x8 BC7 -> 4 blocks
+        std::vector<uint8_t>(16, 0x22),  // 4x4
+        std::vector<uint8_t>(16, 0x33)   // 2x2
+    };
+    CompressedTexture texture = TextureLoader::parseKTX2(makeKTX2(VK_FORMAT_BC7_SRGB_BLOCK, 8, 8, levels));
+
+    EXPECT_EQ(texture.format, VK_FORMAT_BC7_SRGB_BLOCK);
+    EXPECT_EQ(texture.width, 8u);
+    EXPECT_EQ(texture.height, 8u);
+    ASSERT_EQ(texture.mipLevels, 3u);
+    ASSERT_EQ(texture.levelOffsets.size(), 3u);
+    for (uint32_t level = 0; level < 3; ++level) {
+        EXPECT_EQ(texture.levelOffsets[level] % 16, 0u);
+        EXPECT_EQ(texture.data[texture.levelOffsets[level]], levels[level][0]);
+    }
+}
+// --------------------------------------------------------------------------------
+
+TEST(TextureLoaderTest, RejectsUnsupportedKTX2Format) {
+    const std::vector<std::vector<uint8_t>> levels = {std::vector<uint8_t>(64, 0)};
+    EXPECT_THROW(TextureLoader::parseKTX2(makeKTX2(VK_FORMAT_R8G8B8A8_SRGB, 4, 4, levels)), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+TEST(TextureLoaderTest, RejectsTruncatedKTX2Level) {
+    const std::vector<std::vector<uint8_t>> levels = {std::vector<uint8_t>(8, 0)};  // 8x8 BC7 needs 64
+    EXPECT_THROW(TextureLoader::parseKTX2(makeKTX2(VK_FORMAT_BC7_SRGB_BLOCK, 8, 8, levels)), std::runtime_error);
+}
+// ================================================================================
+// ================================================================================
+// DDS parsing
+
+TEST(TextureLoaderTest, ParsesLegacyDXT1) {
+    // 8x8 BC1 is 4 blocks of 8 bytes, followed by a 4x4 level of one block
+    std::vector<uint8_t> payload(40, 0xAA);
+    payload[32] = 0xBB;
+    CompressedTexture texture = TextureLoader::parseDDS(makeDDS("DXT1", 8, 8, 2, payload));
+
+    EXPECT_EQ(texture.format, VK_FORMAT_BC1_RGBA_SRGB_BLOCK);
+    ASSERT_EQ(texture.mipLevels, 2u);
+    EXPECT_EQ(texture.data[texture.levelOffsets[1]], 0xBB);
+}
+// --------------------------------------------------------------------------------
+
+TEST(TextureLoaderTest, ParsesDX10BC7) {
+    std::vector<uint8_t> payload(16, 0x5A);
+    CompressedTexture texture = TextureLoader::parseDDS(makeDDS("DX10", 4, 4, 1, payload, 98));
+
+    EXPECT_EQ(texture.format, VK_FORMAT_BC7_UNORM_BLOCK);
+    EXPECT_EQ(texture.mipLevels, 1u);
+    EXPECT_EQ(texture.data.size(), 16u);
+}
+// --------------------------------------------------------------------------------
+
+TEST(TextureLoaderTest, RejectsTruncatedDDS) {
+    std::vector<uint8_t> payload(8, 0);
+    EXPECT_THROW(TextureLoader::parseDDS(makeDDS("DXT5", 4, 4, 1, payload)), std::runtime_error);
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,63 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_thread_pool.cpp
+// - Purpose: Unit tests for the ThreadPool class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include "../include/thread_pool.hpp"
+// ================================================================================
+// ================================================================================
+
+TEST(ThreadPoolTest, ReturnsTaskResultsThroughFutures) {
+    ThreadPool pool(4);
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 64; ++i) {
+        results.push_back(pool.submit([i]() { return i * i; }));
+    }
+    for (int i = 0; i < 64; ++i) {
+        EXPECT_EQ(results[i].get(), i * i);
+    }
+}
+// --------------------------------------------------------------------------------
+
+TEST(ThreadPoolTest, PropagatesExceptionsToTheCaller) {
+    ThreadPool pool(1);
+    std::future<void> result = pool.submit([]() { throw std::runtime_error("decode failed"); });
+    EXPECT_THROW(result.get(), std::runtime_error);
+}
+// --------------------------------------------------------------------------------
+
+TEST(ThreadPoolTest, RunsTasksOnEveryWorker) {
+    ThreadPool pool(3);
+    EXPECT_EQ(pool.size(), 3u);
+
+    std::atomic<int> counter{0};
+    std::vector<std::future<void>> results;
+    for (int i = 0; i < 100; ++i) {
+        results.push_back(pool.submit([&counter]() { counter.fetch_add(1); }));
+    }
+    for (std::future<void>& result : results) {
+        result.get();
+    }
+    EXPECT_EQ(counter.load(), 100);
+}
+// --------------------------------------------------------------------------------
+
+TEST(ThreadPoolTest, DefaultSizeHasAtLeastOneWorker) {
+    ThreadPool pool;
+    EXPECT_GE(pool.size(), 1u);
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,92 @@
+// ================================================================================
+// ================================================================================
+// - File:    test_vertex_format.cpp
+// - Purpose: Unit tests for attribute quantization and the generated vertex layouts
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2024, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <limits>
+#include "../include/vertex_format.hpp"
+// ================================================================================
+// ================================================================================
+
+TEST(VertexFormatTest, ConvertsFloatsToHalf) {
+    EXPECT_EQ(floatToHalf(0.0f), 0x0000);
+    EXPECT_EQ(floatToHalf(-0.0f), 0x8000);
+    EXPECT_EQ(floatToHalf(1.0f), 0x3C00);
+    EXPECT_EQ(floatToHalf(-2.0f), 0xC000);
+    EXPECT_EQ(floatToHalf(0.5f), 0x3800);
+    EXPECT_EQ(floatToHalf(65504.0f), 0x7BFF);
+    EXPECT_EQ(floatToHalf(1.0e6f), 0x7C00);
+    EXPECT_EQ(floatToHalf(std::numeric_limits<float>::infinity()), 0x7C00);
+    EXPECT_EQ(floatToHalf(5.9604645e-8f), 0x0001);   // Smallest subnormal
+    EXPECT_NE(floatToHalf(std::numeric_limits<float>::quiet_NaN()) & 0x03FF, 0);
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormatTest, PacksNormalizedIntegersWithClamping) {
+    EXPECT_EQ(packUnorm8(0.0f), 0);
+    EXPECT_EQ(packUnorm8(1.0f), 255);
+    EXPECT_EQ(packUnorm8(0.5f), 128);
+    EXPECT_EQ(packUnorm8(2.0f), 255);
+    EXPECT_EQ(packSnorm16(-1.0f), -32767);
+    EXPECT_EQ(packSnorm16(1.0f), 32767);
+    EXPECT_EQ(packSnorm16(-3.0f), -32767);
+    EXPECT_EQ(packSnorm16(0.0f), 0);
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormatTest, EncodesAxisNormalsOnTheOctahedron) {
+    OctNormal16 up = packOctNormal({0.0f, 0.0f, 1.0f});
+    EXPECT_EQ(up.value[0], 0);
+    EXPECT_EQ(up.value[1], 0);
+
+    OctNormal16 right = packOctNormal({2.0f, 0.0f, 0.0f});
+    EXPECT_EQ(right.value[0], 32767);
+    EXPECT_EQ(right.value[1], 0);
+
+    // The lower pole folds onto a corner of the square
+    OctNormal16 down = packOctNormal({0.0f, 0.0f, -1.0f});
+    EXPECT_EQ(down.value[0], 32767);
+    EXPECT_EQ(down.value[1], 32767);
+}
+// --------------------------------------------------------------------------------
+
+TEST(VertexFormatTest, GeneratesDescriptionsFromTheLayout) {
+    using Compact = VertexLayout<CompactVertexTraits>;
+    using Full = VertexLayout<FullVertexTraits>;
+    static_assert(sizeof(Compact) == 16, "compact layout size");
+    static_assert(sizeof(Full) == sizeof(Vertex), "full layout size");
+
+    constexpr auto compact = Compact::getAttributeDescriptions();
+    EXPECT_EQ(Compact::getBindingDescription().stride, 16u);
+    EXPECT_EQ(compact[0].format, VK_FORMAT_R16G16B16A16_SFLOAT);
+    EXPECT_EQ(compact[1].format, VK_FORMAT_R8G8B8A8_UNORM);
+    EXPECT_EQ(compact[1].offset, 8u);
+    EXPECT_EQ(compact[2].format, VK_FORMAT_R16G16_SFLOAT);
+    EXPECT_EQ(compact[2].offset, 12u);
+
+    constexpr auto full = Full::getAttributeDescriptions();
+    EXPECT_EQ(full[0].format, VK_FORMAT_R32G32B32_SFLOAT);
+    EXPECT_EQ(full[2].offset, offsetof(Vertex, texCoord));
+
+    const Vertex vertex{{1.0f, -2.0f, 0.5f}, {1.0f, 0.0f, 0.5f}, {0.5f, 1.0f}};
+    const Compact packed = Compact::pack(vertex);
+    EXPECT_EQ(packed.pos.value[0], 0x3C00);
+    EXPECT_EQ(packed.pos.value[1], 0xC000);
+    EXPECT_EQ(packed.pos.value[3], 0x3C00);
+    EXPECT_EQ(packed.color.value[0], 255);
+    EXPECT_EQ(packed.color.value[3], 255);
+    EXPECT_EQ(packed.texCoord.value[1], 0x3C00);
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,312 @@
+// ================================================================================
+// ================================================================================
+// - File:    texture_loader.cpp
+// - Purpose: This file contains the implementation of the TextureLoader class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/texture_loader.hpp"
+
+#include <cstring>  // memcpy
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+// ================================================================================
+// ================================================================================
+
+// Container layout constants
+static const uint8_t KTX2_IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+static const size_t KTX2_HEADER_SIZE = 80;      // identifier + header + index
+static const size_t KTX2_LEVEL_ENTRY_SIZE = 24; // byteOffset, byteLength, uncompressedByteLength
+static const size_t DDS_HEADER_SIZE = 128;      // magic + DDS_HEADER
+static const size_t DDS_DX10_HEADER_SIZE = 20;
+static const VkDeviceSize LEVEL_ALIGNMENT = 16;
+
+static constexpr uint32_t makeFourCC(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(a)) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+}
+// --------------------------------------------------------------------------------
+
+static uint32_t readU32(const std::vector<uint8_t>& bytes, size_t offset) {
+    uint32_t value;
+    memcpy(&value, bytes.data() + offset, sizeof(value));
+    return value;
+}
+// --------------------------------------------------------------------------------
+
+static uint64_t readU64(const std::vector<uint8_t>& bytes, size_t offset) {
+    uint64_t value;
+    memcpy(&value, bytes.data() + offset, sizeof(value));
+    return value;
+}
+// --------------------------------------------------------------------------------
+
+static bool hasExtension(const std::string& path, const std::string& extension) {
+    if (path.size() < extension.size()) {
+        return false;
+    }
+    std::string tail = path.substr(path.size() - extension.size());
+    std::transform(tail.begin(), tail.end(), tail.begin(), [](unsigned char c) { return std::tolower(c); });
+    return tail == extension;
+}
+// ================================================================================
+// ================================================================================
+
+bool TextureLoader::isCompressedContainer(const std::string& path) {
+    return hasExtension(path, ".ktx2") || hasExtension(path, ".dds");
+}
+// --------------------------------------------------------------------------------
+
+CompressedTexture TextureLoader::loadFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        throw std::runtime_error("TextureLoader: Failed to open " + path);
+    }
+    std::vector<uint8_t> bytes(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+        throw std::runtime_error("TextureLoader: Failed to read " + path);
+    }
+
+    if (hasExtension(path, ".ktx2")) {
+        return parseKTX2(bytes);
+    }
+    if (hasExtension(path, ".dds")) {
+        return parseDDS(bytes);
+    }
+    throw std::runtime_error("TextureLoader: Unsupported container " + path);
+}
+// --------------------------------------------------------------------------------
+
+VkFormat TextureLoader::peekFormat(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return VK_FORMAT_UNDEFINED;
+    }
+    std::vector<uint8_t> header(DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE, 0);
+    file.read(reinterpret_cast<char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    const size_t bytesRead = static_cast<size_t>(file.gcount());
+
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    if (hasExtension(path, ".ktx2")) {
+        if (bytesRead >= KTX2_HEADER_SIZE && memcmp(header.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0) {
+            format = static_cast<VkFormat>(readU32(header, 12));
+        }
+    } else if (hasExtension(path, ".dds")) {
+        if (bytesRead >= DDS_HEADER_SIZE && readU32(header, 0) == makeFourCC('D', 'D', 'S', ' ')) {
+            const uint32_t fourCC = readU32(header, 84);
+            if (fourCC == makeFourCC('D', 'X', '1', '0')) {
+                format = bytesRead >= DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE
+                         ? formatFromDXGI(readU32(header, DDS_HEADER_SIZE))
+                         : VK_FORMAT_UNDEFINED;
+            } else {
+                format = formatFromFourCC(fourCC);
+            }
+        }
+    }
+
+    uint32_t blockWidth, blockHeight, blockBytes;
+    return getBlockInfo(format, blockWidth, blockHeight, blockBytes) ? format : VK_FORMAT_UNDEFINED;
+}
+// --------------------------------------------------------------------------------
+
+CompressedTexture TextureLoader::parseKTX2(const std::vector<uint8_t>& bytes) {
+    if (bytes.size() < KTX2_HEADER_SIZE || memcmp(bytes.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+        throw std::runtime_error("TextureLoader: Not a KTX2 file.");
+    }
+
+    CompressedTexture texture;
+    texture.format = static_cast<VkFormat>(readU32(bytes, 12));
+    texture.width = readU32(bytes, 20);
+    texture.height = readU32(bytes, 24);
+    const uint32_t pixelDepth = readU32(bytes, 28);
+    const uint32_t layerCount = readU32(bytes, 32);
+    const uint32_t faceCount = readU32(bytes, 36);
+    const uint32_t levelCount = readU32(bytes, 40);
+    const uint32_t supercompression = readU32(bytes, 44);
+
+    uint32_t blockWidth, blockHeight, blockBytes;
+    if (!getBlockInfo(texture.format, blockWidth, blockHeight, blockBytes)) {
+        throw std::runtime_error("TextureLoader: KTX2 format " + std::to_string(texture.format) +
+                                 " is not a supported block-compressed format.");
+    }
+    if (supercompression != 0) {
+        throw std::runtime_error("TextureLoader: Supercompressed KTX2 files are not supported.");
+    }
+    if (pixelDepth > 1 || layerCount > 1 || faceCount != 1 || texture.width == 0 || texture.height == 0) {
+        throw std::runtime_error("TextureLoader: Only single-layer 2D KTX2 textures are supported.");
+    }
+
+    // A level count of zero asks the loader to generate mips; only level 0 is stored
+    texture.mipLevels = std::max(levelCount, 1u);
+    if (bytes.size() < KTX2_HEADER_SIZE + texture.mipLevels * KTX2_LEVEL_ENTRY_SIZE) {
+        throw std::runtime_error("TextureLoader: Truncated KTX2 level index.");
+    }
+
+    VkDeviceSize total = 0;
+    std::vector<VkDeviceSize> sourceOffsets(texture.mipLevels);
+    std::vector<VkDeviceSize> sizes(texture.mipLevels);
+    for (uint32_t level = 0; level < texture.mipLevels; ++level) {
+        const size_t entry = KTX2_HEADER_SIZE + level * KTX2_LEVEL_ENTRY_SIZE;
+        sourceOffsets[level] = readU64(bytes, entry);
+        sizes[level] = readU64(bytes, entry + 8);
+
+        const VkDeviceSize expected = levelSize(texture.format,
+                                                std::max(texture.width >> level, 1u),
+                                                std::max(texture.height >> level, 1u));
+        if (sizes[level] < expected || sourceOffsets[level] + sizes[level] > bytes.size()) {
+            throw std::runtime_error("TextureLoader: KTX2 level " + std::to_string(level) + " is out of bounds.");
+        }
+        sizes[level] = expected;
+
+        total = (total + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+        texture.levelOffsets.push_back(total);
+        total += expected;
+    }
+
+    texture.data.resize(static_cast<size_t>(total));
+    for (uint32_t level = 0; level < texture.mipLevels; ++level) {
+        memcpy(texture.data.data() + texture.levelOffsets[level],
+               bytes.data() + sourceOffsets[level], static_cast<size_t>(sizes[level]));
+    }
+    return texture;
+}
+// --------------------------------------------------------------------------------
+
+CompressedTexture TextureLoader::parseDDS(const std::vector<uint8_t>& bytes) {
+    if (bytes.size() < DDS_HEADER_SIZE || readU32(bytes, 0) != makeFourCC('D', 'D', 'S', ' ')) {
+        throw std::runtime_error("TextureLoader: Not a DDS file.");
+    }
+
+    CompressedTexture texture;
+    texture.height = readU32(bytes, 12);
+    texture.width = readU32(bytes, 16);
+    texture.mipLevels = std::max(readU32(bytes, 28), 1u);
+
+    size_t dataOffset = DDS_HEADER_SIZE;
+    const uint32_t fourCC = readU32(bytes, 84);
+    if (fourCC == makeFourCC('D', 'X', '1', '0')) {
+        if (bytes.size() < DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE) {
+            throw std::runtime_error("TextureLoader: Truncated DDS DX10 header.");
+        }
+        texture.format = formatFromDXGI(readU32(bytes, DDS_HEADER_SIZE));
+        if (readU32(bytes, DDS_HEADER_SIZE + 12) > 1) {
+            throw std::runtime_error("TextureLoader: DDS texture arrays are not supported.");
+        }
+        dataOffset += DDS_DX10_HEADER_SIZE;
+    } else {
+        texture.format = formatFromFourCC(fourCC);
+    }
+
+    if (texture.format == VK_FORMAT_UNDEFINED) {
+        throw std::runtime_error("TextureLoader: DDS pixel format is not a supported block-compressed format.");
+    }
+    if (texture.width == 0 || texture.height == 0) {
+        throw std::runtime_error("TextureLoader: DDS texture has zero size.");
+    }
+
+    // DDS stores the levels back to back, largest first
+    VkDeviceSize total = 0;
+    std::vector<VkDeviceSize> sizes(texture.mipLevels);
+    for (uint32_t level = 0; level < texture.mipLevels; ++level) {
+        sizes[level] = levelSize(texture.format,
+                                 std::max(texture.width >> level, 1u),
+                                 std::max(texture.height >> level, 1u));
+        total = (total + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+        texture.levelOffsets.push_back(total);
+        total += sizes[level];
+    }
+
+    texture.data.resize(static_cast<size_t>(total));
+    size_t source = dataOffset;
+    for (uint32_t level = 0; level < texture.mipLevels; ++level) {
+        if (source + sizes[level] > bytes.size()) {
+            throw std::runtime_error("TextureLoader: DDS level " + std::to_string(level) + " is out of bounds.");
+        }
+        memcpy(texture.data.data() + texture.levelOffsets[level], bytes.data() + source,
+               static_cast<size_t>(sizes[level]));
+        source += static_cast<size_t>(sizes[level]);
+    }
+    return texture;
+}
+// --------------------------------------------------------------------------------
+
+bool TextureLoader::getBlockInfo(VkFormat format, uint32_t& blockWidth, uint32_t& blockHeight, uint32_t& blockBytes) {
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            blockWidth = 4; blockHeight = 4; blockBytes = 8;
+            return true;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+        case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+            blockWidth = 4; blockHeight = 4; blockBytes = 16;
+            return true;
+        case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+            blockWidth = 6; blockHeight = 6; blockBytes = 16;
+            return true;
+        case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+            blockWidth = 8; blockHeight = 8; blockBytes = 16;
+            return true;
+        default:
+            return false;
+    }
+}
+// --------------------------------------------------------------------------------
+
+VkDeviceSize TextureLoader::levelSize(VkFormat format, uint32_t width, uint32_t height) {
+    uint32_t blockWidth, blockHeight, blockBytes;
+    if (!getBlockInfo(format, blockWidth, blockHeight, blockBytes)) {
+        return 0;
+    }
+    const VkDeviceSize blocksX = (width + blockWidth - 1) / blockWidth;
+    const VkDeviceSize blocksY = (height + blockHeight - 1) / blockHeight;
+    return blocksX * blocksY * blockBytes;
+}
+// ================================================================================
+
+VkFormat TextureLoader::formatFromDXGI(uint32_t dxgiFormat) {
+    switch (dxgiFormat) {
+        case 71: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;  // DXGI_FORMAT_BC1_UNORM
+        case 72: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;   // DXGI_FORMAT_BC1_UNORM_SRGB
+        case 77: return VK_FORMAT_BC3_UNORM_BLOCK;       // DXGI_FORMAT_BC3_UNORM
+        case 78: return VK_FORMAT_BC3_SRGB_BLOCK;        // DXGI_FORMAT_BC3_UNORM_SRGB
+        case 98: return VK_FORMAT_BC7_UNORM_BLOCK;       // DXGI_FORMAT_BC7_UNORM
+        case 99: return VK_FORMAT_BC7_SRGB_BLOCK;        // DXGI_FORMAT_BC7_UNORM_SRGB
+        default: return VK_FORMAT_UNDEFINED;
+    }
+}
+// --------------------------------------------------------------------------------
+
+VkFormat TextureLoader::formatFromFourCC(uint32_t fourCC) {
+    // Legacy DDS files carry no color space; color textures in this application are sRGB
+    if (fourCC == makeFourCC('D', 'X', 'T', '1')) {
+        return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+    }
+    if (fourCC == makeFourCC('D', 'X', 'T', '5')) {
+        return VK_FORMAT_BC3_SRGB_BLOCK;
+    }
+    return VK_FORMAT_UNDEFINED;
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,557 @@
+// ================================================================================
+// ================================================================================
+// - File:    texture_registry.cpp
+// - Purpose: This file contains the implementation of the TextureRegistry class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/texture_registry.hpp"
+
+#include <fstream>
+#include <stdexcept>
+// ================================================================================
+// ================================================================================
+
+// Returns the contents of a file, or an empty vector if it cannot be opened
+static std::vector<uint8_t> readFileBytes(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return {};
+    }
+    std::vector<uint8_t> bytes(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return bytes;
+}
+// ================================================================================
+// ================================================================================
+
+TextureRegistry::TextureRegistry(AllocatorManager& allocatorManager,
+                                 VkDevice device,
+                                 VkPhysicalDevice physicalDevice,
+                                 UploadQueue& uploadQueue,
+                                 SamplerManager& samplerManager,
+                                 ThreadPool& threadPool,
+                                 DeletionQueue& deletionQueue,
+                                 VkDeviceSize budgetBytes,
+                                 BindlessTextureTable* bindlessTable)
+    : allocatorManager(allocatorManager),
+      device(device),
+      physicalDevice(physicalDevice),
+      uploadQueue(uploadQueue),
+      samplerManager(samplerManager),
+      threadPool(threadPool),
+      deletionQueue(deletionQueue),
+      budgetBytes(budgetBytes),
+      bindlessTable(bindlessTable) {}
+// --------------------------------------------------------------------------------
+
+TextureRegistry::~TextureRegistry() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    // Outstanding futures report broken_promise once their PendingLoad is released
+    pendingLoads.clear();
+    residencyWaiters.clear();
+    pendingReloads.clear();
+    for (Entry& entry : entries) {
+        entry.texture.reset();
+    }
+    entries.clear();
+}
+// --------------------------------------------------------------------------------
+
+TextureHandle TextureRegistry::acquire(const std::string& path, const SamplerDesc& samplerDesc) {
+    if (path.empty()) {
+        throw std::invalid_argument("TextureRegistry: path is empty, please provide a valid texture file path.");
+    }
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    // Same path loaded before: no I/O at all
+    auto pathIt = pathIndex.find(path);
+    if (pathIt != pathIndex.end()) {
+        ++stats.cacheHits;
+        return reference(pathIt->second);
+    }
+
+    // A different path with identical bytes shares the existing texture
+    uint64_t contentHash = 0;
+    std::vector<uint8_t> bytes = readFileBytes(path);
+    if (!bytes.empty()) {
+        contentHash = hashBytes(bytes.data(), bytes.size());
+
+        auto contentIt = contentIndex.find(contentHash);
+        if (contentIt != contentIndex.end()) {
+            ++stats.cacheHits;
+            pathIndex[path] = contentIt->second;
+            return reference(contentIt->second);
+        }
+    }
+
+    DecodedTexture decoded = TextureManager::decodeTexture(path, physicalDevice, bytes);
+    std::unique_ptr<TextureManager> texture = std::make_unique<TextureManager>(
+        allocatorManager, device, physicalDevice, uploadQueue, decoded, samplerManager, samplerDesc);
+    ++stats.cacheMisses;
+    return reference(insert(std::move(texture), path, contentHash));
+}
+// --------------------------------------------------------------------------------
+
+std::shared_future<TextureHandle> TextureRegistry::acquireAsync(const std::string& path,
+                                                                const SamplerDesc& samplerDesc,
+                                                                std::function<void(TextureHandle)> onResident) {
+    if (path.empty()) {
+        throw std::invalid_argument("TextureRegistry: path is empty, please provide a valid texture file path.");
+    }
+
+    std::shared_ptr<PendingLoad> ready;
+    std::shared_future<TextureHandle> future;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+
+        auto pathIt = pathIndex.find(path);
+        if (pathIt != pathIndex.end()) {
+            // Already loaded; only the upload may still be in flight
+            ++stats.cacheHits;
+            std::shared_ptr<PendingLoad> load = std::make_shared<PendingLoad>();
+            load->future = load->promise.get_future().share();
+            load->handle = reference(pathIt->second);
+            load->uploadTicket = entries[pathIt->second].texture->getUploadTicket();
+            if (onResident) {
+                load->callbacks.push_back(std::move(onResident));
+            }
+            future = load->future;
+            if (uploadQueue.isComplete(load->uploadTicket)) {
+                ready = load;
+            } else {
+                residencyWaiters.push_back(load);
+            }
+        } else {
+            std::shared_ptr<PendingLoad>& load = pendingLoads[path];
+            if (load) {
+                ++stats.cacheHits;
+            } else {
+                load = std::make_shared<PendingLoad>();
+                load->future = load->promise.get_future().share();
+                std::shared_ptr<PendingLoad> task = load;
+                try {
+                    threadPool.submit([this, path, samplerDesc, task]() { loadAsync(path, samplerDesc, task); });
+                } catch (...) {
+                    pendingLoads.erase(path);
+                    throw;
+                }
+            }
+            ++load->references;
+            if (onResident) {
+                load->callbacks.push_back(std::move(onResident));
+            }
+            future = load->future;
+        }
+    }
+
+    if (ready) {
+        resolve(*ready);
+    }
+    return future;
+}
+// --------------------------------------------------------------------------------
+
+void TextureRegistry::addRef(TextureHandle handle) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    lookup(handle);
+    reference(handle.index);
+}
+// --------------------------------------------------------------------------------
+
+std::shared_future<TextureHandle> TextureRegistry::reloadAsync(TextureHandle handle, const std::string& path,
+                                                               std::function<void(TextureHandle)> onSwapped) {
+    if (path.empty()) {
+        throw std::invalid_argument("TextureRegistry: path is empty, please provide a valid texture file path.");
+    }
+    std::lock_guard<std::mutex> lock(registryMutex);
+    TextureManager* texture = lookup(handle).texture.get();
+
+    std::shared_ptr<PendingReload> reload = std::make_shared<PendingReload>();
+    reload->future = reload->promise.get_future().share();
+    reload->callback = std::move(onSwapped);
+    reload->handle = handle;
+    reload->path = path;
+
+    // Held until the swap so the slot cannot be evicted while the worker writes into it
+    reference(handle.index);
+    try {
+        threadPool.submit([this, texture, reload]() {
+            try {
+                std::vector<uint8_t> bytes = readFileBytes(reload->path);
+                const uint64_t contentHash = bytes.empty() ? 0 : hashBytes(bytes.data(), bytes.size());
+                const uint64_t serial = texture->reloadTexture(
+                    TextureManager::decodeTexture(reload->path, physicalDevice, bytes));
+
+                std::lock_guard<std::mutex> lock(registryMutex);
+                reload->contentHash = contentHash;
+                reload->serial = serial;
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                reload->error = std::current_exception();
+            }
+        });
+    } catch (...) {
+        unreference(handle.index);
+        throw;
+    }
+    pendingReloads.push_back(reload);
+    return reload->future;
+}
+// --------------------------------------------------------------------------------
+
+void TextureRegistry::release(TextureHandle handle) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    Entry& entry = lookup(handle);
+    if (entry.refCount == 0) {
+        throw std::invalid_argument("TextureRegistry: release called more often than acquire.");
+    }
+    unreference(handle.index);
+}
+// --------------------------------------------------------------------------------
+
+TextureManager& TextureRegistry::get(TextureHandle handle) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return *lookup(handle).texture;
+}
+// --------------------------------------------------------------------------------
+
+BindlessIndices TextureRegistry::getBindlessIndices(TextureHandle handle) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    const Entry& entry = lookup(handle);
+    if (!bindlessTable) {
+        throw std::runtime_error("TextureRegistry: no bindless table was provided.");
+    }
+    return entry.bindless;
+}
+// --------------------------------------------------------------------------------
+
+bool TextureRegistry::isValid(TextureHandle handle) const {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return handle.isValid() && handle.index < entries.size() &&
+           entries[handle.index].generation == handle.generation &&
+           entries[handle.index].texture != nullptr;
+}
+// --------------------------------------------------------------------------------
+
+void TextureRegistry::trim() {
+    std::vector<std::shared_ptr<PendingLoad>> resident;
+    std::vector<std::shared_ptr<PendingReload>> swapped;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        ++frameCounter;
+        advanceReloads(swapped);
+
+        for (auto it = residencyWaiters.begin(); it != residencyWaiters.end();) {
+            if (uploadQueue.isComplete((*it)->uploadTicket)) {
+                resident.push_back(std::move(*it));
+                it = residencyWaiters.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        while (!lru.empty() && overBudget()) {
+            const uint32_t index = lru.front();
+            // Frames recorded before the last release may still be sampling the texture
+            if (frameCounter - entries[index].releasedFrame < MAX_FRAMES_IN_FLIGHT) {
+                break;
+            }
+            evict(index);
+        }
+    }
+
+    // Callbacks may call back into the registry, so they run without the lock
+    for (const std::shared_ptr<PendingLoad>& load : resident) {
+        resolve(*load);
+    }
+    for (const std::shared_ptr<PendingReload>& reload : swapped) {
+        if (reload->error) {
+            reload->promise.set_exception(reload->error);
+            continue;
+        }
+        reload->promise.set_value(reload->handle);
+        if (reload->callback) {
+            reload->callback(reload->handle);
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+void TextureRegistry::setBudget(VkDeviceSize budgetBytes) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    this->budgetBytes = budgetBytes;
+}
+// --------------------------------------------------------------------------------
+
+TextureRegistry::Stats TextureRegistry::getStats() const {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    Stats snapshot = stats;
+    snapshot.pendingLoads = pendingLoads.size() + residencyWaiters.size();
+    return snapshot;
+}
+// --------------------------------------------------------------------------------
+
+uint64_t TextureRegistry::hashBytes(const uint8_t* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+// ================================================================================
+
+TextureRegistry::Entry& TextureRegistry::lookup(TextureHandle handle) {
+    if (!handle.isValid() || handle.index >= entries.size() ||
+        entries[handle.index].generation != handle.generation ||
+        entries[handle.index].texture == nullptr) {
+        throw std::invalid_argument("TextureRegistry: stale or invalid texture handle.");
+    }
+    return entries[handle.index];
+}
+// --------------------------------------------------------------------------------
+
+TextureHandle TextureRegistry::reference(uint32_t index) {
+    Entry& entry = entries[index];
+    if (entry.refCount++ == 0 && entry.lruPosition != lru.end()) {
+        lru.erase(entry.lruPosition);
+        entry.lruPosition = lru.end();
+        --stats.unreferencedTextures;
+    }
+    return TextureHandle{index, entry.generation};
+}
+// --------------------------------------------------------------------------------
+
+void TextureRegistry::unreference(uint32_t index) {
+    Entry& entry = entries[index];
+    if (--entry.refCount == 0) {
+        entry.releasedFrame = frameCounter;
+        entry.lruPosition = lru.insert(lru.end(), index);
+        ++stats.unreferencedTextures;
+    }
+}
+// --------------------------------------------------------------------------------
+
+void TextureRegistry::advanceReloads(std::vector<std::shared_ptr<PendingReload>>& swapped) {
+    for (auto it = pendingReloads.begin(); it != pendingReloads.end();) {
+        PendingReload& reload = **it;
+        const uint32_t index = reload.handle.index;
+        TextureManager& texture = *entries[index].texture;
+
+        if (!reload.error) {
+            if (reload.serial == 0) {
+                ++it;
+                continue;
+            }
+            const VkDeviceSize previousSize = texture.getSizeInBytes();
+            if (texture.commitReload(deletionQueue)) {
+                stats.residentBytes = stats.residentBytes - previousSize + texture.getSizeInBytes();
+                retiringSlots.push_back(index);
+                if (bindlessTable) {
+                    // Frames in flight keep sampling the old view through the old slot
+                    const uint32_t retiredSlot = entries[index].bindless.texture;
+                    entries[index].bindless.texture = bindlessTable->addTexture(texture.getTextureImageView());
+                    BindlessTextureTable* table = bindlessTable;
+                    deletionQueue.push([table, retiredSlot]() { table->removeTexture(retiredSlot); });
+                }
+            }
+            // A later reload of the same texture may have superseded this one before it went live
+            if (texture.getCommittedReload() < reload.serial) {
+                ++it;
+                continue;
+            }
+            reindex(index, reload.path, reload.contentHash);
+        }
+
+        unreference(index);
+        swapped.push_back(std::move(*it));
+        it = pendingReloads.erase(it);
+    }
+
+    for (auto it = retiringSlots.begin(); it != retiringSlots.end();) {
+        if (entries[*it].texture->releaseRetired() == 0) {
+            it = retiringSlots.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+void TextureRegistry::reindex(uint32_t index, const std::string& path, uint64_t contentHash) {
+    Entry& entry = entries[index];
+    for (auto it = pathIndex.begin(); it != pathIndex.end();) {
+        it = it->second == index ? pathIndex.erase(it) : std::next(it);
+    }
+    auto contentIt = contentIndex.find(entry.contentHash);
+    if (contentIt != contentIndex.end() && contentIt->second == index) {
+        contentIndex.erase(contentIt);
+    }
+
+    entry.path = path;
+    entry.contentHash = contentHash;
+    pathIndex[path] = index;
+    if (contentHash != 0) {
+        contentIndex[contentHash] = index;
+    }
+}
+// --------------------------------------------------------------------------------
+
+uint32_t TextureRegistry::insert(std::unique_ptr<TextureManager> texture, const std::string& path,
+                                 uint64_t contentHash) {
+    // Taken first so a full table leaves the registry unchanged
+    BindlessIndices bindless;
+    if (bindlessTable) {
+        bindless.sampler = bindlessTable->addSampler(texture->getTextureSampler());
+        bindless.texture = bindlessTable->addTexture(texture->getTextureImageView());
+    }
+
+    uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(entries.size());
+        entries.emplace_back();
+    }
+
+    Entry& entry = entries[index];
+    entry.texture = std::move(texture);
+    entry.path = path;
+    entry.contentHash = contentHash;
+    entry.refCount = 0;
+    entry.lruPosition = lru.end();
+    entry.bindless = bindless;
+
+    stats.residentBytes += entry.texture->getSizeInBytes();
+    ++stats.residentTextures;
+    pathIndex.emplace(path, index);
+    if (contentHash != 0) {
+        contentIndex.emplace(contentHash, index);
+    }
+    return index;
+}
+// --------------------------------------------------------------------------------
+
+void TextureRegistry::loadAsync(const std::string& path, const SamplerDesc& samplerDesc,
+                                const std::shared_ptr<PendingLoad>& load) {
+    try {
+        std::vector<uint8_t> bytes = readFileBytes(path);
+        const uint64_t contentHash = bytes.empty() ? 0 : hashBytes(bytes.data(), bytes.size());
+
+        if (contentHash != 0) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            auto contentIt = contentIndex.find(contentHash);
+            if (contentIt != contentIndex.end()) {
+                pathIndex.emplace(path, contentIt->second);
+                completeLoad(path, contentIt->second, load);
+                return;
+            }
+        }
+
+        // Decoding and CPU mip generation run unlocked; only the staging copy is serialized
+        DecodedTexture decoded = TextureManager::decodeTexture(path, physicalDevice, bytes);
+        std::unique_ptr<TextureManager> texture = std::make_unique<TextureManager>(
+            allocatorManager, device, physicalDevice, uploadQueue, decoded, samplerManager, samplerDesc);
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        ++stats.cacheMisses;
+        completeLoad(path, insert(std::move(texture), path, contentHash), load);
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            pendingLoads.erase(path);
+        }
+        load->promise.set_exception(std::current_exception());
+    }
+}
+// --------------------------------------------------------------------------------
+
+void TextureRegistry::completeLoad(const std::string& path, uint32_t index,
+                                   const std::shared_ptr<PendingLoad>& load) {
+    for (uint32_t i = 0; i < load->references; ++i) {
+        load->handle = reference(index);
+    }
+    load->uploadTicket = entries[index].texture->getUploadTicket();
+    residencyWaiters.push_back(load);
+    pendingLoads.erase(path);
+}
+// --------------------------------------------------------------------------------
+
+void TextureRegistry::resolve(PendingLoad& load) {
+    load.promise.set_value(load.handle);
+    for (const std::function<void(TextureHandle)>& callback : load.callbacks) {
+        callback(load.handle);
+    }
+}
+// --------------------------------------------------------------------------------
+
+bool TextureRegistry::overBudget() const {
+    if (budgetBytes != 0 && stats.residentBytes > budgetBytes) {
+        return true;
+    }
+
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(allocatorManager.getAllocator(), &memoryProperties);
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+    vmaGetHeapBudgets(allocatorManager.getAllocator(), budgets);
+
+    for (uint32_t heap = 0; heap < memoryProperties->memoryHeapCount; ++heap) {
+        if ((memoryProperties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) &&
+            budgets[heap].usage > budgets[heap].budget) {
+            return true;
+        }
+    }
+    return false;
+}
+// --------------------------------------------------------------------------------
+
+void TextureRegistry::evict(uint32_t index) {
+    Entry& entry = entries[index];
+
+    // Remove every path alias that resolves to this slot
+    for (auto it = pathIndex.begin(); it != pathIndex.end();) {
+        it = it->second == index ? pathIndex.erase(it) : std::next(it);
+    }
+    auto contentIt = contentIndex.find(entry.contentHash);
+    if (contentIt != contentIndex.end() && contentIt->second == index) {
+        contentIndex.erase(contentIt);
+    }
+    if (entry.lruPosition != lru.end()) {
+        lru.erase(entry.lruPosition);
+        entry.lruPosition = lru.end();
+        --stats.unreferencedTextures;
+    }
+
+    // Destroying the texture also destroys its superseded images, whose uploads are long done
+    for (auto it = retiringSlots.begin(); it != retiringSlots.end();) {
+        it = *it == index ? retiringSlots.erase(it) : std::next(it);
+    }
+
+    stats.residentBytes -= entry.texture->getSizeInBytes();
+    --stats.residentTextures;
+    ++stats.evictions;
+
+    // No frame in flight samples an evicted texture, so its slot is free right away
+    if (bindlessTable) {
+        bindlessTable->removeTexture(entry.bindless.texture);
+    }
+    entry.texture.reset();
+    entry.path.clear();
+    entry.contentHash = 0;
+    // Skip generation 0 so a default-constructed handle never matches
+    entry.generation = entry.generation + 1 == 0 ? 1 : entry.generation + 1;
+    freeSlots.push_back(index);
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,79 @@
+// ================================================================================
+// ================================================================================
+// - File:    thread_pool.cpp
+// - Purpose: This file contains the implementation of the ThreadPool class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/thread_pool.hpp"
+
+#include <algorithm>
+// ================================================================================
+// ================================================================================
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) {
+        const size_t hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = std::max<size_t>(hardwareThreads > 1 ? hardwareThreads - 1 : 1, 1);
+    }
+
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+// --------------------------------------------------------------------------------
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        stopping = true;
+        tasks.clear();
+    }
+    taskAvailable.notify_all();
+
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+size_t ThreadPool::size() const {
+    return workers.size();
+}
+// --------------------------------------------------------------------------------
+
+size_t ThreadPool::pending() const {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return tasks.size();
+}
+// ================================================================================
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(poolMutex);
+            taskAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        // Exceptions are captured by the packaged task and rethrown from the future
+        task();
+    }
+}
+// ================================================================================
+// ================================================================================
+// eof
@@ -0,0 +1,673 @@
+// ================================================================================
+// ================================================================================
+// - File:    upload.cpp
+// - Purpose: This file contains the implementation of the UploadQueue class
+//
+// Source Metadata
+// - Author:  Jonathan A. Webb
+// - Date:    October 14, 2026
+// - Version: 1.0
+// - Copyright: Copyright 2022, Jon Webb Inc.
+// ================================================================================
+// ================================================================================
+// Include modules here
+
+#include "include/upload.hpp"
+
+#include <cstring>  // memcpy
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+// ================================================================================
+// ================================================================================
+
+UploadQueue::UploadQueue(VkDevice device,
+                         AllocatorManager& allocatorManager,
+                         VkQueue transferQueue,
+                         uint32_t transferFamily,
+                         VkQueue graphicsQueue,
+                         uint32_t graphicsFamily)
+    : device(device),
+      allocatorManager(allocatorManager),
+      transferQueue(transferQueue),
+      transferFamily(transferFamily),
+      graphicsQueue(graphicsQueue),
+      graphicsFamily(graphicsFamily),
+      dedicatedTransfer(transferFamily != graphicsFamily),
+      submitThread(std::this_thread::get_id()) {
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = transferFamily;
+
+    VkResult result = vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error(std::string("UploadQueue: Failed to create command pool! Error code: ") +
+                                 std::to_string(result));
+    }
+
+    if (dedicatedTransfer) {
+        poolInfo.queueFamilyIndex = graphicsFamily;
+        result = vkCreateCommandPool(device, &poolInfo, nullptr, &acquirePool);
+        if (result != VK_SUCCESS) {
+            vkDestroyCommandPool(device, commandPool, nullptr);
+            throw std::runtime_error(std::string("UploadQueue: Failed to create acquire command pool! Error code: ") +
+                                     std::to_string(result));
+        }
+    }
+}
+// --------------------------------------------------------------------------------
+
+UploadQueue::~UploadQueue() {
+    std::lock_guard<std::mutex> lock(uploadMutex);
+
+    if (recordingOpen) {
+        flushLocked();
+    }
+
+    for (Batch& batch : inFlight) {
+        vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+        retire(batch);
+    }
+    inFlight.clear();
+
+    for (Batch& batch : freeBatches) {
+        if (batch.fence != VK_NULL_HANDLE) {
+            vkDestroyFence(device, batch.fence, nullptr);
+        }
+        if (batch.semaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(device, batch.semaphore, nullptr);
+        }
+    }
+    freeBatches.clear();
+
+    // Destroying the pools frees every command buffer allocated from them
+    if (commandPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(device, commandPool, nullptr);
+        commandPool = VK_NULL_HANDLE;
+    }
+    if (acquirePool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(device, acquirePool, nullptr);
+        acquirePool = VK_NULL_HANDLE;
+    }
+}
+// --------------------------------------------------------------------------------
+
+void UploadQueue::uploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset) {
+    if (size == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    beginRecording();
+
+    VkDeviceSize srcOffset = 0;
+    VkBuffer stagingBuffer = stage(data, size, srcOffset);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = srcOffset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(recording.commandBuffer, stagingBuffer, dstBuffer, 1, &copyRegion);
+
+    // A buffer written on the transfer family must be handed over to the graphics family
+    // before it can be bound for drawing
+    if (dedicatedTransfer) {
+        VkBufferMemoryBarrier bufferBarrier{};
+        bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        bufferBarrier.dstAccessMask = 0;
+        bufferBarrier.srcQueueFamilyIndex = transferFamily;
+        bufferBarrier.dstQueueFamilyIndex = graphicsFamily;
+        bufferBarrier.buffer = dstBuffer;
+        bufferBarrier.offset = dstOffset;
+        bufferBarrier.size = size;
+        recording.bufferReleaseBarriers.push_back(bufferBarrier);
+    }
+}
+// --------------------------------------------------------------------------------
+
+uint64_t UploadQueue::uploadImage(VkImage image, const void* data, VkDeviceSize size, uint32_t width,
+                                  uint32_t height, uint32_t mipLevels) {
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    beginRecording();
+
+    VkDeviceSize srcOffset = 0;
+    VkBuffer stagingBuffer = stage(data, size, srcOffset);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = srcOffset;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {width, height, 1};
+
+    mipLevels = std::max(mipLevels, 1u);
+    recordImageCopy(image, stagingBuffer, {region}, mipLevels, mipLevels > 1);
+    if (mipLevels > 1) {
+        recording.mipJobs.push_back({image, width, height, mipLevels});
+    }
+    return nextTicket;
+}
+// --------------------------------------------------------------------------------
+
+uint64_t UploadQueue::uploadImageLevels(VkImage image, const void* data, VkDeviceSize size, uint32_t width,
+                                        uint32_t height, const std::vector<VkDeviceSize>& levelOffsets) {
+    if (levelOffsets.empty()) {
+        throw std::invalid_argument("UploadQueue: uploadImageLevels requires at least one mip level.");
+    }
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    beginRecording();
+
+    VkDeviceSize srcOffset = 0;
+    VkBuffer stagingBuffer = stage(data, size, srcOffset);
+
+    std::vector<VkBufferImageCopy> regions(levelOffsets.size());
+    for (uint32_t level = 0; level < regions.size(); ++level) {
+        VkBufferImageCopy& region = regions[level];
+        region.bufferOffset = srcOffset + levelOffsets[level];
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {std::max(width >> level, 1u), std::max(height >> level, 1u), 1};
+    }
+
+    recordImageCopy(image, stagingBuffer, regions, static_cast<uint32_t>(regions.size()), false);
+    return nextTicket;
+}
+// --------------------------------------------------------------------------------
+
+uint64_t UploadQueue::flush() {
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    return flushLocked();
+}
+// --------------------------------------------------------------------------------
+
+bool UploadQueue::isComplete(uint64_t ticket) {
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    collectLocked();
+    return ticket <= completedTicket;
+}
+// --------------------------------------------------------------------------------
+
+void UploadQueue::wait(uint64_t ticket) {
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    if (recordingOpen && ticket >= nextTicket) {
+        flushLocked();
+    }
+
+    for (Batch& batch : inFlight) {
+        if (batch.ticket > ticket) {
+            break;
+        }
+        VkResult result = vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error(std::string("UploadQueue: Failed to wait for upload batch ") +
+                                     std::to_string(batch.ticket) + ". Error code: " +
+                                     std::to_string(result));
+        }
+    }
+    collectLocked();
+}
+// --------------------------------------------------------------------------------
+
+void UploadQueue::waitIdle() {
+    uint64_t ticket;
+    {
+        std::lock_guard<std::mutex> lock(uploadMutex);
+        ticket = flushLocked();
+    }
+    wait(ticket);
+}
+// --------------------------------------------------------------------------------
+
+void UploadQueue::collect() {
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    collectLocked();
+}
+// --------------------------------------------------------------------------------
+
+uint64_t UploadQueue::pendingTicket() const {
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    return nextTicket;
+}
+// --------------------------------------------------------------------------------
+
+bool UploadQueue::usesDedicatedTransferQueue() const {
+    return dedicatedTransfer;
+}
+// ================================================================================
+
+void UploadQueue::beginRecording() {
+    if (recordingOpen) {
+        return;
+    }
+
+    if (!freeBatches.empty()) {
+        recording = std::move(freeBatches.back());
+        freeBatches.pop_back();
+        vkResetCommandBuffer(recording.commandBuffer, 0);
+    } else {
+        recording = Batch{};
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = commandPool;
+        allocInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(device, &allocInfo, &recording.commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("UploadQueue: Failed to allocate command buffer!");
+        }
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        if (vkCreateFence(device, &fenceInfo, nullptr, &recording.fence) != VK_SUCCESS) {
+            throw std::runtime_error("UploadQueue: Failed to create fence!");
+        }
+
+        if (dedicatedTransfer) {
+            allocInfo.commandPool = acquirePool;
+            if (vkAllocateCommandBuffers(device, &allocInfo, &recording.acquireCommandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("UploadQueue: Failed to allocate acquire command buffer!");
+            }
+
+            VkSemaphoreCreateInfo semaphoreInfo{};
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &recording.semaphore) != VK_SUCCESS) {
+                throw std::runtime_error("UploadQueue: Failed to create upload semaphore!");
+            }
+        }
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(recording.commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("UploadQueue: Failed to begin command buffer!");
+    }
+    recordingOpen = true;
+}
+// --------------------------------------------------------------------------------
+
+VkBuffer UploadQueue::stage(const void* data, VkDeviceSize size, VkDeviceSize& srcOffset) {
+    // Copy offsets out of the ring must satisfy the texel and optimal copy alignment of the image formats in use
+    constexpr VkDeviceSize stagingAlignment = 16;
+    StagingRing& ring = allocatorManager.getStagingRing();
+
+    if (size <= ring.getCapacity()) {
+        // Queues need external synchronization, so loader threads never submit the open batch
+        const bool mayFlush = std::this_thread::get_id() == submitThread;
+        StagingRing::Region region;
+        bool stalled = false;
+        bool allocated = ring.tryAllocate(size, stagingAlignment, region);
+        while (!allocated) {
+            if (!stalled) {
+                ring.recordStall();
+                stalled = true;
+            }
+            if (inFlight.empty()) {
+                if (!mayFlush) {
+                    break;
+                }
+                // The open batch holds the space we need; submit it so it can retire
+                flushLocked();
+                beginRecording();
+            } else {
+                VkResult result = vkWaitForFences(device, 1, &inFlight.front().fence, VK_TRUE, UINT64_MAX);
+                if (result != VK_SUCCESS) {
+                    throw std::runtime_error(std::string("UploadQueue: Failed to wait for staging space. Error code: ") +
+                                             std::to_string(result));
+                }
+                collectLocked();
+            }
+            allocated = ring.tryAllocate(size, stagingAlignment, region);
+        }
+
+        if (allocated) {
+            memcpy(region.mapped, data, static_cast<size_t>(size));
+            ring.flush(region, size);
+            srcOffset = region.offset;
+            return region.buffer;
+        }
+    }
+
+    ring.recordDedicatedFallback();
+    StagingBuffer staging;
+    allocatorManager.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                  VMA_MEMORY_USAGE_CPU_ONLY, staging.buffer, staging.allocation,
+                                  MemoryCategory::Staging);
+
+    void* mapped = nullptr;
+    try {
+        allocatorManager.mapMemory(staging.allocation, &mapped);
+    } catch (const std::runtime_error&) {
+        allocatorManager.destroyBuffer(staging.buffer, staging.allocation);
+        throw;
+    }
+    memcpy(mapped, data, static_cast<size_t>(size));
+    allocatorManager.unmapMemory(staging.allocation);
+
+    recording.stagingBuffers.push_back(staging);
+    srcOffset = 0;
+    return staging.buffer;
+}
+// --------------------------------------------------------------------------------
+
+void UploadQueue::recordImageCopy(VkImage image, VkBuffer stagingBuffer,
+                                  const std::vector<VkBufferImageCopy>& regions,
+                                  uint32_t mipLevels, bool generateMips) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = mipLevels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(recording.commandBuffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &barrier);
+
+    vkCmdCopyBufferToImage(recording.commandBuffer, stagingBuffer, image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+
+    if (generateMips) {
+        // The blit chain performs the final transitions itself, so only an ownership
+        // transfer is needed when the copies ran on another queue family
+        if (!dedicatedTransfer) {
+            return;
+        }
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    } else {
+        // The transition to a sampled layout is deferred so that all images in the batch
+        // share one barrier at flush time
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    }
+    if (dedicatedTransfer) {
+        barrier.srcQueueFamilyIndex = transferFamily;
+        barrier.dstQueueFamilyIndex = graphicsFamily;
+    }
+    recording.releaseBarriers.push_back(barrier);
+}
+// --------------------------------------------------------------------------------
+
+void UploadQueue::recordMipChain(VkCommandBuffer commandBuffer, const MipJob& job) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = job.image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.subresourceRange.levelCount = 1;
+
+    int32_t mipWidth = static_cast<int32_t>(job.width);
+    int32_t mipHeight = static_cast<int32_t>(job.height);
+
+    for (uint32_t level = 1; level < job.mipLevels; ++level) {
+        // The previous level has been written by the copy or the previous blit; read from it next
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0,
+                             0, nullptr,
+                             0, nullptr,
+                             1, &barrier);
+
+        int32_t nextWidth = mipWidth > 1 ? mipWidth / 2 : 1;
+        int32_t nextHeight = mipHeight > 1 ? mipHeight / 2 : 1;
+
+        VkImageBlit blit{};
+        blit.srcOffsets[0] = {0, 0, 0};
+        blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = level - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = 1;
+        blit.dstOffsets[0] = {0, 0, 0};
+        blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = level;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount = 1;
+
+        vkCmdBlitImage(commandBuffer,
+                       job.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       job.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       1, &blit,
+                       VK_FILTER_LINEAR);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0,
+                             0, nullptr,
+                             0, nullptr,
+                             1, &barrier);
+
+        mipWidth = nextWidth;
+        mipHeight = nextHeight;
+    }
+
+    // The last level is only ever written
+    barrier.subresourceRange.baseMipLevel = job.mipLevels - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &barrier);
+}
+// --------------------------------------------------------------------------------
+
+uint64_t UploadQueue::flushLocked() {
+    if (!recordingOpen) {
+        return nextTicket - 1;
+    }
+
+    if (dedicatedTransfer) {
+        submitWithOwnershipTransfer();
+    } else {
+        for (const MipJob& job : recording.mipJobs) {
+            recordMipChain(recording.commandBuffer, job);
+        }
+
+        // Make every transfer in the batch visible to the stages that consume uploaded data
+        VkMemoryBarrier memoryBarrier{};
+        memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                                      VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(recording.commandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0,
+                             1, &memoryBarrier,
+                             0, nullptr,
+                             static_cast<uint32_t>(recording.releaseBarriers.size()),
+                             recording.releaseBarriers.data());
+
+        if (vkEndCommandBuffer(recording.commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("UploadQueue: Failed to record upload command buffer!");
+        }
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &recording.commandBuffer;
+
+        VkResult result = vkQueueSubmit(graphicsQueue, 1, &submitInfo, recording.fence);
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error(std::string("UploadQueue: Failed to submit upload batch! Error code: ") +
+                                     std::to_string(result));
+        }
+    }
+
+    recording.ticket = nextTicket++;
+    recording.ringMark = allocatorManager.getStagingRing().mark();
+    recording.releaseBarriers.clear();
+    recording.bufferReleaseBarriers.clear();
+    recording.mipJobs.clear();
+    inFlight.push_back(std::move(recording));
+    recording = Batch{};
+    recordingOpen = false;
+
+    return inFlight.back().ticket;
+}
+// --------------------------------------------------------------------------------
+
+void UploadQueue::submitWithOwnershipTransfer() {
+    // Release: the transfer family gives up ownership once the copies are done. The layout
+    // transition is part of the ownership transfer and must match on both sides.
+    std::vector<VkImageMemoryBarrier> imageBarriers = recording.releaseBarriers;
+    std::vector<VkBufferMemoryBarrier> bufferBarriers = recording.bufferReleaseBarriers;
+    for (VkImageMemoryBarrier& barrier : imageBarriers) {
+        barrier.dstAccessMask = 0;
+    }
+
+    vkCmdPipelineBarrier(recording.commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0,
+                         0, nullptr,
+                         static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+                         static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+    if (vkEndCommandBuffer(recording.commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("UploadQueue: Failed to record upload command buffer!");
+    }
+
+    VkSubmitInfo transferSubmit{};
+    transferSubmit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    transferSubmit.commandBufferCount = 1;
+    transferSubmit.pCommandBuffers = &recording.commandBuffer;
+    transferSubmit.signalSemaphoreCount = 1;
+    transferSubmit.pSignalSemaphores = &recording.semaphore;
+
+    VkResult result = vkQueueSubmit(transferQueue, 1, &transferSubmit, VK_NULL_HANDLE);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error(std::string("UploadQueue: Failed to submit upload batch! Error code: ") +
+                                 std::to_string(result));
+    }
+
+    // Acquire: the graphics family takes ownership and makes the data visible to consumers.
+    // Images that still need their mip chain stay in TRANSFER_DST_OPTIMAL for the blits.
+    for (VkImageMemoryBarrier& barrier : imageBarriers) {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = barrier.newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+                                ? VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT
+                                : VK_ACCESS_SHADER_READ_BIT;
+    }
+    for (VkBufferMemoryBarrier& barrier : bufferBarriers) {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                                VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkResetCommandBuffer(recording.acquireCommandBuffer, 0);
+    if (vkBeginCommandBuffer(recording.acquireCommandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("UploadQueue: Failed to begin acquire command buffer!");
+    }
+
+    vkCmdPipelineBarrier(recording.acquireCommandBuffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT |
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0,
+                         0, nullptr,
+                         static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+                         static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+    // Blits need a graphics-capable queue, so mip chains are generated after the acquire
+    for (const MipJob& job : recording.mipJobs) {
+        recordMipChain(recording.acquireCommandBuffer, job);
+    }
+
+    if (vkEndCommandBuffer(recording.acquireCommandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("UploadQueue: Failed to record acquire command buffer!");
+    }
+
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    VkSubmitInfo acquireSubmit{};
+    acquireSubmit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    acquireSubmit.waitSemaphoreCount = 1;
+    acquireSubmit.pWaitSemaphores = &recording.semaphore;
+    acquireSubmit.pWaitDstStageMask = &waitStage;
+    acquireSubmit.commandBufferCount = 1;
+    acquireSubmit.pCommandBuffers = &recording.acquireCommandBuffer;
+
+    result = vkQueueSubmit(graphicsQueue, 1, &acquireSubmit, recording.fence);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error(std::string("UploadQueue: Failed to submit acquire batch! Error code: ") +
+                                 std::to_string(result));
+    }
+}
+// --------------------------------------------------------------------------------
+
+void UploadQueue::collectLocked() {
+    while (!inFlight.empty() && vkGetFenceStatus(device, inFlight.front().fence) == VK_SUCCESS) {
+        completedTicket = inFlight.front().ticket;
+        retire(inFlight.front());
+        inFlight.pop_front();
+    }
+}
+// --------------------------------------------------------------------------------
+
+void UploadQueue::retire(Batch& batch) {
+    for (const StagingBuffer& staging : batch.stagingBuffers) {
+        allocatorManager.destroyBuffer(staging.buffer, staging.allocation);
+    }
+    batch.stagingBuffers.clear();
+    allocatorManager.getStagingRing().release(batch.ringMark);
+    batch.releaseBarriers.clear();
+    batch.bufferReleaseBarriers.clear();
+    batch.mipJobs.clear();
+    vkResetFences(device, 1, &batch.fence);
+
+    completedTicket = std::max(completedTicket, batch.ticket);
+    freeBatches.push_back(std::move(batch));
+}
+// ================================================================================
+// ================================================================================
+// eof